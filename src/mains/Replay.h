@@ -0,0 +1,332 @@
+/*
+ * (C) Crown copyright 2021 Met Office. All rights reserved.
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ */
+
+#ifndef MAINS_REPLAY_H_
+#define MAINS_REPLAY_H_
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "eckit/config/LocalConfiguration.h"
+#include "eckit/exception/Exceptions.h"
+#include "eckit/mpi/Comm.h"
+
+#include "oops/base/ObsFilters.h"
+#include "oops/base/Variables.h"
+#include "oops/interface/GeoVaLs.h"
+#include "oops/interface/ObsAuxControl.h"
+#include "oops/interface/ObsDataVector.h"
+#include "oops/interface/ObsDiagnostics.h"
+#include "oops/interface/ObsOperator.h"
+#include "oops/interface/ObsSpace.h"
+#include "oops/interface/ObsVector.h"
+#include "oops/mpi/mpi.h"
+#include "oops/runs/Application.h"
+#include "oops/util/DateTime.h"
+#include "oops/util/Logger.h"
+#include "oops/util/parameters/OptionalParameter.h"
+#include "oops/util/parameters/Parameter.h"
+#include "oops/util/parameters/Parameters.h"
+#include "oops/util/parameters/RequiredParameter.h"
+
+#include "ufo/ObsBiasParameters.h"
+#include "ufo/ObsTraits.h"
+#include "ufo/utils/Instrumentation.h"
+#include "ufo/utils/ParallelFor.h"
+
+namespace ufo {
+
+/// \brief Options controlling the replay of the processing of a single ObsSpace.
+class ReplayObsTypeParameters : public oops::Parameters {
+  OOPS_CONCRETE_PARAMETERS(ReplayObsTypeParameters, Parameters)
+
+ public:
+  /// Options used to configure the observation space.
+  oops::RequiredParameter<eckit::LocalConfiguration> obsSpace{"obs space", this};
+
+  /// Options used to configure the observation operator. If not set, H(x) is not computed and
+  /// only the filters not depending on it are run.
+  oops::OptionalParameter<eckit::LocalConfiguration> obsOperator{"obs operator", this};
+
+  /// Options used to configure the observation bias.
+  oops::Parameter<ObsBiasParameters> obsBias{"obs bias", {}, this};
+
+  /// Options used to configure observation filters.
+  oops::Parameter<std::vector<oops::ObsFilterParametersWrapper<ObsTraits>>> obsFilters{
+    "obs filters", {}, this};
+
+  /// Options used to load GeoVaLs from a file. Required if the observation operator, the bias
+  /// correction or any filter depends on GeoVaLs.
+  oops::OptionalParameter<eckit::LocalConfiguration> geovals{"geovals", this};
+};
+
+/// \brief Options of the replay application.
+class ReplayParameters : public oops::Parameters {
+  OOPS_CONCRETE_PARAMETERS(ReplayParameters, Parameters)
+
+ public:
+  oops::RequiredParameter<util::DateTime> windowBegin{"window begin", this};
+  oops::RequiredParameter<util::DateTime> windowEnd{"window end", this};
+
+  oops::RequiredParameter<std::vector<ReplayObsTypeParameters>> observations{
+    "observations", this};
+
+  /// Number of untimed runs made before the timed ones for each configuration.
+  oops::Parameter<int> warmUpRuns{"warm-up runs", 1, this};
+
+  /// Number of timed runs made for each configuration.
+  oops::Parameter<int> repetitions{"repetitions", 3, this};
+
+  /// Numbers of threads used by multithreaded UFO loops (see ufo::parallelFor()). Each value is
+  /// tried in turn; 0 stands for the number set by the `UFO_NUM_THREADS` environment variable.
+  oops::Parameter<std::vector<int>> threadCounts{"thread count", {0}, this};
+
+  /// Chunk sizes used by ufo::parallelForChunks(). Each value is tried in turn with each thread
+  /// count; 0 lets each loop choose its own chunk size.
+  oops::Parameter<std::vector<int>> chunkSizes{"chunk size", {0}, this};
+
+  /// If set, the timings are also written in JSON format to this file.
+  oops::OptionalParameter<std::string> outputFile{"output file", this};
+};
+
+// -----------------------------------------------------------------------------
+
+/// \brief Replays the computation of H(x), its bias correction and the application of a chain
+/// of filters to observations read from a file, using GeoVaLs read from a file.
+///
+/// This is meant for throughput profiling outside a full data assimilation system. Each
+/// ObsSpace is processed `warm-up runs` + `repetitions` times for every combination of the
+/// requested thread counts and chunk sizes; every run starts from scratch (the ObsSpace is
+/// reloaded). The wall-clock time taken by each stage of the timed runs on the slowest MPI
+/// rank is logged and optionally written to a JSON file.
+///
+/// The stages are: `obs space` (loading observations), `setup` (constructing the observation
+/// operator, bias and filters), `geovals` (loading GeoVaLs), `pre-process`, `prior filter`,
+/// `H(x)` (including the bias correction), `bias correction` (the part of `H(x)` spent in the
+/// bias correction) and `post filter`.
+class Replay : public oops::Application {
+  typedef oops::GeoVaLs<ObsTraits>           GeoVaLs_;
+  typedef oops::ObsAuxControl<ObsTraits>     ObsAuxCtrl_;
+  typedef oops::ObsDataVector<ObsTraits, int> ObsDataVectorInt_;
+  typedef oops::ObsDiagnostics<ObsTraits>    ObsDiags_;
+  typedef oops::ObsFilters<ObsTraits>        ObsFilters_;
+  typedef oops::ObsOperator<ObsTraits>       ObsOperator_;
+  typedef oops::ObsSpace<ObsTraits>          ObsSpace_;
+  typedef oops::ObsVector<ObsTraits>         ObsVector_;
+
+  /// Times (in seconds) of the stages of a single run, in the order in which they were run.
+  typedef std::vector<std::pair<std::string, double>> StageTimes;
+
+  /// Results obtained for a single ObsSpace and configuration.
+  struct Result {
+    std::string obsSpace;
+    int threadCount;
+    int chunkSize;
+    std::vector<StageTimes> runs;
+  };
+
+ public:
+// -----------------------------------------------------------------------------
+  explicit Replay(const eckit::mpi::Comm & comm = oops::mpi::world()) : Application(comm) {}
+// -----------------------------------------------------------------------------
+  virtual ~Replay() {}
+// -----------------------------------------------------------------------------
+  int execute(const eckit::Configuration & fullConfig) const {
+    ReplayParameters params;
+    params.validateAndDeserialize(fullConfig);
+    if (params.warmUpRuns.value() < 0 || params.repetitions.value() < 1)
+      throw eckit::UserError("The number of warm-up runs must be non-negative and the number "
+                             "of repetitions positive", Here());
+
+    // Needed to separate the time spent in the bias correction from the rest of H(x).
+    Instrumentation::instance().setEnabled(true);
+
+    std::vector<Result> results;
+    for (const ReplayObsTypeParameters & obsTypeParams : params.observations.value()) {
+      const std::string name = obsTypeParams.obsSpace.value().getString("name");
+      for (int threadCount : params.threadCounts.value()) {
+        for (int chunkSize : params.chunkSizes.value()) {
+          if (threadCount < 0 || chunkSize < 0)
+            throw eckit::UserError("Thread counts and chunk sizes must be non-negative", Here());
+          setDefaultNumThreads(threadCount);
+          setChunkSizeOverride(chunkSize);
+
+          Result result{name, threadCount, chunkSize, {}};
+          for (int run = 0; run < params.warmUpRuns.value() + params.repetitions.value(); ++run) {
+            StageTimes times = replay(params, obsTypeParams);
+            if (run >= params.warmUpRuns.value())
+              result.runs.push_back(std::move(times));
+          }
+          logResult(result);
+          results.push_back(std::move(result));
+        }
+      }
+    }
+    setDefaultNumThreads(0);
+    setChunkSizeOverride(0);
+
+    if (params.outputFile.value() != boost::none && this->getComm().rank() == 0) {
+      std::ofstream os(*params.outputFile.value());
+      if (!os)
+        throw eckit::UserError("Unable to open the file '" + *params.outputFile.value() + "'",
+                               Here());
+      writeJson(os, results);
+    }
+    return 0;
+  }
+// -----------------------------------------------------------------------------
+ private:
+  std::string appname() const {
+    return "ufo::Replay";
+  }
+// -----------------------------------------------------------------------------
+  /// \brief Process a single ObsSpace from scratch and return the times taken by each stage on
+  /// the slowest MPI rank.
+  StageTimes replay(const ReplayParameters & params,
+                    const ReplayObsTypeParameters & obsTypeParams) const {
+    StageTimes times;
+    auto startTime = std::chrono::steady_clock::now();
+    auto endStage = [&](const std::string & stage) {
+      const auto now = std::chrono::steady_clock::now();
+      double seconds = std::chrono::duration<double>(now - startTime).count();
+      this->getComm().allReduceInPlace(seconds, eckit::mpi::max());
+      times.emplace_back(stage, seconds);
+      this->getComm().barrier();
+      startTime = std::chrono::steady_clock::now();
+    };
+
+    this->getComm().barrier();
+    startTime = std::chrono::steady_clock::now();
+    ObsSpace_ obspace(obsTypeParams.obsSpace.value(), this->getComm(), params.windowBegin.value(),
+                      params.windowEnd.value(), oops::mpi::myself());
+    Instrumentation::instance().clear();
+    endStage("obs space");
+
+    ObsVector_ obserr(obspace, "ObsError");
+    std::shared_ptr<ObsDataVectorInt_> qcflags(new ObsDataVectorInt_(obspace,
+                                                                     obspace.obsvariables()));
+    ObsFilters_ filters(obspace, obsTypeParams.obsFilters.value(), qcflags, obserr);
+    std::unique_ptr<ObsOperator_> hop;
+    std::unique_ptr<ObsAuxCtrl_> ybias;
+    oops::Variables geovars = filters.requiredVars();
+    oops::Variables diagvars = filters.requiredHdiagnostics();
+    if (obsTypeParams.obsOperator.value() != boost::none) {
+      hop.reset(new ObsOperator_(obspace, *obsTypeParams.obsOperator.value()));
+      ybias.reset(new ObsAuxCtrl_(obspace, obsTypeParams.obsBias.value()));
+      geovars += hop->requiredVars();
+      geovars += ybias->requiredVars();
+      diagvars += ybias->requiredHdiagnostics();
+    }
+    endStage("setup");
+
+    std::unique_ptr<const GeoVaLs_> gval;
+    if (geovars.size() > 0) {
+      if (obsTypeParams.geovals.value() == boost::none)
+        throw eckit::UserError("The processing of the '" + obspace.obsname() +
+                               "' ObsSpace requires a 'geovals' section", Here());
+      gval.reset(new GeoVaLs_(*obsTypeParams.geovals.value(), obspace, geovars));
+    }
+    endStage("geovals");
+
+    filters.preProcess();
+    endStage("pre-process");
+
+    if (gval)
+      filters.priorFilter(*gval);
+    endStage("prior filter");
+
+    if (hop) {
+      ObsVector_ hofx(obspace);
+      ObsDiags_ diags(obspace, hop->locations(), diagvars);
+      hop->simulateObs(*gval, hofx, *ybias, diags);
+      endStage("H(x)");
+      times.emplace_back("bias correction", biasCorrectionTime(obspace.obsname()));
+
+      filters.postFilter(hofx, diags);
+      endStage("post filter");
+    }
+    // All ranks get here in the same order, so the aggregated report can be written safely.
+    Instrumentation::instance().writeReportIfRequested(obspace.comm(), obspace.obsname());
+    return times;
+  }
+// -----------------------------------------------------------------------------
+  /// \brief Return the time spent in the bias correction of \p obsSpace since the last reset of
+  /// the instrumentation registry (maximum over MPI ranks).
+  double biasCorrectionTime(const std::string & obsSpace) const {
+    double seconds = 0.0;
+    for (const auto & keyAndRecord : Instrumentation::instance().records(obsSpace))
+      if (keyAndRecord.first.entryPoint == "ObsBiasOperator::computeObsBias")
+        seconds += keyAndRecord.second.seconds;
+    this->getComm().allReduceInPlace(seconds, eckit::mpi::max());
+    return seconds;
+  }
+// -----------------------------------------------------------------------------
+  /// \brief Return the minimum, mean and maximum time taken by each stage over all runs.
+  static std::vector<std::pair<std::string, std::vector<double>>> statistics(
+      const Result & result) {
+    std::vector<std::pair<std::string, std::vector<double>>> stats;
+    for (size_t stage = 0; stage < result.runs.front().size(); ++stage) {
+      double min = result.runs.front()[stage].second, max = min, sum = 0.0;
+      for (const StageTimes & run : result.runs) {
+        min = std::min(min, run[stage].second);
+        max = std::max(max, run[stage].second);
+        sum += run[stage].second;
+      }
+      stats.emplace_back(result.runs.front()[stage].first,
+                         std::vector<double>{min, sum / result.runs.size(), max});
+    }
+    return stats;
+  }
+// -----------------------------------------------------------------------------
+  void logResult(const Result & result) const {
+    oops::Log::info() << "Replay of " << result.obsSpace << " with thread count "
+                      << result.threadCount << " and chunk size " << result.chunkSize
+                      << " (min/mean/max over " << result.runs.size() << " runs, in s):"
+                      << std::endl;
+    for (const auto & stage : statistics(result))
+      oops::Log::info() << "  " << std::left << std::setw(16) << stage.first << std::right
+                        << std::setw(12) << stage.second[0] << std::setw(12) << stage.second[1]
+                        << std::setw(12) << stage.second[2] << std::endl;
+  }
+// -----------------------------------------------------------------------------
+  void writeJson(std::ostream & os, const std::vector<Result> & results) const {
+    os << std::setprecision(12)
+       << "{\n"
+       << "  \"number of ranks\": " << this->getComm().size() << ",\n"
+       << "  \"results\": [";
+    for (size_t i = 0; i < results.size(); ++i) {
+      const Result & result = results[i];
+      os << (i == 0 ? "\n" : ",\n")
+         << "    {\n"
+         << "      \"obs space\": \"" << result.obsSpace << "\",\n"
+         << "      \"thread count\": " << result.threadCount << ",\n"
+         << "      \"chunk size\": " << result.chunkSize << ",\n"
+         << "      \"runs\": " << result.runs.size() << ",\n"
+         << "      \"stages\": {";
+      bool first = true;
+      for (const auto & stage : statistics(result)) {
+        os << (first ? "\n" : ",\n")
+           << "        \"" << stage.first << "\": {\"min\": " << stage.second[0]
+           << ", \"mean\": " << stage.second[1] << ", \"max\": " << stage.second[2] << "}";
+        first = false;
+      }
+      os << "\n      }\n    }";
+    }
+    os << (results.empty() ? "]\n" : "\n  ]\n") << "}\n";
+  }
+// -----------------------------------------------------------------------------
+};
+
+}  // namespace ufo
+
+#endif  // MAINS_REPLAY_H_
@@ -0,0 +1,14 @@
+/*
+ * (C) Crown copyright 2021 Met Office. All rights reserved.
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ */
+
+#include "./Replay.h"
+#include "oops/runs/Run.h"
+
+int main(int argc,  char ** argv) {
+  oops::Run run(argc, argv);
+  ufo::Replay replay;
+  return run.execute(replay);
+}
@@ -321,6 +321,16 @@ void GeoVaLs::get(std::vector<float> & vals, const std::string & var, const int
   oops::Log::trace() << "GeoVaLs::get done" << std::endl;
 }
 // -----------------------------------------------------------------------------
+/*! \brief Return all values for a specific variable at all levels */
+void GeoVaLs::getAllLevels(float * vals, const std::string & var) const {
+  oops::Log::trace() << "GeoVaLs::getAllLevels starting" << std::endl;
+  size_t nlocs;
+  ufo_geovals_nlocs_f90(keyGVL_, nlocs);
+  const int nlevs = this->nlevs(var);
+  ufo_geovals_get_all_levels_f90(keyGVL_, var.size(), var.c_str(), nlevs, nlocs, *vals);
+  oops::Log::trace() << "GeoVaLs::getAllLevels done" << std::endl;
+}
+// -----------------------------------------------------------------------------
 /*! \brief Return all values for a specific variable and level */
 void GeoVaLs::get(std::vector<double> & vals, const std::string & var, const int lev) const {
   oops::Log::trace() << "GeoVaLs::get starting" << std::endl;
@@ -352,6 +362,16 @@ void GeoVaLs::get(std::vector<int> & vals, const std::string & var) const {
   oops::Log::trace() << "GeoVaLs::get 2D done" << std::endl;
 }
 // -----------------------------------------------------------------------------
+/*! \brief Return all values for a specific 2D variable identified by a handle */
+void GeoVaLs::get(std::vector<float> & vals, VariableHandle handle) const {
+  this->get(vals, VariableRegistry::instance().variable(handle));
+}
+// -----------------------------------------------------------------------------
+/*! \brief Return all values for a specific variable identified by a handle and level */
+void GeoVaLs::get(std::vector<float> & vals, VariableHandle handle, const int lev) const {
+  this->get(vals, VariableRegistry::instance().variable(handle), lev);
+}
+// -----------------------------------------------------------------------------
 /*! \brief Return all values for a specific variable and location */
 void GeoVaLs::getAtLocation(std::vector<double> & vals,
                             const std::string & var,
@@ -18,6 +18,7 @@
 #include "oops/util/Printable.h"
 
 #include "ufo/GeoVaLs.interface.h"
+#include "ufo/utils/VariableRegistry.h"
 
 namespace eckit {
   class Configuration;
@@ -79,12 +80,20 @@ class GeoVaLs : public util::Printable,
   size_t nlevs(const std::string & var) const;
   void get(std::vector<float> &, const std::string &, const int) const;
   void get(std::vector<double> &, const std::string &, const int) const;
+  /// Get the values of variable \p var at all levels and store them in the array \p vals of
+  /// size nlevs(var) * nlocs(), level by level (all values at the first level come first).
+  void getAllLevels(float * vals, const std::string & var) const;
   /// Get 2D GeoVaLs for variable \p var (fails for 3D GeoVaLs)
   void get(std::vector<double> &, const std::string & var) const;
   /// Get 2D GeoVaLs for variable \p var (fails for 3D GeoVaLs), and convert to float
   void get(std::vector<float> &, const std::string & var) const;
   /// Get 2D GeoVaLs for variable \p var (fails for 3D GeoVaLs), and convert to int
   void get(std::vector<int> &, const std::string & var) const;
+  /// Get 2D GeoVaLs for the variable identified by \p handle (fails for 3D GeoVaLs), and
+  /// convert to float
+  void get(std::vector<float> &, VariableHandle handle) const;
+  /// Get GeoVaLs for the variable identified by \p handle at level \p lev
+  void get(std::vector<float> &, VariableHandle handle, const int lev) const;
   /// Get GeoVaLs at a specified location
   void getAtLocation(std::vector<double> &, const std::string &, const int) const;
   /// Get GeoVaLs at a specified location and convert to float
@@ -65,6 +65,8 @@ extern "C" {
                            double &);
   void ufo_geovals_get_f90(const F90goms &, const int &, const char *, const int &,
                            const int &, float &);
+  void ufo_geovals_get_all_levels_f90(const F90goms &, const int &, const char *,
+                                      const int &, const int &, float &);
   void ufo_geovals_get_loc_f90(const F90goms &, const int &, const char *, const int &,
                                const int &, double &);
   void ufo_geovals_getdouble_f90(const F90goms &, const int &, const char *, const int &,
@@ -10,6 +10,11 @@
 #include <memory>
 #include <vector>
 
+#include <Eigen/Core>
+
+#include "eckit/exception/Exceptions.h"
+
+#include "ioda/distribution/Accumulator.h"
 #include "ioda/ObsSpace.h"
 #include "ioda/ObsVector.h"
 
@@ -18,9 +23,17 @@
 
 #include "ufo/ObsBias.h"
 #include "ufo/ObsBiasIncrement.h"
+#include "ufo/utils/ParallelFor.h"
 
 namespace ufo {
 
+namespace {
+
+/// Minimum number of locations processed by a single thread.
+const size_t minNumLocsPerTask = 4096;
+
+}  // namespace
+
 // -----------------------------------------------------------------------------
 
 LinearObsBiasOperator::LinearObsBiasOperator(ioda::ObsSpace & odb)
@@ -35,11 +48,26 @@ void LinearObsBiasOperator::setTrajectory(const GeoVaLs & geovals, const ObsBias
   oops::Log::trace() << "LinearObsBiasOperator::setTrajectory starts." << std::endl;
   const std::vector<std::shared_ptr<const PredictorBase>> variablePredictors =
       bias.variablePredictors();
-  const std::size_t npreds = variablePredictors.size();
-
-  predData_.resize(npreds, ioda::ObsVector(odb_));
-  for (std::size_t p = 0; p < npreds; ++p) {
-    variablePredictors[p]->compute(odb_, geovals, ydiags, predData_[p]);
+  const double missing = util::missingValue(missing);
+  npreds_ = variablePredictors.size();
+  nvars_ = odb_.obsvariables().size();
+  const std::size_t nlocs = odb_.nlocs();
+
+  // Transpose the predictors into a single block so that the TL and AD only need to traverse
+  // contiguous memory.
+  predData_.assign(nlocs * nvars_ * npreds_, 0.0);
+  missingPred_.assign(nlocs * nvars_, 0);
+  ioda::ObsVector predictor(odb_);
+  for (std::size_t p = 0; p < npreds_; ++p) {
+    predictor.zero();
+    variablePredictors[p]->compute(odb_, geovals, ydiags, predictor);
+    for (std::size_t row = 0; row < nlocs * nvars_; ++row) {
+      const double value = predictor[row];
+      if (value == missing)
+        missingPred_[row] = 1;
+      else
+        predData_[row * npreds_ + p] = value;
+    }
   }
 
   oops::Log::trace() << "LinearObsBiasOperator::setTrajectory done." << std::endl;
@@ -52,12 +80,30 @@ void LinearObsBiasOperator::computeObsBiasTL(const GeoVaLs & geovals,
                                              ioda::ObsVector & ybiasinc) const {
   oops::Log::trace() << "LinearObsBiasOperator::computeObsBiasTL starts." << std::endl;
 
-  const size_t npreds = predData_.size();
-
-  ybiasinc.zero();
-  for (size_t jpred = 0; jpred < npreds; ++jpred) {
-    ybiasinc.axpy(biascoeffinc.coefficients(jpred), predData_[jpred]);
-  }
+  const double missing = util::missingValue(missing);
+  const std::size_t nlocs = ybiasinc.nlocs();
+  ASSERT(ybiasinc.nvars() == nvars_);
+  ASSERT(predData_.size() == nlocs * nvars_ * npreds_);
+  const double *coeffs = biascoeffinc.data().data();
+
+  // ybiasinc(l, v) = sum_p predData_(p, v, l) * coeffs(p, v), or missing if any predictor is.
+  parallelForChunks(nlocs, minNumLocsPerTask, [&](std::size_t begin, std::size_t end) {
+    for (std::size_t jloc = begin; jloc < end; ++jloc) {
+      for (std::size_t jvar = 0; jvar < nvars_; ++jvar) {
+        const std::size_t row = jloc * nvars_ + jvar;
+        if (missingPred_[row]) {
+          ybiasinc[row] = missing;
+          continue;
+        }
+        const double *pred = &predData_[row * npreds_];
+        const double *beta = coeffs + jvar * npreds_;
+        double sum = 0.0;
+        for (std::size_t jpred = 0; jpred < npreds_; ++jpred)
+          sum += pred[jpred] * beta[jpred];
+        ybiasinc[row] = sum;
+      }
+    }
+  });
 
   oops::Log::trace() << "LinearObsBiasOperator::computeObsBiasTL done." << std::endl;
 }
@@ -69,11 +115,31 @@ void LinearObsBiasOperator::computeObsBiasAD(GeoVaLs & geovals,
                                              const ioda::ObsVector & ybiasinc) const {
   oops::Log::trace() << "LinearObsBiasOperator::computeObsBiasAD starts." << std::endl;
 
-  const size_t npreds = predData_.size();
-
-  for (std::size_t jpred = 0; jpred < npreds; ++jpred) {
-    biascoeffinc.updateCoeff(jpred, predData_[jpred].multivar_dot_product_with(ybiasinc));
+  const double missing = util::missingValue(missing);
+  const std::size_t nlocs = ybiasinc.nlocs();
+  ASSERT(ybiasinc.nvars() == nvars_);
+  ASSERT(predData_.size() == nlocs * nvars_ * npreds_);
+
+  // coeffs(p, v) += sum_l predData_(p, v, l) * ybiasinc(l, v), summed over all MPI tasks.
+  // The accumulator takes care of locations held by more than one task.
+  std::unique_ptr<ioda::Accumulator<std::vector<double>>> accumulator =
+      odb_.distribution()->createAccumulator<double>(nvars_ * npreds_);
+  for (std::size_t jloc = 0; jloc < nlocs; ++jloc) {
+    for (std::size_t jvar = 0; jvar < nvars_; ++jvar) {
+      const std::size_t row = jloc * nvars_ + jvar;
+      const double dy = ybiasinc[row];
+      if (dy == missing)
+        continue;
+      const double *pred = &predData_[row * npreds_];
+      for (std::size_t jpred = 0; jpred < npreds_; ++jpred)
+        accumulator->addTerm(jloc, jvar * npreds_ + jpred, pred[jpred] * dy);
+    }
   }
+  const std::vector<double> coeffsInc = accumulator->computeResult();
+
+  Eigen::VectorXd &coeffs = biascoeffinc.data();
+  for (std::size_t i = 0; i < coeffsInc.size(); ++i)
+    coeffs[i] += coeffsInc[i];
 
   oops::Log::trace() << "LinearObsBiasOperator::computeAD done." << std::endl;
 }
@@ -8,6 +8,7 @@
 #ifndef UFO_LINEAROBSBIASOPERATOR_H_
 #define UFO_LINEAROBSBIASOPERATOR_H_
 
+#include <cstddef>
 #include <vector>
 
 #include "oops/util/Printable.h"
@@ -44,8 +45,17 @@ class LinearObsBiasOperator : public util::Printable {
   /// ObsSpace used for this bias correction
   ioda::ObsSpace & odb_;
 
-  /// predictors values; set in setTrajectory
-  std::vector<ioda::ObsVector> predData_;
+  /// number of predictors; set in setTrajectory
+  std::size_t npreds_ = 0;
+  /// number of bias-corrected variables; set in setTrajectory
+  std::size_t nvars_ = 0;
+  /// predictors values, with missing values replaced by zeros; set in setTrajectory.
+  /// The value of predictor p for variable v at location l is stored at index
+  /// (l * nvars_ + v) * npreds_ + p, so that the predictors multiplying the coefficients of each
+  /// variable at each location are contiguous, like the coefficients in ObsBiasIncrement.
+  std::vector<double> predData_;
+  /// nonzero at index l * nvars_ + v if any predictor of variable v is missing at location l
+  std::vector<char> missingPred_;
 };
 
 // -----------------------------------------------------------------------------
@@ -5,7 +5,7 @@
  * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
  */
 
-#include <Eigen/Core>
+#include <Eigen/Dense>
 #include <cmath>
 #include <fstream>
 #include <memory>
@@ -23,6 +23,7 @@
 
 #include "oops/util/IntSetParser.h"
 #include "oops/util/Logger.h"
+#include "oops/util/missingValues.h"
 #include "oops/util/Random.h"
 
 #include "ufo/ObsBias.h"
@@ -69,6 +70,9 @@ ObsBiasCovariance::ObsBiasCovariance(ioda::ObsSpace & odb,
     // Override the largest analysis variance if provided
     largest_analysis_variance_ = biasCovParams.largestAnalysisVariance;
 
+    // Compute the full blocks of the Hessian if requested
+    full_hessian_ = biasCovParams.fullHessian;
+
     // Initialize the variances to upper limit
     variances_ = Eigen::VectorXd::Constant(prednames_.size()*vars_.size(), largest_variance_);
 
@@ -190,67 +194,87 @@ void ObsBiasCovariance::linearize(const ObsBias & bias, const eckit::Configurati
     // Retrieve the QC flags and do statistics from second outer loop
     const int jouter = innerConf.getInt("iteration");
     if (jouter >= 1) {
-      std::unique_ptr<ioda::Accumulator<std::vector<size_t>>> obs_num_accumulator =
-          odb_.distribution()->createAccumulator<size_t>(obs_num_.size());
+      const std::size_t nvars = vars_.size();
+      const std::size_t npreds = prednames_.size();
+      const std::size_t nlocs = odb_.nlocs();
+      const double missing = util::missingValue(missing);
 
-      // Retrieve the QC flags of previous outer loop and recalculate the number of effective obs.
+      // Make sure the QC flags of previous outer loop are available before reading anything else.
       const std::string group_name = "EffectiveQC" + std::to_string(jouter-1);
       const std::vector<std::string> vars = odb_.obsvariables().variables();
-      std::vector<int> qc_flags(odb_.nlocs(), 999);
-      for (std::size_t jvar = 0; jvar < vars.size(); ++jvar) {
-        if (odb_.has(group_name, vars[jvar])) {
-          odb_.get_db(group_name, vars[jvar], qc_flags);
-          for (std::size_t jloc = 0; jloc < qc_flags.size(); ++jloc)
-            if (qc_flags[jloc] == 0)
-              obs_num_accumulator->addTerm(jloc, jvar, 1);
-        } else {
+      for (std::size_t jvar = 0; jvar < vars.size(); ++jvar)
+        if (!odb_.has(group_name, vars[jvar]))
           throw eckit::UserError("Unable to find QC flags : " + vars[jvar] + "@" + group_name);
-        }
-      }
-
-      // Sum across the processors
-      obs_num_ = obs_num_accumulator->computeResult();
-
-      const float missing = util::missingValue(missing);
 
-      // compute the hessian contribution from Jo bias terms channel by channel
-      // retrieve the effective error (after QC) for this channel
-      ioda::ObsVector r_inv(odb_, "EffectiveError");
-
-      // compute \mathrm{R}^{-1}
-      std::size_t nvars = r_inv.nvars();
-      for (size_t vv = 0; vv < nvars; ++vv) {
-        for (size_t ii = 0; ii < r_inv.nlocs(); ++ii) {
-          if (r_inv[ii*nvars + vv] != missing) {
-            r_inv[ii*nvars + vv] = 1.0f / pow(r_inv[ii*nvars + vv], 2);
-          } else {
-            r_inv[ii*nvars + vv] = 0.0f;
+      // Retrieve the effective errors and the predictors
+      const ioda::ObsVector err(odb_, "EffectiveError");
+      std::vector<ioda::ObsVector> predx;
+      predx.reserve(npreds);
+      for (std::size_t p = 0; p < npreds; ++p)
+        predx.emplace_back(odb_, prednames_[p] + "Predictor");
+      ASSERT(err.nvars() == nvars);
+
+      // All partial sums are gathered in one accumulator so that a single global reduction is
+      // needed. They are laid out as follows:
+      // - the number of effective obs. for each variable,
+      // - the diagonal of \mathrm{H}_\beta^\intercal \mathrm{R}^{-1} \mathrm{H}_\beta,
+      //   at j*npreds + p,
+      // - optionally, the upper triangle of its diagonal blocks, at (j*npreds + p)*npreds + q.
+      const std::size_t diagOffset = nvars;
+      const std::size_t blockOffset = diagOffset + nvars * npreds;
+      const std::size_t numSums = blockOffset + (full_hessian_ ? nvars * npreds * npreds : 0);
+      std::unique_ptr<ioda::Accumulator<std::vector<double>>> accumulator =
+          odb_.distribution()->createAccumulator<double>(numSums);
+
+      // Single pass over the observations of each variable
+      std::vector<int> qc_flags(nlocs, 999);
+      std::vector<double> x(npreds);
+      for (std::size_t jvar = 0; jvar < nvars; ++jvar) {
+        odb_.get_db(group_name, vars[jvar], qc_flags);
+        for (std::size_t jloc = 0; jloc < nlocs; ++jloc) {
+          if (qc_flags[jloc] == 0)
+            accumulator->addTerm(jloc, jvar, 1.0);
+
+          // \mathrm{R}^{-1}; rejected obs. have missing effective errors and do not contribute.
+          const std::size_t ii = jloc*nvars + jvar;
+          if (err[ii] == missing || err[ii] == 0.0)
+            continue;
+          const double r_inv = 1.0 / (err[ii] * err[ii]);
+
+          // Missing predictor values do not contribute either.
+          for (std::size_t p = 0; p < npreds; ++p)
+            x[p] = predx[p][ii] == missing ? 0.0 : predx[p][ii];
+          for (std::size_t p = 0; p < npreds; ++p) {
+            if (x[p] == 0.0)
+              continue;
+            const double xp_r_inv = x[p] * r_inv;
+            accumulator->addTerm(jloc, diagOffset + jvar*npreds + p, x[p] * xp_r_inv);
+            if (full_hessian_)
+              for (std::size_t q = p + 1; q < npreds; ++q)
+                if (x[q] != 0.0)
+                  accumulator->addTerm(jloc, blockOffset + (jvar*npreds + p)*npreds + q,
+                                       xp_r_inv * x[q]);
           }
         }
       }
 
-      // compute \mathrm{H}_\beta^\intercal \mathrm{R}^{-1} \mathrm{H}_\beta
-      // -----------------------------------------
-      std::unique_ptr<ioda::Accumulator<std::vector<double>>> ht_rinv_h_accumulator =
-          odb_.distribution()->createAccumulator<double>(ht_rinv_h_.size());
-      for (std::size_t p = 0; p < prednames_.size(); ++p) {
-        // retrieve the predictors
-        const ioda::ObsVector predx(odb_, prednames_[p] + "Predictor");
-
-        // for each variable
-        ASSERT(r_inv.nlocs() == predx.nlocs());
-        std::size_t nvars = predx.nvars();
-        // only keep the diagnoal
-        for (size_t vv = 0; vv < nvars; ++vv) {
-          for (size_t ii = 0; ii < predx.nlocs(); ++ii)
-            ht_rinv_h_accumulator->addTerm(ii,
-                                           vv*prednames_.size() + p,
-                                           pow(predx[ii*nvars + vv], 2) * r_inv[ii*nvars + vv]);
+      // Sum across the processors
+      const std::vector<double> sums = accumulator->computeResult();
+      for (std::size_t jvar = 0; jvar < nvars; ++jvar)
+        obs_num_[jvar] = static_cast<std::size_t>(std::round(sums[jvar]));
+      std::copy(sums.begin() + diagOffset, sums.begin() + blockOffset, ht_rinv_h_.begin());
+      if (full_hessian_) {
+        // Fill in the diagonal and the lower triangle of each block
+        ht_rinv_h_blocks_.assign(sums.begin() + blockOffset, sums.end());
+        for (std::size_t jvar = 0; jvar < nvars; ++jvar) {
+          double *block = &ht_rinv_h_blocks_[jvar*npreds*npreds];
+          for (std::size_t p = 0; p < npreds; ++p) {
+            block[p*npreds + p] = ht_rinv_h_[jvar*npreds + p];
+            for (std::size_t q = p + 1; q < npreds; ++q)
+              block[q*npreds + p] = block[p*npreds + q];
+          }
         }
       }
-
-      // Sum the hessian contributions across the tasks
-      ht_rinv_h_ = ht_rinv_h_accumulator->computeResult();
     }
 
     // reset variances for bias predictor coeff. based on current data count
@@ -262,16 +286,30 @@ void ObsBiasCovariance::linearize(const ObsBias & bias, const eckit::Configurati
     }
 
     // set a coeff. factor for variances of control variables
+    const std::size_t npreds = prednames_.size();
     for (std::size_t j = 0; j < vars_.size(); ++j) {
-      for (std::size_t p = 0; p < prednames_.size(); ++p) {
-        const std::size_t index = j*prednames_.size() + p;
+      // With the full Hessian, invert the whole block of \mathrm{A} coupling the predictors of
+      // this variable instead of its diagonal only.
+      Eigen::VectorXd block_inverse_diagonal;
+      if (obs_num_[j] > 0 && !ht_rinv_h_blocks_.empty()) {
+        Eigen::MatrixXd a = Eigen::Map<const Eigen::MatrixXd>(
+              &ht_rinv_h_blocks_[j*npreds*npreds], npreds, npreds);
+        a.diagonal() += variances_.segment(j*npreds, npreds).cwiseInverse();
+        const Eigen::MatrixXd a_inverse =
+            a.ldlt().solve(Eigen::MatrixXd::Identity(npreds, npreds));
+        block_inverse_diagonal = a_inverse.diagonal();
+      }
+      for (std::size_t p = 0; p < npreds; ++p) {
+        const std::size_t index = j*npreds + p;
+        const double a_inverse = block_inverse_diagonal.size() > 0 ?
+              block_inverse_diagonal[p] : 1.0 / (1.0 / variances_[index] + ht_rinv_h_[index]);
         preconditioner_[index] = step_size_;
         // L = \mathrm{A}^{-1}
         if (obs_num_[j] > 0)
-          preconditioner_[index] = 1.0 / (1.0 / variances_[index] + ht_rinv_h_[index]);
+          preconditioner_[index] = a_inverse;
         if (obs_num_[j] > minimal_required_obs_number_) {
           if (ht_rinv_h_[index] > 0.0) {
-            analysis_variances_[index] = 1.0 / (1.0 / variances_[index] + ht_rinv_h_[index]);
+            analysis_variances_[index] = a_inverse;
           } else {
             analysis_variances_[index] = largest_analysis_variance_;
           }
@@ -57,6 +57,7 @@ class ObsBiasCovariance : public util::Printable,
   void read(const ObsBiasCovariancePriorParameters &);
   void write(const eckit::Configuration &);
   const std::vector<std::string> predictorNames() const {return prednames_;}
+  const std::vector<double> & analysisVariances() const {return analysis_variances_;}
 
  private:
   void print(std::ostream &) const {}
@@ -66,9 +67,16 @@ class ObsBiasCovariance : public util::Printable,
 // Hessian contribution from Jo bias correction terms
   std::vector<double> ht_rinv_h_;
 
+// Blocks of the Hessian contribution coupling the predictors of each variable
+// <channel, predictor, predictor>; computed only if full_hessian_ is set
+  std::vector<double> ht_rinv_h_blocks_;
+
 // preconditioner
   std::vector<double> preconditioner_;
 
+// Use the full blocks of the Hessian rather than its diagonal
+  bool full_hessian_ = false;
+
 // QCed obs numbers <channel>
   std::vector<std::size_t> obs_num_;
 
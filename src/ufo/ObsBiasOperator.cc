@@ -10,6 +10,7 @@
 #include <string>
 #include <vector>
 
+#include "ioda/ObsSpace.h"
 #include "ioda/ObsVector.h"
 
 #include "oops/util/Logger.h"
@@ -17,6 +18,7 @@
 
 #include "ufo/ObsBias.h"
 #include "ufo/ObsDiagnostics.h"
+#include "ufo/utils/Instrumentation.h"
 
 namespace ufo {
 
@@ -32,6 +34,7 @@ ObsBiasOperator::ObsBiasOperator(ioda::ObsSpace & odb)
 void ObsBiasOperator::computeObsBias(const GeoVaLs & geovals, ioda::ObsVector & ybias,
                                      const ObsBias & biascoeffs, ObsDiagnostics & ydiags) const {
   oops::Log::trace() << "ObsBiasOperator::computeObsBias starting" << std::endl;
+  ScopedTimer timer(odb_.obsname(), "ObsBiasOperator::computeObsBias", typeid(*this));
 
   const double missing = util::missingValue(missing);
   const Predictors & predictors = biascoeffs.predictors();
@@ -63,6 +63,10 @@ class ObsBiasCovarianceParameters : public oops::Parameters {
     "step size", defaultStepSize(), this};
   oops::Parameter<double> largestAnalysisVariance{
     "largest analysis variance", defaultLargestAnalysisVariance(), this};
+  /// If true, the preconditioner and analysis error variances are derived from the inverse of
+  /// the full block of the Hessian coupling the predictors of each variable rather than from the
+  /// inverse of its diagonal.
+  oops::Parameter<bool> fullHessian{"full hessian", false, this};
 
   oops::OptionalParameter<ObsBiasCovariancePriorParameters> prior{
     "prior", this};
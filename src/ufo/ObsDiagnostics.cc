@@ -8,9 +8,14 @@
 #include "ufo/ObsDiagnostics.h"
 
 #include <ostream>
+#include <sstream>
 #include <string>
 #include <vector>
 
+#include <boost/make_unique.hpp>
+
+#include "eckit/exception/Exceptions.h"
+
 #include "oops/base/Variables.h"
 #include "ufo/Locations.h"
 
@@ -35,6 +40,7 @@ ObsDiagnostics::ObsDiagnostics(const eckit::Configuration & conf, const ioda::Ob
 // -----------------------------------------------------------------------------
 
 void ObsDiagnostics::allocate(const int nlev, const oops::Variables & vars) {
+  clearTensors();
   gdiags_.allocate(nlev, vars);
 }
 
@@ -43,6 +49,7 @@ void ObsDiagnostics::allocate(const int nlev, const oops::Variables & vars) {
 void ObsDiagnostics::save(const std::vector<double> & vals,
                           const std::string & var,
                           const int lev) {
+  clearTensors();
   gdiags_.put(vals, var, lev);
 }
 
@@ -67,6 +74,48 @@ void ObsDiagnostics::get(std::vector<float> & vals, const std::string & var,
 
 // -----------------------------------------------------------------------------
 
+void ObsDiagnostics::getAllLevels(float * vals, const std::string & var) const {
+  gdiags_.getAllLevels(vals, var);
+}
+
+// -----------------------------------------------------------------------------
+
+const ObsDiagnosticsTensor & ObsDiagnostics::getTensor(const std::string & family,
+                                                      const std::vector<int> & channels) const {
+  std::ostringstream key;
+  key << family;
+  for (int channel : channels)
+    key << '_' << channel;
+
+  std::lock_guard<std::mutex> lock(tensorsMutex_);
+  std::unique_ptr<ObsDiagnosticsTensor> & tensor = tensors_[key.str()];
+  if (!tensor) {
+    std::vector<std::string> names;
+    for (int channel : channels)
+      names.push_back(family + "_" + std::to_string(channel));
+    for (const std::string & name : names)
+      if (!gdiags_.has(name))
+        throw eckit::UserError("ObsDiagnostics::getTensor: variable " + name + " not found",
+                               Here());
+    const size_t nlevs = names.empty() ? 0 : gdiags_.nlevs(names.front());
+    auto newTensor = boost::make_unique<ObsDiagnosticsTensor>(names.size(), nlevs,
+                                                              gdiags_.nlocs());
+    for (size_t jchan = 0; jchan < names.size(); ++jchan)
+      gdiags_.getAllLevels(newTensor->channel(jchan), names[jchan]);
+    tensor = std::move(newTensor);
+  }
+  return *tensor;
+}
+
+// -----------------------------------------------------------------------------
+
+void ObsDiagnostics::clearTensors() {
+  std::lock_guard<std::mutex> lock(tensorsMutex_);
+  tensors_.clear();
+}
+
+// -----------------------------------------------------------------------------
+
 void ObsDiagnostics::print(std::ostream & os) const {
   os << "ObsDiagnostics not printing yet.";
 }
@@ -8,6 +8,9 @@
 #ifndef UFO_OBSDIAGNOSTICS_H_
 #define UFO_OBSDIAGNOSTICS_H_
 
+#include <map>
+#include <memory>
+#include <mutex>
 #include <ostream>
 #include <string>
 #include <vector>
@@ -31,6 +34,39 @@ namespace ufo {
 
 // -----------------------------------------------------------------------------
 
+/// \brief Values of a family of channel-dependent diagnostics (e.g. the Jacobians
+/// `brightness_temperature_jacobian_air_temperature_<channel>`) at all channels, levels and
+/// locations, stored contiguously in (channel, level, location) order.
+class ObsDiagnosticsTensor {
+ public:
+  ObsDiagnosticsTensor(size_t nchans, size_t nlevs, size_t nlocs)
+    : nchans_(nchans), nlevs_(nlevs), nlocs_(nlocs), values_(nchans * nlevs * nlocs) {}
+
+  size_t nchans() const {return nchans_;}
+  size_t nlevs() const {return nlevs_;}
+  size_t nlocs() const {return nlocs_;}
+
+  /// Value at channel index \p ichan, level index \p ilev (0-based, in the order in which the
+  /// levels are stored in ObsDiagnostics) and location \p iloc.
+  float operator()(size_t ichan, size_t ilev, size_t iloc) const {
+    return values_[(ichan * nlevs_ + ilev) * nlocs_ + iloc];
+  }
+  /// Pointer to the values at all locations for channel index \p ichan and level index \p ilev.
+  const float * slice(size_t ichan, size_t ilev) const {
+    return values_.data() + (ichan * nlevs_ + ilev) * nlocs_;
+  }
+  /// Pointer to the values at all levels and locations for channel index \p ichan.
+  float * channel(size_t ichan) {return values_.data() + ichan * nlevs_ * nlocs_;}
+
+ private:
+  size_t nchans_;
+  size_t nlevs_;
+  size_t nlocs_;
+  std::vector<float> values_;
+};
+
+// -----------------------------------------------------------------------------
+
 class ObsDiagnostics : public util::Printable,
                        private boost::noncopyable {
  public:
@@ -50,21 +86,37 @@ class ObsDiagnostics : public util::Printable,
   void save(const std::vector<double> &, const std::string &, const int);
 
 // Interfaces
-  int & toFortran() {return gdiags_.toFortran();}
+  /// Give access to the diagnostics to Fortran code, which may modify them.
+  int & toFortran() {clearTensors(); return gdiags_.toFortran();}
   const int & toFortran() const {return gdiags_.toFortran();}
 
   bool has(const std::string & var) const {return gdiags_.has(var);}
   size_t nlevs(const std::string &) const;
   void get(std::vector<float> &, const std::string &) const;
   void get(std::vector<float> &, const std::string &, const int) const;
+  /// Get the values of \p var at all levels, level by level, into the array \p vals of size
+  /// nlevs(var) * nlocs.
+  void getAllLevels(float * vals, const std::string & var) const;
+
+  /// \brief Return the values of the diagnostics `<family>_<channel>` for all channels in
+  /// \p channels at all levels and locations.
+  ///
+  /// The tensor is filled on first use and kept until the diagnostics are next modified, so
+  /// functions reading the same family of diagnostics share a single copy.
+  const ObsDiagnosticsTensor & getTensor(const std::string & family,
+                                         const std::vector<int> & channels) const;
 
   void write(const eckit::Configuration & config) const {
     gdiags_.write(config);}
  private:
   void print(std::ostream &) const;
+  void clearTensors();
+
   const ioda::ObsSpace & obsdb_;
 
   GeoVaLs gdiags_;
+  mutable std::mutex tensorsMutex_;
+  mutable std::map<std::string, std::unique_ptr<ObsDiagnosticsTensor>> tensors_;
 };
 
 // -----------------------------------------------------------------------------
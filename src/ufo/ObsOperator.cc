@@ -5,6 +5,7 @@
  * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
  */
 
+#include <exception>
 #include <vector>
 
 #include "ufo/ObsOperator.h"
@@ -15,6 +16,7 @@
 #include "ioda/ObsVector.h"
 
 #include "oops/base/Variables.h"
+#include "oops/util/Logger.h"
 
 #include "ufo/GeoVaLs.h"
 #include "ufo/Locations.h"
@@ -22,6 +24,7 @@
 #include "ufo/ObsBiasOperator.h"
 #include "ufo/ObsDiagnostics.h"
 #include "ufo/ObsOperatorBase.h"
+#include "ufo/utils/Instrumentation.h"
 
 namespace ufo {
 
@@ -44,9 +47,26 @@ ObsOperator::ObsOperator(ioda::ObsSpace & os, const eckit::Configuration & conf)
 
 // -----------------------------------------------------------------------------
 
+ObsOperator::~ObsOperator() {
+  if (!Instrumentation::instance().enabled())
+    return;
+  try {
+    // No collective operations here: ranks may destroy their operators in different orders.
+    Instrumentation::instance().writeLocalReportIfRequested(odb_.obsname(), odb_.comm().rank());
+  } catch (const std::exception & e) {
+    oops::Log::warning() << "Writing the instrumentation report failed: " << e.what()
+                         << std::endl;
+  }
+}
+
+// -----------------------------------------------------------------------------
+
 void ObsOperator::simulateObs(const GeoVaLs & gvals, ioda::ObsVector & yy,
                               const ObsBias & bias, ObsDiagnostics & ydiags) const {
-  oper_->simulateObs(gvals, yy, ydiags);
+  {
+    ScopedTimer timer(odb_.obsname(), "ObsOperator::simulateObs", typeid(*oper_));
+    oper_->simulateObs(gvals, yy, ydiags);
+  }
   if (bias) {
     ioda::ObsVector ybias(odb_);
     ObsBiasOperator biasoper(odb_);
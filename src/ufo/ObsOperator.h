@@ -43,6 +43,9 @@ class ObsOperator : public util::Printable,
                     private boost::noncopyable {
  public:
   ObsOperator(ioda::ObsSpace &, const eckit::Configuration &);
+  /// Writes the instrumentation report of the current rank for the ObsSpace if one was
+  /// requested (see ufo::Instrumentation).
+  ~ObsOperator();
 
 /// Obs Operator
   void simulateObs(const GeoVaLs &, ioda::ObsVector &, const ObsBias &, ObsDiagnostics &) const;
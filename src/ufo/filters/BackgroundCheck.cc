@@ -55,6 +55,10 @@ BackgroundCheck::BackgroundCheck(ioda::ObsSpace & obsdb, const Parameters_ & par
            !parameters_.absoluteThreshold.value());
     ASSERT(!parameters_.functionAbsoluteThreshold.value()->empty());
   }
+
+  // Resolve the filter variables once to avoid string operations in loops over channels.
+  hofxHandles_ = Variables(filtervars_, test_hofx).handles();
+  observedIndices_ = findVariables(obsdb.obsvariables(), filtervars_.handles());
 }
 
 // -----------------------------------------------------------------------------
@@ -69,7 +73,7 @@ void BackgroundCheck::applyFilter(const std::vector<bool> & apply,
                                   const Variables & filtervars,
                                   std::vector<std::vector<bool>> & flagged) const {
   oops::Log::trace() << "BackgroundCheck postFilter" << std::endl;
-  const oops::Variables observed = obsdb_.obsvariables();
+  ASSERT(filtervars.nvars() == observedIndices_.size());
   const float missing = util::missingValue(missing);
   oops::Log::debug() << "BackgroundCheck obserr: " << *obserr_;
 
@@ -85,12 +89,11 @@ void BackgroundCheck::applyFilter(const std::vector<bool> & apply,
     ioda::ObsDataVector<float> function_abs_threshold(obsdb_, rtvar.toOopsVariables());
     data_.get(rtvar, function_abs_threshold);
 
-    Variables varhofx(filtervars_, test_hofx);
     for (size_t jv = 0; jv < filtervars.nvars(); ++jv) {
-      size_t iv = observed.find(filtervars.variable(jv).variable());
+      const size_t iv = observedIndices_[jv];
 //    H(x)
       std::vector<float> hofx;
-      data_.get(varhofx.variable(jv), hofx);
+      data_.get(hofxHandles_[jv], hofx);
       for (size_t jobs = 0; jobs < obsdb_.nlocs(); ++jobs) {
         if (apply[jobs] && (*flags_)[iv][jobs] == QCflags::pass) {
           ASSERT((*obserr_)[iv][jobs] != util::missingValue((*obserr_)[iv][jobs]));
@@ -107,12 +110,11 @@ void BackgroundCheck::applyFilter(const std::vector<bool> & apply,
       }
     }
   } else {
-    Variables varhofx(filtervars_, test_hofx);
     for (size_t jv = 0; jv < filtervars.nvars(); ++jv) {
-      size_t iv = observed.find(filtervars.variable(jv).variable());
+      const size_t iv = observedIndices_[jv];
 //    H(x)
       std::vector<float> hofx;
-      data_.get(varhofx.variable(jv), hofx);
+      data_.get(hofxHandles_[jv], hofx);
 
 //    Threshold for current variable
       std::vector<float> abs_thr(obsdb_.nlocs(), std::numeric_limits<float>::max());
@@ -19,6 +19,7 @@
 #include "ufo/filters/FilterBase.h"
 #include "ufo/filters/QCflags.h"
 #include "ufo/filters/Variable.h"
+#include "ufo/utils/VariableRegistry.h"
 #include "ufo/utils/parameters/ParameterTraitsVariable.h"
 
 namespace eckit {
@@ -92,6 +93,10 @@ class BackgroundCheck : public FilterBase,
   int qcFlag() const override {return QCflags::fguess;}
 
   Parameters_ parameters_;
+  /// Handles of the H(x) of each filter variable.
+  std::vector<VariableHandle> hofxHandles_;
+  /// Index of each filter variable in the list of simulated variables.
+  std::vector<size_t> observedIndices_;
 };
 
 }  // namespace ufo
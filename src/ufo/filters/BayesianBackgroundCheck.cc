@@ -61,33 +61,6 @@ Variable BayesianBackgroundCheck::backgrErrVariable(const Variable &filterVariab
   return Variable(filterVariable.variable() + "_background_error@ObsDiag");
 }
 
-// -----------------------------------------------------------------------------
-/// Reduce a vector to only the elements for which j_reduced=true.
-
-template <class T>
-std::vector<T> BayesianBackgroundCheck::reduceVector(const std::vector<T> &vector_full,
-                                                     const std::vector<size_t> &j_reduced) const {
-  size_t reduced_size = j_reduced.size();
-  std::vector<T> vector_reduced(reduced_size);
-  for (size_t i_reduced=0; i_reduced < reduced_size; ++i_reduced) {
-    vector_reduced[i_reduced] = vector_full[j_reduced[i_reduced]];
-  }
-  return vector_reduced;
-}
-
-// -----------------------------------------------------------------------------
-/// Copy a reduced vector back into the correct indices of the full vector.
-
-template <class T>
-void BayesianBackgroundCheck::unreduceVector(const std::vector<T> &vector_reduced,
-                                             std::vector<T> &vector_full,
-                                             const std::vector<size_t> &j_reduced) const {
-  size_t reduced_size = vector_reduced.size();
-  for (size_t i_reduced=0; i_reduced < reduced_size; ++i_reduced) {
-    vector_full[j_reduced[i_reduced]] = vector_reduced[i_reduced];
-  }
-}
-
 // -----------------------------------------------------------------------------
 /// Apply the Bayesian background check filter.
 
@@ -104,8 +77,6 @@ void BayesianBackgroundCheck::applyFilter(const std::vector<bool> & apply,
   Variables varhofx(filtervars_, "HofX");
   Variables varflags(filtervars_, "QCFlags");
 
-  // Probability density of bad observations, PdBad:
-  const std::vector<float> PdBad(obsdb_.nlocs(), parameters_.PdBad.value());
   // NOT profiles averaged to model levels (single-level anyway):
   const bool ModelLevels = false;
 
@@ -132,7 +103,8 @@ void BayesianBackgroundCheck::applyFilter(const std::vector<bool> & apply,
       std::vector<float> PGEBd1(obsdb_.nlocs());
       // QC flags:
       std::vector<int> qcflags1(obsdb_.nlocs());
-      std::vector<float> firstComponentObVal, secondComponentObVal;
+      // observation values:
+      const float *firstComponentObVal = nullptr, *secondComponentObVal = nullptr;
       // make note of conditions on apply and flags_:
       std::vector<bool> applycondition(obsdb_.nlocs(), false);
       // index mapping between full and reduced vectors:
@@ -147,8 +119,8 @@ void BayesianBackgroundCheck::applyFilter(const std::vector<bool> & apply,
         data_.get(varhofx.variable(filterVarIndex-1), hofx1);
         data_.get(varhofx.variable(filterVarIndex), hofx2);
         // observation values:
-        firstComponentObVal = obs[filterVarIndex-1];
-        secondComponentObVal = obs[filterVarIndex];
+        firstComponentObVal = obs[filterVarIndex-1].data();
+        secondComponentObVal = obs[filterVarIndex].data();
         // QC flags (all zeros, or read from file if possible):
         if (obsdb_.has("QCFlags", varname1)) {
           data_.get(varflags.variable(filterVarIndex-1), qcflags1);
@@ -167,7 +139,7 @@ void BayesianBackgroundCheck::applyFilter(const std::vector<bool> & apply,
         // H(x):
         data_.get(varhofx.variable(filterVarIndex), hofx1);
         // observation values:
-        firstComponentObVal = obs[filterVarIndex];
+        firstComponentObVal = obs[filterVarIndex].data();
         // QC flags (all zeros, or read from file if possible):
         if (obsdb_.has("QCFlags", varname1)) {
           data_.get(varflags.variable(filterVarIndex), qcflags1);
@@ -181,42 +153,24 @@ void BayesianBackgroundCheck::applyFilter(const std::vector<bool> & apply,
         }
       }
 
-      // create reduced vectors, copied from full ones, fulfilling applycondition:
-      std::vector<float> firstComponentObVal_reduced = reduceVector(firstComponentObVal,
-                                                                    j_reduced);
-      std::vector<float> ObsErr_reduced = reduceVector((*obserr_)[iv1], j_reduced);
-      std::vector<float> hofx1_reduced = reduceVector(hofx1, j_reduced);
-      std::vector<float> hofxerr_reduced = reduceVector(hofxerr, j_reduced);
-      std::vector<float> PdBad_reduced = reduceVector(PdBad, j_reduced);
-      std::vector<int> qcflags1_reduced = reduceVector(qcflags1, j_reduced);
-      std::vector<float> PGE1_reduced = reduceVector(PGE1, j_reduced);
-      std::vector<float> PGEBd1_reduced = reduceVector(PGEBd1, j_reduced);
-      std::vector<float> secondComponentObVal_reduced;
-      std::vector<float> hofx2_reduced;
+      // Update the PGEs in place at the locations fulfilling applycondition:
+      BayesianPGEBatch batch;
+      batch.size = j_reduced.size();
+      batch.indices = j_reduced.data();
+      batch.obsVal = firstComponentObVal;
+      batch.obsErr = (*obserr_)[iv1].data();
+      batch.bkgVal = hofx1.data();
+      batch.bkgErr = hofxerr.data();
       if (previousVariableWasFirstComponentOfTwo) {
-        secondComponentObVal_reduced = reduceVector(secondComponentObVal, j_reduced);
-        hofx2_reduced = reduceVector(hofx2, j_reduced);
+        batch.obsVal2 = secondComponentObVal;
+        batch.bkgVal2 = hofx2.data();
       }
-
-      ufo::BayesianPGEUpdate(parameters_.PGEParameters,
-                             firstComponentObVal_reduced,
-                             ObsErr_reduced,
-                             hofx1_reduced,
-                             hofxerr_reduced,
-                             PdBad_reduced,
-                             ModelLevels,
-                             qcflags1_reduced,
-                             PGE1_reduced,
-                             PGEBd1_reduced,
-                             -1,
-                             previousVariableWasFirstComponentOfTwo?
-                              &secondComponentObVal_reduced : nullptr,
-                             previousVariableWasFirstComponentOfTwo?
-                              &hofx2_reduced : nullptr);
-      // write PGE-updated values from reduced vectors back into full ones:
-      unreduceVector(qcflags1_reduced, qcflags1, j_reduced);
-      unreduceVector(PGE1_reduced, PGE1, j_reduced);
-      unreduceVector(PGEBd1_reduced, PGEBd1, j_reduced);
+      // Probability density of bad observations, PdBad:
+      batch.PdBadValue = parameters_.PdBad.value();
+      batch.flags = qcflags1.data();
+      batch.PGE = PGE1.data();
+      batch.PGEBd = PGEBd1.data();
+      ufo::BayesianPGEUpdate(parameters_.PGEParameters, batch, ModelLevels);
 
       // Save PGE to obsdb
       obsdb_.put_db("GrossErrorProbabilityTotal", varname1, PGE1);  // 'packed' PGE
@@ -234,12 +188,10 @@ void BayesianBackgroundCheck::applyFilter(const std::vector<bool> & apply,
         // Save QC flags to obsdb
         std::vector<int> &qcflags2 = qcflags1;  // in old OPS, flags same for both components
         obsdb_.put_db("QCFlags", varname2, qcflags2);
-        // Set flagged, for 2nd component:
+        // Set flagged, for both components in one pass (their flags are shared):
         for (size_t jobs=0; jobs < obsdb_.nlocs(); ++jobs) {
-          if (qcflags1[jobs] & ufo::MetOfficeQCFlags::Elem::BackRejectFlag) {
-            flagged[filterVarIndex-1][jobs] = true;
-          }
           if (qcflags2[jobs] & ufo::MetOfficeQCFlags::Elem::BackRejectFlag) {
+            flagged[filterVarIndex-1][jobs] = true;
             flagged[filterVarIndex][jobs] = true;
           }
           oops::Log::debug() << "flagged(1)[" << jobs << "]: "
@@ -99,23 +99,6 @@ class BayesianBackgroundCheck : public FilterBase,
   /// \brief Return the name of the variable containing the background error estimate of the
   /// specified filter variable.
   Variable backgrErrVariable(const Variable & filterVariable) const;
-
-  /// \brief Reduce a vector to only the elements for which j_reduced=true.
-  ///  \param[in] vector_full: full vector,
-  ///  \param[in] j_reduced: indices of vector_full to be copied into...
-  ///  \return vector_reduced.
-  template <class T>
-  std::vector<T> reduceVector(const std::vector<T> & vector_full,
-                              const std::vector<size_t> & j_reduced) const;
-
-  /// \brief Copy a reduced vector back into the correct indices of the full vector.
-  ///  \param[in] vector_reduced: reduced vector to restore to...
-  ///  \param[inout] vector_full: full vector,
-  ///  \param[in] j_reduced: indices of vector_full to be populated.
-  template <class T>
-  void unreduceVector(const std::vector<T> & vector_reduced,
-                      std::vector<T> & vector_full,
-                      const std::vector<size_t> & j_reduced) const;
   Parameters_ parameters_;
 };
 
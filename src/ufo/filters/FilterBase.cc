@@ -7,16 +7,24 @@
 
 #include "ufo/filters/FilterBase.h"
 
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <sstream>
+#include <string>
 #include <utility>
 #include <vector>
 
 #include "eckit/config/Configuration.h"
+#include "eckit/exception/Exceptions.h"
+#include "eckit/mpi/Comm.h"
 
 #include "ioda/ObsDataVector.h"
 #include "ioda/ObsSpace.h"
 #include "ioda/ObsVector.h"
 
 #include "oops/interface/ObsFilter.h"
+#include "oops/util/DateTime.h"
 #include "oops/util/Logger.h"
 
 #include "ufo/filters/actions/FilterAction.h"
@@ -24,9 +32,122 @@
 #include "ufo/filters/processWhere.h"
 #include "ufo/GeoVaLs.h"
 #include "ufo/ObsDiagnostics.h"
+#include "ufo/utils/Instrumentation.h"
+#include "ufo/utils/ObsSpaceCache.h"
 
 namespace ufo {
 
+namespace {
+
+/// \brief Inputs and results of a filter run in the incremental mode, retained between
+/// applications of the filter.
+struct IncrementalFilterState {
+  /// Hash of the inputs at each location.
+  std::vector<std::uint64_t> fingerprints;
+  /// Locations flagged by the filter, for each filter variable.
+  std::vector<std::vector<bool>> flagged;
+};
+
+/// Return the state of the filter identified by \p key applied to \p obsdb, creating it if
+/// necessary.
+///
+/// The state must outlive filter objects, since these are typically recreated in each outer loop.
+/// It is released when \p obsdb is destroyed.
+std::shared_ptr<IncrementalFilterState> getIncrementalFilterState(const ioda::ObsSpace &obsdb,
+                                                                  const std::string &key) {
+  static ObsSpaceCache<IncrementalFilterState> cache;
+  return cache.get(obsdb, key, [] { return std::make_shared<IncrementalFilterState>(); });
+}
+
+std::uint64_t hashValue(float value) {
+  return bitPattern(value);
+}
+
+std::uint64_t hashValue(int value) {
+  return static_cast<std::uint32_t>(value);
+}
+
+std::uint64_t hashValue(const std::string &value) {
+  return std::hash<std::string>()(value);
+}
+
+std::uint64_t hashValue(const util::DateTime &value) {
+  return std::hash<std::string>()(value.toString());
+}
+
+template <typename T>
+void addToFingerprints(const std::vector<T> &values, std::vector<std::uint64_t> &fingerprints) {
+  for (size_t jloc = 0; jloc < fingerprints.size(); ++jloc)
+    fingerprints[jloc] = hashCombine(fingerprints[jloc], hashValue(values[jloc]));
+}
+
+template <typename T>
+void addToFingerprints(const ObsFilterData &data, const Variable &var,
+                       std::vector<std::uint64_t> &fingerprints) {
+  std::vector<T> values;
+  data.get(var, values);
+  addToFingerprints(values, fingerprints);
+}
+
+/// Add the values of the single-channel variable \p var at each location to \p fingerprints.
+void addToFingerprints(const ObsFilterData &data, const Variable &var,
+                       std::vector<std::uint64_t> &fingerprints) {
+  // Hash the variable name too, so that a variable disappearing or swapping values with another
+  // one is detected.
+  const std::uint64_t nameHash = hashValue(var.variable() + "@" + var.group());
+  for (std::uint64_t &fingerprint : fingerprints)
+    fingerprint = hashCombine(fingerprint, nameHash);
+  if (!data.has(var))
+    return;
+  const size_t nlevs = data.nlevs(var);
+  if (nlevs > 1) {
+    std::vector<float> values;
+    for (size_t jlev = 0; jlev < nlevs; ++jlev) {
+      data.get(var, jlev, values);
+      addToFingerprints(values, fingerprints);
+    }
+    return;
+  }
+  switch (data.dtype(var)) {
+  case ioda::ObsDtype::Integer:
+    addToFingerprints<int>(data, var, fingerprints);
+    break;
+  case ioda::ObsDtype::String:
+    addToFingerprints<std::string>(data, var, fingerprints);
+    break;
+  case ioda::ObsDtype::DateTime:
+    addToFingerprints<util::DateTime>(data, var, fingerprints);
+    break;
+  default:
+    addToFingerprints<float>(data, var, fingerprints);
+  }
+}
+
+/// \brief Return hashes of the values of \p vars, \p apply, \p flags and \p obserr at each
+/// location.
+std::vector<std::uint64_t> calculateInputFingerprints(const ObsFilterData &data,
+                                                      const Variables &vars,
+                                                      const std::vector<bool> &apply,
+                                                      const ioda::ObsDataVector<int> &flags,
+                                                      const ioda::ObsDataVector<float> &obserr) {
+  std::vector<std::uint64_t> fingerprints(apply.size(), 0);
+  for (size_t jloc = 0; jloc < apply.size(); ++jloc)
+    fingerprints[jloc] = hashCombine(fingerprints[jloc], apply[jloc]);
+  for (size_t jv = 0; jv < flags.nvars(); ++jv)
+    addToFingerprints(flags[jv], fingerprints);
+  for (size_t jv = 0; jv < obserr.nvars(); ++jv)
+    addToFingerprints(obserr[jv], fingerprints);
+
+  for (size_t jv = 0; jv < vars.nvars(); ++jv) {
+    const Variable var = vars.variable(jv);
+    for (size_t jch = 0; jch < var.size(); ++jch)
+      addToFingerprints(data, var[jch], fingerprints);
+  }
+  return fingerprints;
+}
+
+}  // namespace
+
 // -----------------------------------------------------------------------------
 
 FilterBase::FilterBase(ioda::ObsSpace & os,
@@ -36,8 +157,9 @@ FilterBase::FilterBase(ioda::ObsSpace & os,
   : ObsProcessorBase(os, parameters.deferToPost, std::move(flags), std::move(obserr)),
     config_(parameters.toConfiguration()),
     filtervars_(),
-    whereParameters_(parameters.where),
-    actionParameters_(parameters.action().clone())
+    where_(parameters.where),
+    actionParameters_(parameters.action().clone()),
+    incremental_(parameters.incremental)
 {
   oops::Log::trace() << "FilterBase constructor" << std::endl;
   allvars_ += getAllWhereVariables(parameters.where);
@@ -76,9 +198,14 @@ FilterBase::~FilterBase() {
 
 void FilterBase::doFilter() const {
   oops::Log::trace() << "FilterBase doFilter begin" << std::endl;
+  ScopedTimer doFilterTimer(obsdb_.obsname(), "FilterBase::doFilter", typeid(*this));
 
 // Select locations to which the filter will be applied
-  std::vector<bool> apply = processWhere(whereParameters_, data_);
+  std::vector<bool> apply;
+  {
+    ScopedTimer timer(obsdb_.obsname(), "processWhere", typeid(*this));
+    apply = where_.evaluate(data_);
+  }
 
 // Allocate flagged obs indicator (false by default)
   const size_t nvars = filtervars_.nvars();
@@ -86,11 +213,20 @@ void FilterBase::doFilter() const {
   for (size_t jv = 0; jv < flagged.size(); ++jv) flagged[jv].resize(obsdb_.nlocs());
 
 // Apply filter
-  this->applyFilter(apply, filtervars_, flagged);
+  {
+    ScopedTimer timer(obsdb_.obsname(), "FilterBase::applyFilter", typeid(*this));
+    if (incremental_)
+      applyFilterIncrementally(apply, flagged);
+    else
+      this->applyFilter(apply, filtervars_, flagged);
+  }
 
 // Take action
-  FilterAction action(*actionParameters_);
-  action.apply(filtervars_, flagged, data_, this->qcFlag(), *flags_, *obserr_);
+  {
+    ScopedTimer timer(obsdb_.obsname(), "FilterAction::apply", typeid(*this));
+    FilterAction action(*actionParameters_);
+    action.apply(filtervars_, flagged, data_, this->qcFlag(), *flags_, *obserr_);
+  }
 
 // Done
   oops::Log::trace() << "FilterBase doFilter end" << std::endl;
@@ -98,4 +234,56 @@ void FilterBase::doFilter() const {
 
 // -----------------------------------------------------------------------------
 
+void FilterBase::applyFilterIncrementally(const std::vector<bool> &apply,
+                                          std::vector<std::vector<bool>> &flagged) const {
+  const boost::optional<Variables> additionalInputs = incrementalModeInputs();
+  if (additionalInputs == boost::none) {
+    std::ostringstream msg;
+    msg << "The filter " << *this << " does not support the incremental mode";
+    throw eckit::UserError(msg.str(), Here());
+  }
+
+  // Fingerprint everything applyFilter() may read: the declared inputs, the observed values of
+  // the filter variables and the variables listed by the filter itself.
+  Variables inputs = allvars_;
+  inputs += Variables(filtervars_, "ObsValue");
+  inputs += *additionalInputs;
+
+  const size_t nlocs = obsdb_.nlocs();
+  std::vector<std::uint64_t> fingerprints =
+      calculateInputFingerprints(data_, inputs, apply, *flags_, *obserr_);
+
+  std::ostringstream key;
+  key << typeid(*this).name() << '\n' << config_;
+  std::shared_ptr<IncrementalFilterState> state = getIncrementalFilterState(obsdb_, key.str());
+
+  // Identify locations whose inputs have changed since the previous application.
+  size_t numChanged = nlocs;
+  if (state->fingerprints.size() == nlocs && state->flagged.size() == flagged.size()) {
+    numChanged = 0;
+    for (size_t jloc = 0; jloc < nlocs; ++jloc)
+      numChanged += fingerprints[jloc] != state->fingerprints[jloc];
+  }
+  // applyFilter() may communicate, so all ranks must agree whether to call it.
+  size_t totalNumChanged = numChanged;
+  obsdb_.comm().allReduceInPlace(totalNumChanged, eckit::mpi::sum());
+
+  size_t numReevaluated = 0;
+  if (totalNumChanged == 0) {
+    flagged = state->flagged;
+  } else {
+    this->applyFilter(apply, filtervars_, flagged);
+    numReevaluated = nlocs;
+  }
+
+  oops::Log::debug() << "FilterBase: incremental mode: " << numReevaluated << " of " << nlocs
+                     << " locations re-evaluated" << std::endl;
+  ScopedTimer::count("re-evaluated locations", numReevaluated);
+
+  state->fingerprints = std::move(fingerprints);
+  state->flagged = flagged;
+}
+
+// -----------------------------------------------------------------------------
+
 }  // namespace ufo
@@ -13,6 +13,8 @@
 #include <string>
 #include <vector>
 
+#include <boost/optional.hpp>
+
 #include "ioda/ObsDataVector.h"
 #include "oops/base/Variables.h"
 #include "oops/util/ObjectCounter.h"
@@ -59,15 +61,33 @@ class FilterBase : public ObsProcessorBase {
   const eckit::LocalConfiguration config_;
   ufo::Variables filtervars_;
 
+  /// \brief Return the variables read by applyFilter() in addition to those in allvars_ and the
+  /// ObsValues of the filter variables, or boost::none if the filter cannot be run in the
+  /// incremental mode (see FilterParametersBaseWithAbstractAction::incremental).
+  ///
+  /// Filters must not support the incremental mode unless all their inputs are known in advance
+  /// and their only effect is to flag locations, since applyFilter() is not called when none of
+  /// the inputs has changed. Filters writing to the ObsSpace or modifying QC flags or
+  /// observation errors directly must therefore keep the default implementation.
+  ///
+  /// Checking whether the inputs have changed requires reading and hashing all of them at every
+  /// location, followed by a reduction over all ranks. Filters whose applyFilter() costs about
+  /// as much as that (such as the Bounds Check) gain nothing from the incremental mode and
+  /// should keep the default implementation too.
+  virtual boost::optional<Variables> incrementalModeInputs() const {return boost::none;}
+
  private:
   void doFilter() const override;
+  void applyFilterIncrementally(const std::vector<bool> &apply,
+                                std::vector<std::vector<bool>> &flagged) const;
   void print(std::ostream &) const override = 0;
   virtual void applyFilter(const std::vector<bool> &, const Variables &,
                            std::vector<std::vector<bool>> &) const = 0;
   virtual int qcFlag() const = 0;
 
-  std::vector<WhereParameters> whereParameters_;
+  CompiledWhere where_;
   std::unique_ptr<FilterActionParametersBase> actionParameters_;
+  bool incremental_;
 };
 
 }  // namespace ufo
@@ -68,6 +68,22 @@ class FilterParametersBaseWithAbstractAction : public oops::ObsFilterParametersB
   /// doesn't require any variables from the GeoVaLs or HofX groups).
   oops::Parameter<bool> deferToPost{"defer to post", false, this};
 
+  /// If set to true, the filter remembers its inputs and results between applications to the
+  /// same ObsSpace (typically in successive outer loops). When applied again, the filter is
+  /// skipped if none of its inputs has changed at any location on any rank; otherwise it is rerun
+  /// in full.
+  ///
+  /// The inputs are the QC flags and observation errors on entry to the filter, the locations
+  /// selected by the `where` statement, the observed values of the filter variables and the
+  /// values of all other variables the filter reads (including those used by the `where`
+  /// statement and by the action). The results are kept for as long as the ObsSpace exists.
+  ///
+  /// Checking the inputs costs about as much as running a simple filter, so this option is only
+  /// supported by filters whose sole effect is to flag observations and which are much more
+  /// expensive than reading their inputs; currently this is only the Gaussian Thinning filter.
+  /// An exception is thrown if it is enabled for any other filter.
+  oops::Parameter<bool> incremental{"incremental", false, this};
+
   /// Return parameters defining the action performed on observations flagged by the filter.
   virtual const FilterActionParametersBase &action() const = 0;
 };
@@ -9,6 +9,8 @@
 
 #include <algorithm>
 #include <cmath>
+#include <limits>
+#include <sstream>
 #include <string>
 #include <utility>
 #include <vector>
@@ -27,11 +29,105 @@
 #include "ufo/utils/EquispacedBinSelector.h"
 #include "ufo/utils/GeodesicDistanceCalculator.h"
 #include "ufo/utils/MaxNormDistanceCalculator.h"
+#include "ufo/utils/ObsSpaceCache.h"
+#include "ufo/utils/ParallelFor.h"
 #include "ufo/utils/RecursiveSplitter.h"
 #include "ufo/utils/SpatialBinSelector.h"
 
 namespace ufo {
 
+namespace {
+
+/// Minimum number of observations processed by a single task in parallel loops over
+/// observations.
+const size_t minNumObsPerTask = 16384;
+
+/// Minimum number of bins processed by a single task in parallel loops over bins.
+const size_t minNumBinsPerTask = 1024;
+
+}  // namespace
+
+// -----------------------------------------------------------------------------
+
+/// \brief Combines the indices of the bins containing each observation along successive axes
+/// (pressure, time, latitude, longitude) into a single key.
+///
+/// Grouping observations by these keys with a single call to RecursiveSplitter::groupBy()
+/// produces the same groups, with the same order of elements, as grouping them by the bin
+/// indices along each axis in turn, but is considerably faster.
+class Gaussian_Thinning::CompositeBinKeys {
+ public:
+  CompositeBinKeys(size_t numObs, RecursiveSplitter &splitter)
+    : keys_(numObs, 0), numKeys_(1), splitter_(splitter)
+  {}
+
+  /// \brief Refine the keys using the bin indices \p bins, which must lie in [0, \p numBins).
+  void addBins(const std::vector<size_t> &bins, size_t numBins) {
+    if (numBins <= 1)
+      return;
+    if (numKeys_ > std::numeric_limits<size_t>::max() / numBins)
+      // The combined key would overflow. Split the observations by the keys accumulated so far.
+      flush();
+    parallelForChunks(keys_.size(), minNumObsPerTask, [&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; ++i)
+        keys_[i] = keys_[i] * numBins + bins[i];
+    });
+    numKeys_ *= numBins;
+  }
+
+  /// \brief Split the groups of observations according to the keys accumulated so far.
+  void flush() {
+    if (numKeys_ <= 1)
+      return;
+    splitter_.groupBy(keys_);
+    std::fill(keys_.begin(), keys_.end(), 0);
+    numKeys_ = 1;
+  }
+
+ private:
+  std::vector<size_t> keys_;
+  size_t numKeys_;
+  RecursiveSplitter &splitter_;
+};
+
+// -----------------------------------------------------------------------------
+
+/// \brief Bins containing observations and their distances to the bin centers, retained across
+/// calls to applyFilter().
+///
+/// All vectors are indexed by observation ID (as defined by ObsAccessor). Observations are binned
+/// lazily, the first time they are found to be valid, since the coordinates of invalid
+/// observations may be missing.
+///
+/// The coordinates are assumed not to change once the filter has been applied to an ObsSpace; they
+/// are neither kept nor re-read to check this.
+class Gaussian_Thinning::BinIndex {
+ public:
+  BinIndex(const GaussianThinningParameters &options, size_t numObs)
+    : spatialBinSelector(makeSpatialBinSelector(options)),
+      pressureBinSelector(makePressureBinSelector(options)),
+      timeBinSelector(makeTimeBinSelector(options, timeOffset)),
+      latitudeBins(spatialBinSelector ? numObs : 0, 0),
+      longitudeBins(spatialBinSelector ? numObs : 0, 0),
+      pressureBins(pressureBinSelector ? numObs : 0, 0),
+      timeBins(timeBinSelector ? numObs : 0, 0),
+      distancesToBinCenter(numObs, 0.f),
+      isBinned(numObs, false)
+  {}
+
+  util::DateTime timeOffset;
+  boost::optional<SpatialBinSelector> spatialBinSelector;
+  boost::optional<EquispacedBinSelector> pressureBinSelector;
+  boost::optional<EquispacedBinSelector> timeBinSelector;
+
+  std::vector<int> latitudeBins;
+  std::vector<int> longitudeBins;
+  std::vector<int> pressureBins;
+  std::vector<int> timeBins;
+  std::vector<float> distancesToBinCenter;
+  std::vector<char> isBinned;
+};
+
 // -----------------------------------------------------------------------------
 
 Gaussian_Thinning::Gaussian_Thinning(ioda::ObsSpace & obsdb,
@@ -52,16 +148,54 @@ void Gaussian_Thinning::applyFilter(const std::vector<bool> & apply,
 
   const std::vector<size_t> validObsIds = obsAccessor.getValidObservationIds(apply, *flags_);
 
-  std::vector<float> distancesToBinCenter(validObsIds.size(), 0.f);
-  std::unique_ptr<DistanceCalculator> distanceCalculator = makeDistanceCalculator(options_);
+  // Bin the valid observations that have not been binned in previous calls.
+  std::shared_ptr<BinIndex> binIndex = getBinIndex(obsAccessor.totalNumObservations());
+  ASSERT(binIndex->isBinned.size() == obsAccessor.totalNumObservations());
+  std::vector<size_t> unbinnedObsIds;
+  for (size_t obsId : validObsIds)
+    if (!binIndex->isBinned[obsId])
+      unbinnedObsIds.push_back(obsId);
+  oops::Log::debug() << "Gaussian_Thinning: number of newly binned observations = "
+                     << unbinnedObsIds.size() << std::endl;
+  // validObsIds and isBinned are the same on all ranks, so either all or none of them gather the
+  // coordinates below.
+  if (!unbinnedObsIds.empty()) {
+    std::unique_ptr<DistanceCalculator> distanceCalculator = makeDistanceCalculator(options_);
+    binObservationsByPressure(unbinnedObsIds, obsAccessor, *distanceCalculator, *binIndex);
+    binObservationsByTime(unbinnedObsIds, obsAccessor, *distanceCalculator, *binIndex);
+    binObservationsBySpatialLocation(unbinnedObsIds, obsAccessor, *distanceCalculator,
+                                     *binIndex);
+    for (size_t obsId : unbinnedObsIds)
+      binIndex->isBinned[obsId] = true;
+  }
 
+  // Group the valid observations by bin.
   RecursiveSplitter splitter = obsAccessor.splitObservationsIntoIndependentGroups(validObsIds);
-  groupObservationsByPressure(validObsIds, *distanceCalculator, obsAccessor,
-                              splitter, distancesToBinCenter);
-  groupObservationsByTime(validObsIds, *distanceCalculator, obsAccessor,
-                          splitter, distancesToBinCenter);
-  groupObservationsBySpatialLocation(validObsIds, *distanceCalculator, obsAccessor,
-                                     splitter, distancesToBinCenter);
+  CompositeBinKeys binKeys(validObsIds.size(), splitter);
+  auto addBins = [&](const std::vector<int> &binsByObsId, size_t numBins) {
+    std::vector<size_t> bins(validObsIds.size());
+    parallelForChunks(validObsIds.size(), minNumObsPerTask, [&](size_t begin, size_t end) {
+      for (size_t validObsIndex = begin; validObsIndex < end; ++validObsIndex)
+        bins[validObsIndex] = binsByObsId[validObsIds[validObsIndex]];
+    });
+    binKeys.addBins(bins, numBins);
+  };
+  if (binIndex->pressureBinSelector)
+    addBins(binIndex->pressureBins, binIndex->pressureBinSelector->numBins());
+  if (binIndex->timeBinSelector)
+    addBins(binIndex->timeBins, binIndex->timeBinSelector->numBins());
+  if (binIndex->spatialBinSelector) {
+    addBins(binIndex->latitudeBins, binIndex->spatialBinSelector->numLatitudeBins());
+    // The number of longitude bins varies between zonal bands, but never exceeds the total
+    // number of bins.
+    addBins(binIndex->longitudeBins, binIndex->spatialBinSelector->totalNumBins());
+  }
+  binKeys.flush();
+
+  std::vector<float> distancesToBinCenter(validObsIds.size());
+  for (size_t validObsIndex = 0; validObsIndex < validObsIds.size(); ++validObsIndex)
+    distancesToBinCenter[validObsIndex] =
+        binIndex->distancesToBinCenter[validObsIds[validObsIndex]];
 
   const std::vector<bool> isThinned = identifyThinnedObservations(
         validObsIds, obsAccessor, splitter, distancesToBinCenter);
@@ -74,6 +208,19 @@ void Gaussian_Thinning::applyFilter(const std::vector<bool> & apply,
 
 // -----------------------------------------------------------------------------
 
+boost::optional<Variables> Gaussian_Thinning::incrementalModeInputs() const {
+  Variables inputs;
+  for (const char *coordinate : {"latitude", "longitude", "air_pressure", "datetime"})
+    inputs += Variable(std::string(coordinate) + "@MetaData");
+  if (options_.priorityVariable.value() != boost::none)
+    inputs += *options_.priorityVariable.value();
+  if (options_.categoryVariable.value() != boost::none)
+    inputs += *options_.categoryVariable.value();
+  return inputs;
+}
+
+// -----------------------------------------------------------------------------
+
 ObsAccessor Gaussian_Thinning::createObsAccessor() const {
   if (options_.categoryVariable.value() != boost::none) {
     return ObsAccessor::toObservationsSplitIntoIndependentGroupsByVariable(
@@ -85,6 +232,21 @@ ObsAccessor Gaussian_Thinning::createObsAccessor() const {
 
 // -----------------------------------------------------------------------------
 
+std::shared_ptr<Gaussian_Thinning::BinIndex> Gaussian_Thinning::getBinIndex(
+    size_t numObs) const {
+  // Bin indices are shared by all instances of the filter with the same options applied to the
+  // same ObsSpace, so that they survive the re-creation of filters in each outer loop. They are
+  // released when the ObsSpace is destroyed.
+  static ObsSpaceCache<BinIndex> cache;
+
+  std::ostringstream key;
+  key << options_;
+  return cache.get(obsdb_, key.str(),
+                   [&] { return std::make_shared<BinIndex>(options_, numObs); });
+}
+
+// -----------------------------------------------------------------------------
+
 std::unique_ptr<DistanceCalculator> Gaussian_Thinning::makeDistanceCalculator(
     const GaussianThinningParameters &options) {
   switch (options.distanceNorm.value()) {
@@ -98,13 +260,12 @@ std::unique_ptr<DistanceCalculator> Gaussian_Thinning::makeDistanceCalculator(
 
 // -----------------------------------------------------------------------------
 
-void Gaussian_Thinning::groupObservationsBySpatialLocation(
-    const std::vector<size_t> &validObsIds,
-    const DistanceCalculator &distanceCalculator,
+void Gaussian_Thinning::binObservationsBySpatialLocation(
+    const std::vector<size_t> &obsIds,
     const ObsAccessor &obsAccessor,
-    RecursiveSplitter &splitter,
-    std::vector<float> &distancesToBinCenter) const {
-  boost::optional<SpatialBinSelector> binSelector = makeSpatialBinSelector(options_);
+    const DistanceCalculator &distanceCalculator,
+    BinIndex &binIndex) const {
+  const boost::optional<SpatialBinSelector> &binSelector = binIndex.spatialBinSelector;
   if (binSelector == boost::none)
     return;
 
@@ -113,7 +274,7 @@ void Gaussian_Thinning::groupObservationsBySpatialLocation(
   oops::Log::debug() << "Gaussian_Thinning: number of horizontal bins = "
                      << binSelector->totalNumBins() << std::endl;
 
-  std::vector<float> lat = obsAccessor.getFloatVariableFromObsSpace("MetaData", "latitude");
+  const std::vector<float> lat = obsAccessor.getFloatVariableFromObsSpace("MetaData", "latitude");
   std::vector<float> lon = obsAccessor.getFloatVariableFromObsSpace("MetaData", "longitude");
   // Longitudes will typically be either in the [-180, 180] degree range or in the [0, 360]
   // degree range. The spatial bin selector is written with the latter convention in mind,
@@ -121,35 +282,30 @@ void Gaussian_Thinning::groupObservationsBySpatialLocation(
   for (float &longitude : lon)
     if (longitude < 0)
       longitude += 360;
-
-  std::vector<size_t> latBins;
-  std::vector<size_t> lonBins;
-  latBins.reserve(validObsIds.size());
-  lonBins.reserve(validObsIds.size());
-  for (size_t obsId : validObsIds) {
-    const size_t latBin = binSelector->latitudeBin(lat[obsId]);
-    latBins.push_back(latBin);
-    lonBins.push_back(binSelector->longitudeBin(latBin, lon[obsId]));
-  }
-  splitter.groupBy(latBins);
-  splitter.groupBy(lonBins);
+  std::vector<int> &latBins = binIndex.latitudeBins;
+  std::vector<int> &lonBins = binIndex.longitudeBins;
+  parallelForChunks(obsIds.size(), minNumObsPerTask, [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+      const size_t obsId = obsIds[i];
+      const int latBin = binSelector->latitudeBin(lat[obsId]);
+      const int lonBin = binSelector->longitudeBin(latBin, lon[obsId]);
+      latBins[obsId] = latBin;
+      lonBins[obsId] = lonBin;
+      const float component = distanceCalculator.spatialDistanceComponent(
+            lat[obsId], lon[obsId],
+            binSelector->latitudeBinCenter(latBin),
+            binSelector->longitudeBinCenter(latBin, lonBin),
+            binSelector->inverseLatitudeBinWidth(),
+            binSelector->inverseLongitudeBinWidth(latBin));
+      binIndex.distancesToBinCenter[obsId] = distanceCalculator.combineDistanceComponents(
+            binIndex.distancesToBinCenter[obsId], component);
+    }
+  });
 
   oops::Log::debug() << "Gaussian_Thinning: latitudes  = " << lat << std::endl;
   oops::Log::debug() << "Gaussian_Thinning: longitudes = " << lon << std::endl;
   oops::Log::debug() << "Gaussian_Thinning: lat bins   = " << latBins << std::endl;
   oops::Log::debug() << "Gaussian_Thinning: lon bins   = " << lonBins << std::endl;
-
-  for (size_t validObsIndex = 0; validObsIndex < validObsIds.size(); ++validObsIndex) {
-    const size_t obsId = validObsIds[validObsIndex];
-    float component = distanceCalculator.spatialDistanceComponent(
-          lat[obsId], lon[obsId],
-          binSelector->latitudeBinCenter(latBins[validObsIndex]),
-          binSelector->longitudeBinCenter(latBins[validObsIndex], lonBins[validObsIndex]),
-          binSelector->inverseLatitudeBinWidth(),
-          binSelector->inverseLongitudeBinWidth(latBins[validObsIndex]));
-    distancesToBinCenter[validObsIndex] = distanceCalculator.combineDistanceComponents(
-          distancesToBinCenter[validObsIndex], component);
-  }
 }
 
 // -----------------------------------------------------------------------------
@@ -182,40 +338,35 @@ boost::optional<SpatialBinSelector> Gaussian_Thinning::makeSpatialBinSelector(
 
 // -----------------------------------------------------------------------------
 
-void Gaussian_Thinning::groupObservationsByPressure(
-    const std::vector<size_t> &validObsIds,
-    const DistanceCalculator &distanceCalculator,
+void Gaussian_Thinning::binObservationsByPressure(
+    const std::vector<size_t> &obsIds,
     const ObsAccessor &obsAccessor,
-    RecursiveSplitter &splitter,
-    std::vector<float> &distancesToBinCenter) const {
-  boost::optional<EquispacedBinSelector> binSelector = makePressureBinSelector(options_);
+    const DistanceCalculator &distanceCalculator,
+    BinIndex &binIndex) const {
+  const boost::optional<EquispacedBinSelector> &binSelector = binIndex.pressureBinSelector;
   if (binSelector == boost::none)
     return;
 
   oops::Log::debug() << "Gaussian_Thinning: number of vertical bins = "
                      << binSelector->numBins() << std::endl;
 
-  std::vector<float> pres = obsAccessor.getFloatVariableFromObsSpace("MetaData", "air_pressure");
-
-  std::vector<size_t> bins;
-  bins.reserve(validObsIds.size());
-  for (size_t obsId : validObsIds)
-  {
-    bins.push_back(binSelector->bin(pres[obsId]));
-  }
-  splitter.groupBy(bins);
+  const std::vector<float> pres =
+      obsAccessor.getFloatVariableFromObsSpace("MetaData", "air_pressure");
+  std::vector<int> &bins = binIndex.pressureBins;
+  parallelForChunks(obsIds.size(), minNumObsPerTask, [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+      const size_t obsId = obsIds[i];
+      bins[obsId] = binSelector->bin(pres[obsId]);
+      const float component = distanceCalculator.nonspatialDistanceComponent(
+            pres[obsId], binSelector->binCenter(bins[obsId]),
+            binSelector->inverseBinWidth());
+      binIndex.distancesToBinCenter[obsId] = distanceCalculator.combineDistanceComponents(
+            binIndex.distancesToBinCenter[obsId], component);
+    }
+  });
 
   oops::Log::debug() << "Gaussian_Thinning: pressures     = " << pres << std::endl;
   oops::Log::debug() << "Gaussian_Thinning: pressure bins = " << bins << std::endl;
-
-  for (size_t validObsIndex = 0; validObsIndex < validObsIds.size(); ++validObsIndex) {
-    const size_t obsId = validObsIds[validObsIndex];
-    const float component = distanceCalculator.nonspatialDistanceComponent(
-          pres[obsId], binSelector->binCenter(bins[validObsIndex]),
-          binSelector->inverseBinWidth());
-    distancesToBinCenter[validObsIndex] = distanceCalculator.combineDistanceComponents(
-          distancesToBinCenter[validObsIndex], component);
-  }
 }
 
 // -----------------------------------------------------------------------------
@@ -240,45 +391,38 @@ boost::optional<EquispacedBinSelector> Gaussian_Thinning::makePressureBinSelecto
 
 // -----------------------------------------------------------------------------
 
-void Gaussian_Thinning::groupObservationsByTime(
-    const std::vector<size_t> &validObsIds,
-    const DistanceCalculator &distanceCalculator,
+void Gaussian_Thinning::binObservationsByTime(
+    const std::vector<size_t> &obsIds,
     const ObsAccessor &obsAccessor,
-    RecursiveSplitter &splitter,
-    std::vector<float> &distancesToBinCenter) const {
-  util::DateTime timeOffset;
-  boost::optional<EquispacedBinSelector> binSelector = makeTimeBinSelector(options_, timeOffset);
+    const DistanceCalculator &distanceCalculator,
+    BinIndex &binIndex) const {
+  const boost::optional<EquispacedBinSelector> &binSelector = binIndex.timeBinSelector;
   if (binSelector == boost::none)
     return;
 
   oops::Log::debug() << "Gaussian_Thinning: number of time bins = "
                      << binSelector->numBins() << std::endl;
 
-  std::vector<util::DateTime> times = obsAccessor.getDateTimeVariableFromObsSpace(
-        "MetaData", "datetime");
-
-  std::vector<size_t> bins;
-  bins.reserve(validObsIds.size());
-  for (size_t obsId : validObsIds)
-  {
-    bins.push_back(binSelector->bin((times[obsId] - timeOffset).toSeconds()));
-  }
-  splitter.groupBy(bins);
+  const std::vector<util::DateTime> times =
+      obsAccessor.getDateTimeVariableFromObsSpace("MetaData", "datetime");
+  const util::DateTime &timeOffset = binIndex.timeOffset;
+  std::vector<int> &bins = binIndex.timeBins;
+  parallelForChunks(obsIds.size(), minNumObsPerTask, [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+      const size_t obsId = obsIds[i];
+      const float time = (times[obsId] - timeOffset).toSeconds();
+      bins[obsId] = binSelector->bin(time);
+      const float component = distanceCalculator.nonspatialDistanceComponent(
+            time, binSelector->binCenter(bins[obsId]), binSelector->inverseBinWidth());
+      binIndex.distancesToBinCenter[obsId] = distanceCalculator.combineDistanceComponents(
+            binIndex.distancesToBinCenter[obsId], component);
+    }
+  });
 
   oops::Log::debug() << "Gaussian_Thinning: times = ";
   eckit::__print_list(oops::Log::debug(), times, eckit::VectorPrintSimple());
   oops::Log::debug() << std::endl;
   oops::Log::debug() << "Gaussian_Thinning: time bins = " << bins << std::endl;
-
-  for (size_t validObsIndex = 0; validObsIndex < validObsIds.size(); ++validObsIndex) {
-    const size_t obsId = validObsIds[validObsIndex];
-    const float component = distanceCalculator.nonspatialDistanceComponent(
-          (times[obsId] - timeOffset).toSeconds(),
-          binSelector->binCenter(bins[validObsIndex]),
-          binSelector->inverseBinWidth());
-    distancesToBinCenter[validObsIndex] = distanceCalculator.combineDistanceComponents(
-          distancesToBinCenter[validObsIndex], component);
-  }
 }
 
 // -----------------------------------------------------------------------------
@@ -326,15 +470,25 @@ std::vector<bool> Gaussian_Thinning::identifyThinnedObservations(
 
   size_t totalNumObs = obsAccessor.totalNumObservations();
 
-  std::vector<bool> isThinned(totalNumObs, false);
-  for (auto group : splitter.multiElementGroups()) {
-    const size_t bestValidObsIndex = *std::min_element(
-          std::begin(group), std::end(group), comparator);
+  std::vector<RecursiveSplitter::Group> groups;
+  for (auto group : splitter.multiElementGroups())
+    groups.push_back(group);
 
-    for (size_t validObsIndex : group)
-      if (validObsIndex != bestValidObsIndex)
+  // Select the best observation in each bin concurrently...
+  std::vector<size_t> bestValidObsIndices(groups.size());
+  parallelForChunks(groups.size(), minNumBinsPerTask, [&](size_t begin, size_t end) {
+    for (size_t groupIndex = begin; groupIndex < end; ++groupIndex)
+      bestValidObsIndices[groupIndex] = *std::min_element(
+            std::begin(groups[groupIndex]), std::end(groups[groupIndex]), comparator);
+  });
+
+  // ... and thin the others serially (std::vector<bool> cannot be safely modified by
+  // multiple threads).
+  std::vector<bool> isThinned(totalNumObs, false);
+  for (size_t groupIndex = 0; groupIndex < groups.size(); ++groupIndex)
+    for (size_t validObsIndex : groups[groupIndex])
+      if (validObsIndex != bestValidObsIndices[groupIndex])
         isThinned[validObsIds[validObsIndex]] = true;
-  }
 
   return isThinned;
 }
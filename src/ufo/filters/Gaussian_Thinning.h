@@ -56,6 +56,14 @@ class SpatialBinSelector;
 /// - optionally, its priority.
 ///
 /// See GaussianThinningParameters for the documentation of the available options.
+///
+/// The bins containing each observation and its distance to the bin center depend only on the
+/// observation's coordinates, which do not change between outer loops. They are therefore
+/// calculated only once per ObsSpace and filter configuration and reused in subsequent calls,
+/// which then only need to group the currently valid observations and select the best
+/// observation in each bin. The cached values are released when the ObsSpace is destroyed. The
+/// coordinates must therefore not be modified after the filter has first been applied to an
+/// ObsSpace.
 class Gaussian_Thinning : public FilterBase,
                           private util::ObjectCounter<Gaussian_Thinning> {
  public:
@@ -70,30 +78,33 @@ class Gaussian_Thinning : public FilterBase,
                     std::shared_ptr<ioda::ObsDataVector<float> > obserr);
 
  private:
+  class BinIndex;
+  class CompositeBinKeys;
+
   void print(std::ostream &) const override;
   void applyFilter(const std::vector<bool> &, const Variables &,
                    std::vector<std::vector<bool>> &) const override;
   int qcFlag() const override {return QCflags::thinned;}
+  boost::optional<Variables> incrementalModeInputs() const override;
 
   ObsAccessor createObsAccessor() const;
 
-  void groupObservationsBySpatialLocation(const std::vector<size_t> &validObsIds,
-                                          const DistanceCalculator &distanceCalculator,
-                                          const ObsAccessor &obsAccessor,
-                                          RecursiveSplitter &splitter,
-                                          std::vector<float> &distancesToBinCenter) const;
-
-  void groupObservationsByPressure(const std::vector<size_t> &validObsIds,
-                                   const DistanceCalculator &distanceCalculator,
-                                   const ObsAccessor &obsAccessor,
-                                   RecursiveSplitter &splitter,
-                                   std::vector<float> &distancesToBinCenter) const;
-
-  void groupObservationsByTime(const std::vector<size_t> &validObsIds,
-                               const DistanceCalculator &distanceCalculator,
-                               const ObsAccessor &obsAccessor,
-                               RecursiveSplitter &splitter,
-                               std::vector<float> &distancesToBinCenter) const;
+  std::shared_ptr<BinIndex> getBinIndex(size_t numObs) const;
+
+  void binObservationsBySpatialLocation(const std::vector<size_t> &obsIds,
+                                        const ObsAccessor &obsAccessor,
+                                        const DistanceCalculator &distanceCalculator,
+                                        BinIndex &binIndex) const;
+
+  void binObservationsByPressure(const std::vector<size_t> &obsIds,
+                                 const ObsAccessor &obsAccessor,
+                                 const DistanceCalculator &distanceCalculator,
+                                 BinIndex &binIndex) const;
+
+  void binObservationsByTime(const std::vector<size_t> &obsIds,
+                             const ObsAccessor &obsAccessor,
+                             const DistanceCalculator &distanceCalculator,
+                             BinIndex &binIndex) const;
 
   std::vector<bool> identifyThinnedObservations(
       const std::vector<size_t> &validObsIds,
@@ -18,6 +18,9 @@
 #include <boost/none.hpp>
 #include <boost/optional.hpp>
 #include "eckit/config/Configuration.h"
+#include "eckit/config/LocalConfiguration.h"
+#include "eckit/exception/Exceptions.h"
+#include "eckit/filesystem/PathName.h"
 #include "ioda/ObsDataVector.h"
 #include "ioda/ObsSpace.h"
 #include "oops/base/Variables.h"
@@ -25,7 +28,9 @@
 #include "oops/util/DateTime.h"
 #include "oops/util/Duration.h"
 #include "oops/util/Logger.h"
+#include "oops/util/missingValues.h"
 #include "ufo/filters/HistoryCheckParameters.h"
+#include "ufo/filters/HistoryCheckState.h"
 #include "ufo/filters/ObsAccessor.h"
 #include "ufo/filters/QCflags.h"
 #include "ufo/filters/StuckCheck.h"
@@ -58,16 +63,29 @@ HistoryCheck::HistoryCheck(ioda::ObsSpace &obsdb,
 /// obs space (which is assumed to be a superset of \p obsdb_ with an earlier starting time),
 /// before checking which observations have both been (1) flagged by either of the sub-filters
 /// from the superset obs space and (2) are located within \p obsdb_
+///
+/// In incremental mode the auxiliary obs space is instead assembled from the station histories
+/// retained at the end of the previous cycle and the observations from \p obsdb_ (see
+/// applyFilterIncrementally()).
 void HistoryCheck::applyFilter(const std::vector<bool> & apply,
                                const Variables & filtervars,
                                std::vector<std::vector<bool> > & flagged) const {
+  if (options_.historyStateInputFile.value() != boost::none ||
+      options_.historyStateOutputFile.value() != boost::none) {
+    applyFilterIncrementally(filtervars, flagged);
+    return;
+  }
+  if (options_.largerObsSpace.value() == boost::none)
+    throw eckit::UserError("HistoryCheck: the 'obs space' option must be set unless the filter "
+                           "is run in incremental mode", Here());
+
   util::DateTime widerWindowStart = obsdb_.windowStart() - options_.timeBeforeStartOfWindow.value();
   // In order to prevent the MPI from distributing the aux spaces's observations to different
   // ranks from the distribution used for obsdb_, widerObsSpace uses the myself communicator
   // for both time and spatial communicators, ensuring that all observations in widerObsSpace
   // are saved to all ranks
-  ioda::ObsSpace widerObsSpace(options_.largerObsSpace, oops::mpi::myself(), widerWindowStart,
-                               obsdb_.windowEnd(), oops::mpi::myself());
+  ioda::ObsSpace widerObsSpace(*options_.largerObsSpace.value(), oops::mpi::myself(),
+                               widerWindowStart, obsdb_.windowEnd(), oops::mpi::myself());
   if (options_.resetLargerObsSpaceVariables) {  // used for unit testing
     if (unitTestConfig_.has("station_ids_wide")) {
       const std::vector<int> stationIds = unitTestConfig_.getIntVector("station_ids_wide");
@@ -87,52 +105,7 @@ void HistoryCheck::applyFilter(const std::vector<bool> & apply,
         new ioda::ObsDataVector<float>(widerObsSpace, widerObsSpace.obsvariables(), "ObsError"));
   std::shared_ptr<ioda::ObsDataVector<int>> qcflagsWide(
         new ioda::ObsDataVector<int>(widerObsSpace, widerObsSpace.obsvariables()));
-  const oops::RequiredParameter<SurfaceObservationSubtype> &subtype =
-      options_.surfaceObservationSubtype;
-  const boost::optional<TrackCheckShipCoreParameters> &trackOptions =
-      options_.trackCheckShipParameters.value();
-  // If the observation type is one which the track check ship filter should be run on and
-  // the necessary filter parameters were set within the configuration file
-  if (subtype != SurfaceObservationSubtype::LNDSYB &&
-      subtype != SurfaceObservationSubtype::LNDSYN &&
-      trackOptions) {
-    // Collecting parameters relevant for running the track check ship filter on the wider obs space
-    eckit::LocalConfiguration configTrackCheckShip =
-        trackOptions->toConfiguration();
-    subtype.serialize(configTrackCheckShip);
-    // Importing the base parameters
-    options_.TrackCheckUtilsParameters::serialize(configTrackCheckShip);
-    ufo::TrackCheckShipParameters trackParams;
-    trackParams.deserialize(configTrackCheckShip);
-    // Setting up and running the track check ship filter on the wider obs space
-    ufo::TrackCheckShip trackCheck(widerObsSpace, trackParams,
-                                   qcflagsWide, obserrWide);
-    trackCheck.preProcess();
-  }
-  const boost::optional<StuckCheckCoreParameters> &stuckOptions =
-      options_.stuckCheckParameters;
-  // If the stuck check filter parameters were set and if the stuck check filter has the potential
-  // to flag observations (number of observations is greater than the numberStuckTolerance value)
-  if (stuckOptions &&
-      widerObsSpace.index().size() >
-      (stuckOptions)->numberStuckTolerance) {
-    // If the observation subtype is one which the stuck check filter should be run on
-    if (subtype != SurfaceObservationSubtype::TEMP &&
-        subtype != SurfaceObservationSubtype::BATHY &&
-        subtype != SurfaceObservationSubtype::TESAC &&
-        subtype != SurfaceObservationSubtype::BUOYPROF) {
-      // Collecting the relevant parameters for running the stuck check filter
-      eckit::LocalConfiguration configStuckCheck =
-          stuckOptions->toConfiguration();
-      options_.TrackCheckUtilsParameters::serialize(configStuckCheck);
-      ufo::StuckCheckParameters stuckParams;
-      stuckParams.deserialize(configStuckCheck);
-      // Setting up and running the stuck check filter on the wider obs space
-      ufo::StuckCheck stuckCheck(widerObsSpace, stuckParams,
-                                 qcflagsWide, obserrWide);
-      stuckCheck.preProcess();
-    }
-  }
+  runSubFilters(widerObsSpace, qcflagsWide, obserrWide);
   // Creating obs accessors for both obs spaces, assuming the same variable is used for grouping
   // into stations on both obs spaces
   ObsAccessor historicalObsAccessor = TrackCheckUtils::createObsAccessor(options_.stationIdVariable,
@@ -250,6 +223,232 @@ void HistoryCheck::applyFilter(const std::vector<bool> & apply,
   windowObsAccessor.flagRejectedObservations(globalObsToFlag, flagged);
 }
 
+/// The auxiliary obs space contains the observations retained in the history state file that
+/// were taken within the period of length `time before start of window` preceding the current
+/// window, followed by all observations from the current window (gathered from all MPI ranks).
+/// Since the position of each window observation in the auxiliary obs space is known, there is
+/// no need to match observations by their identifiers as in the non-incremental mode.
+void HistoryCheck::applyFilterIncrementally(const Variables & filtervars,
+                                            std::vector<std::vector<bool> > & flagged) const {
+  const boost::optional<Variable> &statIdVar = options_.stationIdVariable.value();
+  if (statIdVar == boost::none)
+    throw eckit::UserError("HistoryCheck: the incremental mode requires the station_id_variable "
+                           "option to be set", Here());
+
+  const std::vector<std::string> variables = filtervars.toOopsVariables().variables();
+  const util::DateTime historyStart =
+      obsdb_.windowStart() - options_.timeBeforeStartOfWindow.value();
+
+  // Load the station histories retained at the end of the previous cycle.
+  HistoryCheckState state(variables);
+  if (options_.historyStateInputFile.value() != boost::none) {
+    const std::string &inputFile = *options_.historyStateInputFile.value();
+    if (eckit::PathName(inputFile).exists()) {
+      state = HistoryCheckState::read(inputFile, variables);
+    } else {
+      oops::Log::warning() << "HistoryCheck: history state file '" << inputFile
+                           << "' not found; assuming no observations were taken before "
+                           << "the current window" << std::endl;
+    }
+  }
+
+  // Retrieve the observations from the current window held on all MPI ranks.
+  ObsAccessor windowObsAccessor = ObsAccessor::toAllObservations(obsdb_);
+  const size_t numWindowObs = windowObsAccessor.totalNumObservations();
+  const std::vector<util::DateTime> windowDts =
+      windowObsAccessor.getDateTimeVariableFromObsSpace("MetaData", "datetime");
+  const std::vector<float> windowLats =
+      windowObsAccessor.getFloatVariableFromObsSpace("MetaData", "latitude");
+  const std::vector<float> windowLons =
+      windowObsAccessor.getFloatVariableFromObsSpace("MetaData", "longitude");
+  std::vector<std::string> windowStationIds;
+  switch (obsdb_.dtype(statIdVar->group(), statIdVar->variable())) {
+  case ioda::ObsDtype::Integer:
+    {
+      const std::vector<int> intIds = windowObsAccessor.getIntVariableFromObsSpace(
+            statIdVar->group(), statIdVar->variable());
+      windowStationIds.reserve(intIds.size());
+      for (int id : intIds)
+        windowStationIds.push_back(std::to_string(id));
+      break;
+    }
+  case ioda::ObsDtype::String:
+    windowStationIds = windowObsAccessor.getStringVariableFromObsSpace(
+          statIdVar->group(), statIdVar->variable());
+    break;
+  default:
+    throw eckit::UserError("Only integer and string variables may be used as station IDs",
+                           Here());
+  }
+  std::vector<std::vector<float>> windowValues;
+  for (const std::string &variable : variables) {
+    if (obsdb_.has("ObsValue", variable))
+      windowValues.push_back(windowObsAccessor.getFloatVariableFromObsSpace("ObsValue", variable));
+    else
+      windowValues.emplace_back(numWindowObs, util::missingValue(float()));
+  }
+
+  // Assemble the contents of the auxiliary obs space: the retained history of each station
+  // (restricted to the period preceding the current window) followed by the window observations.
+  // Both are also collected per station to update the state at the end.
+  std::map<std::string, HistoryCheckState::StationHistory> updatedHistories;
+  std::vector<double> lats, lons;
+  std::vector<std::string> datetimes;
+  std::vector<std::string> stationIds;
+  std::vector<std::vector<float>> values(variables.size());
+  auto appendObservation = [&](const std::string &stationId,
+                               const HistoryCheckState::Observation &obs) {
+    lats.push_back(obs.latitude);
+    lons.push_back(obs.longitude);
+    datetimes.push_back(obs.datetime.toString());
+    stationIds.push_back(stationId);
+    for (size_t ivar = 0; ivar < variables.size(); ++ivar)
+      values[ivar].push_back(obs.values[ivar]);
+    updatedHistories[stationId].push_back(obs);
+  };
+  for (const auto &station : state.stations())
+    for (const HistoryCheckState::Observation &obs : station.second)
+      if (obs.datetime >= historyStart && obs.datetime < obsdb_.windowStart())
+        appendObservation(station.first, obs);
+  const size_t numHistoricalObs = lats.size();
+  for (size_t i = 0; i < numWindowObs; ++i) {
+    HistoryCheckState::Observation obs;
+    obs.datetime = windowDts[i];
+    obs.latitude = windowLats[i];
+    obs.longitude = windowLons[i];
+    for (size_t ivar = 0; ivar < variables.size(); ++ivar)
+      obs.values.push_back(windowValues[ivar][i]);
+    appendObservation(windowStationIds[i], obs);
+  }
+  oops::Log::debug() << "HistoryCheck: " << numHistoricalObs << " observations retained from "
+                     << "previous cycles, " << numWindowObs << " observations in current window"
+                     << std::endl;
+
+  std::vector<bool> globalObsToFlag(numWindowObs, false);
+  if (numWindowObs > 0) {
+    // Replace string station ids by integer codes.
+    std::map<std::string, int> stationIdMap;
+    for (const auto &station : updatedHistories)
+      stationIdMap.emplace(station.first, static_cast<int>(stationIdMap.size()));
+    std::vector<int> stationCodes;
+    stationCodes.reserve(stationIds.size());
+    for (const std::string &stationId : stationIds)
+      stationCodes.push_back(stationIdMap.at(stationId));
+
+    eckit::LocalConfiguration listConf;
+    listConf.set("lats", lats);
+    listConf.set("lons", lons);
+    listConf.set("datetimes", datetimes);
+    eckit::LocalConfiguration generateConf;
+    generateConf.set("list", listConf);
+    generateConf.set("obs errors", std::vector<double>(variables.size(), 1.0));
+    eckit::LocalConfiguration auxObsSpaceConf;
+    auxObsSpaceConf.set("name", obsdb_.obsname());
+    auxObsSpaceConf.set("simulated variables", variables);
+    auxObsSpaceConf.set("generate", generateConf);
+
+    // As in the non-incremental mode, the auxiliary obs space is held in full on each rank.
+    // Its window starts slightly before the earliest retained observation, since observations
+    // taken exactly at the window start would be excluded.
+    ioda::ObsSpace auxObsSpace(auxObsSpaceConf, oops::mpi::myself(),
+                               historyStart - util::Duration("PT1S"), obsdb_.windowEnd(),
+                               oops::mpi::myself());
+    if (auxObsSpace.nlocs() != stationCodes.size())
+      throw eckit::UserError("HistoryCheck: some observations from the history state file or "
+                             "the current window were not accepted by the auxiliary obs space",
+                             Here());
+    auxObsSpace.put_db(statIdVar->group(), statIdVar->variable(), stationCodes);
+    for (size_t ivar = 0; ivar < variables.size(); ++ivar)
+      auxObsSpace.put_db("ObsValue", variables[ivar], values[ivar]);
+
+    std::shared_ptr<ioda::ObsDataVector<float>> obserrAux(
+          new ioda::ObsDataVector<float>(auxObsSpace, auxObsSpace.obsvariables(), "ObsError"));
+    std::shared_ptr<ioda::ObsDataVector<int>> qcflagsAux(
+          new ioda::ObsDataVector<int>(auxObsSpace, auxObsSpace.obsvariables()));
+    runSubFilters(auxObsSpace, qcflagsAux, obserrAux);
+
+    // qc flags are the same across all variables for these filters
+    const std::vector<int> &auxFlags = (*qcflagsAux)[0];
+    for (size_t i = 0; i < numWindowObs; ++i)
+      globalObsToFlag[i] = auxFlags[numHistoricalObs + i] == QCflags::track;
+  }
+  windowObsAccessor.flagRejectedObservations(globalObsToFlag, flagged);
+
+  if (options_.historyStateOutputFile.value() != boost::none) {
+    // Only observations taken within `time before start of window` of the end of the current
+    // window may be relevant to the next cycle.
+    const util::DateTime nextHistoryStart =
+        obsdb_.windowEnd() - options_.timeBeforeStartOfWindow.value();
+    for (const auto &station : state.stations())
+      if (updatedHistories.find(station.first) == updatedHistories.end())
+        updatedHistories[station.first] = station.second;
+    HistoryCheckState updatedState(variables);
+    for (auto &station : updatedHistories) {
+      std::stable_sort(station.second.begin(), station.second.end(),
+                       [](const HistoryCheckState::Observation &a,
+                          const HistoryCheckState::Observation &b)
+                       { return a.datetime < b.datetime; });
+      updatedState.setStationHistory(station.first, std::move(station.second), nextHistoryStart,
+                                     options_.maxRetainedObservationsPerStation);
+    }
+    if (obsdb_.comm().rank() == 0)
+      updatedState.write(*options_.historyStateOutputFile.value());
+    oops::Log::debug() << "HistoryCheck: " << updatedState.numObservations()
+                       << " observations retained for the next cycle" << std::endl;
+  }
+}
+
+void HistoryCheck::runSubFilters(ioda::ObsSpace &obsSpace,
+                                 std::shared_ptr<ioda::ObsDataVector<int>> qcflags,
+                                 std::shared_ptr<ioda::ObsDataVector<float>> obserr) const {
+  const oops::RequiredParameter<SurfaceObservationSubtype> &subtype =
+      options_.surfaceObservationSubtype;
+  const boost::optional<TrackCheckShipCoreParameters> &trackOptions =
+      options_.trackCheckShipParameters.value();
+  // If the observation type is one which the track check ship filter should be run on and
+  // the necessary filter parameters were set within the configuration file
+  if (subtype != SurfaceObservationSubtype::LNDSYB &&
+      subtype != SurfaceObservationSubtype::LNDSYN &&
+      trackOptions) {
+    // Collecting parameters relevant for running the track check ship filter on the wider obs space
+    eckit::LocalConfiguration configTrackCheckShip =
+        trackOptions->toConfiguration();
+    subtype.serialize(configTrackCheckShip);
+    // Importing the base parameters
+    options_.TrackCheckUtilsParameters::serialize(configTrackCheckShip);
+    ufo::TrackCheckShipParameters trackParams;
+    trackParams.deserialize(configTrackCheckShip);
+    // Setting up and running the track check ship filter on the wider obs space
+    ufo::TrackCheckShip trackCheck(obsSpace, trackParams,
+                                   qcflags, obserr);
+    trackCheck.preProcess();
+  }
+  const boost::optional<StuckCheckCoreParameters> &stuckOptions =
+      options_.stuckCheckParameters;
+  // If the stuck check filter parameters were set and if the stuck check filter has the potential
+  // to flag observations (number of observations is greater than the numberStuckTolerance value)
+  if (stuckOptions &&
+      obsSpace.index().size() >
+      (stuckOptions)->numberStuckTolerance) {
+    // If the observation subtype is one which the stuck check filter should be run on
+    if (subtype != SurfaceObservationSubtype::TEMP &&
+        subtype != SurfaceObservationSubtype::BATHY &&
+        subtype != SurfaceObservationSubtype::TESAC &&
+        subtype != SurfaceObservationSubtype::BUOYPROF) {
+      // Collecting the relevant parameters for running the stuck check filter
+      eckit::LocalConfiguration configStuckCheck =
+          stuckOptions->toConfiguration();
+      options_.TrackCheckUtilsParameters::serialize(configStuckCheck);
+      ufo::StuckCheckParameters stuckParams;
+      stuckParams.deserialize(configStuckCheck);
+      // Setting up and running the stuck check filter on the wider obs space
+      ufo::StuckCheck stuckCheck(obsSpace, stuckParams,
+                                 qcflags, obserr);
+      stuckCheck.preProcess();
+    }
+  }
+}
+
 std::vector<int> HistoryCheck::getStationIds(const std::map<std::string, int> &stringMap,
                                              const boost::optional<Variable> &stationIdVar,
                                              const ioda::ObsSpace &obsdb,
@@ -40,6 +40,11 @@ class HistoryCheck: public FilterBase,
 ///  1. Read in wider window of observations
 ///  2. Apply track check and stuck value check over wider window
 ///  3. Apply flags over wider window to observations in main window.
+///
+///  In incremental mode (enabled by setting `history state input file` and/or
+///  `history state output file`), step 1 is replaced by reading a compact summary of the recent
+///  history of each station saved at the end of the previous cycle, and the summary is updated
+///  with the observations from the current window at the end of the run.
   HistoryCheck(ioda::ObsSpace &obsdb, const Parameters_ &parameters,
                  std::shared_ptr<ioda::ObsDataVector<int> > flags,
                  std::shared_ptr<ioda::ObsDataVector<float> > obserr);
@@ -57,6 +62,15 @@ class HistoryCheck: public FilterBase,
   void print(std::ostream &) const override;
   void applyFilter(const std::vector<bool> &, const Variables &,
                    std::vector<std::vector<bool>> &) const override;
+  /// \brief Run the filter in incremental mode, using the station histories retained in the
+  /// history state file instead of the obs space covering the wider window.
+  void applyFilterIncrementally(const Variables &filtervars,
+                                std::vector<std::vector<bool>> &flagged) const;
+  /// \brief Run the ship track check and the stuck check (as far as they are enabled for the
+  /// current observation subtype) on the auxiliary obs space \p obsSpace.
+  void runSubFilters(ioda::ObsSpace &obsSpace,
+                     std::shared_ptr<ioda::ObsDataVector<int>> qcflags,
+                     std::shared_ptr<ioda::ObsDataVector<float>> obserr) const;
   int qcFlag() const override {
     return QCflags::history;
   }
@@ -7,9 +7,11 @@
 #ifndef UFO_FILTERS_HISTORYCHECKPARAMETERS_H_
 #define UFO_FILTERS_HISTORYCHECKPARAMETERS_H_
 
+#include <string>
 #include <utility>
 
 #include "oops/util/Duration.h"
+#include "oops/util/parameters/OptionalParameter.h"
 #include "oops/util/parameters/Parameter.h"
 #include "oops/util/parameters/Parameters.h"
 #include "oops/util/parameters/ParameterTraits.h"
@@ -52,10 +54,39 @@ class HistoryCheckParameters : public TrackCheckUtilsParameters {
 
     /// Creates a new obs space with the wider window that is determined by the observation subtype.
     /// Needs: name (can be set with setValue), simulated variables, obsdatain.obsfile.
-    oops::RequiredParameter<eckit::LocalConfiguration> largerObsSpace {
+    /// Required unless the filter is run in incremental mode (see below).
+    oops::OptionalParameter<eckit::LocalConfiguration> largerObsSpace {
       "obs space", this
     };
 
+    /// Path to a file holding the recent history of each station, written at the end of the
+    /// previous cycle (see `history state output file`).
+    ///
+    /// If this option or `history state output file` is set, the filter runs in incremental mode:
+    /// instead of reading the wider window from `obs space`, the track and stuck checks are run
+    /// on the history retained in this file followed by the observations from the current window.
+    /// If the file does not exist (e.g. in the first cycle), the history is assumed to be empty.
+    /// Incremental mode requires `station_id_variable` to be set.
+    oops::OptionalParameter<std::string> historyStateInputFile {
+      "history state input file", this
+    };
+
+    /// Path to a file to which the recent history of each station will be written in incremental
+    /// mode, to be read at the start of the next cycle. It may coincide with
+    /// `history state input file`.
+    oops::OptionalParameter<std::string> historyStateOutputFile {
+      "history state output file", this
+    };
+
+    /// Number of most recent observations of each station retained in the history state file.
+    /// Observations forming a streak of unchanging values at the end of a station's history are
+    /// retained regardless of this limit, so that the stuck check produces the same results
+    /// as in the non-incremental mode. Observations older than `time before start of window`
+    /// (measured from the end of the current window) are never retained.
+    oops::Parameter<size_t> maxRetainedObservationsPerStation {
+      "max retained observations per station", 10, this
+    };
+
     /// Controls whether all of the larger obs space's variables are reset to match the primary
     /// obs space's when filter is run. Used for unit testing (esp. stuck check portions).
     oops::Parameter<bool> resetLargerObsSpaceVariables {
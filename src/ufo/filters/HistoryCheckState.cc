@@ -0,0 +1,218 @@
+/*
+ * (C) Crown copyright 2021 Met Office. All rights reserved.
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ */
+
+#include "ufo/filters/HistoryCheckState.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "eckit/exception/Exceptions.h"
+#include "eckit/utils/StringTools.h"
+#include "eckit/utils/Translator.h"
+
+namespace ufo {
+
+namespace {
+
+/// Names of the columns preceding those holding the values of filter variables.
+const std::vector<std::string> metaDataColumnNames{
+  "MetaData/station_id", "MetaData/datetime", "MetaData/latitude", "MetaData/longitude"};
+/// Types of the columns preceding those holding the values of filter variables.
+const std::vector<std::string> metaDataColumnTypes{"string", "datetime", "float", "float"};
+
+/// Prefix of the names of columns holding values of filter variables.
+const char *valueColumnPrefix = "ObsValue/";
+
+/// Return \p field, enclosed in double quotes if it contains a separator, quote, backslash or
+/// line break. Within quotes, these characters are escaped with backslashes as in JSON strings.
+std::string quoteField(const std::string &field) {
+  if (field.find_first_of(",\"\\\n\r") == std::string::npos)
+    return field;
+  std::string quoted = "\"";
+  for (char c : field) {
+    switch (c) {
+    case '"':
+      quoted += "\\\"";
+      break;
+    case '\\':
+      quoted += "\\\\";
+      break;
+    case '\n':
+      quoted += "\\n";
+      break;
+    case '\r':
+      quoted += "\\r";
+      break;
+    default:
+      quoted += c;
+    }
+  }
+  quoted += '"';
+  return quoted;
+}
+
+/// Split line \p lineNumber of file \p filename into comma-separated fields, undoing the quoting
+/// applied by quoteField().
+std::vector<std::string> splitLine(const std::string &line, const std::string &filename,
+                                   size_t lineNumber) {
+  std::vector<std::string> fields(1);
+  bool inQuotes = false;
+  for (size_t i = 0; i < line.size(); ++i) {
+    const char c = line[i];
+    if (inQuotes) {
+      if (c == '"') {
+        inQuotes = false;
+      } else if (c == '\\' && i + 1 < line.size()) {
+        const char escaped = line[++i];
+        fields.back() += escaped == 'n' ? '\n' : escaped == 'r' ? '\r' : escaped;
+      } else {
+        fields.back() += c;
+      }
+    } else if (c == '"') {
+      inQuotes = true;
+    } else if (c == ',') {
+      fields.emplace_back();
+    } else {
+      fields.back() += c;
+    }
+  }
+  if (inQuotes)
+    throw eckit::UserError("Unterminated quoted field in line " + std::to_string(lineNumber) +
+                           " of '" + filename + "'", Here());
+  return fields;
+}
+
+/// Return the length of the trailing streak of equal values of variable \p ivar.
+size_t trailingStreakLength(const HistoryCheckState::StationHistory &observations, size_t ivar) {
+  if (observations.empty())
+    return 0;
+  const float lastValue = observations.back().values[ivar];
+  size_t length = 1;
+  while (length < observations.size() &&
+         observations[observations.size() - 1 - length].values[ivar] == lastValue)
+    ++length;
+  return length;
+}
+
+}  // namespace
+
+HistoryCheckState::HistoryCheckState(const std::vector<std::string> &variables)
+  : variables_(variables)
+{}
+
+HistoryCheckState HistoryCheckState::read(const std::string &filename,
+                                          const std::vector<std::string> &variables) {
+  std::ifstream in(filename);
+  if (!in)
+    throw eckit::UserError("Cannot open the history state file '" + filename + "'", Here());
+
+  std::string line;
+  std::vector<std::string> columnNames;
+  if (std::getline(in, line))
+    columnNames = splitLine(line, filename, 1);
+  std::vector<std::string> expectedColumnNames = metaDataColumnNames;
+  for (const std::string &variable : variables)
+    expectedColumnNames.push_back(valueColumnPrefix + variable);
+  if (columnNames != expectedColumnNames)
+    throw eckit::UserError("The columns of the history state file '" + filename +
+                           "' do not match the variables filtered by the history check", Here());
+  // The second line holds the column types, which are fixed.
+  if (!std::getline(in, line))
+    throw eckit::UserError("The history state file '" + filename + "' is truncated", Here());
+
+  HistoryCheckState state(variables);
+  eckit::Translator<std::string, double> toDouble;
+  size_t lineNumber = 2;
+  while (std::getline(in, line)) {
+    ++lineNumber;
+    if (line.empty())
+      continue;
+    const std::vector<std::string> fields = splitLine(line, filename, lineNumber);
+    if (fields.size() != expectedColumnNames.size())
+      throw eckit::UserError("The number of columns in line " + std::to_string(lineNumber) +
+                             " of '" + filename + "' differs from that in line 1", Here());
+    Observation obs;
+    obs.datetime = util::DateTime(fields[1]);
+    obs.latitude = static_cast<float>(toDouble(fields[2]));
+    obs.longitude = static_cast<float>(toDouble(fields[3]));
+    obs.values.reserve(variables.size());
+    for (size_t ivar = 0; ivar < variables.size(); ++ivar) {
+      const std::string &field = fields[metaDataColumnNames.size() + ivar];
+      obs.values.push_back(static_cast<float>(toDouble(field)));
+    }
+    state.stations_[fields[0]].push_back(std::move(obs));
+  }
+
+  for (auto &station : state.stations_)
+    std::stable_sort(station.second.begin(), station.second.end(),
+                     [](const Observation &a, const Observation &b)
+                     { return a.datetime < b.datetime; });
+  return state;
+}
+
+void HistoryCheckState::write(const std::string &filename) const {
+  std::ofstream out(filename);
+  if (!out)
+    throw eckit::UserError("Cannot open the history state file '" + filename + "'", Here());
+
+  std::vector<std::string> columnNames = metaDataColumnNames;
+  std::vector<std::string> columnTypes = metaDataColumnTypes;
+  for (const std::string &variable : variables_) {
+    columnNames.push_back(valueColumnPrefix + variable);
+    columnTypes.push_back("float");
+  }
+  out << eckit::StringTools::join(",", columnNames) << '\n'
+      << eckit::StringTools::join(",", columnTypes) << '\n';
+
+  out << std::setprecision(std::numeric_limits<float>::max_digits10);
+  for (const auto &station : stations_) {
+    for (const Observation &obs : station.second) {
+      out << quoteField(station.first) << ',' << obs.datetime << ',' << obs.latitude << ',' << obs.longitude;
+      for (float value : obs.values)
+        out << ',' << value;
+      out << '\n';
+    }
+  }
+
+  if (!out)
+    throw eckit::UserError("Failed to write the history state file '" + filename + "'",
+                           Here());
+}
+
+void HistoryCheckState::setStationHistory(const std::string &stationId,
+                                          StationHistory observations,
+                                          const util::DateTime &horizon,
+                                          size_t maxNumObservations) {
+  const auto firstWithinHorizon =
+      std::find_if(observations.begin(), observations.end(),
+                   [&horizon](const Observation &obs) { return obs.datetime >= horizon; });
+  observations.erase(observations.begin(), firstWithinHorizon);
+  if (observations.empty()) {
+    stations_.erase(stationId);
+    return;
+  }
+
+  size_t numToKeep = std::min(maxNumObservations, observations.size());
+  for (size_t ivar = 0; ivar < variables_.size(); ++ivar)
+    numToKeep = std::max(numToKeep, std::min(trailingStreakLength(observations, ivar) + 1,
+                                             observations.size()));
+  observations.erase(observations.begin(), observations.end() - numToKeep);
+  stations_[stationId] = std::move(observations);
+}
+
+size_t HistoryCheckState::numObservations() const {
+  size_t n = 0;
+  for (const auto &station : stations_)
+    n += station.second.size();
+  return n;
+}
+
+}  // namespace ufo
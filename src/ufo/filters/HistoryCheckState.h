@@ -0,0 +1,86 @@
+/*
+ * (C) Crown copyright 2021 Met Office. All rights reserved.
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ */
+
+#ifndef UFO_FILTERS_HISTORYCHECKSTATE_H_
+#define UFO_FILTERS_HISTORYCHECKSTATE_H_
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "oops/util/DateTime.h"
+#include "oops/util/Duration.h"
+
+namespace ufo {
+
+/// \brief Compact summary of the recent history of each station, carried between consecutive
+/// runs of the HistoryCheck filter in incremental mode.
+///
+/// For each station the state holds a short chronologically ordered sequence of observations
+/// (time, position and the values of the filter variables). It contains enough information to
+/// reproduce the speeds seen by the ship track check around the start of the next window and the
+/// streaks of unchanging values that the stuck check may extend into it.
+///
+/// The state is stored in a CSV file with the same two-line header (column names followed by
+/// column types) as the files read by the CSV backend of the DataExtractor. Station IDs containing
+/// commas, double quotes, backslashes or line breaks are enclosed in double quotes, with the last
+/// three escaped with backslashes.
+class HistoryCheckState {
+ public:
+  /// \brief A single observation retained in the state.
+  struct Observation {
+    util::DateTime datetime;
+    float latitude;
+    float longitude;
+    /// Values of the filter variables (in the order returned by HistoryCheckState::variables()).
+    std::vector<float> values;
+  };
+
+  /// Observations from a single station, sorted chronologically.
+  typedef std::vector<Observation> StationHistory;
+
+  /// \brief Create an empty state storing values of the variables \p variables.
+  explicit HistoryCheckState(const std::vector<std::string> &variables);
+
+  /// \brief Load the state from the file \p filename.
+  ///
+  /// Throws an exception if the file is malformed or the variables stored in it differ from
+  /// \p variables.
+  static HistoryCheckState read(const std::string &filename,
+                                const std::vector<std::string> &variables);
+
+  /// \brief Save the state to the file \p filename.
+  void write(const std::string &filename) const;
+
+  const std::vector<std::string> &variables() const { return variables_; }
+
+  /// \brief Return the histories of all stations, indexed by station ID.
+  const std::map<std::string, StationHistory> &stations() const { return stations_; }
+
+  /// \brief Replace the history of station \p stationId by the observations \p observations
+  /// (assumed to be sorted chronologically), retaining only those that may influence the
+  /// checks performed in the next cycle.
+  ///
+  /// Observations taken before \p horizon are discarded. Of the rest, the last
+  /// \p maxNumObservations are kept, together with all observations belonging to a trailing
+  /// streak of unchanging values of any variable and the observation immediately preceding
+  /// that streak (needed to tell the streak apart from a station whose values never changed).
+  void setStationHistory(const std::string &stationId,
+                         StationHistory observations,
+                         const util::DateTime &horizon,
+                         size_t maxNumObservations);
+
+  /// \brief Total number of observations held in the state.
+  size_t numObservations() const;
+
+ private:
+  std::vector<std::string> variables_;
+  std::map<std::string, StationHistory> stations_;
+};
+
+}  // namespace ufo
+
+#endif  // UFO_FILTERS_HISTORYCHECKSTATE_H_
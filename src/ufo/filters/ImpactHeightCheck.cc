@@ -7,7 +7,6 @@
 
 #include "ufo/filters/ImpactHeightCheck.h"
 
-#include <Eigen/Core>
 #include <iomanip>
 #include <iostream>
 #include <limits>
@@ -58,24 +57,23 @@ void ImpactHeightCheck::applyFilter(const std::vector<bool> & apply,
   const oops::Variables observed = obsdb_.obsvariables();
   const float missingFloat = util::missingValue(missingFloat);
 
+  const size_t nlocs = obsdb_.nlocs();
+
   // Get the refractivity from the obs diagnostics, including the number of
-  // vertical levels on which the refractivity has been calculated (nRefLevels)
+  // vertical levels on which the refractivity has been calculated (nRefLevels).
+  // All levels are read at once; the value at level iLevel for observation iObs
+  // is stored at index iLevel * nlocs + iObs.
   Variable refractivityVariable = Variable("refractivity@ObsDiag");
   oops::Log::debug() << data_.nlevs(refractivityVariable) << std::endl;
   const size_t nRefLevels = data_.nlevs(refractivityVariable);
-  std::vector<std::vector<float>> refractivity;
-
-  for (size_t iLevel = 1; iLevel < nRefLevels+1; ++iLevel) {
-    std::vector<float> inputData;
-    data_.get(refractivityVariable, static_cast<int>(iLevel), inputData);
-    refractivity.push_back(inputData);
-  }
+  std::vector<float> refractivity;
+  data_.getAllLevels(refractivityVariable, refractivity);
 
   // For the benefits of debugging, output the refractivity for the first
   // observation
   oops::Log::debug() << "Refractivity(first ob) ";
-  for (size_t iLevel = 0; iLevel < nRefLevels; ++iLevel) {
-    oops::Log::debug() << refractivity[iLevel][0] << " ";
+  for (size_t iLevel = 0; iLevel < nRefLevels && nlocs > 0; ++iLevel) {
+    oops::Log::debug() << refractivity[iLevel * nlocs] << " ";
   }
   oops::Log::debug() << std::endl;
 
@@ -87,20 +85,14 @@ void ImpactHeightCheck::applyFilter(const std::vector<bool> & apply,
     throw eckit::BadValue("Model heights and refractivity must have the same number of levels",
                           Here());
   }
-  std::vector<std::vector<float>> modelHeights;
-
-  // Read the heights of the refractivity levels
-  for (size_t iLevel = 1; iLevel < nRefLevels+1; ++iLevel) {
-    std::vector<float> inputData;
-    data_.get(modelHeightsVariable, static_cast<int>(iLevel), inputData);
-    modelHeights.push_back(inputData);
-  }
+  std::vector<float> modelHeights;
+  data_.getAllLevels(modelHeightsVariable, modelHeights);
 
   // For debugging, output the heights of the refractivity levels for the first
   // observation.
   oops::Log::debug() << "Model heights (first ob) ";
-  for (size_t iLevel = 0; iLevel < nRefLevels; ++iLevel) {
-    oops::Log::debug() << modelHeights[iLevel][0] << " ";
+  for (size_t iLevel = 0; iLevel < nRefLevels && nlocs > 0; ++iLevel) {
+    oops::Log::debug() << modelHeights[iLevel * nlocs] << " ";
   }
   oops::Log::debug() << std::endl;
 
@@ -114,85 +106,44 @@ void ImpactHeightCheck::applyFilter(const std::vector<bool> & apply,
   std::vector<float> radiusCurvature;
   data_.get(radiusCurvatureParameter, radiusCurvature);
 
+  // The model profiles are the same for every filter variable, so process them all at once
+  const ProfileImpactHeights profiles = calcProfileImpactHeights(refractivity, modelHeights,
+                                                                 radiusCurvature, nRefLevels);
+
   // For each variable, perform the filter
   for (size_t iFilterVar = 0; iFilterVar < filtervars.nvars(); ++iFilterVar) {
     const size_t iVar = observed.find(filtervars.variable(iFilterVar).variable());
 
     // Loop over the observations
-    for (size_t iObs = 0; iObs < obsdb_.nlocs(); ++iObs) {
+    for (size_t iObs = 0; iObs < nlocs; ++iObs) {
       if (apply[iObs] && (*flags_)[iVar][iObs] == QCflags::pass) {
-        // Load the refractivity profile and the associated model heights for this observation,
-        // cleansing any missing data
-        std::vector<float> refracProfile;
-        std::vector<float> heightProfile;
-        for (size_t iLevel = 0; iLevel < nRefLevels; ++iLevel)
-          if (refractivity[iLevel][iObs] != missingFloat &&
-              modelHeights[iLevel][iObs] != missingFloat) {
-            refracProfile.push_back(refractivity[iLevel][iObs]);
-            heightProfile.push_back(modelHeights[iLevel][iObs]);
-          }
-
-        if (refracProfile.size() < 2) {
+        if (profiles.numValidLevels[iObs] < 2) {
           oops::Log::error() << "Should have at least two valid points in every profile:" <<
-                                std::endl << "size = " << refracProfile.size() << "  " <<
+                                std::endl << "size = " << profiles.numValidLevels[iObs] << "  " <<
                                 "iObs = " << iObs << std::endl;
           flagged[iFilterVar][iObs] = true;
           continue;
         }
 
-        oops::Log::debug() << "Min and max refrac for profile " << iObs <<
-                              " is " << refracProfile[0] << " to " << refracProfile.back() <<
-                              std::endl;
-        oops::Log::debug() << "Impact height " << impactParameter[iObs] - radiusCurvature[iObs] <<
-                              std::endl;
-
-        // Output the calculated refractivity gradient for the first observation
-        const std::vector<float> & gradient = calcVerticalGradient(refracProfile, heightProfile);
-        if (iObs == 0) {
-            oops::Log::debug() << "Gradient found to be" << std::endl;
-            for (float grad : gradient)
-                oops::Log::debug() << grad << "  ";
-            oops::Log::debug() << std::endl;
-        }
-
-        float sharpGradientImpact = std::numeric_limits<float>::lowest();
-        // Search for sharp gradients (super-refraction) starting at the top of the profile
-        for (int iLevel = static_cast<int>(nRefLevels)-2; iLevel >= 0; --iLevel) {
-          size_t thisLevel = static_cast<size_t>(iLevel);
-          if (gradient[thisLevel] != missingFloat &&
-              gradient[thisLevel] < parameters_.gradientThreshold.value()) {
-            sharpGradientImpact = calcImpactHeight(refracProfile[thisLevel],
-                                                   heightProfile[thisLevel],
-                                                   radiusCurvature[iObs]);
-            oops::Log::info() << "Sharp refractivity gradient of " << gradient[thisLevel] <<
-                                 " found at " << thisLevel << "  " << sharpGradientImpact <<
-                                 std::endl;
-            oops::Log::debug() << thisLevel << "   " << refracProfile[thisLevel] << "   " <<
-                                  heightProfile[thisLevel] << "   " <<
-                                  radiusCurvature[thisLevel] << std::endl;
-            break;
-          }
-        }
+        const float sharpGradientImpact = profiles.sharpGradient[iObs];
+        if (sharpGradientImpact != std::numeric_limits<float>::lowest())
+          oops::Log::info() << "Sharp refractivity gradient found for observation " << iObs <<
+                               " at impact height " << sharpGradientImpact << std::endl;
 
         // Reject observation if it is below the minimum (either surface or sharp gradient)
         const float obsImpactHeight = impactParameter[iObs] - radiusCurvature[iObs];
         oops::Log::debug() << "Checking minimum height " << obsImpactHeight << "   " <<
                               sharpGradientImpact + parameters_.sharpGradientOffset.value() <<
-                              "   " << calcImpactHeight(refracProfile[0], heightProfile[0],
-                                                        radiusCurvature[iObs]) +
+                              "   " << profiles.bottom[iObs] +
                               parameters_.surfaceOffset.value() << std::endl;
         if (obsImpactHeight < sharpGradientImpact + parameters_.sharpGradientOffset.value() ||
-            obsImpactHeight < calcImpactHeight(refracProfile[0], heightProfile[0],
-                                               radiusCurvature[iObs]) +
-                                               parameters_.surfaceOffset.value())
+            obsImpactHeight < profiles.bottom[iObs] + parameters_.surfaceOffset.value())
           flagged[iFilterVar][iObs] = true;
 
         // Reject observation if it is above the maximum
         oops::Log::debug() << "Checking maximum height " << obsImpactHeight << "   " <<
-                              calcImpactHeight(refracProfile.back(), heightProfile.back(),
-                                               radiusCurvature[iObs]) << std::endl;
-        if (obsImpactHeight > calcImpactHeight(refracProfile.back(), heightProfile.back(),
-                                               radiusCurvature[iObs]))
+                              profiles.top[iObs] << std::endl;
+        if (obsImpactHeight > profiles.top[iObs])
           flagged[iFilterVar][iObs] = true;
       }
     }
@@ -200,16 +151,60 @@ void ImpactHeightCheck::applyFilter(const std::vector<bool> & apply,
 }
 
 // -----------------------------------------------------------------------------
-/// Calculate the vertical gradient of refractivity, assuming that any missing
-/// data has already been removed
-std::vector<float> ImpactHeightCheck::calcVerticalGradient(
-        const std::vector<float> & refrac,
-        const std::vector<float> & height) const {
-  std::vector<float> gradient;
-  for (size_t iLevel = 0; iLevel < refrac.size()-1; ++iLevel) {
-    gradient.push_back((refrac[iLevel+1] - refrac[iLevel]) / (height[iLevel+1] - height[iLevel]));
+/// Calculate the impact heights bounding the model profile of each observation,
+/// and the impact height of the highest sharp refractivity gradient. Levels at
+/// which the refractivity or model height is missing are skipped, and gradients
+/// are calculated between consecutive valid levels.
+///
+/// All profiles are walked down in lockstep, starting at the top, so that the
+/// innermost loop runs over observations and accesses contiguous memory.
+ImpactHeightCheck::ProfileImpactHeights ImpactHeightCheck::calcProfileImpactHeights(
+        const std::vector<float> & refractivity,
+        const std::vector<float> & modelHeights,
+        const std::vector<float> & radiusCurvature,
+        size_t nlevs) const {
+  const float missingFloat = util::missingValue(missingFloat);
+  const float gradientThreshold = parameters_.gradientThreshold.value();
+  const size_t nlocs = radiusCurvature.size();
+  ASSERT(refractivity.size() == nlevs * nlocs);
+  ASSERT(modelHeights.size() == nlevs * nlocs);
+
+  ProfileImpactHeights profiles;
+  profiles.numValidLevels.assign(nlocs, 0);
+  profiles.bottom.assign(nlocs, missingFloat);
+  profiles.top.assign(nlocs, missingFloat);
+  profiles.sharpGradient.assign(nlocs, std::numeric_limits<float>::lowest());
+
+  // Refractivity and height at the valid level above the current one
+  std::vector<float> refracAbove(nlocs, missingFloat);
+  std::vector<float> heightAbove(nlocs, missingFloat);
+  std::vector<char> sharpGradientFound(nlocs, 0);
+
+  for (size_t iLevel = nlevs; iLevel-- > 0;) {
+    const float * refrac = refractivity.data() + iLevel * nlocs;
+    const float * height = modelHeights.data() + iLevel * nlocs;
+    for (size_t iObs = 0; iObs < nlocs; ++iObs) {
+      if (refrac[iObs] == missingFloat || height[iObs] == missingFloat)
+        continue;
+      const float impactHeight = calcImpactHeight(refrac[iObs], height[iObs],
+                                                  radiusCurvature[iObs]);
+      if (profiles.numValidLevels[iObs] == 0) {
+        profiles.top[iObs] = impactHeight;
+      } else if (!sharpGradientFound[iObs]) {
+        const float gradient = (refracAbove[iObs] - refrac[iObs]) /
+                               (heightAbove[iObs] - height[iObs]);
+        if (gradient != missingFloat && gradient < gradientThreshold) {
+          profiles.sharpGradient[iObs] = impactHeight;
+          sharpGradientFound[iObs] = 1;
+        }
+      }
+      profiles.bottom[iObs] = impactHeight;
+      refracAbove[iObs] = refrac[iObs];
+      heightAbove[iObs] = height[iObs];
+      ++profiles.numValidLevels[iObs];
+    }
   }
-  return gradient;
+  return profiles;
 }
 
 // -----------------------------------------------------------------------------
@@ -75,8 +75,22 @@ class ImpactHeightCheck : public FilterBase,
                    std::vector<std::vector<bool>> &) const override;
   int qcFlag() const override {return QCflags::domain;}
   Parameters_ parameters_;
-  std::vector<float> calcVerticalGradient(const std::vector<float> &,
-                                          const std::vector<float> &) const;
+
+  /// Impact heights derived from the model profile of each observation.
+  struct ProfileImpactHeights {
+    /// Number of levels at which both the refractivity and the model height are valid.
+    std::vector<size_t> numValidLevels;
+    /// Impact heights of the lowest and highest valid levels.
+    std::vector<float> bottom;
+    std::vector<float> top;
+    /// Impact height of the highest sharp refractivity gradient (the lowest float if none).
+    std::vector<float> sharpGradient;
+  };
+
+  ProfileImpactHeights calcProfileImpactHeights(const std::vector<float> & refractivity,
+                                                const std::vector<float> & modelHeights,
+                                                const std::vector<float> & radiusCurvature,
+                                                size_t nlevs) const;
   float calcImpactHeight(float, float, float) const;
 };
 
@@ -25,11 +25,14 @@
 #include "oops/util/DateTime.h"
 #include "oops/util/Duration.h"
 #include "oops/util/Logger.h"
+#include "oops/util/missingValues.h"
 #include "oops/util/sqr.h"
 #include "ufo/filters/MetOfficeBuddyCheckParameters.h"
 #include "ufo/filters/MetOfficeBuddyPair.h"
 #include "ufo/filters/MetOfficeBuddyPairFinder.h"
+#include "ufo/utils/DictionaryEncodedStrings.h"
 #include "ufo/utils/PiecewiseLinearInterpolation.h"
+#include "ufo/utils/ProbabilityOfGrossError.h"
 
 namespace ufo {
 
@@ -46,34 +49,6 @@ std::string fullVariableName(const Variable &var)
     return var.variable() + "@" + var.group();
 }
 
-template <typename T>
-std::vector<T> uniqueElements(const std::vector<T> &v)
-{
-  std::vector<T> result(v);
-  std::sort(result.begin(), result.end());
-  const auto newEnd = std::unique(result.begin(), result.end());
-  result.erase(newEnd, result.end());
-  return result;
-}
-
-template <typename T>
-std::vector<int> mapDistinctValuesToDistinctInts(const std::vector<T> &values)
-{
-  const std::vector<T> uniqueValues = uniqueElements(values);
-  std::map<T, int> intByValue;
-  {
-    int index = 0;
-    for (const T& value : uniqueValues)
-      intByValue[value] = index++;
-  }
-
-  std::vector<int> ints;
-  ints.reserve(values.size());
-  std::transform(values.begin(), values.end(), std::back_inserter(ints),
-                 [&](const T& value) { return intByValue.at(value); });
-  return ints;
-}
-
 struct ScalarSingleLevelVariableData {
   const std::vector<int> *varFlags = nullptr;
   const std::vector<float> *obsValues = nullptr;
@@ -82,6 +57,10 @@ struct ScalarSingleLevelVariableData {
   std::vector<float> bgValues;
   std::vector<float> bgErrors;
   std::vector<float> grossErrorProbabilities;
+  /// Differences between observed and background values.
+  std::vector<float> departures;
+  /// Combined (observation and background) error variances.
+  std::vector<double> errVars;
 };
 
 }  // namespace
@@ -142,6 +121,13 @@ void MetOfficeBuddyCheck::applyFilter(const std::vector<bool> & apply,
     // TODO(wsmigaj): How is this variable going to be initialized?
     data_.get(ufo::Variable(filtervars[filterVarIndex], "GrossErrorProbability"),
               data.grossErrorProbabilities);
+    // Calculate the departures and error variances once rather than for each buddy pair.
+    data.departures.assign(data.obsValues->size(), util::missingValue(1.0f));
+    data.errVars.assign(data.obsValues->size(), util::missingValue(1.0));
+    computeDeparturesAndErrorVariances(validObsIds.size(), validObsIds.data(),
+                                       data.obsValues->data(), data.bgValues.data(),
+                                       data.obsErrors->data(), data.bgErrors.data(),
+                                       1.0f, 1.0f, data.departures.data(), data.errVars.data());
     return data;
   };
 
@@ -178,10 +164,9 @@ void MetOfficeBuddyCheck::applyFilter(const std::vector<bool> & apply,
                              *firstComponentData.varFlags,
                              verbose, bgErrorHorizCorrScales,
                              obsData.stationIds, obsData.datetimes,
-                             *firstComponentData.obsValues,
-                             *secondComponentData.obsValues,
-                             *firstComponentData.obsErrors,
-                             firstComponentData.bgValues, secondComponentData.bgValues,
+                             firstComponentData.departures,
+                             secondComponentData.departures,
+                             firstComponentData.errVars,
                              firstComponentData.bgErrors,
                              firstComponentData.grossErrorProbabilities);
       // OPS doesn't update the gross error probabilities of the second component variable,
@@ -205,8 +190,7 @@ void MetOfficeBuddyCheck::applyFilter(const std::vector<bool> & apply,
         checkScalarSurfaceData(buddyPairs,
                                *data.varFlags, verbose, bgErrorHorizCorrScales,
                                obsData.stationIds, obsData.datetimes,
-                               *data.obsValues, *data.obsErrors,
-                               data.bgValues, data.bgErrors,
+                               data.departures, data.errVars, data.bgErrors,
                                data.grossErrorProbabilities);
         calculatedGrossErrProbsByVarName[getFilterVariableName(filterVarIndex)] =
             std::move(data.grossErrorProbabilities);
@@ -278,7 +262,7 @@ std::vector<int> MetOfficeBuddyCheck::getStationIds() const {
       {
         std::vector<std::string> stringIds(obsdb_.nlocs());
         obsdb_.get_db(stationIdVariable->group(), stationIdVariable->variable(), stringIds);
-        return mapDistinctValuesToDistinctInts(stringIds);
+        return DictionaryEncodedStrings(stringIds).codes();
       }
 
     default:
@@ -352,9 +336,8 @@ void MetOfficeBuddyCheck::checkScalarSurfaceData(const std::vector<MetOfficeBudd
                                                  const std::vector<float> &bgErrorHorizCorrScales,
                                                  const std::vector<int> &stationIds,
                                                  const std::vector<util::DateTime> &datetimes,
-                                                 const std::vector<float> &obsValues,
-                                                 const std::vector<float> &obsErrors,
-                                                 const std::vector<float> &bgValues,
+                                                 const std::vector<float> &departures,
+                                                 const std::vector<double> &errVars,
                                                  const std::vector<float> &bgErrors,
                                                  std::vector<float> &pges) const {
   using util::sqr;
@@ -394,11 +377,11 @@ void MetOfficeBuddyCheck::checkScalarSurfaceData(const std::vector<MetOfficeBudd
       continue;  // skip to next pair
 
     // Differences from background
-    double diffA = obsValues[jA] - bgValues[jA];
-    double diffB = obsValues[jB] - bgValues[jB];
+    double diffA = departures[jA];
+    double diffB = departures[jB];
     // Estimated error variances (ob+bk) (eqn 2.5)
-    double errVarA = sqr(obsErrors[jA]) + sqr(bgErrors[jA]);
-    double errVarB = sqr(obsErrors[jB]) + sqr(bgErrors[jB]);
+    double errVarA = errVars[jA];
+    double errVarB = errVars[jB];
     // Background error covariance between ob positions (eqn 3.13)
     double covar = corr * bgErrors[jA] * bgErrors[jB];
     // (Total error correlation between ob positions)**2 (eqn 3.14)
@@ -409,7 +392,8 @@ void MetOfficeBuddyCheck::checkScalarSurfaceData(const std::vector<MetOfficeBudd
     expArg = options_.dampingFactor1 * (-0.5 * std::log(1.0 - rho2) + expArg);  // exponent of
     expArg = std::min(expArgMax, std::max(-expArgMax, expArg));                 // eqn 3.18
     // Z = P(OA)*P(OB)/P(OA and OB)
-    double z = 1.0 / (1.0 - (1.0 - pges[jA]) * (1.0 - pges[jB]) * (1.0 - std::exp(expArg)));
+    const double expOfArg = clampedExp(expArg);
+    double z = 1.0 / (1.0 - (1.0 - pges[jA]) * (1.0 - pges[jB]) * (1.0 - expOfArg));
     if (z <= 0.0)
       z = 1.0;  // rounding error control
     z = std::pow(z, options_.dampingFactor2);  // eqn 3.16
@@ -421,7 +405,7 @@ void MetOfficeBuddyCheck::checkScalarSurfaceData(const std::vector<MetOfficeBudd
                                           "%5.3f %6.3f %6.3f %6.3f %6.3f\n") %
                             jA % jB % stationIds[jA] % stationIds[jB] %
                             diffA % diffB % pair.distanceInKm %
-                            corr % std::exp(expArg) % pges[jA] % pges[jB] % z;
+                            corr % expOfArg % pges[jA] % pges[jB] % z;
     }
   }
 }
@@ -432,11 +416,9 @@ void MetOfficeBuddyCheck::checkVectorSurfaceData(const std::vector<MetOfficeBudd
                                                  const std::vector<float> &bgErrorHorizCorrScales,
                                                  const std::vector<int> &stationIds,
                                                  const std::vector<util::DateTime> &datetimes,
-                                                 const std::vector<float> &uObsValues,
-                                                 const std::vector<float> &vObsValues,
-                                                 const std::vector<float> &obsErrors,
-                                                 const std::vector<float> &uBgValues,
-                                                 const std::vector<float> &vBgValues,
+                                                 const std::vector<float> &uDepartures,
+                                                 const std::vector<float> &vDepartures,
+                                                 const std::vector<double> &errVars,
                                                  const std::vector<float> &bgErrors,
                                                  std::vector<float> &pges) const {
   using util::sqr;
@@ -477,23 +459,19 @@ void MetOfficeBuddyCheck::checkVectorSurfaceData(const std::vector<MetOfficeBudd
     double sinRot = std::sin(pair.rotationAInRad);
     double cosRot = std::cos(pair.rotationAInRad);
     // Difference from background - longitudinal wind
-    double lDiffA = cosRot  * (uObsValues[jA] - uBgValues[jA])
-        + sinRot * (vObsValues[jA] - vBgValues[jA]);           // eqn 3.19
+    double lDiffA = cosRot * uDepartures[jA] + sinRot * vDepartures[jA];    // eqn 3.19
     // Difference from background - transverse wind
-    double tDiffA = - sinRot * (uObsValues[jA] - uBgValues[jA])
-        + cosRot * (vObsValues[jA] - vBgValues[jA]);           // eqn 3.20
+    double tDiffA = -sinRot * uDepartures[jA] + cosRot * vDepartures[jA];   // eqn 3.20
     sinRot = std::sin(pair.rotationBInRad);
     cosRot  = std::cos(pair.rotationBInRad);
     // Difference from background - longitudinal wind
-    double lDiffB = cosRot  * (uObsValues[jB] - uBgValues[jB])
-        + sinRot * (vObsValues[jB] - vBgValues[jB]);           // eqn 3.19
+    double lDiffB = cosRot * uDepartures[jB] + sinRot * vDepartures[jB];    // eqn 3.19
     // Difference from background - transverse wind
-    double tDiffB = - sinRot * (uObsValues[jB] - uBgValues[jB])
-        + cosRot  * (vObsValues[jB] - vBgValues[jB]);          // eqn 3.20
+    double tDiffB = -sinRot * uDepartures[jB] + cosRot * vDepartures[jB];   // eqn 3.20
 
     // Estimated error variances (ob + bk; component wind variance)
-    double errVarA = sqr(obsErrors[jA]) + sqr(bgErrors[jA]);                // eqn 2.5
-    double errVarB = sqr(obsErrors[jB]) + sqr(bgErrors[jB]);                // eqn 2.5
+    double errVarA = errVars[jA];                                           // eqn 2.5
+    double errVarB = errVars[jB];                                           // eqn 2.5
 
     // Calculate covariances and probabilities
     double lCovar = lCorr * bgErrors[jA] * bgErrors[jB];                    // eqn 3.13
@@ -513,7 +491,8 @@ void MetOfficeBuddyCheck::checkVectorSurfaceData(const std::vector<MetOfficeBudd
     expArg = options_.dampingFactor1 * (-0.5 * std::log((1.0 - lRho2) * (1.0 - lRho2)) + expArg);
     expArg = std::min(expArgMax, std::max(-expArgMax, expArg));           // eqn 3.22
     // Z = P(OA)*P(OB)/P(OA and OB)
-    double z = 1.0 / (1.0 - (1.0 - pges[jA]) * (1.0 - pges[jB]) * (1.0 - std::exp(expArg)));
+    const double expOfArg = clampedExp(expArg);
+    double z = 1.0 / (1.0 - (1.0 - pges[jA]) * (1.0 - pges[jB]) * (1.0 - expOfArg));
     if (z <= 0.0)
       z = 1.0;  // rounding error control
     z = std::pow(z, options_.dampingFactor2);         // eqn 3.16
@@ -526,7 +505,7 @@ void MetOfficeBuddyCheck::checkVectorSurfaceData(const std::vector<MetOfficeBudd
                                           "%5.3f %6.3f %6.3f %6.3f %6.3f\n") %
                             jA % jB % stationIds[jA] % stationIds[jB] %
                             lDiffA % lDiffB % tDiffA % tDiffB % pair.distanceInKm %
-                            lCorr % std::exp(expArg) % pges[jA] % pges[jB] % z;
+                            lCorr % expOfArg % pges[jA] % pges[jB] % z;
     }
   }
 }
@@ -152,12 +152,10 @@ class MetOfficeBuddyCheck : public FilterBase,
   ///   Station IDs ("call signs").
   /// \param datetimes
   ///   Observation times.
-  /// \param obsValues
-  ///   Observed values.
-  /// \param obsErrors
-  ///   Estimated errors of observed values.
-  /// \param bgValues
-  ///   Background values.
+  /// \param departures
+  ///   Differences between observed and background values.
+  /// \param errVars
+  ///   Combined (observation and background) error variances.
   /// \param bgErrors
   ///   Estimated errors of background values.
   /// \param[inout] pges
@@ -168,9 +166,8 @@ class MetOfficeBuddyCheck : public FilterBase,
                               const std::vector<float> &bgErrorHorizCorrScales,
                               const std::vector<int> &stationIds,
                               const std::vector<util::DateTime> &datetimes,
-                              const std::vector<float> &obsValues,
-                              const std::vector<float> &obsErrors,
-                              const std::vector<float> &bgValues,
+                              const std::vector<float> &departures,
+                              const std::vector<double> &errVars,
                               const std::vector<float> &bgErrors,
                               std::vector<float> &pges) const;
 
@@ -190,16 +187,12 @@ class MetOfficeBuddyCheck : public FilterBase,
   ///   Station IDs ("call signs").
   /// \param datetimes
   ///   Observation times.
-  /// \param uObsValues
-  ///   Observed values of the first component, u.
-  /// \param vObsValues
-  ///   Observed values of the second component, v.
-  /// \param obsErrors
-  ///   Estimated errors of observed values (u or v).
-  /// \param uBgValues
-  ///   Background values of u.
-  /// \param vBgValues
-  ///   Background values of v.
+  /// \param uDepartures
+  ///   Differences between observed and background values of the first component, u.
+  /// \param vDepartures
+  ///   Differences between observed and background values of the second component, v.
+  /// \param errVars
+  ///   Combined (observation and background) error variances (u or v).
   /// \param bgErrors
   ///   Estimated errors of background values (u or v).
   /// \param[inout] pges
@@ -210,11 +203,9 @@ class MetOfficeBuddyCheck : public FilterBase,
                               const std::vector<float> &bgErrorHorizCorrScales,
                               const std::vector<int> &stationIds,
                               const std::vector<util::DateTime> &datetimes,
-                              const std::vector<float> &uObsValues,
-                              const std::vector<float> &vObsValues,
-                              const std::vector<float> &obsErrors,
-                              const std::vector<float> &uBgValues,
-                              const std::vector<float> &vBgValues,
+                              const std::vector<float> &uDepartures,
+                              const std::vector<float> &vDepartures,
+                              const std::vector<double> &errVars,
                               const std::vector<float> &bgErrors,
                               std::vector<float> &pges) const;
 
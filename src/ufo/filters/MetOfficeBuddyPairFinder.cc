@@ -8,6 +8,8 @@
 #include "ufo/filters/MetOfficeBuddyPairFinder.h"
 
 #include <algorithm>
+#include <cstdint>
+#include <vector>
 
 #include "oops/util/Logger.h"
 #include "ufo/filters/MetOfficeBuddyCheckParameters.h"
@@ -69,22 +71,27 @@ void MetOfficeBuddyPairFinder::sortObservations(const std::vector<size_t> & vali
 
   // Sort observations
 
+  // Precompute the sort keys of all valid observations to avoid indirect accesses during sorting
+  const size_t numValidObs = validObsIds.size();
+  std::vector<float> longitudes(numValidObs), minusLatitudes(numValidObs);
+  std::vector<int64_t> times(numValidObs);
+  for (size_t validObsIndex = 0; validObsIndex < numValidObs; ++validObsIndex) {
+    const size_t obsId = validObsIds[validObsIndex];
+    longitudes[validObsIndex] = longitudes_[obsId];
+    minusLatitudes[validObsIndex] = -latitudes_[obsId];
+    times[validObsIndex] = (datetimes_[obsId] - datetimes_[validObsIds.front()]).toSeconds();
+  }
+
   RecursiveSplitter splitter(validObsIds.size());
   splitter.groupBy(bandIndices);
-  splitter.sortGroupsBy(
-        [this, &validObsIds](size_t obsIndexA, size_t obsIndexB)
-        {
-          size_t obsIdA = validObsIds[obsIndexA];
-          size_t obsIdB = validObsIds[obsIndexB];
-          if (pressures_ != nullptr)
-            return std::make_tuple(longitudes_[obsIdA], -latitudes_[obsIdA],
-                                   (*pressures_)[obsIdA], datetimes_[obsIdA]) <
-                   std::make_tuple(longitudes_[obsIdB], -latitudes_[obsIdB],
-                                   (*pressures_)[obsIdB], datetimes_[obsIdB]);
-          else
-            return std::make_tuple(longitudes_[obsIdA], -latitudes_[obsIdA], datetimes_[obsIdA]) <
-                   std::make_tuple(longitudes_[obsIdB], -latitudes_[obsIdB], datetimes_[obsIdB]);
-        });
+  if (pressures_ != nullptr) {
+    std::vector<float> pressures(numValidObs);
+    for (size_t validObsIndex = 0; validObsIndex < numValidObs; ++validObsIndex)
+      pressures[validObsIndex] = (*pressures_)[validObsIds[validObsIndex]];
+    splitter.sortGroupsByKeys(longitudes, minusLatitudes, pressures, times);
+  } else {
+    splitter.sortGroupsByKeys(longitudes, minusLatitudes, times);
+  }
 
   // Fill the validObsIdsInSortOrder and bandLbounds vectors
 
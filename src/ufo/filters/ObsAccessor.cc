@@ -15,6 +15,7 @@
 #include "ioda/ObsDataVector.h"
 #include "ioda/ObsSpace.h"
 #include "ufo/filters/QCflags.h"
+#include "ufo/utils/DictionaryEncodedStrings.h"
 #include "ufo/utils/RecursiveSplitter.h"
 
 namespace ufo {
@@ -152,6 +153,11 @@ std::vector<util::DateTime> ObsAccessor::getDateTimeVariableFromObsSpace(
   return getVariableFromObsSpaceImpl<util::DateTime>(group, variable, *obsdb_, *obsDistribution_);
 }
 
+DictionaryEncodedStrings ObsAccessor::getEncodedStringVariableFromObsSpace(
+      const std::string &group, const std::string &variable) const {
+  return DictionaryEncodedStrings(getStringVariableFromObsSpace(group, variable));
+}
+
 std::vector<size_t> ObsAccessor::getRecordIds() const {
   std::vector<size_t> recordIds = obsdb_->recnum();
   obsDistribution_->allGatherv(recordIds);
@@ -197,8 +203,13 @@ void ObsAccessor::groupObservationsByCategoryVariable(
     break;
 
   case ioda::ObsDtype::String:
-    groupObservationsByVariableImpl<std::string>(*categoryVariable_, validObsIds,
-                                                 *obsdb_, *obsDistribution_, splitter);
+    {
+      // Codes are ordered in the same way as the strings they represent, so grouping by codes
+      // produces the same groups (in the same order) as grouping by strings, but faster.
+      const DictionaryEncodedStrings obsCategories = getEncodedStringVariableFromObsSpace(
+            categoryVariable_->group(), categoryVariable_->variable());
+      splitter.groupBy(getValidObservationCategories(obsCategories.codes(), validObsIds));
+    }
     break;
 
   default:
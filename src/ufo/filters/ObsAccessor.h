@@ -25,6 +25,7 @@ class ObsSpace;
 
 namespace ufo {
 
+class DictionaryEncodedStrings;
 class RecursiveSplitter;
 
 /// \brief This class provides access to observations that may be held on multiple MPI ranks.
@@ -140,6 +141,13 @@ class ObsAccessor {
   std::vector<util::DateTime> getDateTimeVariableFromObsSpace(const std::string &group,
                                                               const std::string &variable) const;
 
+  /// \brief Return the values of the specified string variable at successive observation
+  /// locations, encoded as integer codes into a dictionary of distinct values.
+  ///
+  /// The locations are ordered in the same way as in getStringVariableFromObsSpace().
+  DictionaryEncodedStrings getEncodedStringVariableFromObsSpace(
+      const std::string &group, const std::string &variable) const;
+
   /// \brief Return the vector of IDs of records successive observation locations belong to.
   ///
   /// If each independent group of observations is stored entirely on a single MPI rank, the
@@ -23,6 +23,7 @@
 #include "oops/util/Logger.h"
 #include "oops/util/missingValues.h"
 #include "ufo/utils/Constants.h"
+#include "ufo/utils/RecordIndex.h"
 
 namespace ufo {
 
@@ -42,9 +43,9 @@ ObsDerivativeCheck::~ObsDerivativeCheck() {}
 
 // -----------------------------------------------------------------------------
 
-void get_locs(const std::vector<std::size_t> & rSort, const size_t & i1, const size_t & i2,
+void get_locs(const RecordIndex::Record & rSort, const size_t & i1, const size_t & i2,
               const size_t & ilocs, size_t & ii1, size_t & ii2)
-// rSort - the vector of integers of indices of the sorted ObsDataVector
+// rSort - the indices of the locations in the sorted record
 //         used to get the size of the sorted record
 // i1 and i2 are by default 0 but can be defined in YAML to assign fixed indices
 //         for the derivative computed for each point in the record
@@ -132,13 +133,12 @@ void ObsDerivativeCheck::applyFilter(const std::vector<bool> & apply,
   if ( strInd_ == "datetime" ) {  // special case for datetime
       std::vector<util::DateTime> varIndT_(nlocs_);
       obsdb_.get_db("MetaData", strInd_, varIndT_);
-      ioda::ObsSpace::RecIdxIter irec;
+      const RecordIndex &records = data_.recordIndex();
       if ( strDep_ == "distance" ) {  // special case for moving obs
         ioda::ObsDataVector<float> varDepX_(obsdb_, "longitude", "MetaData");
         ioda::ObsDataVector<float> varDepY_(obsdb_, "latitude", "MetaData");
-        for ( irec = obsdb_.recidx_begin(); irec != obsdb_.recidx_end(); ++irec ) {
-          std:: size_t rNum = obsdb_.recidx_recnum(irec);
-          std::vector<std::size_t> rSort = obsdb_.recidx_vector(irec);
+        for (size_t irec = 0; irec < records.numRecords(); ++irec) {
+          const RecordIndex::Record rSort = records[irec];
           for (size_t ilocs = 0; ilocs < rSort.size(); ++ilocs) {
             get_locs(rSort, i1, i2, ilocs, ii1, ii2);
             if ( ii1 == ii2 ) {
@@ -160,9 +160,8 @@ void ObsDerivativeCheck::applyFilter(const std::vector<bool> & apply,
         }
       } else {
         ioda::ObsDataVector<float> varDep_(obsdb_, strDep_, "MetaData");
-        for ( irec = obsdb_.recidx_begin(); irec != obsdb_.recidx_end(); ++irec ) {
-          std:: size_t rNum = obsdb_.recidx_recnum(irec);
-          std::vector<std::size_t> rSort = obsdb_.recidx_vector(irec);
+        for (size_t irec = 0; irec < records.numRecords(); ++irec) {
+          const RecordIndex::Record rSort = records[irec];
           for (size_t ilocs = 0; ilocs < rSort.size(); ++ilocs) {
             get_locs(rSort, i1, i2, ilocs, ii1, ii2);
             if ( ii1 == ii2 ) {
@@ -183,10 +182,9 @@ void ObsDerivativeCheck::applyFilter(const std::vector<bool> & apply,
       ioda::ObsDataVector<float> varDep_(obsdb_, strDep_, "MetaData");
       ioda::ObsDataVector<float> varIndX_(obsdb_, "longitude", "MetaData");
       ioda::ObsDataVector<float> varIndY_(obsdb_, "latitude", "MetaData");
-      ioda::ObsSpace::RecIdxIter irec;
-      for ( irec = obsdb_.recidx_begin(); irec != obsdb_.recidx_end(); ++irec ) {
-        std:: size_t rNum = obsdb_.recidx_recnum(irec);
-        std::vector<std::size_t> rSort = obsdb_.recidx_vector(irec);
+      const RecordIndex &records = data_.recordIndex();
+      for (size_t irec = 0; irec < records.numRecords(); ++irec) {
+        const RecordIndex::Record rSort = records[irec];
         for (size_t ilocs = 0; ilocs < rSort.size(); ++ilocs) {
           get_locs(rSort, i1, i2, ilocs, ii1, ii2);
           if ( ii1 == ii2 ) {
@@ -209,10 +207,9 @@ void ObsDerivativeCheck::applyFilter(const std::vector<bool> & apply,
   } else {  // standard case where independent var is not datetime or distance
       ioda::ObsDataVector<float> varDep_(obsdb_, strDep_, "MetaData");
       ioda::ObsDataVector<float> varInd_(obsdb_, strInd_, "MetaData");
-      ioda::ObsSpace::RecIdxIter irec;
-      for ( irec = obsdb_.recidx_begin(); irec != obsdb_.recidx_end(); ++irec ) {
-        std:: size_t rNum = obsdb_.recidx_recnum(irec);
-        std::vector<std::size_t> rSort = obsdb_.recidx_vector(irec);
+      const RecordIndex &records = data_.recordIndex();
+      for (size_t irec = 0; irec < records.numRecords(); ++irec) {
+        const RecordIndex::Record rSort = records[irec];
         for (size_t ilocs = 0; ilocs < rSort.size(); ++ilocs) {
           get_locs(rSort, i1, i2, ilocs, ii1, ii2);
           if ( ii1 == ii2 ) {
@@ -7,9 +7,11 @@
 
 #include "ufo/filters/ObsFilterData.h"
 
+#include <sstream>
 #include <string>
 #include <vector>
 
+#include "eckit/exception/Exceptions.h"
 #include "ioda/ObsDataVector.h"
 #include "ioda/ObsSpace.h"
 #include "ioda/ObsVector.h"
@@ -17,12 +19,33 @@
 #include "ufo/filters/obsfunctions/ObsFunction.h"
 #include "ufo/GeoVaLs.h"
 #include "ufo/ObsDiagnostics.h"
+#include "ufo/utils/DictionaryEncodedStrings.h"
+#include "ufo/utils/Instrumentation.h"
+#include "ufo/utils/RecordIndex.h"
 
 namespace ufo {
 
+namespace {
+
+/// Record in the innermost active ScopedTimer that \p numValues values of type T were read.
+template <typename T>
+void countBytesRead(size_t numValues) {
+  ScopedTimer::count("bytes read", numValues * sizeof(T));
+}
+
+/// Record in the innermost active ScopedTimer that a temporary vector was allocated.
+template <typename T>
+void countAllocation(const ioda::ObsDataVector<T> & vec) {
+  ScopedTimer::count("allocations", 1);
+  ScopedTimer::count("bytes allocated", vec.nvars() * vec.nlocs() * sizeof(T));
+}
+
+}  // namespace
+
 // -----------------------------------------------------------------------------
 ObsFilterData::ObsFilterData(ioda::ObsSpace & obsdb)
-  : obsdb_(obsdb), gvals_(NULL), ovecs_(), diags_(NULL), dvecsf_(), dvecsi_() {
+  : obsdb_(obsdb), gvals_(NULL), ovecs_(), diags_(NULL), dvecsf_(), dvecsi_(),
+    functionDepth_(0) {
   oops::Log::trace() << "ObsFilterData created" << std::endl;
 }
 
@@ -41,6 +64,7 @@ void ObsFilterData::associate(const GeoVaLs & gvals) {
 /*! Associates H(x) ObsVector with this ObsFilterData */
 void ObsFilterData::associate(const ioda::ObsVector & hofx, const std::string & name) {
   ovecs_[name] = &hofx;
+  vectorPositions_.clear();
 }
 
 // -----------------------------------------------------------------------------
@@ -67,6 +91,13 @@ size_t ObsFilterData::nlocs() const {
   return obsdb_.nlocs();
 }
 
+// -----------------------------------------------------------------------------
+/*! Returns the record index of the associated ObsSpace */
+const RecordIndex & ObsFilterData::recordIndex() const {
+  // The index is kept alive by RecordIndex::get() for as long as obsdb_ exists.
+  return *RecordIndex::get(obsdb_);
+}
+
 // -----------------------------------------------------------------------------
 /*! Checks if requested data exists in ObsFilterData
  *  \param varname is a name of a variable requested
@@ -134,8 +165,10 @@ void ObsFilterData::get(const Variable & varname, std::vector<float> & values) c
   if (grp == "VarMetaData") {
     values.resize(obsdb_.nvars());
     obsdb_.get_db(grp, var, values);
+    countBytesRead<float>(values.size());
   } else {
     ioda::ObsDataVector<float> vec(obsdb_, varname.toOopsVariables(), grp, false);
+    countAllocation(vec);
     this->get(varname, vec);
     values.resize(obsdb_.nlocs());
     for (size_t jj = 0; jj < obsdb_.nlocs(); ++jj) {
@@ -145,6 +178,49 @@ void ObsFilterData::get(const Variable & varname, std::vector<float> & values) c
 }
 
 
+// -----------------------------------------------------------------------------
+/*! Gets requested data from ObsFilterData without building or comparing variable names
+ *  \param[in] handle identifies the variable requested (group must not be ObsFunction
+ *             or VarMetaData)
+ *  \param[out] values on output is data from the variable (undefined on input)
+ *  \warning if data are unavailable, assertions would fail and method abort
+ */
+void ObsFilterData::get(VariableHandle handle, std::vector<float> & values) const {
+  const VariableRegistry & registry = VariableRegistry::instance();
+  const std::string & var = registry.variable(handle);
+  const std::string & grp = registry.group(handle);
+  if (grp == "ObsFunction" || grp == "VarMetaData")
+    throw eckit::UserError("ObsFilterData::get: variable handles are not supported for group " +
+                           grp, Here());
+
+  values.resize(obsdb_.nlocs());
+  if (grp == "GeoVaLs") {
+    ASSERT(gvals_);
+    gvals_->get(values, handle);
+  } else if (grp == "ObsDiag" || grp == "ObsBiasTerm") {
+    ASSERT(diags_);
+    diags_->get(values, var);
+  } else {
+    std::map<std::string, const ioda::ObsVector *>::const_iterator jv = ovecs_.find(grp);
+    auto position = vectorPositions_.find(handle.index);
+    if (jv != ovecs_.end() && position == vectorPositions_.end() && jv->second->has(var))
+      position = vectorPositions_.insert(
+            std::make_pair(handle.index, jv->second->varnames().find(var))).first;
+    if (position != vectorPositions_.end()) {
+      ///  For HofX get from ObsVector H(x)
+      const size_t hofxnvars = jv->second->nvars();
+      for (size_t jj = 0; jj < obsdb_.nlocs(); ++jj) {
+        values[jj] = (*jv->second)[position->second + (jj * hofxnvars)];
+      }
+    } else if (this->hasDataVector(grp, var)) {
+      values = (*dvecsf_.find(grp)->second)[var];
+    } else {
+      obsdb_.get_db(grp, var, values);
+    }
+  }
+  countBytesRead<float>(values.size());
+}
+
 // -----------------------------------------------------------------------------
 /*! Gets requested data from ObsFilterData
  *  \param[in] varname is a name of a variable requested
@@ -165,9 +241,26 @@ void ObsFilterData::get(const Variable & varname, std::vector<std::string> & val
   } else {
     values.resize(obsdb_.nlocs());
     obsdb_.get_db(grp, var, values);
+    if (Instrumentation::instance().enabled()) {
+      size_t numChars = 0;
+      for (const std::string & value : values) numChars += value.size();
+      countBytesRead<char>(numChars);
+    }
   }
 }
 
+// -----------------------------------------------------------------------------
+/*! Gets requested string data from ObsFilterData, encoding each distinct value as an integer
+ *  \param[in] varname is a name of a variable requested
+ *  \param[out] values on output is data from varname (undefined on input)
+ *  \warning if data are unavailable, assertions would fail and method abort
+ */
+void ObsFilterData::get(const Variable & varname, DictionaryEncodedStrings & values) const {
+  std::vector<std::string> strings;
+  this->get(varname, strings);
+  values = DictionaryEncodedStrings(strings);
+}
+
 
 // -----------------------------------------------------------------------------
 /*! Gets requested data from ObsFilterData
@@ -189,6 +282,7 @@ void ObsFilterData::get(const Variable & varname, std::vector<util::DateTime> &
   } else {
     values.resize(obsdb_.nlocs());
     obsdb_.get_db(grp, var, values);
+    countBytesRead<util::DateTime>(values.size());
   }
 }
 
@@ -207,6 +301,7 @@ void ObsFilterData::get(const Variable & varname, std::vector<int> & values) con
   if (grp == "VarMetaData") {
     values.resize(obsdb_.nvars());
     obsdb_.get_db(grp, var, values);
+    countBytesRead<int>(values.size());
   } else {
     if (grp == "GeoVaLs" || grp == "HofX" || grp == "ObsDiag" ||
         grp == "ObsBiasTerm" || grp == "ObsFunction") {
@@ -216,6 +311,7 @@ void ObsFilterData::get(const Variable & varname, std::vector<int> & values) con
       ABORT("ObsFilterData::get std::string and int values only supported for ObsSpace");
     } else {
       ioda::ObsDataVector<int> vec(obsdb_, varname.toOopsVariables(), grp, false);
+      countAllocation(vec);
       this->get(varname, vec);
       values.resize(obsdb_.nlocs());
       for (size_t jj = 0; jj < obsdb_.nlocs(); ++jj) {
@@ -225,6 +321,30 @@ void ObsFilterData::get(const Variable & varname, std::vector<int> & values) con
   }
 }
 
+// -----------------------------------------------------------------------------
+/*! Gets requested integer data from ObsFilterData without building or comparing variable names
+ *  \param[in] handle identifies the variable requested (group must be an ObsSpace group)
+ *  \param[out] values on output is data from the variable (undefined on input)
+ *  \warning if data are unavailable, assertions would fail and method abort
+ */
+void ObsFilterData::get(VariableHandle handle, std::vector<int> & values) const {
+  const VariableRegistry & registry = VariableRegistry::instance();
+  const std::string & var = registry.variable(handle);
+  const std::string & grp = registry.group(handle);
+  if (grp == "GeoVaLs" || grp == "HofX" || grp == "ObsDiag" || grp == "ObsBiasTerm" ||
+      grp == "ObsFunction" || grp == "VarMetaData")
+    throw eckit::UserError("ObsFilterData::get: int values of group " + grp +
+                           " cannot be accessed by handle", Here());
+
+  if (this->hasDataVectorInt(grp, var)) {
+    values = (*dvecsi_.find(grp)->second)[var];
+  } else {
+    values.resize(obsdb_.nlocs());
+    obsdb_.get_db(grp, var, values);
+  }
+  countBytesRead<int>(values.size());
+}
+
 
 // -----------------------------------------------------------------------------
 /*! Gets requested data at requested level from ObsFilterData
@@ -250,6 +370,50 @@ void ObsFilterData::get(const Variable & varname, const int level,
     ASSERT(diags_);
     diags_->get(values, var, level);
   }
+  countBytesRead<float>(values.size());
+}
+
+// -----------------------------------------------------------------------------
+/*! Gets requested data at all levels from ObsFilterData in a single call
+ *  \param[in] varname is a name of a variable requested; group must be GeoVaLs, ObsDiag
+ *              or ObsBiasTerm
+ *  \param[out] values on output holds nlevs(varname) * nlocs values; the value at level
+ *              `ilev + 1` (as numbered by get(varname, level, values)) and location `iloc`
+ *              is stored at index `ilev * nlocs + iloc`
+ */
+void ObsFilterData::getAllLevels(const Variable & varname, std::vector<float> & values) const {
+  const std::string var = varname.variable();
+  const std::string grp = varname.group();
+
+  ASSERT(grp == "GeoVaLs" || grp == "ObsDiag" || grp == "ObsBiasTerm");
+  values.resize(this->nlevs(varname) * obsdb_.nlocs());
+  if (values.empty())
+    return;
+///  For GeoVaLs read from GeoVaLs (should be available)
+  if (grp == "GeoVaLs") {
+    ASSERT(gvals_);
+    gvals_->getAllLevels(values.data(), var);
+///  For ObsDiag get from ObsDiagnostics
+  } else {
+    ASSERT(diags_);
+    diags_->getAllLevels(values.data(), var);
+  }
+  countBytesRead<float>(values.size());
+}
+
+// -----------------------------------------------------------------------------
+/*! Gets values of a multi-channel ObsDiag variable at all channels, levels and locations
+ *  \param[in] varname is a name of a variable requested; group must be ObsDiag
+ *  \return tensor owned by the ObsDiagnostics, valid until they are next modified
+ */
+const ObsDiagnosticsTensor & ObsFilterData::getTensor(const Variable & varname) const {
+  if (varname.group() != "ObsDiag")
+    throw eckit::UserError("ObsFilterData::getTensor: " + varname.variable() + "@" +
+                           varname.group() + " is not an ObsDiag variable", Here());
+  ASSERT(diags_);
+  const ObsDiagnosticsTensor & tensor = diags_->getTensor(varname.variable(), varname.channels());
+  countBytesRead<float>(tensor.nchans() * tensor.nlevs() * tensor.nlocs());
+  return tensor;
 }
 
 // -----------------------------------------------------------------------------
@@ -270,8 +434,8 @@ void ObsFilterData::get(const Variable & varname, ioda::ObsDataVector<float> & v
     values[var] = vec;
   /// For Function call compute
   } else if (grp == "ObsFunction") {
-    ObsFunction obsfunc(varname);
-    obsfunc.compute(*this, values);
+    computeFunction(varname, values);
+    return;
   ///  For HofX get from ObsVector H(x) (should be available)
   } else if (this->hasVector(grp, var)) {
     std::map<std::string, const ioda::ObsVector *>::const_iterator jv = ovecs_.find(grp);
@@ -297,6 +461,42 @@ void ObsFilterData::get(const Variable & varname, ioda::ObsDataVector<float> & v
   } else {
     values.read(grp);
   }
+  countBytesRead<float>(values.nvars() * values.nlocs());
+}
+
+// -----------------------------------------------------------------------------
+/*! Computes ObsFunction \p varname, reusing its result if the same function (with the same
+ *  options and output variables) has already been computed during the evaluation of the
+ *  outermost ObsFunction. Functions only read data, and none of the data can change while
+ *  the outermost function is evaluated, so subexpressions shared by several inputs (e.g. by the
+ *  `where` clauses of different Conditional cases or by different terms of a LinearCombination)
+ *  are computed only once.
+ */
+void ObsFilterData::computeFunction(const Variable & varname,
+                                    ioda::ObsDataVector<float> & values) const {
+  std::ostringstream key;
+  key << varname << '\n' << varname.options() << '\n' << values.varnames();
+  const auto cached = functionResults_.find(key.str());
+  if (cached != functionResults_.end()) {
+    values = *cached->second;
+    ScopedTimer::count("ObsFunction reuses", 1);
+    return;
+  }
+
+  // Forget all results once the outermost function has been computed (or has failed).
+  struct DepthGuard {
+    explicit DepthGuard(const ObsFilterData & data) : data_(data) {++data_.functionDepth_;}
+    ~DepthGuard() {
+      if (--data_.functionDepth_ == 0) data_.functionResults_.clear();
+    }
+    const ObsFilterData & data_;
+  } guard(*this);
+
+  ObsFunction obsfunc(varname);
+  obsfunc.compute(*this, values);
+  ScopedTimer::count("ObsFunction evaluations", 1);
+  if (functionDepth_ > 1)
+    functionResults_[key.str()].reset(new ioda::ObsDataVector<float>(values));
 }
 
 // -----------------------------------------------------------------------------
@@ -314,6 +514,7 @@ void ObsFilterData::get(const Variable & varname, ioda::ObsDataVector<int> & val
   } else {
     values.read(grp);
   }
+  countBytesRead<int>(values.nvars() * values.nlocs());
 }
 
 // -----------------------------------------------------------------------------
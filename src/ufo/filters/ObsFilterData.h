@@ -9,14 +9,17 @@
 #define UFO_FILTERS_OBSFILTERDATA_H_
 
 #include <map>
+#include <memory>
 #include <ostream>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "ioda/ObsDataVector.h"
 #include "oops/util/ObjectCounter.h"
 #include "oops/util/Printable.h"
 #include "ufo/filters/Variable.h"
+#include "ufo/utils/VariableRegistry.h"
 
 namespace ioda {
   class ObsSpace;
@@ -24,8 +27,11 @@ namespace ioda {
 }
 
 namespace ufo {
+  class DictionaryEncodedStrings;
   class GeoVaLs;
   class ObsDiagnostics;
+  class ObsDiagnosticsTensor;
+  class RecordIndex;
 
 // -----------------------------------------------------------------------------
 /*! \brief ObsFilterData provides access to all data related to an ObsFilter
@@ -60,8 +66,17 @@ class ObsFilterData : public util::Printable,
   void get(const Variable &, std::vector<float> &) const;
   //! Gets requested data at requested level from ObsFilterData
   void get(const Variable &, const int, std::vector<float> &) const;
+  //! Gets requested data at all levels from ObsFilterData, level by level
+  void getAllLevels(const Variable &, std::vector<float> &) const;
+  //! Gets requested data from ObsFilterData (faster equivalent of get(Variable) for variables
+  //! resolved in advance; not supported for ObsFunctions)
+  void get(VariableHandle, std::vector<float> &) const;
+  //! Gets requested integer data from ObsSpace (faster equivalent of get(Variable))
+  void get(VariableHandle, std::vector<int> &) const;
   //! Gets requested data from ObsFilterData
   void get(const Variable &, std::vector<std::string> &) const;
+  //! Gets requested string data from ObsFilterData as integer codes into a dictionary
+  void get(const Variable &, DictionaryEncodedStrings &) const;
   //! Gets requested data from ObsFilterData
   void get(const Variable &, std::vector<int> &) const;
   //! Gets requested data from ObsFilterData
@@ -70,6 +85,9 @@ class ObsFilterData : public util::Printable,
   void get(const Variable &, ioda::ObsDataVector<float> &) const;
   //! Gets requested data from ObsFilterData (ObsDataVector has to be allocated)
   void get(const Variable &, ioda::ObsDataVector<int> &) const;
+  //! Returns the values of the ObsDiag variable with channels at all channels, levels and
+  //! locations, without copying them
+  const ObsDiagnosticsTensor & getTensor(const Variable &) const;
   //! Checks if requested data exists in ObsFilterData
   bool has(const Variable &) const;
 
@@ -80,6 +98,9 @@ class ObsFilterData : public util::Printable,
   size_t nlocs() const;
   //! Returns number of levels for specified variable if 3D GeoVaLs or ObsDiags
   size_t nlevs(const Variable &) const;
+  //! Returns the index of locations belonging to each record of the ObsSpace (built once per
+  //! ObsSpace and shared by all filters)
+  const RecordIndex & recordIndex() const;
   //! Returns reference to ObsSpace associated with ObsFilterData
   ioda::ObsSpace & obsspace() const {return obsdb_;}
   //! Returns reference to GeoVaLs required by 1DVar
@@ -91,11 +112,18 @@ class ObsFilterData : public util::Printable,
   bool hasVector(const std::string &, const std::string &) const;
   bool hasDataVector(const std::string &, const std::string &) const;
   bool hasDataVectorInt(const std::string &, const std::string &) const;
+  void computeFunction(const Variable &, ioda::ObsDataVector<float> &) const;
 
   ioda::ObsSpace & obsdb_;                 //!< ObsSpace associated with this object
   const GeoVaLs mutable * gvals_;          //!< pointer to GeoVaLs associated with this object
   std::map<std::string, const ioda::ObsVector *> ovecs_;  //!< Associated ObsVectors
   const ObsDiagnostics mutable * diags_;   //!< pointer to ObsDiagnostics associated with object
+  //! Positions of variables identified by handles in the associated H(x) ObsVectors
+  mutable std::unordered_map<size_t, size_t> vectorPositions_;
+  //! Number of ObsFunctions being computed through this object (nesting depth)
+  mutable int functionDepth_;
+  //! Results of ObsFunctions computed during the evaluation of the outermost ObsFunction
+  mutable std::map<std::string, std::unique_ptr<ioda::ObsDataVector<float>>> functionResults_;
   std::map<std::string, const ioda::ObsDataVector<float> *> dvecsf_;  //!< Associated ObsDataVectors
   std::map<std::string, const ioda::ObsDataVector<int> *> dvecsi_;  //!< Associated ObsDataVectors
 };
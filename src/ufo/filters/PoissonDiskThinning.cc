@@ -9,122 +9,30 @@
 
 #include <algorithm>
 #include <cmath>
+#include <cstdint>
 #include <limits>
+#include <memory>
 #include <string>
 #include <utility>
 #include <vector>
 
 #include "eckit/config/Configuration.h"
-#include "eckit/container/KDTree.h"
 #include "ioda/ObsDataVector.h"
 #include "ioda/ObsSpace.h"
 #include "oops/base/Variables.h"
 #include "oops/util/DateTime.h"
 #include "oops/util/Duration.h"
-#include "oops/util/IsAnyPointInVolumeInterior.h"
 #include "oops/util/Logger.h"
 #include "ufo/filters/getScalarOrFilterData.h"
 #include "ufo/filters/ObsAccessor.h"
 #include "ufo/filters/PoissonDiskThinningParameters.h"
 #include "ufo/utils/Constants.h"
+#include "ufo/utils/ParallelFor.h"
+#include "ufo/utils/PointIndex.h"
 #include "ufo/utils/RecursiveSplitter.h"
 
 namespace ufo {
 
-namespace {
-
-/// \brief Abstract interface of a container storing point sets and able to answer spatial queries
-/// needed by PoissonDiskThinning ("does any point lie in the interior of an axis-aligned
-/// ellipsoid/cylinder?").
-template <int numDims_>
-class PointIndex {
- public:
-  typedef float CoordType;
-  static const int numDims = numDims_;
-
-  typedef std::array<CoordType, numDims> Point;
-  typedef std::array<CoordType, numDims> Extent;
-
-  virtual ~PointIndex() {}
-
-  virtual void insert(const Point &point) = 0;
-
-  virtual bool isAnyPointInCylinderInterior(const Point &center,
-                                            const Extent &semiAxes,
-                                            int numSpatialDims) const = 0;
-
-  virtual bool isAnyPointInEllipsoidInterior(const Point &center,
-                                             const Extent &semiAxes) const = 0;
-};
-
-/// \brief An implementation of PointIndex storing the point set in a kd-tree.
-template <int numDims_>
-class KDTree : public PointIndex<numDims_> {
- public:
-  typedef PointIndex<numDims_> Base;
-
-  typedef typename Base::CoordType CoordType;
-  typedef typename Base::Point Point;
-  typedef typename Base::Extent Extent;
-
-  static const int numDims = Base::numDims;
-
-  void insert(const Point &point) override;
-
-  bool isAnyPointInCylinderInterior(const Point &center,
-                                    const Extent &semiAxes,
-                                    int numSpatialDims) const override;
-
-  bool isAnyPointInEllipsoidInterior(const Point &center,
-                                     const Extent &semiAxes) const override;
-
- private:
-  struct EmptyPayload {};
-
-  struct TreeTraits {
-    typedef eckit::geometry::KPoint<numDims> Point;
-    typedef EmptyPayload Payload;
-  };
-
-  typedef eckit::KDTreeMemory<TreeTraits> KDTreeImpl;
-  typedef typename KDTreeImpl::Alloc Alloc;
-  typedef typename KDTreeImpl::Node Node;
-  typedef typename KDTreeImpl::Point KPoint;
-  typedef typename KDTreeImpl::Value Value;
-
-  KDTreeImpl tree_;
-};
-
-template <int numDims_>
-void KDTree<numDims_>::insert(
-    const Point &point) {
-  tree_.insert(Value(KPoint(point), EmptyPayload()));
-}
-
-template <int numDims_>
-bool KDTree<numDims_>::isAnyPointInEllipsoidInterior(
-    const Point &center, const Extent &semiAxes) const {
-  KPoint lbound, ubound;
-  for (int d = 0; d < numDims; ++d) {
-    lbound.data()[d] = center[d] - semiAxes[d];
-    ubound.data()[d] = center[d] + semiAxes[d];
-  }
-  return util::isAnyPointInEllipsoidInterior(tree_, lbound, ubound);
-}
-
-template <int numDims_>
-bool KDTree<numDims_>::isAnyPointInCylinderInterior(
-    const Point &center, const Extent &semiAxes, int numSpatialDims) const {
-  KPoint lbound, ubound;
-  for (int d = 0; d < numDims; ++d) {
-    lbound.data()[d] = center[d] - semiAxes[d];
-    ubound.data()[d] = center[d] + semiAxes[d];
-  }
-  return util::isAnyPointInCylinderInterior(tree_, lbound, ubound, numSpatialDims);
-}
-
-}  // namespace
-
 struct PoissonDiskThinning::ObsData
 {
   boost::optional<util::ScalarOrMap<int, float>> minHorizontalSpacings;
@@ -189,6 +97,8 @@ void PoissonDiskThinning::applyFilter(const std::vector<bool> & apply,
   // Thin points from each category separately.
   RecursiveSplitter categorySplitter =
       obsAccessor.splitObservationsIntoIndependentGroups(validObsIds);
+  std::vector<std::vector<size_t>> obsIdsInCategories;
+  std::vector<RecursiveSplitter> prioritySplitters;
   for (auto categoryGroup : categorySplitter.multiElementGroups()) {
     std::vector<size_t> obsIdsInCategory;
     for (size_t validObsIndex : categoryGroup) {
@@ -196,17 +106,29 @@ void PoissonDiskThinning::applyFilter(const std::vector<bool> & apply,
     }
 
     // Within each category, sort points by descending priority and then (if requested)
-    // randomly shuffle points of equal priority.
+    // randomly shuffle points of equal priority. This is done serially, in a fixed order of
+    // categories, so that the sequence of random numbers drawn does not depend on the number of
+    // threads.
     RecursiveSplitter prioritySplitter(obsIdsInCategory.size());
     groupObservationsByPriority(obsIdsInCategory, obsAccessor, prioritySplitter);
     if (options_.shuffle)
       prioritySplitter.shuffleGroups();
 
-    // Select points to retain within the category.
-    thinCategory(obsData, obsIdsInCategory, prioritySplitter, numSpatialDims, numNonspatialDims,
-                 isThinned);
+    obsIdsInCategories.push_back(std::move(obsIdsInCategory));
+    prioritySplitters.push_back(std::move(prioritySplitter));
   }
 
+  // Select points to retain within each category. Categories are independent, so they can be
+  // processed concurrently.
+  std::vector<std::vector<size_t>> thinnedObsIdsInCategories(obsIdsInCategories.size());
+  parallelFor(obsIdsInCategories.size(), [&](size_t category) {
+    thinCategory(obsData, obsIdsInCategories[category], prioritySplitters[category],
+                 numSpatialDims, numNonspatialDims, thinnedObsIdsInCategories[category]);
+  });
+  for (const std::vector<size_t> &thinnedObsIds : thinnedObsIdsInCategories)
+    for (size_t obsId : thinnedObsIds)
+      isThinned[obsId] = true;
+
   obsAccessor.flagRejectedObservations(isThinned, flagged);
 
   if (filtervars.size() != 0) {
@@ -350,20 +272,25 @@ void PoissonDiskThinning::thinCategory(const ObsData &obsData,
                                        const RecursiveSplitter &prioritySplitter,
                                        int numSpatialDims,
                                        int numNonspatialDims,
-                                       std::vector<bool> &isThinned) const {
+                                       std::vector<size_t> &thinnedObsIds) const {
   switch (numSpatialDims + numNonspatialDims) {
   case 0:
     return;  // nothing to do
   case 1:
-    return thinCategory<1>(obsData, obsIdsInCategory, prioritySplitter, numSpatialDims, isThinned);
+    return thinCategory<1>(obsData, obsIdsInCategory, prioritySplitter, numSpatialDims,
+                           thinnedObsIds);
   case 2:
-    return thinCategory<2>(obsData, obsIdsInCategory, prioritySplitter, numSpatialDims, isThinned);
+    return thinCategory<2>(obsData, obsIdsInCategory, prioritySplitter, numSpatialDims,
+                           thinnedObsIds);
   case 3:
-    return thinCategory<3>(obsData, obsIdsInCategory, prioritySplitter, numSpatialDims, isThinned);
+    return thinCategory<3>(obsData, obsIdsInCategory, prioritySplitter, numSpatialDims,
+                           thinnedObsIds);
   case 4:
-    return thinCategory<4>(obsData, obsIdsInCategory, prioritySplitter, numSpatialDims, isThinned);
+    return thinCategory<4>(obsData, obsIdsInCategory, prioritySplitter, numSpatialDims,
+                           thinnedObsIds);
   case 5:
-    return thinCategory<5>(obsData, obsIdsInCategory, prioritySplitter, numSpatialDims, isThinned);
+    return thinCategory<5>(obsData, obsIdsInCategory, prioritySplitter, numSpatialDims,
+                           thinnedObsIds);
   }
 
   ABORT("Unexpected number of thinning dimensions");
@@ -374,21 +301,42 @@ void PoissonDiskThinning::thinCategory(const ObsData &obsData,
                                        const std::vector<size_t> &obsIdsInCategory,
                                        const RecursiveSplitter &prioritySplitter,
                                        int numSpatialDims,
-                                       std::vector<bool> &isThinned) const {
-  KDTree<numDims> pointIndex;
+                                       std::vector<size_t> &thinnedObsIds) const {
+  typedef typename PointIndex<numDims>::Extent Extent;
+
+  // The semi-axes of the exclusion volumes determine the size of the grid cells.
+  std::vector<Extent> semiAxes(obsIdsInCategory.size());
+  Extent maxSemiAxes;
+  maxSemiAxes.fill(0);
+  bool allSemiAxesPositive = true;
+  for (size_t obsIndex = 0; obsIndex < obsIdsInCategory.size(); ++obsIndex) {
+    semiAxes[obsIndex] = getExclusionVolumeSemiAxes<numDims>(obsIdsInCategory[obsIndex], obsData);
+    for (int d = 0; d < numDims; ++d) {
+      allSemiAxesPositive = allSemiAxesPositive && semiAxes[obsIndex][d] > 0;
+      maxSemiAxes[d] = std::max(maxSemiAxes[d], semiAxes[obsIndex][d]);
+    }
+  }
+
+  // The grid index can't represent degenerate exclusion volumes; fall back to the kd-tree if
+  // there are any.
+  std::unique_ptr<PointIndex<numDims>> pointIndex;
+  if (allSemiAxesPositive)
+    pointIndex.reset(new GridIndex<numDims>(maxSemiAxes));
+  else
+    pointIndex.reset(new KDTree<numDims>());
 
   for (auto priorityGroup : prioritySplitter.groups()) {
     for (size_t obsIndex : priorityGroup) {
       const size_t obsId = obsIdsInCategory[obsIndex];
       std::array<float, numDims> point = getObservationPosition<numDims>(obsId, obsData);
-      std::array<float, numDims> semiAxes = getExclusionVolumeSemiAxes<numDims>(obsId, obsData);
       if ((options_.exclusionVolumeShape == ExclusionVolumeShape::CYLINDER &&
-           pointIndex.isAnyPointInCylinderInterior(point, semiAxes, numSpatialDims)) ||
+           pointIndex->isAnyPointInCylinderInterior(point, semiAxes[obsIndex],
+                                                    numSpatialDims)) ||
           (options_.exclusionVolumeShape == ExclusionVolumeShape::ELLIPSOID &&
-           pointIndex.isAnyPointInEllipsoidInterior(point, semiAxes))) {
-        isThinned[obsId] = true;
+           pointIndex->isAnyPointInEllipsoidInterior(point, semiAxes[obsIndex]))) {
+        thinnedObsIds.push_back(obsId);
       } else {
-        pointIndex.insert(point);
+        pointIndex->insert(point);
       }
     }
   }
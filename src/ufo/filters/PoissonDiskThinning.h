@@ -97,12 +97,16 @@ class PoissonDiskThinning : public FilterBase,
                                    const ObsAccessor &obsAccessor,
                                    RecursiveSplitter &splitter) const;
 
+  /// Thin observations belonging to a single category, appending the IDs of rejected
+  /// observations to \p thinnedObsIds.
+  ///
+  /// May be called concurrently for different categories.
   void thinCategory(const ObsData &obsData,
                     const std::vector<size_t> &obsIdsInCategory,
                     const RecursiveSplitter &prioritySplitter,
                     int numSpatialDims,
                     int numNonspatialDims,
-                    std::vector<bool> &isThinned) const;
+                    std::vector<size_t> &thinnedObsIds) const;
 
   /// Thin observations belonging to a single category.
   template <int numDims>
@@ -110,7 +114,7 @@ class PoissonDiskThinning : public FilterBase,
                     const std::vector<size_t> &obsIdsInCategory,
                     const RecursiveSplitter &prioritySplitter,
                     int numSpatialDims,
-                    std::vector<bool> &isThinned) const;
+                    std::vector<size_t> &thinnedObsIds) const;
 
   template <int numDims>
   std::array<float, numDims> getObservationPosition(
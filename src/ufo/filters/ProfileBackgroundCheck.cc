@@ -23,6 +23,7 @@
 
 #include "ufo/filters/getScalarOrFilterData.h"
 #include "ufo/filters/QCflags.h"
+#include "ufo/utils/RecordIndex.h"
 
 namespace ufo {
 
@@ -92,6 +93,7 @@ void ProfileBackgroundCheck::applyFilter(const std::vector<bool> & apply,
   if (parameters_.relativeThreshold.value())
     rel_thr = getScalarOrFilterData(*parameters_.relativeThreshold.value(), data_);
 
+  const RecordIndex &records = data_.recordIndex();
   Variables varhofx(filtervars_, "HofX");
   for (size_t jv = 0; jv < filtervars.nvars(); ++jv) {
     size_t iv = observed.find(filtervars.variable(jv).variable());
@@ -100,8 +102,8 @@ void ProfileBackgroundCheck::applyFilter(const std::vector<bool> & apply,
     data_.get(varhofx.variable(jv), hofx);
 
     // Loop over the unique profiles
-    for (const auto& iprofile : unique) {
-      std::vector<size_t> obs_numbers = obsdb_.recidx_vector(iprofile);
+    for (size_t iprofile = 0; iprofile < records.numRecords(); ++iprofile) {
+      const RecordIndex::Record obs_numbers = records[iprofile];
       // Initialise the accumulators for this profile
       double total_diff = 0;
       int total_nobs = 0;
@@ -16,6 +16,7 @@
 
 #include "oops/util/Logger.h"
 #include "ufo/filters/QCflags.h"
+#include "ufo/utils/RecordIndex.h"
 
 namespace ufo {
 
@@ -60,13 +61,15 @@ void ProfileFewObsCheck::applyFilter(const std::vector<bool> & apply,
     oops::Log::debug() << iProfile << ' ';
   oops::Log::debug() << std::endl;
 
+  const RecordIndex &records = data_.recordIndex();
+
   // For each variable, check the number of observations in the profile
   for (size_t iFilterVar = 0; iFilterVar < filtervars.nvars(); ++iFilterVar) {
     const size_t iVar = observed.find(filtervars.variable(iFilterVar).variable());
 
     // Loop over the unique profiles
-    for (size_t iProfile : record_numbers) {
-      const std::vector<size_t> & obs_numbers = obsdb_.recidx_vector(iProfile);
+    for (size_t iProfile = 0; iProfile < records.numRecords(); ++iProfile) {
+      const RecordIndex::Record obs_numbers = records[iProfile];
 
       // Count the number of valid observations in this profile
       int numValid = 0;
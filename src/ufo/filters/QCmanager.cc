@@ -7,6 +7,7 @@
 
 #include "ufo/filters/QCmanager.h"
 
+#include <exception>
 #include <numeric>
 #include <string>
 #include <utility>
@@ -23,6 +24,7 @@
 #include "oops/util/Logger.h"
 #include "oops/util/missingValues.h"
 #include "ufo/filters/QCflags.h"
+#include "ufo/utils/Instrumentation.h"
 
 namespace ufo {
 
@@ -87,6 +89,17 @@ void QCmanager::postFilter(const ioda::ObsVector & hofx, const ObsDiagnostics &)
 QCmanager::~QCmanager() {
   oops::Log::trace() << "QCmanager::~QCmanager starting" << std::endl;
   oops::Log::info() << *this;
+  // Like the QC statistics printed above, the instrumentation report aggregated across ranks is
+  // computed collectively; it covers everything recorded for the ObsSpace so far, so the report
+  // written when the last QCmanager is destroyed covers the whole run.
+  if (Instrumentation::instance().enabled()) {
+    try {
+      Instrumentation::instance().writeReportIfRequested(obsdb_.comm(), obsdb_.obsname());
+    } catch (const std::exception & e) {
+      oops::Log::warning() << "Writing the instrumentation report failed: " << e.what()
+                           << std::endl;
+    }
+  }
   oops::Log::trace() << "QCmanager::~QCmanager done" << std::endl;
 }
 
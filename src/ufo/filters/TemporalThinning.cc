@@ -9,12 +9,15 @@
 
 #include <algorithm>
 #include <cmath>
+#include <cstdint>
 #include <functional>
+#include <queue>
 #include <string>
 #include <utility>
 #include <vector>
 
 #include "eckit/config/Configuration.h"
+#include "eckit/exception/Exceptions.h"
 #include "ioda/ObsDataVector.h"
 #include "ioda/ObsSpace.h"
 #include "oops/base/Variables.h"
@@ -23,240 +26,233 @@
 #include "oops/util/Logger.h"
 #include "ufo/filters/ObsAccessor.h"
 #include "ufo/filters/TemporalThinningParameters.h"
+#include "ufo/filters/TemporalThinningStream.h"
+#include "ufo/utils/ParallelFor.h"
 #include "ufo/utils/RecursiveSplitter.h"
 
 namespace ufo {
 
 namespace {
 
-struct Observation {
-  size_t id;
-  util::DateTime time;
-  int priority = 0;
-};
+/// Minimum number of observations thinned by a single task.
+const size_t minNumObsPerTask = 4096;
 
 /// \brief Responsible for the selection of observations to retain.
+///
+/// Times are expressed in seconds relative to an arbitrary reference time.
 class TemporalThinner {
  public:
   TemporalThinner(const std::vector<size_t> &validObsIds,
-                  const std::vector<util::DateTime> &times,
+                  const std::vector<std::int64_t> &times,
                   const std::vector<int> *priorities,
                   const RecursiveSplitter &splitter,
-                  const TemporalThinningParameters &options);
+                  const TemporalThinningParameters &options,
+                  boost::optional<std::int64_t> seedTime);
 
   std::vector<bool> identifyThinnedObservations(size_t totalNumObservations) const;
 
+  /// Thin the valid observations by passing them to a TemporalThinningStream in chronological
+  /// order, treating each group as a separate station identified by its index.
+  std::vector<bool> identifyThinnedObservationsInStream(size_t totalNumObservations) const;
+
  private:
   typedef std::vector<size_t>::const_iterator ForwardValidObsIndexIterator;
   typedef std::vector<size_t>::const_reverse_iterator BackwardValidObsIndexIterator;
 
-  Observation getObservation(size_t validObsIndex) const {
-    Observation obs;
-    obs.id = validObsIds_[validObsIndex];
-    obs.time = times_[obs.id];
-    if (priorities_)
-      obs.priority = (*priorities_)[obs.id];
-    return obs;
-  }
-
-  util::DateTime getTime(size_t validObsIndex) const {
+  std::int64_t getTime(size_t validObsIndex) const {
     return times_[validObsIds_[validObsIndex]];
   }
 
   int getPriority(size_t validObsIndex) const {
-    ASSERT(priorities_ != nullptr);
-    return (*priorities_)[validObsIds_[validObsIndex]];
+    return priorities_ ? (*priorities_)[validObsIds_[validObsIndex]] : 0;
   }
 
   bool hasPriorities() const {
     return priorities_ != nullptr;
   }
 
-  /// Thin the valid observations with indices from the specified range. The first observation
-  /// to retain must be taken at or after \p deadline.
-  void thinRangeForwards(ForwardValidObsIndexIterator validIndicesBegin,
-                         ForwardValidObsIndexIterator validIndicesEnd,
-                         util::DateTime deadline,
-                         std::vector<bool> &isThinned) const;
+  /// Thin the valid observations belonging to a single group, appending the IDs of rejected
+  /// observations to \p thinnedObsIds.
+  void thinGroup(const RecursiveSplitter::Group &group, std::vector<size_t> &thinnedObsIds) const;
 
   /// Thin the valid observations with indices from the specified range. The first observation
-  /// to retain must be taken at or before \p deadline.
-  void thinRangeBackwards(BackwardValidObsIndexIterator validIndicesBegin,
-                          BackwardValidObsIndexIterator validIndicesEnd,
-                          util::DateTime deadline,
-                          std::vector<bool> &isThinned) const;
-
-  /// \brief Common implementation shared by thinRangeForwards() and thinRangeBackwards().
+  /// to retain must be taken at or after (before) \p deadline if \p direction is 1 (-1).
   ///
   /// \tparam Iterator
   ///   Iterator visiting indices of observations in chronological (reverse chronological) order
   ///   when thinning forwards (backwards).
-  /// \tparam IsPast
-  ///   Binary functor taking two parameters of type util::DateTime and returning true if and only
-  ///   if the first argument is later (earlier) than the second when thinning forwards (backwards).
-  /// \tparam IsAtOrPast
-  ///   Binary functor taking two parameters of type util::DateTime and returning true if and only
-  ///   if the first argument is later (earlier) than or equal to the second when thinning forwards
-  ///   (backwards).
-  /// \tparam Advance
-  ///   Binary functor taking two parameters of types util::DateTime and util::Duration and
-  ///   returning the datetime obtained by adding (subtracting) the second argument to (from) the
-  ///   first argument when thinning forwards (backwards).
-  template <typename Iterator, typename IsPast, typename IsAtOrPast, typename Advance>
+  template <typename Iterator>
   void thinRange(Iterator validIndicesBegin,
                  Iterator validIndicesEnd,
-                 util::DateTime deadline,
-                 IsPast isPast,
-                 IsAtOrPast isAtOrPast,
-                 Advance advance,
-                 std::vector<bool> &isThinned) const;
+                 boost::optional<std::int64_t> deadline,
+                 int direction,
+                 std::vector<size_t> &thinnedObsIds) const;
 
   /// Return an iterator to the first observation to be retained.
   ForwardValidObsIndexIterator findSeed(
       ForwardValidObsIndexIterator validObsIndicesBegin,
       ForwardValidObsIndexIterator validObsIndicesEnd,
-      util::DateTime seedTime) const;
+      std::int64_t seedTime) const;
 
   /// Return an iterator to the valid observation taken at a time closest to \p targetTime.
   /// In case of a tie, the later (more recent) observation is selected.
   ForwardValidObsIndexIterator findNearest(
       ForwardValidObsIndexIterator validObsIndicesBegin,
       ForwardValidObsIndexIterator validObsIndicesEnd,
-      util::DateTime targetTime) const;
+      std::int64_t targetTime) const;
 
  private:
   const std::vector<size_t> &validObsIds_;
-  const std::vector<util::DateTime> &times_;
+  const std::vector<std::int64_t> &times_;
   const std::vector<int> *priorities_;
   const RecursiveSplitter &splitter_;
   const TemporalThinningParameters &options_;
+  std::int64_t minSpacing_;
+  std::int64_t tolerance_;
+  boost::optional<std::int64_t> seedTime_;
 };
 
 TemporalThinner::TemporalThinner(const std::vector<size_t> &validObsIds,
-                                 const std::vector<util::DateTime> &times,
+                                 const std::vector<std::int64_t> &times,
                                  const std::vector<int> *priorities,
                                  const RecursiveSplitter &splitter,
-                                 const TemporalThinningParameters &options) :
+                                 const TemporalThinningParameters &options,
+                                 boost::optional<std::int64_t> seedTime) :
   validObsIds_(validObsIds),
   times_(times),
   priorities_(priorities),
   splitter_(splitter),
-  options_(options)
+  options_(options),
+  minSpacing_(options.minSpacing.value().toSeconds()),
+  tolerance_(options.tolerance.value().toSeconds()),
+  seedTime_(seedTime)
 {}
 
 std::vector<bool> TemporalThinner::identifyThinnedObservations(size_t totalNumObservations) const {
-  std::vector<bool> isThinned(totalNumObservations, false);
-
+  std::vector<RecursiveSplitter::Group> groups;
+  std::vector<size_t> firstGroupInTask(1, 0);
+  size_t numObsInTask = 0;
   for (RecursiveSplitter::Group group : splitter_.multiElementGroups()) {
-    if (options_.seedTime.value() == boost::none) {
-      util::DateTime deadline = getTime(*group.begin());
-      thinRangeForwards(group.begin(), group.end(), deadline, isThinned);
-    } else {
-      const ForwardValidObsIndexIterator seedIt = findSeed(
-            group.begin(), group.end(), *options_.seedTime.value());
-      Observation seed = getObservation(*seedIt);
-      {
-        util::DateTime deadline = seed.time + options_.minSpacing;
-        thinRangeForwards(seedIt + 1, group.end(), deadline, isThinned);
-      }
-      {
-        const BackwardValidObsIndexIterator seedRevIt(seedIt + 1);
-        const BackwardValidObsIndexIterator revEnd(group.begin());
-        util::DateTime deadline = seed.time - options_.minSpacing;
-        thinRangeBackwards(seedRevIt, revEnd, seed.time, isThinned);
-      }
+    groups.push_back(group);
+    numObsInTask += group.end() - group.begin();
+    if (numObsInTask >= minNumObsPerTask) {
+      firstGroupInTask.push_back(groups.size());
+      numObsInTask = 0;
     }
   }
+  if (firstGroupInTask.back() != groups.size())
+    firstGroupInTask.push_back(groups.size());
+
+  // Groups are independent, so they can be thinned concurrently. Each task collects the IDs of
+  // the observations it rejects in a separate vector.
+  std::vector<std::vector<size_t>> thinnedObsIdsByTask(firstGroupInTask.size() - 1);
+  parallelFor(thinnedObsIdsByTask.size(), [&](size_t task) {
+    for (size_t group = firstGroupInTask[task]; group < firstGroupInTask[task + 1]; ++group)
+      thinGroup(groups[group], thinnedObsIdsByTask[task]);
+  });
 
+  std::vector<bool> isThinned(totalNumObservations, false);
+  for (const std::vector<size_t> &thinnedObsIds : thinnedObsIdsByTask)
+    for (size_t obsId : thinnedObsIds)
+      isThinned[obsId] = true;
   return isThinned;
 }
 
-void TemporalThinner::thinRangeForwards(ForwardValidObsIndexIterator validIndicesBegin,
-                                        ForwardValidObsIndexIterator validIndicesEnd,
-                                        util::DateTime deadline,
-                                        std::vector<bool> &isThinned) const {
-  thinRange(validIndicesBegin, validIndicesEnd, deadline,
-            std::greater<util::DateTime>(),
-            std::greater_equal<util::DateTime>(),
-            // Unfortunately in C++11 std::plus requires both arguments to be of the same type
-            [](const util::DateTime &time, const util::Duration &offset) { return time + offset; },
-            isThinned);
+std::vector<bool> TemporalThinner::identifyThinnedObservationsInStream(
+    size_t totalNumObservations) const {
+  struct StationCursor {
+    std::int64_t time;  // time of the next observation
+    size_t station;
+    ForwardValidObsIndexIterator next;
+    ForwardValidObsIndexIterator end;
+  };
+  auto isLater = [](const StationCursor &a, const StationCursor &b) {
+    return a.time > b.time || (a.time == b.time && a.station > b.station);
+  };
+
+  // Merge the groups, each already sorted chronologically, so that the observations of each
+  // group reach the stream in the same order as in thinGroup().
+  std::priority_queue<StationCursor, std::vector<StationCursor>, decltype(isLater)>
+      cursors(isLater);
+  size_t station = 0;
+  for (RecursiveSplitter::Group group : splitter_.multiElementGroups())
+    cursors.push(StationCursor{getTime(*group.begin()), station++, group.begin(), group.end()});
+
+  BasicTemporalThinningStream<size_t> stream(options_);
+  std::vector<bool> isThinned(totalNumObservations, false);
+  while (!cursors.empty()) {
+    StationCursor cursor = cursors.top();
+    cursors.pop();
+    const size_t validObsIndex = *cursor.next;
+    const boost::optional<size_t> thinnedObsId = stream.add(
+          cursor.station, validObsIds_[validObsIndex], cursor.time,
+          getPriority(validObsIndex));
+    if (thinnedObsId != boost::none)
+      isThinned[*thinnedObsId] = true;
+    if (++cursor.next != cursor.end) {
+      cursor.time = getTime(*cursor.next);
+      cursors.push(cursor);
+    }
+  }
+  return isThinned;
 }
 
-void TemporalThinner::thinRangeBackwards(
-    BackwardValidObsIndexIterator validIndicesBegin,
-    BackwardValidObsIndexIterator validIndicesEnd,
-    util::DateTime deadline,
-    std::vector<bool> &isThinned) const {
-  thinRange(validIndicesBegin, validIndicesEnd, deadline,
-            std::less<util::DateTime>(),
-            std::less_equal<util::DateTime>(),
-            [](const util::DateTime &time, const util::Duration &offset) { return time - offset; },
-            isThinned);
+void TemporalThinner::thinGroup(const RecursiveSplitter::Group &group,
+                                std::vector<size_t> &thinnedObsIds) const {
+  if (seedTime_ == boost::none) {
+    thinRange(group.begin(), group.end(), boost::none, 1, thinnedObsIds);
+  } else {
+    const ForwardValidObsIndexIterator seedIt = findSeed(group.begin(), group.end(), *seedTime_);
+    const std::int64_t seedTime = getTime(*seedIt);
+    thinRange(seedIt + 1, group.end(), seedTime + minSpacing_, 1, thinnedObsIds);
+    // The backward pass starts from the seed itself, which is therefore always retained.
+    const BackwardValidObsIndexIterator seedRevIt(seedIt + 1);
+    const BackwardValidObsIndexIterator revEnd(group.begin());
+    thinRange(seedRevIt, revEnd, seedTime, -1, thinnedObsIds);
+  }
 }
 
-template <typename Iterator, typename IsPast, typename IsAtOrPast, typename Advance>
+template <typename Iterator>
 void TemporalThinner::thinRange(Iterator validIndicesBegin,
                                 Iterator validIndicesEnd,
-                                util::DateTime deadline,
-                                IsPast isPast,
-                                IsAtOrPast isAtOrPast,
-                                Advance advance,
-                                std::vector<bool> &isThinned) const {
-  boost::optional<Observation> best;
+                                boost::optional<std::int64_t> deadline,
+                                int direction,
+                                std::vector<size_t> &thinnedObsIds) const {
+  // Thinning backwards is equivalent to thinning forwards in negated time.
+  if (deadline != boost::none)
+    *deadline *= direction;
+  TemporalThinningSequence sequence(minSpacing_, tolerance_, deadline);
   for (Iterator it = validIndicesBegin; it != validIndicesEnd; ++it) {
     const size_t validObsIndex = *it;
-    Observation current = getObservation(validObsIndex);
-    if (best != boost::none) {
-      // We're looking for a higher-priority observation at or before the deadline
-      if (isPast(current.time, deadline)) {
-        // We haven't found one
-        deadline = advance(best->time, options_.minSpacing);
-        best = boost::none;
-        // The decision whether to thin 'current' will be taken in the next if statement
-      } else {
-        if (current.priority > best->priority) {
-          isThinned[best->id] = true;
-          best = current;
-        } else {
-          isThinned[current.id] = true;
-        }
-      }
-    }
-
-    if (best == boost::none) {
-      // We're looking for an observation at or after the deadline
-      if (isAtOrPast(current.time, deadline)) {
-        best = current;
-        deadline = advance(best->time, options_.tolerance);
-      } else {
-        isThinned[current.id] = true;
-      }
-    }
+    const boost::optional<size_t> thinnedObsId = sequence.add(
+          validObsIds_[validObsIndex], direction * getTime(validObsIndex),
+          getPriority(validObsIndex));
+    if (thinnedObsId != boost::none)
+      thinnedObsIds.push_back(*thinnedObsId);
   }
 }
 
 typename TemporalThinner::ForwardValidObsIndexIterator TemporalThinner::findSeed(
     ForwardValidObsIndexIterator validObsIndicesBegin,
     ForwardValidObsIndexIterator validObsIndicesEnd,
-    util::DateTime seedTime) const {
+    std::int64_t seedTime) const {
   const ForwardValidObsIndexIterator nearestToSeedIt = findNearest(
         validObsIndicesBegin, validObsIndicesEnd, seedTime);
   if (!hasPriorities()) {
     return nearestToSeedIt;
   }
 
-  util::DateTime nearestToSeedTime = getObservation(*nearestToSeedIt).time;
+  const std::int64_t nearestToSeedTime = getTime(*nearestToSeedIt);
 
   ForwardValidObsIndexIterator acceptableBegin = std::lower_bound(
         validObsIndicesBegin, nearestToSeedIt,
-        nearestToSeedTime - options_.tolerance,
-        [&](size_t validObsIndexA, const util::DateTime &timeB)
+        nearestToSeedTime - tolerance_,
+        [&](size_t validObsIndexA, std::int64_t timeB)
         { return getTime(validObsIndexA) < timeB; });
   ForwardValidObsIndexIterator acceptableEnd = std::upper_bound(
         acceptableBegin, validObsIndicesEnd,
-        nearestToSeedTime + options_.tolerance,
-        [&](const util::DateTime &timeA, size_t validObsIndexB)
+        nearestToSeedTime + tolerance_,
+        [&](std::int64_t timeA, size_t validObsIndexB)
         { return timeA < getTime(validObsIndexB); });
 
   // Find the element with highest priority in the acceptable range.
@@ -268,11 +264,11 @@ typename TemporalThinner::ForwardValidObsIndexIterator TemporalThinner::findSeed
 typename TemporalThinner::ForwardValidObsIndexIterator TemporalThinner::findNearest(
     ForwardValidObsIndexIterator validObsIndicesBegin,
     ForwardValidObsIndexIterator validObsIndicesEnd,
-    util::DateTime targetTime) const {
+    std::int64_t targetTime) const {
   ASSERT_MSG(validObsIndicesEnd - validObsIndicesBegin != 0,
              "The range of observation indices must not be empty");
 
-  auto isEarlierThan = [&](size_t validObsIndexA, const util::DateTime &timeB) {
+  auto isEarlierThan = [&](size_t validObsIndexA, std::int64_t timeB) {
     return getTime(validObsIndexA) < timeB;
   };
   const ForwardValidObsIndexIterator firstGreaterOrEqualToTargetIt =
@@ -289,12 +285,9 @@ typename TemporalThinner::ForwardValidObsIndexIterator TemporalThinner::findNear
   const ForwardValidObsIndexIterator lastLessThanTargetIt =
       firstGreaterOrEqualToTargetIt - 1;
 
-  Observation firstGreaterOrEqualToTarget = getObservation(*firstGreaterOrEqualToTargetIt);
-  Observation lastLessThanTarget = getObservation(*lastLessThanTargetIt);
-
   // Prefer the later observation if there's a tie
-  if ((firstGreaterOrEqualToTarget.time - targetTime).toSeconds() <=
-      (targetTime - lastLessThanTarget.time).toSeconds()) {
+  if (getTime(*firstGreaterOrEqualToTargetIt) - targetTime <=
+      targetTime - getTime(*lastLessThanTargetIt)) {
     return firstGreaterOrEqualToTargetIt;
   } else {
     return lastLessThanTargetIt;
@@ -309,6 +302,9 @@ TemporalThinning::TemporalThinning(ioda::ObsSpace & obsdb, const Parameters_ & p
   : FilterBase(obsdb, parameters, flags, obserr), options_(parameters)
 {
   oops::Log::debug() << "TemporalThinning: config = " << options_ << std::endl;
+  if (options_.streaming && options_.seedTime.value() != boost::none)
+    throw eckit::UserError("TemporalThinning: the seed_time option cannot be used in "
+                           "streaming mode", Here());
 }
 
 // Required for the correct destruction of options_.
@@ -349,14 +345,29 @@ std::vector<bool> TemporalThinning::identifyThinnedObservations(
 
   RecursiveSplitter splitter = obsAccessor.splitObservationsIntoIndependentGroups(validObsIds);
 
-  std::vector<util::DateTime> times = obsAccessor.getDateTimeVariableFromObsSpace(
-        "MetaData", "datetime");
+  // Convert times to seconds since the start of the assimilation window once and for all;
+  // integer arithmetic is much cheaper than util::DateTime arithmetic.
+  const util::DateTime &referenceTime = obsdb_.windowStart();
+  std::vector<std::int64_t> times;
+  {
+    const std::vector<util::DateTime> datetimes = obsAccessor.getDateTimeVariableFromObsSpace(
+          "MetaData", "datetime");
+    times.resize(datetimes.size());
+    for (size_t obsId = 0; obsId < datetimes.size(); ++obsId)
+      times[obsId] = (datetimes[obsId] - referenceTime).toSeconds();
+  }
   splitter.sortGroupsBy([&times, &validObsIds](size_t obsIndexA, size_t obsIndexB)
                         { return times[validObsIds[obsIndexA]] < times[validObsIds[obsIndexB]]; });
 
   boost::optional<std::vector<int>> priorities = getObservationPriorities(obsAccessor);
 
-  TemporalThinner thinner(validObsIds, times, priorities.get_ptr(), splitter, options_);
+  boost::optional<std::int64_t> seedTime;
+  if (options_.seedTime.value() != boost::none)
+    seedTime = (*options_.seedTime.value() - referenceTime).toSeconds();
+
+  TemporalThinner thinner(validObsIds, times, priorities.get_ptr(), splitter, options_, seedTime);
+  if (options_.streaming)
+    return thinner.identifyThinnedObservationsInStream(times.size());
   return thinner.identifyThinnedObservations(times.size());
 }
 
@@ -61,6 +61,15 @@ class TemporalThinningParameters : public FilterParametersBase {
   /// Variable storing observation priorities. Used together with \c tolerance; see the
   /// documentation of that parameter for more information.
   oops::OptionalParameter<Variable> priorityVariable{"priority_variable", this};
+
+  /// If true, the filter will pass all observations to a TemporalThinningStream in chronological
+  /// order, treating each category (or record) as a separate station, instead of thinning each
+  /// category separately. The results are the same. The filter still reads all observations and
+  /// sorts them by category and time before passing them to the stream, so this option neither
+  /// reduces its memory use nor speeds it up (the merge of categories makes it slightly slower);
+  /// it exercises the algorithm used by TemporalThinningStream on real data. Incompatible with
+  /// \c seed_time.
+  oops::Parameter<bool> streaming{"streaming", false, this};
 };
 
 }  // namespace ufo
@@ -0,0 +1,97 @@
+/*
+ * (C) Crown copyright 2021 Met Office. All rights reserved.
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ */
+
+#include "ufo/filters/TemporalThinningStream.h"
+
+#include <sstream>
+#include <string>
+
+#include "eckit/exception/Exceptions.h"
+#include "oops/util/Duration.h"
+#include "ufo/filters/TemporalThinningParameters.h"
+
+namespace ufo {
+
+TemporalThinningSequence::TemporalThinningSequence(std::int64_t minSpacing,
+                                                   std::int64_t tolerance,
+                                                   boost::optional<std::int64_t> deadline)
+  : minSpacing_(minSpacing), tolerance_(tolerance), deadline_(deadline)
+{}
+
+boost::optional<size_t> TemporalThinningSequence::add(size_t id, std::int64_t time,
+                                                      int priority) {
+  const Observation current{id, time, priority};
+  if (deadline_ == boost::none)
+    deadline_ = time;
+
+  if (best_ != boost::none) {
+    // We're looking for a higher-priority observation at or before the deadline
+    if (current.time > *deadline_) {
+      // We haven't found one
+      deadline_ = best_->time + minSpacing_;
+      best_ = boost::none;
+      // The decision whether to thin 'current' will be taken in the next if statement
+    } else {
+      if (current.priority > best_->priority) {
+        const size_t supersededId = best_->id;
+        best_ = current;
+        return supersededId;
+      } else {
+        return current.id;
+      }
+    }
+  }
+
+  // We're looking for an observation at or after the deadline
+  if (current.time >= *deadline_) {
+    best_ = current;
+    deadline_ = current.time + tolerance_;
+    return boost::none;
+  } else {
+    return current.id;
+  }
+}
+
+template <typename StationId>
+BasicTemporalThinningStream<StationId>::BasicTemporalThinningStream(
+    const TemporalThinningParameters &options)
+  : minSpacing_(options.minSpacing.value().toSeconds()),
+    tolerance_(options.tolerance.value().toSeconds())
+{
+  if (options.seedTime.value() != boost::none)
+    throw eckit::UserError("TemporalThinningStream does not support the seed_time option",
+                           Here());
+}
+
+template <typename StationId>
+boost::optional<size_t> BasicTemporalThinningStream<StationId>::add(
+    const StationId &station, size_t obsId, const util::DateTime &time, int priority) {
+  if (referenceTime_ == boost::none)
+    referenceTime_ = time;
+  return add(station, obsId, (time - *referenceTime_).toSeconds(), priority);
+}
+
+template <typename StationId>
+boost::optional<size_t> BasicTemporalThinningStream<StationId>::add(
+    const StationId &station, size_t obsId, std::int64_t seconds, int priority) {
+  auto it = stations_.find(station);
+  if (it == stations_.end()) {
+    it = stations_.emplace(station, Station{TemporalThinningSequence(minSpacing_, tolerance_),
+                                            seconds}).first;
+  } else if (seconds < it->second.lastTime) {
+    std::ostringstream msg;
+    msg << "Observations from station '" << station
+        << "' were not delivered in chronological order";
+    throw eckit::UserError(msg.str(), Here());
+  }
+  it->second.lastTime = seconds;
+  return it->second.sequence.add(obsId, seconds, priority);
+}
+
+template class BasicTemporalThinningStream<std::string>;
+template class BasicTemporalThinningStream<size_t>;
+
+}  // namespace ufo
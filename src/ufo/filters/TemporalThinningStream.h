@@ -0,0 +1,121 @@
+/*
+ * (C) Crown copyright 2021 Met Office. All rights reserved.
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ */
+
+#ifndef UFO_FILTERS_TEMPORALTHINNINGSTREAM_H_
+#define UFO_FILTERS_TEMPORALTHINNINGSTREAM_H_
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+#include <boost/optional.hpp>
+
+#include "oops/util/DateTime.h"
+
+namespace ufo {
+
+class TemporalThinningParameters;
+
+/// \brief Incremental implementation of the algorithm used by the TemporalThinning filter to thin
+/// a chronologically ordered sequence of observations.
+///
+/// Times are expressed in seconds relative to an arbitrary reference. To thin a sequence in
+/// reverse chronological order, negate the times (and the initial deadline, if any).
+class TemporalThinningSequence {
+ public:
+  /// \param minSpacing
+  ///   Minimum spacing (in seconds) between two successive retained observations.
+  /// \param tolerance
+  ///   Tolerance (in seconds) within which a higher-priority observation may replace one
+  ///   retained earlier.
+  /// \param deadline
+  ///   Time at or after which the first retained observation must be taken. If not set, the
+  ///   first observation passed to add() will be retained.
+  TemporalThinningSequence(std::int64_t minSpacing, std::int64_t tolerance,
+                           boost::optional<std::int64_t> deadline = boost::none);
+
+  /// \brief Process the next observation of the sequence.
+  ///
+  /// \param id
+  ///   Observation ID.
+  /// \param time
+  ///   Observation time; must not be earlier than that of the previous observation.
+  /// \param priority
+  ///   Observation priority.
+  ///
+  /// \returns The ID of the observation rejected as a result: either \p id or that of a
+  /// previously retained observation superseded by this one. An empty optional if no observation
+  /// was rejected.
+  boost::optional<size_t> add(size_t id, std::int64_t time, int priority);
+
+ private:
+  struct Observation {
+    size_t id;
+    std::int64_t time;
+    int priority;
+  };
+
+  std::int64_t minSpacing_;
+  std::int64_t tolerance_;
+  boost::optional<std::int64_t> deadline_;
+  boost::optional<Observation> best_;
+};
+
+/// \brief Thins a stream of observations taken by multiple stations using the same criteria as the
+/// TemporalThinning filter.
+///
+/// Observations can be delivered in any order across stations, but the observations of each
+/// station must arrive in chronological order. Each rejection is reported as soon as it is made.
+/// Memory use depends on the number of stations rather than the number of observations, so this
+/// class is suitable for very long time windows that do not fit in a single ObsSpace.
+///
+/// Seed times are not supported, since they require all observations of a station to be known
+/// in advance.
+///
+/// \tparam StationId
+///   Type of the station identifiers: std::string or size_t (e.g. the index of a group of
+///   observations).
+template <typename StationId>
+class BasicTemporalThinningStream {
+ public:
+  /// \brief Create a stream thinning observations according to \p options.
+  ///
+  /// Only the `min_spacing` and `tolerance` options are used. Throws an exception if
+  /// `seed_time` is set.
+  explicit BasicTemporalThinningStream(const TemporalThinningParameters &options);
+
+  /// \brief Process an observation taken by station \p station at time \p time.
+  ///
+  /// \returns The ID of the observation rejected as a result (\p obsId or that of an
+  /// observation from the same station retained earlier), if any.
+  boost::optional<size_t> add(const StationId &station, size_t obsId,
+                              const util::DateTime &time, int priority = 0);
+
+  /// \brief Process an observation taken by station \p station at time \p time, expressed in
+  /// seconds relative to a reference time shared by all observations passed to this function.
+  ///
+  /// Must not be mixed with calls to the overload taking a util::DateTime.
+  boost::optional<size_t> add(const StationId &station, size_t obsId,
+                              std::int64_t time, int priority = 0);
+
+ private:
+  struct Station {
+    TemporalThinningSequence sequence;
+    std::int64_t lastTime;
+  };
+
+  std::int64_t minSpacing_;
+  std::int64_t tolerance_;
+  boost::optional<util::DateTime> referenceTime_;
+  std::unordered_map<StationId, Station> stations_;
+};
+
+/// \brief Thins a stream of observations taken by stations identified by strings.
+typedef BasicTemporalThinningStream<std::string> TemporalThinningStream;
+
+}  // namespace ufo
+
+#endif  // UFO_FILTERS_TEMPORALTHINNINGSTREAM_H_
@@ -125,6 +125,14 @@ const std::vector<int> & Variable::channels() const {
 
 // -----------------------------------------------------------------------------
 
+VariableHandle Variable::handle(const size_t jch) const {
+  ASSERT(jch < this->size());
+  return VariableRegistry::instance().intern(
+        varname_, grpname_, channels_.empty() ? VariableRegistry::noChannel : channels_[jch]);
+}
+
+// -----------------------------------------------------------------------------
+
 oops::Variables Variable::toOopsVariables() const {
   oops::Variables vars;
   for (size_t jj = 0; jj < this->size(); ++jj) {
@@ -15,6 +15,7 @@
 #include "eckit/config/LocalConfiguration.h"
 #include "oops/base/Variables.h"
 #include "oops/util/Printable.h"
+#include "ufo/utils/VariableRegistry.h"
 
 namespace ufo {
 
@@ -37,6 +38,8 @@ class Variable: public util::Printable {
   std::string variable(const size_t) const;
   const std::string & group() const;
   const std::vector<int> & channels() const;
+  /// Return the handle of the single-channel variable with index \p jch (see VariableRegistry).
+  VariableHandle handle(const size_t jch = 0) const;
 
   oops::Variables toOopsVariables() const;
 
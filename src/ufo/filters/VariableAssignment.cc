@@ -235,7 +235,8 @@ VariableAssignment::VariableAssignment(ioda::ObsSpace & obsdb, const Parameters_
                                        std::shared_ptr<ioda::ObsDataVector<int> > flags,
                                        std::shared_ptr<ioda::ObsDataVector<float> > obserr)
   : ObsProcessorBase(obsdb, parameters.deferToPost, std::move(flags), std::move(obserr)),
-    parameters_(parameters)
+    parameters_(parameters),
+    where_(parameters.where)
 {
   oops::Log::debug() << "VariableAssignment: config = " << parameters_ << std::endl;
   allvars_ += getAllWhereVariables(parameters.where);
@@ -251,7 +252,7 @@ void VariableAssignment::doFilter() const {
   oops::Log::trace() << "VariableAssignment doFilter begin" << std::endl;
 
   // Select locations at which the filter will be applied
-  const std::vector<bool> apply = processWhere(parameters_.where, data_);
+  const std::vector<bool> apply = where_.evaluate(data_);
 
   // Assign values to successive sets of variables
   for (const AssignmentParameters &assignment : parameters_.assignments.value()) {
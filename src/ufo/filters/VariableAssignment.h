@@ -145,6 +145,7 @@ class VariableAssignment : public ObsProcessorBase,
   void doFilter() const override;
 
   Parameters_ parameters_;
+  CompiledWhere where_;
 };
 
 }  // namespace ufo
@@ -125,6 +125,19 @@ Variable Variables::variable(const size_t jj) const {
 
 // -----------------------------------------------------------------------------
 
+std::vector<VariableHandle> Variables::handles() const {
+  std::vector<VariableHandle> result;
+  result.reserve(this->nvars());
+  for (size_t ivar = 0; ivar < vars_.size(); ++ivar) {
+    for (size_t jch = 0; jch < vars_[ivar].size(); ++jch) {
+      result.push_back(vars_[ivar].handle(jch));
+    }
+  }
+  return result;
+}
+
+// -----------------------------------------------------------------------------
+
 Variables Variables::allFromGroup(const std::string & group) const {
   Variables vars;
   for (size_t ivar = 0; ivar < vars_.size(); ++ivar) {
@@ -46,6 +46,9 @@ class Variables: public util::Printable {
   size_t nvars() const;
   /// \brief Return a given constituent "primitive" (single-channel) variable.
   Variable variable(const size_t) const;
+  /// \brief Return the handles of all constituent "primitive" (single-channel) variables, in the
+  /// same order as variable().
+  std::vector<VariableHandle> handles() const;
 
   Variables allFromGroup(const std::string &) const;
   oops::Variables toOopsVariables() const;
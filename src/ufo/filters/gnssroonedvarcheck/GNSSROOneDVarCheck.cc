@@ -21,6 +21,7 @@
 #include "ufo/GeoVaLs.h"
 
 #include "eckit/config/Configuration.h"
+#include "eckit/exception/Exceptions.h"
 
 #include "oops/util/IntSetParser.h"
 
@@ -28,13 +29,19 @@ namespace ufo {
 
 // -----------------------------------------------------------------------------
 
-GNSSROOneDVarCheck::GNSSROOneDVarCheck(ioda::ObsSpace & obsdb, const eckit::Configuration & config,
+GNSSROOneDVarCheck::GNSSROOneDVarCheck(ioda::ObsSpace & obsdb, const Parameters_ & parameters,
                                  std::shared_ptr<ioda::ObsDataVector<int> > flags,
                                  std::shared_ptr<ioda::ObsDataVector<float> > obserr)
-  : FilterBase(obsdb, config, flags, obserr), config_(config)
+  : FilterBase(obsdb, parameters, flags, obserr)
 {
   oops::Log::debug() << "GNSSROOneDVarCheck contructor starting" << std::endl;
 
+  // Check the number of threads is sensible
+  if (parameters.NumThreads.value() < 1) {
+     throw eckit::UserError("GNSSROOneDVarCheck contructor:"
+                            " num_threads must be positive, aborting.");
+  }
+
   // Setup fortran object
   const eckit::Configuration * conf = &config_;
   ufo_gnssroonedvarcheck_create_f90(key_, obsdb, conf, GNSSROOneDVarCheck::qcFlag());
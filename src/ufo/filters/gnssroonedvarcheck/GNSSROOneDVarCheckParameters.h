@@ -0,0 +1,66 @@
+/*
+ * (C) Copyright 2021 Met Office UK
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ */
+
+#ifndef UFO_FILTERS_GNSSROONEDVARCHECK_GNSSROONEDVARCHECKPARAMETERS_H_
+#define UFO_FILTERS_GNSSROONEDVARCHECK_GNSSROONEDVARCHECKPARAMETERS_H_
+
+#include <string>
+
+#include "oops/util/parameters/Parameter.h"
+#include "oops/util/parameters/RequiredParameter.h"
+#include "ufo/filters/FilterParametersBase.h"
+
+namespace ufo {
+
+/// Parameters controlling the operation of the GNSSROOneDVarCheck filter.
+class GNSSROOneDVarCheckParameters : public FilterParametersBase {
+  OOPS_CONCRETE_PARAMETERS(GNSSROOneDVarCheckParameters, FilterParametersBase)
+
+ public:
+  /// Path to the b-matrix file
+  oops::RequiredParameter<std::string> BMatrixFilename{"bmatrix_filename", this};
+
+  /// Whether to remove super-saturation (wrt ice?)
+  oops::RequiredParameter<bool> CapSuperSat{"capsupersat", this};
+
+  /// Threshold value for the cost function convergence test
+  oops::RequiredParameter<double> CostFunctTest{"cost_funct_test", this};
+
+  /// Thresholds used in calculating convergence
+  oops::RequiredParameter<double> DeltaCt2{"Delta_ct2", this};
+  oops::RequiredParameter<double> DeltaFactor{"Delta_factor", this};
+
+  /// Maximum number of iterations in the 1D-Var
+  oops::RequiredParameter<int> NIterationTest{"n_iteration_test", this};
+
+  /// Threshold for the O-B throughout the profile
+  oops::RequiredParameter<double> OBTest{"OB_test", this};
+
+  /// Threshold on distance between observed and solution bending angles
+  oops::RequiredParameter<double> YTest{"y_test", this};
+
+  /// Minimum and maximum heights for the assimilation of data
+  oops::RequiredParameter<double> Zmin{"Zmin", this};
+  oops::RequiredParameter<double> Zmax{"Zmax", this};
+
+  /// Whether to use pseudo levels in the forward operator
+  oops::RequiredParameter<bool> PseudoOps{"pseudo_ops", this};
+
+  /// Whether to use ln(p) or exner in the vertical interpolation
+  oops::RequiredParameter<bool> VertInterpOps{"vert_interp_ops", this};
+
+  /// The minimum vertical temperature gradient allowed
+  oops::RequiredParameter<double> MinTempGrad{"min_temp_grad", this};
+
+  /// Number of OpenMP threads used to process the profiles. The results do not depend on the
+  /// number of threads.
+  oops::Parameter<int> NumThreads{"num_threads", 1, this};
+};
+
+}  // namespace ufo
+
+#endif  // UFO_FILTERS_GNSSROONEDVARCHECK_GNSSROONEDVARCHECKPARAMETERS_H_
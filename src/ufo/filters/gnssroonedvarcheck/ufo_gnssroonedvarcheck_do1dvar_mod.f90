@@ -43,7 +43,8 @@ SUBROUTINE Ops_GPSRO_Do1DVar_BA (nlevp,                  &
                                  Tb,                     &
                                  Ts,                     &
                                  O_Bdiff,                &
-                                 DFS)
+                                 DFS,                    &
+                                 verbose)
 
 use ufo_gnssroonedvarcheck_utils_mod, only: &
     singlebg_type,             &
@@ -81,6 +82,7 @@ REAL(kind_real), INTENT(INOUT)      :: Tb(nlevq)
 REAL(kind_real), INTENT(INOUT)      :: Ts(nlevq)
 REAL(kind_real), INTENT(INOUT)      :: O_Bdiff  ! measure of O-B for whole profile
 REAL(kind_real), INTENT(INOUT)      :: DFS      ! measure of degrees of freedom of signal for whole profile
+LOGICAL, INTENT(IN)                 :: verbose  ! whether to log the progress of the 1D-Var
 
 ! Local parameters
 CHARACTER(len=*), PARAMETER         :: RoutineName = "Ops_GPSRO_Do1DVar_BA"
@@ -154,10 +156,12 @@ nobs = COUNT (Ob % BendingAngle(:) % value /= missing_value(Ob % BendingAngle(1)
               Ob % ImpactParam(:) % value /= missing_value(Ob % ImpactParam(1) % value)   .AND. & ! not missing impact parameter
               Ob % qc_flags(:) == 0)
 
-WRITE (message, '(A,I0)') 'size of input obs vector ', SIZE (Ob % BendingAngle(:) % value)
-CALL fckit_log % info(message)
-WRITE (message, '(A,I0)') 'size of packed obs vector ', nobs
-CALL fckit_log % info(message)
+IF (verbose) THEN
+  WRITE (message, '(A,I0)') 'size of input obs vector ', SIZE (Ob % BendingAngle(:) % value)
+  CALL fckit_log % info(message)
+  WRITE (message, '(A,I0)') 'size of packed obs vector ', nobs
+  CALL fckit_log % info(message)
+END IF
 
 ! Only continue if we have some observations to process
 IF (nobs > 0) THEN
@@ -239,7 +243,8 @@ IF (nobs > 0) THEN
                                 temp_undulation,           &    ! geoid undulation
                                 Tb,                        &
                                 Ts,                        &
-                                DFS)
+                                DFS,                       &
+                                verbose)
     ran_iteration = .TRUE.
   ELSE
 
@@ -348,14 +353,18 @@ IF (nobs > 0) THEN
 
 ELSE
   IF (nobs <= 10) THEN
-    WRITE (message, '(A)') 'nobs is less than 10: exit Ops_GPSRO_Do1DVar_BA'
-    CALL fckit_log % info(message)
+    IF (verbose) THEN
+      WRITE (message, '(A)') 'nobs is less than 10: exit Ops_GPSRO_Do1DVar_BA'
+      CALL fckit_log % info(message)
+    END IF
     Ob % BendingAngle(:) % PGEFinal = 0.55     ! flag lack of observation data
   END IF
 
   IF (BAerr) THEN
-    WRITE (message, '(A)') 'Error in Ops_Refractivity: exit Ops_GPSRO_Do1DVar_BA'
-    CALL fckit_log % info(message)
+    IF (verbose) THEN
+      WRITE (message, '(A)') 'Error in Ops_Refractivity: exit Ops_GPSRO_Do1DVar_BA'
+      CALL fckit_log % info(message)
+    END IF
     Ob % BendingAngle(:) % PGEFinal = 0.58     ! flag BAerr
   END IF
 END IF
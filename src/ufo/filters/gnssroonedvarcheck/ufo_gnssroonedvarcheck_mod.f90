@@ -49,6 +49,7 @@ type, public :: ufo_gnssroonedvarcheck
   logical                   :: pseudo_ops        !< Whether to use pseudo levels in forward operator
   logical                   :: vert_interp_ops   !< Whether to use ln(p) or exner in vertical interpolation
   real(kind_real)           :: min_temp_grad     !< The minimum vertical temperature gradient allowed
+  integer                   :: num_threads       !< Number of OpenMP threads used to process profiles
 end type ufo_gnssroonedvarcheck
 
 ! ------------------------------------------------------------------------------
@@ -90,6 +91,7 @@ subroutine ufo_gnssroonedvarcheck_create(self, obsspace, f_conf, onedvarflag)
   call f_conf%get_or_die("pseudo_ops", self % pseudo_ops)
   call f_conf%get_or_die("vert_interp_ops", self % vert_interp_ops)
   call f_conf%get_or_die("min_temp_grad", self % min_temp_grad)
+  call f_conf%get_or_die("num_threads", self % num_threads)
 
 end subroutine ufo_gnssroonedvarcheck_create
 
@@ -115,6 +117,15 @@ end subroutine ufo_gnssroonedvarcheck_delete
 !! This routine is called from the c++ apply method.  The filter performs 
 !! a 1D-Var minimization
 !!
+!! The profiles are independent, so if num_threads is greater than one they are
+!! shared out among OpenMP threads (when the code is compiled with OpenMP).  Each
+!! thread has its own background and observation structures, and each profile
+!! only updates the QC flags of its own observations, so the results do not
+!! depend on the number of threads.  Nothing is logged inside the threaded loop:
+!! the progress of each minimisation is only logged when running on one thread,
+!! and a summary of each profile is logged after the loop.  The 1D-Var keeps
+!! several matrices on the stack, so OMP_STACKSIZE may need to be increased.
+!!
 !! \author Met Office
 !!
 !! \date 09/06/2020: Created
@@ -122,8 +133,7 @@ end subroutine ufo_gnssroonedvarcheck_delete
 subroutine ufo_gnssroonedvarcheck_apply(self, geovals, apply)
 
   implicit none
-
-  type(ufo_gnssroonedvarcheck), intent(inout) :: self    !< gnssroonedvarcheck main object
+  type(ufo_gnssroonedvarcheck), intent(in)   :: self     !< gnssroonedvarcheck main object
   type(ufo_geovals), intent(in)              :: geovals  !< model values at observation space
   logical, intent(in)                        :: apply(:) !< qc manager flags
 
@@ -149,6 +159,7 @@ subroutine ufo_gnssroonedvarcheck_apply(self, geovals, apply)
   real(kind_real), allocatable       :: sort_key(:)           ! Key for the sorting (based on record number and impact parameter)
   integer, allocatable               :: index_vals(:)         ! Indices of sorted observation
   integer, allocatable               :: unique(:)             ! Set of unique profile numbers
+  integer, allocatable               :: profile_start(:)      ! Index (in index_vals) of the first observation of each profile
   integer                            :: start_point           ! Starting index of the current profile
   integer                            :: current_point         ! Ending index of the current profile
   integer                            :: iprofile              ! Loop variable, profile number
@@ -162,6 +173,9 @@ subroutine ufo_gnssroonedvarcheck_apply(self, geovals, apply)
   real(kind_real)                    :: O_Bdiff               ! Average RMS(O-B) for profile
   real(kind_real), allocatable       :: Tb(:)                 ! Calculated background temperature (derived from p,q)
   real(kind_real), allocatable       :: Ts(:)                 ! 1DVar solution temperature
+  logical                            :: verbose               ! Whether to log the progress of each 1DVar
+  integer, allocatable               :: profile_niter(:)      ! Number of iterations used for each profile
+  real(kind_real), allocatable       :: profile_jcost(:)      ! Final cost function of each profile
 
   ! Get the obs-space information
   nobs = obsspace_get_nlocs(self % obsdb)
@@ -195,10 +209,8 @@ subroutine ufo_gnssroonedvarcheck_apply(self, geovals, apply)
   call ufo_geovals_get_var(geovals, var_z, theta_heights)   ! Geopotential height of the normal model levels
   call ufo_geovals_get_var(geovals, var_zi, rho_heights)    ! Geopotential height of the pressure levels
 
-  ! Read in the B-matrix and background profiles
+  ! Read in the B-matrix
   call Ops_GPSRO_GetBmatrix(self % bmatrix_filename, prs % nval, q % nval, b_matrix)
-  call allocate_singlebg(Back, prs % nval, q % nval)
-  allocate(Tb(q % nval), Ts(q % nval))
 
   ! Read through the record numbers in order to find a profile of observations
   ! Each profile shares the same record number
@@ -207,29 +219,31 @@ subroutine ufo_gnssroonedvarcheck_apply(self, geovals, apply)
   call Ops_RealSortQuick(sort_key, index_vals)
   call find_unique(record_number, unique)
 
-  ! For every profile that we have found, perform a 1DVar minimisation
+  ! Work out which observations belong to each profile
+  allocate(profile_start(size(unique)+1))
   current_point = 1
   do iprofile = 1, size(unique)
-    start_point = current_point
-    WRITE (Message, '(A,I0)') 'ObNumber ', iprofile
-    call fckit_log % info(Message)
-    WRITE (Message, '(A,F12.2)') 'Latitude ', obsLat(index_vals(start_point))
-    call fckit_log % info(Message)
-    WRITE (Message, '(A,F12.2)') 'Longitude ', obsLon(index_vals(start_point))
-    call fckit_log % info(Message)
-    WRITE (Message, '(A,I0)') 'Processing centre ', obsOrigC(index_vals(start_point))
-    call fckit_log % info(Message)
-    WRITE (Message, '(A,I0)') 'Sat ID ', obsSatid(index_vals(start_point))
-    call fckit_log % info(Message)
-    WRITE (Message, '(A,F12.2)') 'GPSRO_Zmin ', self % Zmin
-    call fckit_log % info(Message)
-    WRITE (Message, '(A,F12.2)') 'GPSRO_Zmax ', self % Zmax
-    call fckit_log % info(Message)
-
-    ! Work out which observations belong to the current profile
-    do current_point = start_point, nobs
+    profile_start(iprofile) = current_point
+    do current_point = current_point, nobs
       if (unique(iprofile) /= record_number(index_vals(current_point))) exit
     end do
+  end do
+  profile_start(size(unique)+1) = current_point
+
+  ! For every profile that we have found, perform a 1DVar minimisation
+  verbose = (self % num_threads == 1)
+  allocate(profile_niter(size(unique)), profile_jcost(size(unique)))
+
+  !$omp parallel num_threads(self % num_threads) if(.not. verbose) default(shared) &
+  !$omp   private(iprofile, start_point, current_point, nobs_profile, Back, Ob, &
+  !$omp           Tb, Ts, iband, iseason, ipoint, BAerr, O_Bdiff, dfs)
+  call allocate_singlebg(Back, prs % nval, q % nval)
+  allocate(Tb(q % nval), Ts(q % nval))
+
+  !$omp do schedule(dynamic)
+  do iprofile = 1, size(unique)
+    start_point = profile_start(iprofile)
+    current_point = profile_start(iprofile+1)
 
     ! Load the geovals into the background structure
     Back % za(:) = rho_heights % vals(:, index_vals(start_point))
@@ -286,30 +300,60 @@ subroutine ufo_gnssroonedvarcheck_apply(self, geovals, apply)
                               Tb,                      &   ! Calculated background temperature
                               Ts,                      &   ! 1DVar solution temperature
                               O_Bdiff,                 &   ! Difference between observations and background for profile
-                              DFS)                         ! Estimated degrees of freedom for signal
+                              DFS,                     &   ! Estimated degrees of freedom for signal
+                              verbose)                     ! Whether to log the progress of the 1DVar
 
     ! Flag bad profiles
     do ipoint = 0, nobs_profile-1
-      if (qc_flags(start_point + ipoint) > 0) then
+      if (qc_flags(index_vals(start_point + ipoint)) > 0) then
         ! Do nothing, since the data are already flagged
       else if (Ob % bendingangle(ipoint+1) % PGEFinal > 0.5) then
-        qc_flags(start_point + ipoint) = self % onedvarflag
+        qc_flags(index_vals(start_point + ipoint)) = self % onedvarflag
         Ob % qc_flags(ipoint+1) = self % onedvarflag
       end if
     end do
 
+    profile_niter(iprofile) = Ob % niter
+    profile_jcost(iprofile) = Ob % jcost
+
+    call deallocate_singleob(Ob)
+  end do
+  !$omp end do
+
+  call deallocate_singlebg(Back)
+  deallocate(Tb, Ts)
+  !$omp end parallel
+
+  ! Log a summary of each profile
+  do iprofile = 1, size(unique)
+    start_point = profile_start(iprofile)
+    current_point = profile_start(iprofile+1)
+    WRITE (Message, '(A,I0)') 'ObNumber ', iprofile
+    call fckit_log % info(Message)
+    WRITE (Message, '(A,F12.2)') 'Latitude ', obsLat(index_vals(start_point))
+    call fckit_log % info(Message)
+    WRITE (Message, '(A,F12.2)') 'Longitude ', obsLon(index_vals(start_point))
+    call fckit_log % info(Message)
+    WRITE (Message, '(A,I0)') 'Processing centre ', obsOrigC(index_vals(start_point))
+    call fckit_log % info(Message)
+    WRITE (Message, '(A,I0)') 'Sat ID ', obsSatid(index_vals(start_point))
+    call fckit_log % info(Message)
+    WRITE (Message, '(A,F12.2)') 'GPSRO_Zmin ', self % Zmin
+    call fckit_log % info(Message)
+    WRITE (Message, '(A,F12.2)') 'GPSRO_Zmax ', self % Zmax
+    call fckit_log % info(Message)
+
     write(Message,'(A,2I5,2F10.3,I5,F16.6)') 'Profile stats: ', obsSatid(index_vals(start_point)), &
-        obsOrigC(index_vals(start_point)), Ob % latitude, Ob % longitude, &
-        Ob % niter, Ob % jcost
+        obsOrigC(index_vals(start_point)), obsLat(index_vals(start_point)), &
+        obsLon(index_vals(start_point)), profile_niter(iprofile), profile_jcost(iprofile)
     call fckit_log % debug(Message)
-    do ipoint = 0, nobs_profile-1, 100
+    do ipoint = 0, current_point-start_point-1, 100
         write(Message,'(100I5)') qc_flags(index_vals(start_point+ipoint: &
                                                      min(start_point+ipoint+99, current_point-1)))
         call fckit_log % debug(Message)
     end do
-
-    call deallocate_singleob(Ob)
   end do
+
   call obsspace_put_db(self % obsdb, "FortranQC", "bending_angle", qc_flags)
 
 end subroutine ufo_gnssroonedvarcheck_apply
@@ -57,7 +57,8 @@ SUBROUTINE Ops_GPSRO_rootsolv_BA (nstate,        &   ! size of state vector
                                   RO_geoid_und,  &   ! geoid undulation
                                   Tb,            &
                                   Ts,            &
-                                  DFS)
+                                  DFS,           &
+                                  verbose)       ! Whether to log the iterations
 
 
 USE ufo_gnssro_ukmo1d_utils_mod, only: &
@@ -123,6 +124,7 @@ REAL(kind_real), INTENT(IN)    :: RO_geoid_und
 REAL(kind_real), INTENT(INOUT) :: Tb(nlevq)
 REAL(kind_real), INTENT(INOUT) :: Ts(nlevq)
 REAL(kind_real), INTENT(INOUT) :: DFS         ! Measure of degrees of freesom of signal for whole profile
+LOGICAL, INTENT(IN)            :: verbose     ! Whether to log the progress of the minimisation
 
 ! Local declarations:
 CHARACTER(len=*), PARAMETER  :: RoutineName = "Ops_GPSRO_rootsolv_BA"
@@ -236,7 +238,7 @@ ErrorCode = missing_value(ErrorCode)
 !-----------------------
 
 ! Data to stdout on convergence of iteration loop
-CALL fckit_log % info('J_pen|Conv_test|ct2|lambda|d2|(dJ/dx)^2|')
+IF (verbose) CALL fckit_log % info('J_pen|Conv_test|ct2|lambda|d2|(dJ/dx)^2|')
 
 Iteration_loop: DO
 
@@ -474,17 +476,21 @@ Iteration_loop: DO
   sdx(:) = MATMUL (Amat(:,:) , (x(:) - xold(:)))  !S^-1.dx
   d2 = DOT_PRODUCT ((x(:) - xold(:)) , Sdx(:))    !d^2=dx(S^-1)dx, size of step normalized by error size
 
-  WRITE (message,'(6E14.6)') J_pen, Conv_test, ct2, lambda, d2, ct3
-  CALL fckit_log % info(message)
+  IF (verbose) THEN
+    WRITE (message,'(6E14.6)') J_pen, Conv_test, ct2, lambda, d2, ct3
+    CALL fckit_log % info(message)
+  END IF
 
 END DO Iteration_loop
 
 Ts(:) = T(:)                  !1DVAR solution temperature
 
-WRITE (message, '(A,I0)') 'Number of iterations ', it   !write out number of iterations done
-CALL fckit_log % info(message)
-WRITE (message, '(A,F16.4)') 'O-B size ', O_Bdiff
-CALL fckit_log % info(message)
+IF (verbose) THEN
+  WRITE (message, '(A,I0)') 'Number of iterations ', it   !write out number of iterations done
+  CALL fckit_log % info(message)
+  WRITE (message, '(A,F16.4)') 'O-B size ', O_Bdiff
+  CALL fckit_log % info(message)
+END IF
 
 ! Output the x(:) that gave the lowest cost function
 
@@ -521,8 +527,10 @@ IF (ErrorCode == 0 .AND. it <= iter_max) THEN
     DFS = DFS + AKOK(i,i)
   END DO
 
-  WRITE (message,'(A,F16.4)') 'DFS', DFS
-  CALL fckit_log % info(message)
+  IF (verbose) THEN
+    WRITE (message,'(A,F16.4)') 'DFS', DFS
+    CALL fckit_log % info(message)
+  END IF
 ELSE
 
    Do1DVar_Error = .TRUE.
@@ -21,6 +21,7 @@
 #include "oops/util/IntSetParser.h"
 #include "oops/util/missingValues.h"
 #include "ufo/filters/Variable.h"
+#include "ufo/ObsDiagnostics.h"
 #include "ufo/utils/Constants.h"
 
 namespace ufo {
@@ -105,27 +106,11 @@ void CloudDetectMinResidualAVHRR::compute(const ObsFilterData & in,
                      channels_)[ichan], dbtdts[ichan]);
   }
 
-  // Get temperature jacobian
-  std::vector<std::vector<std::vector<float>>>
-       dbtdt(nchans, std::vector<std::vector<float>>(nlevs, std::vector<float>(nlocs)));
-  for (size_t ichan = 0; ichan < nchans; ++ichan) {
-    for (size_t ilev = 0; ilev < nlevs; ++ilev) {
-      int level = nlevs - ilev;
-      in.get(Variable("brightness_temperature_jacobian_air_temperature@ObsDiag",
-                       channels_)[ichan], level, dbtdt[ichan][ilev]);
-    }
-  }
-
-  // Get layer-to-space transmittance
-  std::vector<std::vector<std::vector<float>>>
-       tao(nchans, std::vector<std::vector<float>>(nlevs, std::vector<float>(nlocs)));
-  for (size_t ichan = 0; ichan < nchans; ++ichan) {
-    for (size_t ilev = 0; ilev < nlevs; ++ilev) {
-      int level = nlevs - ilev;
-      in.get(Variable("transmittances_of_atmosphere_layer@ObsDiag",
-             channels_)[ichan], level,  tao[ichan][ilev]);
-    }
-  }
+  // Get temperature jacobian (level index ilev used below corresponds to the tensor level
+  // index nlevs - 1 - ilev)
+  const ObsDiagnosticsTensor & dbtdt =
+      in.getTensor(Variable("brightness_temperature_jacobian_air_temperature@ObsDiag", channels_));
+  ASSERT(dbtdt.nlevs() >= nlevs);
 
   // Get pressure level at the peak of the weighting function
   std::vector<float> values(nlocs, 0.0);
@@ -273,7 +258,7 @@ void CloudDetectMinResidualAVHRR::compute(const ObsFilterData & in,
             dbt[ichan][k] = (tair[k][iloc] - tsavg[iloc]) * dbtdts[ichan][iloc];
             for (size_t kk = 0; kk < k; ++kk) {
               dbt[ichan][k] = dbt[ichan][k] + (tair[k][iloc] - tair[kk][iloc]) *
-                              dbtdt[ichan][kk][iloc];
+                              dbtdt(ichan, nlevs - 1 - kk, iloc);
             }
             sum = sum + innovation[ichan][iloc] * dbt[ichan][k] * varinv_use[ichan][iloc];
             sum2 = sum2 +  dbt[ichan][k] * dbt[ichan][k] * varinv_use[ichan][iloc];
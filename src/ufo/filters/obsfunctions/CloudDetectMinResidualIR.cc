@@ -21,6 +21,7 @@
 #include "oops/util/IntSetParser.h"
 #include "oops/util/missingValues.h"
 #include "ufo/filters/Variable.h"
+#include "ufo/ObsDiagnostics.h"
 #include "ufo/utils/Constants.h"
 
 namespace ufo {
@@ -102,27 +103,15 @@ void CloudDetectMinResidualIR::compute(const ObsFilterData & in,
                      channels_)[ichan], dbtdts[ichan]);
   }
 
-  // Get temperature jacobian
-  std::vector<std::vector<std::vector<float>>>
-       dbtdt(nchans, std::vector<std::vector<float>>(nlevs, std::vector<float>(nlocs)));
-  for (size_t ichan = 0; ichan < nchans; ++ichan) {
-    for (size_t ilev = 0; ilev < nlevs; ++ilev) {
-      int level = nlevs - ilev;
-      in.get(Variable("brightness_temperature_jacobian_air_temperature@ObsDiag",
-                       channels_)[ichan], level, dbtdt[ichan][ilev]);
-    }
-  }
+  // Get temperature jacobian (level index ilev used below corresponds to the tensor level
+  // index nlevs - 1 - ilev)
+  const ObsDiagnosticsTensor & dbtdt =
+      in.getTensor(Variable("brightness_temperature_jacobian_air_temperature@ObsDiag", channels_));
 
   // Get layer-to-space transmittance
-  std::vector<std::vector<std::vector<float>>>
-       tao(nchans, std::vector<std::vector<float>>(nlevs, std::vector<float>(nlocs)));
-  for (size_t ichan = 0; ichan < nchans; ++ichan) {
-    for (size_t ilev = 0; ilev < nlevs; ++ilev) {
-      int level = nlevs - ilev;
-      in.get(Variable("transmittances_of_atmosphere_layer@ObsDiag",
-             channels_)[ichan], level,  tao[ichan][ilev]);
-    }
-  }
+  const ObsDiagnosticsTensor & tao =
+      in.getTensor(Variable("transmittances_of_atmosphere_layer@ObsDiag", channels_));
+  ASSERT(dbtdt.nlevs() >= nlevs && tao.nlevs() >= nlevs);
 
   // Get pressure level at the peak of the weighting function
   std::vector<float> values(nlocs, 0.0);
@@ -140,9 +129,11 @@ void CloudDetectMinResidualIR::compute(const ObsFilterData & in,
   const float missing = util::missingValue(missing);
   std::vector<int> qcflag(nlocs, 0);
   std::vector<std::vector<float>> varinv_use(nchans, std::vector<float>(nlocs, 0.0));
+  const Variable errvar("brightness_temperature@"+errgrp, channels_);
+  const Variable flagvar("brightness_temperature@"+flaggrp, channels_);
   for (size_t ichan = 0; ichan < nchans; ++ichan) {
-    in.get(Variable("brightness_temperature@"+errgrp, channels_)[ichan], values);
-    in.get(Variable("brightness_temperature@"+flaggrp, channels_)[ichan], qcflag);
+    in.get(errvar.handle(ichan), values);
+    in.get(flagvar.handle(ichan), qcflag);
     for (size_t iloc = 0; iloc < nlocs; ++iloc) {
       if (flaggrp == "PreQC") values[iloc] == missing ? qcflag[iloc] = 100 : qcflag[iloc] = 0;
       (qcflag[iloc] == 0) ? (values[iloc] = 1.0 / pow(values[iloc], 2)) : (values[iloc] = 0.0);
@@ -152,9 +143,11 @@ void CloudDetectMinResidualIR::compute(const ObsFilterData & in,
 
   // Get bias corrected innovation (tbobs - hofx) (hofx includes bias correction)
   std::vector<std::vector<float>> innovation(nchans, std::vector<float>(nlocs));
+  const Variable obsvar("brightness_temperature@ObsValue", channels_);
+  const Variable hofxvar("brightness_temperature@"+hofxgrp, channels_);
   for (size_t ichan = 0; ichan < nchans; ++ichan) {
-    in.get(Variable("brightness_temperature@ObsValue", channels_)[ichan], innovation[ichan]);
-    in.get(Variable("brightness_temperature@"+hofxgrp, channels_)[ichan], values);
+    in.get(obsvar.handle(ichan), innovation[ichan]);
+    in.get(hofxvar.handle(ichan), values);
     for (size_t iloc = 0; iloc < nlocs; ++iloc) {
       innovation[ichan][iloc] = innovation[ichan][iloc] - values[iloc];
     }
@@ -162,8 +155,9 @@ void CloudDetectMinResidualIR::compute(const ObsFilterData & in,
 
   // Get original observation error (uninflated) from ObsSpaec
   std::vector<std::vector<float>> obserr(nchans, std::vector<float>(nlocs));
+  const Variable obserrvar("brightness_temperature@ObsError", channels_);
   for (size_t ichan = 0; ichan < nchans; ++ichan) {
-    in.get(Variable("brightness_temperature@ObsError", channels_)[ichan], obserr[ichan]);
+    in.get(obserrvar.handle(ichan), obserr[ichan]);
   }
 
   // Get variables from GeoVaLS
@@ -274,7 +268,8 @@ void CloudDetectMinResidualIR::compute(const ObsFilterData & in,
         }
         for (size_t kk = 0; kk < k; ++kk) {
           for (size_t ichan = 0; ichan < nchans; ++ichan) {
-            dbt[ichan] = dbt[ichan] + (tair[k][iloc] - tair[kk][iloc]) * dbtdt[ichan][kk][iloc];
+            dbt[ichan] = dbt[ichan] + (tair[k][iloc] - tair[kk][iloc]) *
+                         dbtdt(ichan, nlevs - 1 - kk, iloc);
           }
         }
         sum = 0.0;
@@ -310,7 +305,7 @@ void CloudDetectMinResidualIR::compute(const ObsFilterData & in,
     if (lcloud > 0) {
       for (size_t ichan = 0; ichan < nchans; ++ichan) {
         // Get cloud top transmittance
-        tao_cld = tao[ichan][lcloud-1][iloc];
+        tao_cld = tao(ichan, nlevs - lcloud, iloc);
         // Passive channels
         if (use_flag[ichan] < 0 && lcloud  >= wfunc_pmaxlev[ichan][iloc]) out[ichan][iloc] = 1;
         // Active channels
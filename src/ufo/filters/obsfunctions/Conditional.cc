@@ -5,6 +5,9 @@
  * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
  */
 
+#include <algorithm>
+#include <vector>
+
 #include "ioda/ObsDataVector.h"
 #include "oops/util/missingValues.h"
 #include "oops/util/parameters/Parameter.h"
@@ -21,33 +24,39 @@ Conditional::Conditional(const eckit::LocalConfiguration & conf)
   options_.validateAndDeserialize(conf);
 
   // Populate invars_
-  for (const LocalConditionalParameters &lcp : options_.cases.value())
+  for (const LocalConditionalParameters &lcp : options_.cases.value()) {
     invars_ += getAllWhereVariables(lcp.where);
+    caseWheres_.emplace_back(lcp.where);
+  }
 }
 
 // -----------------------------------------------------------------------------
 void Conditional::compute(const ObsFilterData & in,
                                 ioda::ObsDataVector<float> & out) const {
-  // Assign default value to array
-  const float missing = util::missingValue(float());
-  for (size_t ivar = 0; ivar < out.nvars(); ++ivar) {
-    std::fill(out[ivar].begin(), out[ivar].end(), options_.defaultvalue.value().value_or(missing));
-  }  // ivar
-
-  // Assign values based on the where clauses from the configuration.
+  // Evaluate the where clauses of all cases first, then assign values in a single pass.
   // if firstmatchingcase is true, the first case that is true assigns the value.
   // if firstmatchingcase is false, the last matching case will assign the value.
-  std::vector<bool> applied(out.nlocs(), false);
-  for (const LocalConditionalParameters &lcp : options_.cases.value()) {
-    std::vector<bool> apply = processWhere(lcp.where, in);
-    for (size_t iloc = 0; iloc < out.nlocs(); ++iloc) {
-      if (apply[iloc] && applied[iloc] == false) {
-        for (size_t ivar = 0; ivar < out.nvars(); ++ivar)
-          out[ivar][iloc] = lcp.value.value();
-        if (options_.firstmatchingcase.value()) applied[iloc] = true;
-      }  // if apply
-    }  // iloc
-  }  // lcp
+  const std::vector<LocalConditionalParameters> &cases = options_.cases.value();
+  std::vector<std::vector<bool>> caseApplies;
+  caseApplies.reserve(cases.size());
+  for (const CompiledWhere &where : caseWheres_)
+    caseApplies.push_back(where.evaluate(in));
+
+  const float missing = util::missingValue(float());
+  std::vector<float> values(out.nlocs(), options_.defaultvalue.value().value_or(missing));
+  const bool firstmatchingcase = options_.firstmatchingcase.value();
+  for (size_t iloc = 0; iloc < out.nlocs(); ++iloc) {
+    for (size_t jcase = 0; jcase < cases.size(); ++jcase) {
+      const size_t icase = firstmatchingcase ? jcase : cases.size() - 1 - jcase;
+      if (caseApplies[icase][iloc]) {
+        values[iloc] = cases[icase].value.value();
+        break;
+      }
+    }  // jcase
+  }  // iloc
+
+  for (size_t ivar = 0; ivar < out.nvars(); ++ivar)
+    std::copy(values.begin(), values.end(), out[ivar].begin());
 }  // compute
 
 // -----------------------------------------------------------------------------
@@ -108,6 +108,8 @@ class Conditional : public ObsFunctionBase {
  private:
   ufo::Variables invars_;
   ConditionalParameters options_;
+  /// The `where` clauses of successive cases.
+  std::vector<CompiledWhere> caseWheres_;
 };
 
 // -----------------------------------------------------------------------------
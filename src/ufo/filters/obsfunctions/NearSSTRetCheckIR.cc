@@ -20,6 +20,7 @@
 #include "oops/util/IntSetParser.h"
 #include "oops/util/missingValues.h"
 #include "ufo/filters/Variable.h"
+#include "ufo/ObsDiagnostics.h"
 #include "ufo/utils/Constants.h"
 
 namespace ufo {
@@ -94,27 +95,14 @@ void NearSSTRetCheckIR::compute(const ObsFilterData & in,
                      channels_)[ichan], dbtdts[ichan]);
   }
 
-  // Get temperature jacobian
-  std::vector<std::vector<std::vector<float>>>
-       dbtdt(nchans, std::vector<std::vector<float>>(nlevs, std::vector<float>(nlocs)));
-  for (size_t ichan = 0; ichan < nchans; ++ichan) {
-    for (size_t ilev = 0; ilev < nlevs; ++ilev) {
-      int level = nlevs - ilev;
-      in.get(Variable("brightness_temperature_jacobian_air_temperature@ObsDiag",
-                       channels_)[ichan], level, dbtdt[ichan][ilev]);
-    }
-  }
+  // Get temperature and moisture jacobians (level index ilev used below corresponds to the
+  // tensor level index nlevs - 1 - ilev)
+  const ObsDiagnosticsTensor & dbtdt =
+      in.getTensor(Variable("brightness_temperature_jacobian_air_temperature@ObsDiag", channels_));
 
-  // Get moisture jacobian
-  std::vector<std::vector<std::vector<float>>>
-       dbtdq(nchans, std::vector<std::vector<float>>(nlevs, std::vector<float>(nlocs)));
-  for (size_t ichan = 0; ichan < nchans; ++ichan) {
-    for (size_t ilev = 0; ilev < nlevs; ++ilev) {
-      int level = nlevs - ilev;
-      in.get(Variable("brightness_temperature_jacobian_humidity_mixing_ratio@ObsDiag",
-                       channels_)[ichan], level, dbtdq[ichan][ilev]);
-    }
-  }
+  const ObsDiagnosticsTensor & dbtdq = in.getTensor(
+      Variable("brightness_temperature_jacobian_humidity_mixing_ratio@ObsDiag", channels_));
+  ASSERT(dbtdt.nlevs() == nlevs && dbtdq.nlevs() == nlevs);
 
   // Get variables from ObsSpace
   // Get sensor band central radiation wavenumber
@@ -196,11 +184,11 @@ void NearSSTRetCheckIR::compute(const ObsFilterData & in,
       for (size_t ichan = 0; ichan < nchans; ++ichan) {
         if (use_flag[ichan] >= 1 && varinv[ichan][iloc] > 0.0 && irday[ichan] == 1
                                  && dbtdts[ichan][iloc] >= tschk) {
-          tb_ta[ichan] = dbtdt[ichan][nlevs-1][iloc];
-          tb_qa[ichan] = dbtdq[ichan][nlevs-1][iloc];
+          tb_ta[ichan] = dbtdt(ichan, 0, iloc);
+          tb_qa[ichan] = dbtdq(ichan, 0, iloc);
           for (size_t ilev = 0; ilev < nlevs-1; ++ilev) {
-            tb_ta[ichan] = tb_ta[ichan] + dbtdt[ichan][ilev][iloc];
-            tb_qa[ichan] = tb_qa[ichan] + dbtdq[ichan][ilev][iloc];
+            tb_ta[ichan] = tb_ta[ichan] + dbtdt(ichan, nlevs - 1 - ilev, iloc);
+            tb_qa[ichan] = tb_qa[ichan] + dbtdq(ichan, nlevs - 1 - ilev, iloc);
           }
         }
       }
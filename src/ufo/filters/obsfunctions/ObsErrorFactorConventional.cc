@@ -23,6 +23,7 @@
 #include "ufo/filters/Variable.h"
 #include "ufo/filters/Variables.h"
 #include "ufo/utils/Constants.h"
+#include "ufo/utils/RecordIndex.h"
 
 namespace ufo {
 
@@ -77,9 +78,6 @@ void ObsErrorFactorConventional::compute(const ObsFilterData & data,
   const size_t nlocs = data.nlocs();
   const size_t nlevs = data.nlevs(Variable("air_pressure@GeoVaLs"));
 
-  // Get obs space
-  auto & obsdb = data.obsspace();
-
   // Get output variable size
   int varsize = obserr.nvars();
 
@@ -112,6 +110,9 @@ void ObsErrorFactorConventional::compute(const ObsFilterData & data,
     data.get(Variable("air_pressure@GeoVaLs"), ilev+1, prsl[ilev]);
   }
 
+  // Using obs grouping/sorting indices
+  const RecordIndex &records = data.recordIndex();
+
   for (size_t iv = 0; iv < varsize; ++iv) {   // Variable loop
     // Get QC flags of test variable
     std::vector<int> ob_variable_QCflag(nlocs);
@@ -132,10 +133,8 @@ void ObsErrorFactorConventional::compute(const ObsFilterData & data,
     int icount = 0;
     int ireport = 0;
 
-    ioda::ObsSpace::RecIdxIter irec;   // Using obs grouping/sorting indices
-    for ( irec = obsdb.recidx_begin(); irec != obsdb.recidx_end(); ++irec ) {   // record loop
-      std:: size_t rNum = obsdb.recidx_recnum(irec);
-      std::vector<std::size_t> rSort = obsdb.recidx_vector(irec);
+    for (size_t irec = 0; irec < records.numRecords(); ++irec) {   // record loop
+      const RecordIndex::Record rSort = records[irec];
 
       ireport++;
       for (size_t iloc = 0; iloc < rSort.size(); ++iloc) {   // profile loop
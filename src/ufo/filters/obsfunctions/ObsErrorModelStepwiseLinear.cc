@@ -6,6 +6,8 @@
  */
 
 #include <memory>
+#include <vector>
+
 #include <boost/optional/optional_io.hpp>
 
 #include "ufo/filters/obsfunctions/ObsErrorModelStepwiseLinear.h"
@@ -79,6 +81,8 @@ ObsErrorModelStepwiseLinear::ObsErrorModelStepwiseLinear(const eckit::LocalConfi
       throw eckit::BadValue(errString.str());
     }
   }
+  errorModel_.reset(new PiecewiseLinearKernel<float>(xvals, errors));
+
   oops::Log::debug() << "ObsErrorModelStepwiseLinear: config (constructor) = "
                      << config << std::endl;
 }
@@ -92,19 +96,13 @@ ObsErrorModelStepwiseLinear::~ObsErrorModelStepwiseLinear() {}
 void ObsErrorModelStepwiseLinear::compute(const ObsFilterData & data,
                                      ioda::ObsDataVector<float> & obserr) const {
   const float missing = util::missingValue(missing);
-  // Linearly interpolate from y0 to y1 at xstar between x0 and x1 to arrive at error
-  float x0, x1, y0, y1;
-  float xstar, error;
 
-  // Get the x-variable name and piece-wise parameters from options
+  // Get the x-variable name from options
   const Variable &xvar = options_.xvar.value();
-  const std::vector<float> &xvals = options_.xvals.value();
-  const std::vector<float> &errors = options_.errors.value();
   oops::Log::debug() << "  ObsErrorModelStepwiseLinear, x-variable name: " << xvar.variable()
                      << "  and group: " << xvar.group() << std::endl;
 
   // Populate the testdata array.  xstar is just the 0..nloc-1 value of testvar[iv]
-  // At each nloc, find matching (x0,x1) and (y0,y1) pair for linear interp.
   ioda::ObsDataVector<float> testdata(data.obsspace(), xvar.toOopsVariables());
   data.get(xvar, testdata);
 
@@ -132,37 +130,23 @@ void ObsErrorModelStepwiseLinear::compute(const ObsFilterData & data,
     throw eckit::BadValue(errString.str());
   }
 
-  for (size_t jobs = 0; jobs < testdata[iv].size(); ++jobs) {
-    error = 0.0;
+  // Linearly interpolate the errors to all locations at once (beyond the range of xvals the
+  // first or last error is used), then discard the values at locations where xstar is missing.
+  const size_t nlocs = testdata[iv].size();
+  std::vector<float> errors(nlocs);
+  errorModel_->evaluate(nlocs, testdata[iv].data(), errors.data());
+
+  for (size_t jobs = 0; jobs < nlocs; ++jobs) {
     obserr[iv][jobs] = missing;
     if (testdata[iv][jobs] == missing) {
       continue;
     }
-    xstar = testdata[iv][jobs];
-    if ((xstar <= xvals[0] && isAscending_) || (xstar >= xvals[0] && !isAscending_)) {
-      error = errors[0];
-    } else if ((xstar >= xvals.back() && isAscending_)
-              || (xstar <= xvals.back() && !isAscending_)) {
-      error = errors[errors.size()-1];
-    } else {
-      for (size_t kv = 1; kv < xvals.size(); ++kv) {
-        if ((isAscending_ && (xstar > xvals[kv-1]) && (xstar <= xvals[kv])) ||
-              (!isAscending_ && (xstar < xvals[kv-1]) && (xstar >= xvals[kv]))) {
-          x0 = xvals[kv-1];
-          x1 = xvals[kv];
-          y0 = errors[kv-1];
-          y1 = errors[kv];
-          error = y0 + (xstar-x0)*((y1-y0)/(x1-x0));
-          break;
-        }
-      }
-    }
     // TODO(gthompsn):  probably need this next line for when filtervariable is flagged missing
     // if (!flagged_[jv][jobs]) obserr[jv][jobs] = error;
     if (multiplicative_) {
-      obserr[iv][jobs] = error*(*obvalues)[iv][jobs];
+      obserr[iv][jobs] = errors[jobs]*(*obvalues)[iv][jobs];
     } else {
-      obserr[iv][jobs] = error;
+      obserr[iv][jobs] = errors[jobs];
     }
   }
 }
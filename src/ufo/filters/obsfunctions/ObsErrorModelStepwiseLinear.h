@@ -8,6 +8,7 @@
 #ifndef UFO_FILTERS_OBSFUNCTIONS_OBSERRORMODELSTEPWISELINEAR_H_
 #define UFO_FILTERS_OBSFUNCTIONS_OBSERRORMODELSTEPWISELINEAR_H_
 
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -21,6 +22,7 @@
 #include "ufo/filters/ObsFilterData.h"
 #include "ufo/filters/obsfunctions/ObsFunctionBase.h"
 #include "ufo/filters/Variables.h"
+#include "ufo/utils/PiecewiseLinearInterpolation.h"
 #include "ufo/utils/parameters/ParameterTraitsVariable.h"
 
 namespace ufo {
@@ -105,6 +107,8 @@ class ObsErrorModelStepwiseLinear : public ObsFunctionBase {
   ObsErrorModelStepwiseLinearParameters options_;
   bool isAscending_ = true;
   bool multiplicative_ = false;
+  /// Maps xvar to the observation error (or scale factor).
+  std::unique_ptr<PiecewiseLinearKernel<float>> errorModel_;
 };
 
 // -----------------------------------------------------------------------------
@@ -7,10 +7,16 @@
 
 #include "ufo/filters/processWhere.h"
 
+#include <algorithm>
 #include <bitset>
+#include <map>
+#include <memory>
 #include <regex>
 #include <set>
+#include <sstream>
 #include <string>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "eckit/config/LocalConfiguration.h"
@@ -21,6 +27,7 @@
 #include "oops/util/wildcard.h"
 #include "ufo/filters/ObsFilterData.h"
 #include "ufo/filters/Variables.h"
+#include "ufo/utils/DictionaryEncodedStrings.h"
 
 namespace ufo {
 
@@ -35,19 +42,25 @@ ufo::Variables getAllWhereVariables(const std::vector<WhereParameters> & params)
 }
 
 
+// -----------------------------------------------------------------------------
+// The functions below update a mask stored as a vector of chars rather than a std::vector<bool>,
+// so that (apart from those handling strings and datetimes) their loops are free of branches and
+// bit manipulation and can be vectorised by the compiler.
 // -----------------------------------------------------------------------------
 template<typename T>
 void processWhereMinMax(const std::vector<T> & data,
                         const T & vmin, const T & vmax,
-                        std::vector<bool> & mask) {
+                        std::vector<char> & mask) {
   const T not_set_value = util::missingValue(not_set_value);
   const size_t n = data.size();
 
-  if (vmin != not_set_value || vmax != not_set_value) {
-    for (size_t jj = 0; jj < n; ++jj) {
-      if (vmin != not_set_value && data[jj] < vmin) mask[jj] = false;
-      if (vmax != not_set_value && data[jj] > vmax) mask[jj] = false;
-    }
+  if (vmin != not_set_value) {
+    for (size_t jj = 0; jj < n; ++jj)
+      mask[jj] &= !(data[jj] < vmin);
+  }
+  if (vmax != not_set_value) {
+    for (size_t jj = 0; jj < n; ++jj)
+      mask[jj] &= !(data[jj] > vmax);
   }
 }
 
@@ -55,7 +68,7 @@ void processWhereMinMax(const std::vector<T> & data,
 // -----------------------------------------------------------------------------
 void processWhereMinMax(const std::vector<util::DateTime> & data,
                         const util::PartialDateTime & vmin, const util::PartialDateTime & vmax,
-                        std::vector<bool> & mask) {
+                        std::vector<char> & mask) {
   const util::PartialDateTime not_set_value {};
 
   if (vmin != not_set_value || vmax != not_set_value) {
@@ -69,32 +82,31 @@ void processWhereMinMax(const std::vector<util::DateTime> & data,
 
 // -----------------------------------------------------------------------------
 void processWhereIsDefined(const std::vector<float> & data,
-                           std::vector<bool> & mask) {
+                           std::vector<char> & mask) {
   const float missing = util::missingValue(missing);
   const size_t n = data.size();
-  for (size_t jj = 0; jj < n; ++jj) {
-    if (data[jj] == missing) mask[jj] = false;
-  }
+  for (size_t jj = 0; jj < n; ++jj)
+    mask[jj] &= (data[jj] != missing);
 }
 
 // -----------------------------------------------------------------------------
 
 void processWhereIsNotDefined(const std::vector<float> & data,
-                              std::vector<bool> & mask) {
+                              std::vector<char> & mask) {
   const float missing = util::missingValue(missing);
   const size_t n = data.size();
-  for (size_t jj = 0; jj < n; ++jj) {
-    if (data[jj] != missing) mask[jj] = false;
-  }
+  for (size_t jj = 0; jj < n; ++jj)
+    mask[jj] &= (data[jj] == missing);
 }
 
 // -----------------------------------------------------------------------------
-template <class T>
-void processWhereIsIn(const std::vector<T> & data,
-                      const std::set<T> & whitelist,
-                      std::vector<bool> & mask) {
+void processWhereIsIn(const std::vector<int> & data,
+                      const std::set<int> & whitelist,
+                      std::vector<char> & mask) {
+  const std::vector<int> sortedWhitelist(whitelist.begin(), whitelist.end());
   for (size_t jj = 0; jj < data.size(); ++jj) {
-    if (!oops::contains(whitelist, data[jj])) mask[jj] = false;
+    if (mask[jj] && !std::binary_search(sortedWhitelist.begin(), sortedWhitelist.end(), data[jj]))
+      mask[jj] = false;
   }
 }
 
@@ -102,8 +114,9 @@ void processWhereIsIn(const std::vector<T> & data,
 void processWhereIsClose(const std::vector<float> & data,
                          const float tolerance, const bool relative,
                          const std::vector<float> & whitelist,
-                         std::vector<bool> & mask) {
+                         std::vector<char> & mask) {
   for (size_t jj = 0; jj < data.size(); ++jj) {
+    if (!mask[jj]) continue;
     bool inlist = false;
     for (auto testvalue : whitelist) {
       if (relative) {
@@ -124,22 +137,15 @@ void processWhereIsClose(const std::vector<float> & data,
 }
 
 // -----------------------------------------------------------------------------
-template <class T>
-void processWhereIsNotIn(const std::vector<T> & data,
-                         const std::set<T> & blacklist,
-                         std::vector<bool> & mask) {
-  const T missing = util::missingValue(missing);
+void processWhereIsNotIn(const std::vector<int> & data,
+                         const std::set<int> & blacklist,
+                         std::vector<char> & mask) {
+  const int missing = util::missingValue(missing);
+  const std::vector<int> sortedBlacklist(blacklist.begin(), blacklist.end());
   for (size_t jj = 0; jj < data.size(); ++jj) {
-    if (data[jj] == missing || oops::contains(blacklist, data[jj])) mask[jj] = false;
-  }
-}
-
-// -----------------------------------------------------------------------------
-void processWhereIsNotIn(const std::vector<std::string> & data,
-                         const std::set<std::string> & blacklist,
-                         std::vector<bool> & mask) {
-  for (size_t jj = 0; jj < data.size(); ++jj) {
-    if (oops::contains(blacklist, data[jj])) mask[jj] = false;
+    if (mask[jj] && (data[jj] == missing ||
+                     std::binary_search(sortedBlacklist.begin(), sortedBlacklist.end(), data[jj])))
+      mask[jj] = false;
   }
 }
 
@@ -147,9 +153,10 @@ void processWhereIsNotIn(const std::vector<std::string> & data,
 void processWhereIsNotClose(const std::vector<float> & data,
                             const float tolerance, const bool relative,
                             const std::vector<float> & blacklist,
-                            std::vector<bool> & mask) {
+                            std::vector<char> & mask) {
   const float missing = util::missingValue(missing);
   for (size_t jj = 0; jj < data.size(); ++jj) {
+    if (!mask[jj]) continue;
     for (auto testvalue : blacklist) {
       if (relative) {
         float relativetolerance = testvalue * tolerance;
@@ -170,133 +177,53 @@ void processWhereIsNotClose(const std::vector<float> & data,
 }
 
 // -----------------------------------------------------------------------------
-template <typename T>
-void applyMinMax(std::vector<bool> & where, WhereParameters const & parameters,
-                 ObsFilterData const & filterdata, Variable const & varname) {
-  const T not_set_value = util::missingValue(not_set_value);
-
-  // Set vmin to the value of the 'minvalue' option if it exists; if not, leave vmin unchanged.
-  T vmin = not_set_value;
-  if (parameters.minvalue.value() != boost::none)
-    vmin = parameters.minvalue.value()->as<T>();
-  // Set vmax to the value of the 'maxvalue' option if it exists; if not, leave vmax unchanged.
-  T vmax = not_set_value;
-  if (parameters.maxvalue.value() != boost::none)
-    vmax = parameters.maxvalue.value()->as<T>();
-
-  // Apply mask min/max
-  if (vmin != not_set_value || vmax != not_set_value) {
-    std::vector<T> data;
-    filterdata.get(varname, data);
-    processWhereMinMax(data, vmin, vmax, where);
-  }
-}
-
-// -----------------------------------------------------------------------------
-template <>
-void applyMinMax<util::DateTime>(std::vector<bool> & where, WhereParameters const & parameters,
-                                 ObsFilterData const & filterdata, Variable const & varname) {
-  util::PartialDateTime vmin {}, vmax {}, not_set_value {};
-  if (parameters.minvalue.value() != boost::none)
-    vmin = parameters.minvalue.value()->as<util::PartialDateTime>();
-  if (parameters.maxvalue.value() != boost::none)
-    vmax = parameters.maxvalue.value()->as<util::PartialDateTime>();
-
-  // Apply mask min/max
-  if (vmin != not_set_value || vmax != not_set_value) {
-    std::vector<util::DateTime> data;
-    filterdata.get(varname, data);
-    processWhereMinMax(data, vmin, vmax, where);
+/// \brief Return an integer in which all bits with indices `bitIndices` are set.
+int bitMask(const std::set<int> & bitIndices) {
+  std::bitset<32> mask_bs;
+  for (const int &bitIndex : bitIndices) {
+    mask_bs[bitIndex] = 1;
   }
+  return mask_bs.to_ulong();
 }
 
 // -----------------------------------------------------------------------------
 /// \brief Process an `any_bit_set_of` keyword in a `where` clause.
 ///
 /// This function sets to `false` all elements of `where` corresponding to elements of `data` in
-/// which all bits with indices `bitIndices` are zero. Bits are numbered from 0 starting from the
+/// which all bits set in `bitMask` are zero. Bits are numbered from 0 starting from the
 /// least significant bit.
 ///
 /// The vectors `data` and `where` must be of the same length.
 ///
-/// Example: Suppose `data` is set to [1, 3, 4, 8] and bitIndices to [0, 2]. Then this function will
-/// set only the last element of `where` to false, since 8 is the only integer from `data` in whose
-/// binary representation both bits 0 and 2 are zero.
+/// Example: Suppose `data` is set to [1, 3, 4, 8] and `bitMask` to 5 (bits 0 and 2). Then this
+/// function will set only the last element of `where` to false, since 8 is the only integer from
+/// `data` in whose binary representation both bits 0 and 2 are zero.
 void processWhereAnyBitSetOf(const std::vector<int> & data,
-                             const std::set<int> & bitIndices,
-                             std::vector<bool> & where) {
-  std::bitset<32> mask_bs;
-  for (const int &bitIndex : bitIndices) {
-    mask_bs[bitIndex] = 1;
-  }
-  const int mask = mask_bs.to_ulong();
-
-  for (size_t jj = 0; jj < data.size(); ++jj) {
-    if ((data[jj] & mask) == 0) {
-      // None of the specified bits is set
-      where[jj] = false;
-    }
-  }
+                             const int bitMask,
+                             std::vector<char> & where) {
+  const size_t n = data.size();
+  for (size_t jj = 0; jj < n; ++jj)
+    where[jj] &= ((data[jj] & bitMask) != 0);
 }
 
 // -----------------------------------------------------------------------------
 /// \brief Process an `any_bit_unset_of` keyword in a `where` clause.
 ///
 /// This function sets to `false` all elements of `where` corresponding to elements of `data` in
-/// which all bits with indices `bitIndices` are non-zero. Bits are numbered from 0 starting from
+/// which all bits set in `bitMask` are non-zero. Bits are numbered from 0 starting from
 /// the least significant bit.
 ///
 /// The vectors `data` and `where` must be of the same length.
 ///
-/// Example: Suppose `data` is set to [1, 3, 4, 5] and bitIndices to [0, 2]. Then this function will
-/// set only the last element of `where` to false, since 5 is the only integer from `data` in whose
-/// binary representation both bits 0 and 2 are non-zero.
+/// Example: Suppose `data` is set to [1, 3, 4, 5] and `bitMask` to 5 (bits 0 and 2). Then this
+/// function will set only the last element of `where` to false, since 5 is the only integer from
+/// `data` in whose binary representation both bits 0 and 2 are non-zero.
 void processWhereAnyBitUnsetOf(const std::vector<int> & data,
-                               const std::set<int> & bitIndices,
-                               std::vector<bool> & where) {
-  std::bitset<32> mask_bs;
-  for (const int &bitIndex : bitIndices) {
-    mask_bs[bitIndex] = 1;
-  }
-  const int mask = mask_bs.to_ulong();
-
-  for (size_t jj = 0; jj < data.size(); ++jj) {
-    if ((data[jj] & mask) == mask) {
-      // None of the specified bits is unset
-      where[jj] = false;
-    }
-  }
-}
-
-// -----------------------------------------------------------------------------
-/// \brief Process a `matches_regex` keyword in a `where` clause.
-///
-/// This function sets to `false` all elements of `where` corresponding to elements of `data` that
-/// do not match the regular expression `pattern`. The vectors `data` and `where` must be of the
-/// same length.
-void processWhereMatchesRegex(const std::vector<std::string> & data,
-                              const std::string & pattern,
-                              std::vector<bool> & where) {
-  std::regex regex(pattern);
-  for (size_t jj = 0; jj < data.size(); ++jj) {
-    if (where[jj] && !std::regex_match(data[jj], regex))
-      where[jj] = false;
-  }
-}
-
-/// \brief Process a `matches_regex` keyword in a `where` clause.
-///
-/// This function sets to `false` all elements of `where` corresponding to elements of `data` whose
-/// string representations do not match the regular expression `pattern`. The vectors `data` and
-/// `where` must be of the same length.
-void processWhereMatchesRegex(const std::vector<int> & data,
-                              const std::string & pattern,
-                              std::vector<bool> & where) {
-  std::regex regex(pattern);
-  for (size_t jj = 0; jj < data.size(); ++jj) {
-    if (where[jj] && !std::regex_match(std::to_string(data[jj]), regex))
-      where[jj] = false;
-  }
+                               const int bitMask,
+                               std::vector<char> & where) {
+  const size_t n = data.size();
+  for (size_t jj = 0; jj < n; ++jj)
+    where[jj] &= ((data[jj] & bitMask) != bitMask);
 }
 
 // -----------------------------------------------------------------------------
@@ -312,287 +239,408 @@ bool stringMatchesAnyWildcardPattern(const std::string &string,
                      { return util::matchesWildcardPattern(string, pattern); });
 }
 
-/// \brief Function used to process a `matches_wildcard` or `matches_any_wildcard` keyword in a
-/// `where` clause.
+// -----------------------------------------------------------------------------
+/// \brief Set to `false` all elements of `where` corresponding to elements of `data` for which
+/// `predicate` returns false.
 ///
-/// This function sets to `false` all elements of `where` corresponding to elements of `data` that
-/// do not match any of the patterns from the list `patterns`. The patterns may contain wildcards
-/// `*` (matching any sequence of characters) and `?` (matching a single character). The vectors
-/// `data` and `where` must be of the same length.
-void processWhereMatchesAnyWildcardPattern(const std::vector<std::string> & data,
-                                           const std::vector<std::string> & patterns,
-                                           std::vector<bool> & where) {
-  for (size_t jj = 0; jj < data.size(); ++jj) {
-    if (where[jj] && !stringMatchesAnyWildcardPattern(data[jj], patterns))
-      where[jj] = false;
+/// The predicate is evaluated at most once for each distinct string, and only for strings
+/// occurring at locations at which `where` is still true.
+template <typename Predicate>
+void processWhereStringPredicate(const DictionaryEncodedStrings & data,
+                                 const Predicate & predicate,
+                                 std::vector<char> & where) {
+  const signed char unknown = -1;
+  const std::vector<int> & codes = data.codes();
+  std::vector<signed char> resultByCode(data.dictionary().size(), unknown);
+  for (size_t jj = 0; jj < codes.size(); ++jj) {
+    if (!where[jj]) continue;
+    signed char &result = resultByCode[codes[jj]];
+    if (result == unknown)
+      result = predicate(data.dictionary()[codes[jj]]);
+    where[jj] = result;
   }
 }
 
 /// \overload Same as the function above, but taking a vector of integers rather than strings.
-/// The integers are converted to strings before pattern matching.
-void processWhereMatchesAnyWildcardPattern(const std::vector<int> & data,
-                                           const std::vector<std::string> & patterns,
-                                           std::vector<bool> & where) {
+/// The integers are converted to strings before being passed to `predicate`.
+template <typename Predicate>
+void processWhereStringPredicate(const std::vector<int> & data,
+                                 const Predicate & predicate,
+                                 std::vector<char> & where) {
+  std::unordered_map<int, char> resultByValue;
   for (size_t jj = 0; jj < data.size(); ++jj) {
-    if (where[jj] && !stringMatchesAnyWildcardPattern(std::to_string(data[jj]), patterns))
-      where[jj] = false;
+    if (!where[jj]) continue;
+    auto it = resultByValue.find(data[jj]);
+    if (it == resultByValue.end())
+      it = resultByValue.emplace(data[jj], predicate(std::to_string(data[jj]))).first;
+    where[jj] = it->second;
   }
 }
 
 // -----------------------------------------------------------------------------
-void isInString(std::vector<bool> & where, std::vector<std::string> const & allowedValues,
-                ObsFilterData const & filterdata, Variable const & varname) {
-  std::vector<std::string> data;
-  std::set<std::string> whitelist(allowedValues.begin(), allowedValues.end());
-  filterdata.get(varname, data);
-  processWhereIsIn(data, whitelist, where);
-}
+/// \brief Provides access to the values of variables referenced in `where` clauses.
+///
+/// Each variable is retrieved from ObsFilterData only on first use and then shared by all
+/// clauses referencing it.
+class WhereData {
+ public:
+  explicit WhereData(const ObsFilterData & filterdata) : filterdata_(filterdata) {}
+
+  template <typename T>
+  const std::vector<T> & get(const Variable & var, const std::string & key) {
+    std::map<std::string, std::vector<T>> &values = cache<T>();
+    auto it = values.find(key);
+    if (it == values.end()) {
+      std::vector<T> data;
+      filterdata_.get(var, data);
+      it = values.emplace(key, std::move(data)).first;
+    }
+    return it->second;
+  }
 
-// -----------------------------------------------------------------------------
-void isInInteger(std::vector<bool> & where, std::set<int> const & allowedValues,
-                 ObsFilterData const & filterdata, Variable const & varname) {
-  std::vector<int> data;
-  filterdata.get(varname, data);
-  processWhereIsIn(data, allowedValues, where);
+  const DictionaryEncodedStrings & getEncodedStrings(const Variable & var,
+                                                     const std::string & key) {
+    auto it = encodedStrings_.find(key);
+    if (it == encodedStrings_.end()) {
+      DictionaryEncodedStrings data;
+      filterdata_.get(var, data);
+      it = encodedStrings_.emplace(key, std::move(data)).first;
+    }
+    return it->second;
+  }
+
+  ioda::ObsDtype dtype(const Variable & var, const std::string & key) {
+    auto it = dtypes_.find(key);
+    if (it == dtypes_.end())
+      it = dtypes_.emplace(key, filterdata_.dtype(var)).first;
+    return it->second;
+  }
+
+  bool has(const Variable & var) const { return filterdata_.has(var); }
+
+ private:
+  template <typename T>
+  std::map<std::string, std::vector<T>> & cache();
+
+  const ObsFilterData & filterdata_;
+  std::map<std::string, std::vector<float>> floats_;
+  std::map<std::string, std::vector<int>> ints_;
+  std::map<std::string, std::vector<util::DateTime>> datetimes_;
+  std::map<std::string, DictionaryEncodedStrings> encodedStrings_;
+  std::map<std::string, ioda::ObsDtype> dtypes_;
+};
+
+template <>
+std::map<std::string, std::vector<float>> & WhereData::cache<float>() { return floats_; }
+template <>
+std::map<std::string, std::vector<int>> & WhereData::cache<int>() { return ints_; }
+template <>
+std::map<std::string, std::vector<util::DateTime>> & WhereData::cache<util::DateTime>() {
+  return datetimes_;
 }
 
 // -----------------------------------------------------------------------------
-void isNotInString(std::vector<bool> & where, std::vector<std::string> const & forbiddenValues,
-                   ObsFilterData const & filterdata, Variable const & varname) {
-  std::vector<std::string> data;
-  std::set<std::string> blacklist(forbiddenValues.begin(), forbiddenValues.end());
-  filterdata.get(varname, data);
-  processWhereIsNotIn(data, blacklist, where);
+template <typename T>
+void applyMinMax(std::vector<char> & where, WhereParameters const & parameters,
+                 WhereData & data, Variable const & varname, std::string const & key) {
+  const T not_set_value = util::missingValue(not_set_value);
+
+  // Set vmin to the value of the 'minvalue' option if it exists; if not, leave vmin unchanged.
+  T vmin = not_set_value;
+  if (parameters.minvalue.value() != boost::none)
+    vmin = parameters.minvalue.value()->as<T>();
+  // Set vmax to the value of the 'maxvalue' option if it exists; if not, leave vmax unchanged.
+  T vmax = not_set_value;
+  if (parameters.maxvalue.value() != boost::none)
+    vmax = parameters.maxvalue.value()->as<T>();
+
+  // Apply mask min/max
+  if (vmin != not_set_value || vmax != not_set_value)
+    processWhereMinMax(data.get<T>(varname, key), vmin, vmax, where);
 }
 
 // -----------------------------------------------------------------------------
-void isNotInInteger(std::vector<bool> & where, std::set<int> const & forbiddenValues,
-                    ObsFilterData const & filterdata, Variable const & varname) {
-  std::vector<int> data;
-  filterdata.get(varname, data);
-  processWhereIsNotIn(data, forbiddenValues, where);
+template <>
+void applyMinMax<util::DateTime>(std::vector<char> & where, WhereParameters const & parameters,
+                                 WhereData & data, Variable const & varname,
+                                 std::string const & key) {
+  util::PartialDateTime vmin {}, vmax {}, not_set_value {};
+  if (parameters.minvalue.value() != boost::none)
+    vmin = parameters.minvalue.value()->as<util::PartialDateTime>();
+  if (parameters.maxvalue.value() != boost::none)
+    vmax = parameters.maxvalue.value()->as<util::PartialDateTime>();
+
+  // Apply mask min/max
+  if (vmin != not_set_value || vmax != not_set_value)
+    processWhereMinMax(data.get<util::DateTime>(varname, key), vmin, vmax, where);
 }
 
 // -----------------------------------------------------------------------------
-std::vector<bool> processWhere(const std::vector<WhereParameters> & params,
-                               const ObsFilterData & filterdata) {
-  const size_t nlocs = filterdata.nlocs();
+/// \brief A single variable (channel) referenced by a `where` clause, together with the parts
+/// of the clause's options that are expensive to prepare.
+struct CompiledWhere::Predicate {
+  Predicate(const std::shared_ptr<const WhereParameters> & clause, const Variable & variable)
+    : clause(clause), variable(variable) {
+    std::stringstream ss;
+    ss << variable.variable() << '@' << variable.group() << ' ' << variable.options();
+    key = ss.str();
+    if (clause->matchesRegex.value() != boost::none)
+      regex = std::make_shared<const std::regex>(*clause->matchesRegex.value());
+    if (clause->matchesWildcard.value() != boost::none)
+      wildcardPatterns.push_back(*clause->matchesWildcard.value());
+    if (clause->matchesAnyWildcard.value() != boost::none)
+      anyWildcardPatterns = *clause->matchesAnyWildcard.value();
+    if (clause->anyBitSetOf.value() != boost::none)
+      anyBitSetOfMask = bitMask(*clause->anyBitSetOf.value());
+    if (clause->anyBitUnsetOf.value() != boost::none)
+      anyBitUnsetOfMask = bitMask(*clause->anyBitUnsetOf.value());
+  }
 
-// Everywhere by default if no mask
-  std::vector<bool> where(nlocs, true);
+  void apply(WhereData & data, std::vector<char> & where) const;
 
-  for (const WhereParameters &currentParams : params) {
-    const Variable &var = currentParams.variable;
-    for (size_t jvar = 0; jvar < var.size(); ++jvar) {
-      if (var.group() != "VarMetaData") {
-        const Variable varname = var[jvar];
-        ioda::ObsDtype dtype = filterdata.dtype(varname);
-
-        if (dtype == ioda::ObsDtype::DateTime) {
-          applyMinMax<util::DateTime>(where, currentParams, filterdata, varname);
-        } else if (dtype == ioda::ObsDtype::Integer) {
-          applyMinMax<int>(where, currentParams, filterdata, varname);
-        } else {
-          applyMinMax<float>(where, currentParams, filterdata, varname);
-        }
+  std::shared_ptr<const WhereParameters> clause;
+  Variable variable;
+  /// Identifies the variable in WhereData.
+  std::string key;
+  std::shared_ptr<const std::regex> regex;
+  std::vector<std::string> wildcardPatterns;
+  std::vector<std::string> anyWildcardPatterns;
+  int anyBitSetOfMask = 0;
+  int anyBitUnsetOfMask = 0;
+};
+
+// -----------------------------------------------------------------------------
+void CompiledWhere::Predicate::apply(WhereData & data, std::vector<char> & where) const {
+  const WhereParameters &currentParams = *clause;
+  const Variable &varname = variable;
+  const ioda::ObsDtype dtype = data.dtype(varname, key);
+
+  if (dtype == ioda::ObsDtype::DateTime) {
+    applyMinMax<util::DateTime>(where, currentParams, data, varname, key);
+  } else if (dtype == ioda::ObsDtype::Integer) {
+    applyMinMax<int>(where, currentParams, data, varname, key);
+  } else {
+    applyMinMax<float>(where, currentParams, data, varname, key);
+  }
 
 //      Apply mask is_defined
-        if (currentParams.isDefined.value()) {
-          if (filterdata.has(varname)) {
-            std::vector<float> data;
-            filterdata.get(varname, data);
-            processWhereIsDefined(data, where);
-          } else {
-            std::fill(where.begin(), where.end(), false);
-          }
-        }
+  if (currentParams.isDefined.value()) {
+    if (data.has(varname)) {
+      processWhereIsDefined(data.get<float>(varname, key), where);
+    } else {
+      std::fill(where.begin(), where.end(), false);
+    }
+  }
 
 //      Apply mask is_not_defined
-        if (currentParams.isNotDefined.value()) {
-          std::vector<float> data;
-          filterdata.get(varname, data);
-          processWhereIsNotDefined(data, where);
-        }
+  if (currentParams.isNotDefined.value()) {
+    processWhereIsNotDefined(data.get<float>(varname, key), where);
+  }
 
 //      Apply mask is_in
-        if (currentParams.isIn.value() != boost::none) {
-          if (dtype == ioda::ObsDtype::String) {
-            isInString(where, currentParams.isIn.value()->as<std::vector<std::string>>(),
-                       filterdata, varname);
-          } else if (dtype == ioda::ObsDtype::Integer) {
-            isInInteger(where, currentParams.isIn.value()->as<std::set<int>>(),
-                        filterdata, varname);
-          } else {
-            throw eckit::UserError(
-              "Only integer and string variables may be used for processWhere 'is_in'",
-              Here());
-          }
-        }
+  if (currentParams.isIn.value() != boost::none) {
+    if (dtype == ioda::ObsDtype::String) {
+      const std::vector<std::string> allowedValues =
+          currentParams.isIn.value()->as<std::vector<std::string>>();
+      const std::set<std::string> whitelist(allowedValues.begin(), allowedValues.end());
+      processWhereStringPredicate(data.getEncodedStrings(varname, key),
+                                  [&whitelist](const std::string &value)
+                                  { return oops::contains(whitelist, value); },
+                                  where);
+    } else if (dtype == ioda::ObsDtype::Integer) {
+      processWhereIsIn(data.get<int>(varname, key),
+                       currentParams.isIn.value()->as<std::set<int>>(), where);
+    } else {
+      throw eckit::UserError(
+        "Only integer and string variables may be used for processWhere 'is_in'",
+        Here());
+    }
+  }
 
 //      Apply mask is_close
-        if (currentParams.isClose.value() != boost::none) {
-          if (dtype == ioda::ObsDtype::Float) {
-            std::vector<float> data;
-            filterdata.get(varname, data);
-            if (currentParams.relativetolerance.value() == boost::none &&
-                currentParams.absolutetolerance.value() != boost::none) {
-              processWhereIsClose(data, currentParams.absolutetolerance.value().get(),
-                                  false, currentParams.isClose.value().get(), where);
-            } else if (currentParams.relativetolerance.value() != boost::none &&
-                       currentParams.absolutetolerance.value() == boost::none) {
-              processWhereIsClose(data, currentParams.relativetolerance.value().get(),
-                                  true, currentParams.isClose.value().get(), where);
-            } else {
-              throw eckit::UserError(
-                "For 'is_close' one (and only one) tolerance is needed.",
-                Here());
-            }
-          } else {
-            throw eckit::UserError(
-              "Only float variables may be used for processWhere 'is_close'",
-              Here());
-          }
-        }
+  if (currentParams.isClose.value() != boost::none) {
+    if (dtype == ioda::ObsDtype::Float) {
+      const std::vector<float> &values = data.get<float>(varname, key);
+      if (currentParams.relativetolerance.value() == boost::none &&
+          currentParams.absolutetolerance.value() != boost::none) {
+        processWhereIsClose(values, currentParams.absolutetolerance.value().get(),
+                            false, currentParams.isClose.value().get(), where);
+      } else if (currentParams.relativetolerance.value() != boost::none &&
+                 currentParams.absolutetolerance.value() == boost::none) {
+        processWhereIsClose(values, currentParams.relativetolerance.value().get(),
+                            true, currentParams.isClose.value().get(), where);
+      } else {
+        throw eckit::UserError(
+          "For 'is_close' one (and only one) tolerance is needed.",
+          Here());
+      }
+    } else {
+      throw eckit::UserError(
+        "Only float variables may be used for processWhere 'is_close'",
+        Here());
+    }
+  }
 
 //      Apply mask is_not_in
-        if (currentParams.isNotIn.value() != boost::none) {
-          if (dtype == ioda::ObsDtype::String) {
-            isNotInString(where, currentParams.isNotIn.value()->as<std::vector<std::string>>(),
-                          filterdata, varname);
-          } else if (dtype == ioda::ObsDtype::Integer) {
-            isNotInInteger(where, currentParams.isNotIn.value()->as<std::set<int>>(),
-                           filterdata, varname);
-          } else {
-            throw eckit::UserError(
-              "Only integer and string variables may be used for processWhere 'is_not_in'",
-              Here());
-          }
-        }
+  if (currentParams.isNotIn.value() != boost::none) {
+    if (dtype == ioda::ObsDtype::String) {
+      const std::vector<std::string> forbiddenValues =
+          currentParams.isNotIn.value()->as<std::vector<std::string>>();
+      const std::set<std::string> blacklist(forbiddenValues.begin(), forbiddenValues.end());
+      processWhereStringPredicate(data.getEncodedStrings(varname, key),
+                                  [&blacklist](const std::string &value)
+                                  { return !oops::contains(blacklist, value); },
+                                  where);
+    } else if (dtype == ioda::ObsDtype::Integer) {
+      processWhereIsNotIn(data.get<int>(varname, key),
+                          currentParams.isNotIn.value()->as<std::set<int>>(), where);
+    } else {
+      throw eckit::UserError(
+        "Only integer and string variables may be used for processWhere 'is_not_in'",
+        Here());
+    }
+  }
 
 //      Apply mask is_not_close
-        if (currentParams.isNotClose.value() != boost::none) {
-          if (dtype == ioda::ObsDtype::Float) {
-            std::vector<float> data;
-            filterdata.get(varname, data);
-            if (currentParams.relativetolerance.value() == boost::none &&
-                currentParams.absolutetolerance.value() != boost::none) {
-              processWhereIsNotClose(data, currentParams.absolutetolerance.value().get(),
-                                     false, currentParams.isNotClose.value().get(), where);
-            } else if (currentParams.relativetolerance.value() != boost::none &&
-                       currentParams.absolutetolerance.value() == boost::none) {
-              processWhereIsNotClose(data, currentParams.relativetolerance.value().get(),
-                                     true, currentParams.isNotClose.value().get(), where);
-            } else {
-              throw eckit::UserError(
-                "For 'is_close' one (and only one) tolerance is needed.",
-                Here());
-            }
-          } else {
-            throw eckit::UserError(
-              "Only float variables may be used for processWhere 'is_not_close'",
-              Here());
-          }
-        }
+  if (currentParams.isNotClose.value() != boost::none) {
+    if (dtype == ioda::ObsDtype::Float) {
+      const std::vector<float> &values = data.get<float>(varname, key);
+      if (currentParams.relativetolerance.value() == boost::none &&
+          currentParams.absolutetolerance.value() != boost::none) {
+        processWhereIsNotClose(values, currentParams.absolutetolerance.value().get(),
+                               false, currentParams.isNotClose.value().get(), where);
+      } else if (currentParams.relativetolerance.value() != boost::none &&
+                 currentParams.absolutetolerance.value() == boost::none) {
+        processWhereIsNotClose(values, currentParams.relativetolerance.value().get(),
+                               true, currentParams.isNotClose.value().get(), where);
+      } else {
+        throw eckit::UserError(
+          "For 'is_close' one (and only one) tolerance is needed.",
+          Here());
+      }
+    } else {
+      throw eckit::UserError(
+        "Only float variables may be used for processWhere 'is_not_close'",
+        Here());
+    }
+  }
 
 //      Apply mask any_bit_set_of
-        if (currentParams.anyBitSetOf.value() != boost::none) {
-          if (dtype == ioda::ObsDtype::Integer) {
-            std::vector<int> data;
-            const std::set<int> &bitIndices = *currentParams.anyBitSetOf.value();
-            filterdata.get(varname, data);
-            processWhereAnyBitSetOf(data, bitIndices, where);
-          } else {
-            throw eckit::UserError(
-              "Only integer variables may be used for processWhere 'any_bit_set_of'",
-              Here());
-          }
-        }
+  if (currentParams.anyBitSetOf.value() != boost::none) {
+    if (dtype == ioda::ObsDtype::Integer) {
+      processWhereAnyBitSetOf(data.get<int>(varname, key), anyBitSetOfMask, where);
+    } else {
+      throw eckit::UserError(
+        "Only integer variables may be used for processWhere 'any_bit_set_of'",
+        Here());
+    }
+  }
 
 //      Apply mask any_bit_unset_of
-        if (currentParams.anyBitUnsetOf.value() != boost::none) {
-          if (dtype == ioda::ObsDtype::Integer) {
-            std::vector<int> data;
-            const std::set<int> &bitIndices = *currentParams.anyBitUnsetOf.value();
-            filterdata.get(varname, data);
-            processWhereAnyBitUnsetOf(data, bitIndices, where);
-          } else {
-            throw eckit::UserError(
-              "Only integer variables may be used for processWhere 'any_bit_unset_of'",
-              Here());
-          }
-        }
+  if (currentParams.anyBitUnsetOf.value() != boost::none) {
+    if (dtype == ioda::ObsDtype::Integer) {
+      processWhereAnyBitUnsetOf(data.get<int>(varname, key), anyBitUnsetOfMask, where);
+    } else {
+      throw eckit::UserError(
+        "Only integer variables may be used for processWhere 'any_bit_unset_of'",
+        Here());
+    }
+  }
 
 //      Apply mask matches_regex
-        if (currentParams.matchesRegex.value() != boost::none) {
-          const std::string pattern = *currentParams.matchesRegex.value();
-          // Select observations for which the variable 'varname' matches the regular expression
-          // 'pattern'.
-          if (dtype == ioda::ObsDtype::Integer) {
-            std::vector<int> data;
-            filterdata.get(varname, data);
-            processWhereMatchesRegex(data, pattern, where);
-          } else if (dtype == ioda::ObsDtype::String) {
-            std::vector<std::string> data;
-            filterdata.get(varname, data);
-            processWhereMatchesRegex(data, pattern, where);
-          } else {
-            throw eckit::UserError(
-              "Only string and integer variables may be used for processWhere 'matches_regex'",
-              Here());
-          }
-        }
+  if (regex) {
+    // Select observations for which the variable 'varname' matches the regular expression
+    // 'pattern'.
+    const std::regex &re = *regex;
+    auto matchesRegex = [&re](const std::string &value) { return std::regex_match(value, re); };
+    if (dtype == ioda::ObsDtype::Integer) {
+      processWhereStringPredicate(data.get<int>(varname, key), matchesRegex, where);
+    } else if (dtype == ioda::ObsDtype::String) {
+      processWhereStringPredicate(data.getEncodedStrings(varname, key), matchesRegex, where);
+    } else {
+      throw eckit::UserError(
+        "Only string and integer variables may be used for processWhere 'matches_regex'",
+        Here());
+    }
+  }
 
 //      Apply mask matches_wildcard
-        if (currentParams.matchesWildcard.value() != boost::none) {
-          const std::string &pattern = *currentParams.matchesWildcard.value();
-          // Select observations for which the variable 'varname' matches the pattern
-          // 'pattern', which may contain the * and ? wildcards.
-          if (dtype == ioda::ObsDtype::Integer) {
-            std::vector<int> data;
-            filterdata.get(varname, data);
-            processWhereMatchesAnyWildcardPattern(data, {pattern}, where);
-          } else if (dtype == ioda::ObsDtype::String) {
-            std::vector<std::string> data;
-            filterdata.get(varname, data);
-            processWhereMatchesAnyWildcardPattern(data, {pattern}, where);
-          } else {
-            throw eckit::UserError(
-              "Only string and integer variables may be used for processWhere 'matches_wildcard'",
-              Here());
-          }
-        }
+  if (!wildcardPatterns.empty()) {
+    // Select observations for which the variable 'varname' matches the pattern
+    // 'pattern', which may contain the * and ? wildcards.
+    const std::vector<std::string> &patterns = wildcardPatterns;
+    auto matchesPattern = [&patterns](const std::string &value)
+                          { return stringMatchesAnyWildcardPattern(value, patterns); };
+    if (dtype == ioda::ObsDtype::Integer) {
+      processWhereStringPredicate(data.get<int>(varname, key), matchesPattern, where);
+    } else if (dtype == ioda::ObsDtype::String) {
+      processWhereStringPredicate(data.getEncodedStrings(varname, key), matchesPattern, where);
+    } else {
+      throw eckit::UserError(
+        "Only string and integer variables may be used for processWhere 'matches_wildcard'",
+        Here());
+    }
+  }
 
 //      Apply mask matches_any_wildcard
-        if (currentParams.matchesAnyWildcard.value() != boost::none) {
-          const std::vector<std::string> &patterns = *currentParams.matchesAnyWildcard.value();
-          // Select observations for which the variable 'varname' matches any of the patterns
-          // 'patterns'; these may contain the * and ? wildcards.
-          if (dtype == ioda::ObsDtype::Integer) {
-            std::vector<int> data;
-            filterdata.get(varname, data);
-            processWhereMatchesAnyWildcardPattern(data, patterns, where);
-          } else if (dtype == ioda::ObsDtype::String) {
-            std::vector<std::string> data;
-            filterdata.get(varname, data);
-            processWhereMatchesAnyWildcardPattern(data, patterns, where);
-          } else {
-            throw eckit::UserError(
-              "Only string and integer variables may be used for processWhere "
-              "'matches_any_wildcard'",
-              Here());
-          }
-        }
-      }
+  if (currentParams.matchesAnyWildcard.value() != boost::none) {
+    // Select observations for which the variable 'varname' matches any of the patterns
+    // 'patterns'; these may contain the * and ? wildcards.
+    const std::vector<std::string> &patterns = anyWildcardPatterns;
+    auto matchesAnyPattern = [&patterns](const std::string &value)
+                             { return stringMatchesAnyWildcardPattern(value, patterns); };
+    if (dtype == ioda::ObsDtype::Integer) {
+      processWhereStringPredicate(data.get<int>(varname, key), matchesAnyPattern, where);
+    } else if (dtype == ioda::ObsDtype::String) {
+      processWhereStringPredicate(data.getEncodedStrings(varname, key), matchesAnyPattern, where);
+    } else {
+      throw eckit::UserError(
+        "Only string and integer variables may be used for processWhere "
+        "'matches_any_wildcard'",
+        Here());
     }
   }
-//  Print diagnostics for debug
-  int ii = 0;
-  for (size_t jj = 0; jj < nlocs; ++jj) {
-    if (where[jj] == false) ++ii;
+}
+
+// -----------------------------------------------------------------------------
+CompiledWhere::CompiledWhere(const std::vector<WhereParameters> & params) {
+  for (const WhereParameters &currentParams : params) {
+    const Variable &var = currentParams.variable;
+    if (var.group() == "VarMetaData")
+      continue;
+    const auto clause = std::make_shared<const WhereParameters>(currentParams);
+    for (size_t jvar = 0; jvar < var.size(); ++jvar)
+      predicates_.emplace_back(clause, var[jvar]);
   }
+}
+
+// -----------------------------------------------------------------------------
+CompiledWhere::CompiledWhere(CompiledWhere &&) = default;
+CompiledWhere & CompiledWhere::operator=(CompiledWhere &&) = default;
+CompiledWhere::~CompiledWhere() = default;
+
+// -----------------------------------------------------------------------------
+std::vector<bool> CompiledWhere::evaluate(const ObsFilterData & filterdata) const {
+  const size_t nlocs = filterdata.nlocs();
+
+// Everywhere by default if no mask
+  std::vector<char> where(nlocs, true);
 
+  WhereData data(filterdata);
+  for (const Predicate &predicate : predicates_)
+    predicate.apply(data, where);
+
+//  Print diagnostics for debug
+  const size_t ii = std::count(where.begin(), where.end(), false);
   oops::Log::debug() << "processWhere: selected " << ii << " obs." << std::endl;
-  return where;
+
+  return std::vector<bool>(where.begin(), where.end());
+}
+
+// -----------------------------------------------------------------------------
+std::vector<bool> processWhere(const std::vector<WhereParameters> & params,
+                               const ObsFilterData & filterdata) {
+  return CompiledWhere(params).evaluate(filterdata);
 }
 
 // -----------------------------------------------------------------------------
@@ -109,8 +109,34 @@ class WhereParameters : public oops::Parameters {
   oops::OptionalParameter<std::string> matchesRegex{"matches_regex", this};
 };
 
+/// \brief A list of `where` clauses compiled into a sequence of predicates that can be evaluated
+/// repeatedly.
+///
+/// The clauses are parsed (and any regular expressions compiled) only once, on construction, so
+/// objects of this class should be created when a filter is set up rather than each time it is
+/// run. During each call to evaluate(), every variable referenced by the clauses is retrieved from
+/// ObsFilterData only once, and conditions on string variables (as well as regular expression and
+/// wildcard matches on integer variables) are evaluated only once per distinct value.
+class CompiledWhere {
+ public:
+  explicit CompiledWhere(const std::vector<WhereParameters> &);
+  CompiledWhere(CompiledWhere &&);
+  CompiledWhere & operator=(CompiledWhere &&);
+  ~CompiledWhere();
+
+  /// \brief Return a vector whose ith element is set to true if the ith location held on the
+  /// current MPI rank fulfils all conditions specified in the `where` clauses.
+  std::vector<bool> evaluate(const ObsFilterData &) const;
+
+ private:
+  struct Predicate;
+  std::vector<Predicate> predicates_;
+};
+
 ufo::Variables getAllWhereVariables(const std::vector<WhereParameters> &);
-std::vector<bool> processWhere(const std::vector<WhereParameters> &, const ObsFilterData &);
+/// \brief Equivalent to `CompiledWhere(params).evaluate(filterdata)`.
+std::vector<bool> processWhere(const std::vector<WhereParameters> &params,
+                               const ObsFilterData &filterdata);
 
 }  // namespace ufo
 
@@ -47,6 +47,20 @@ RTTOVOneDVarCheck::RTTOVOneDVarCheck(ioda::ObsSpace & obsdb, const Parameters_ &
      throw eckit::UserError("RTTOVOneDVarCheck contructor: no channels defined, aborting.");
   }
 
+  // Check the batch size and number of threads are sensible
+  if (parameters_.ProfilesPerBatch.value() < 1) {
+     throw eckit::UserError("RTTOVOneDVarCheck contructor:"
+                            " ProfilesPerBatch must be positive, aborting.");
+  }
+  if (parameters_.NumThreads.value() < 1) {
+     throw eckit::UserError("RTTOVOneDVarCheck contructor:"
+                            " NumThreads must be positive, aborting.");
+  }
+  if (parameters_.NumThreads.value() > 1 && parameters_.FullDiagnostics.value()) {
+     throw eckit::UserError("RTTOVOneDVarCheck contructor:"
+                            " FullDiagnostics cannot be used with NumThreads > 1, aborting.");
+  }
+
   // Setup Fortran object
   ufo_rttovonedvarcheck_create_f90(keyRTTOVOneDVarCheck_, obsdb, parameters_.toConfiguration(),
               channels_.size(), channels_[0], retrieved_vars_, QCflags::onedvar, QCflags::pass);
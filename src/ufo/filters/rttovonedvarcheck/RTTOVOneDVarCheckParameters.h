@@ -87,6 +87,18 @@ class RTTOVOneDVarCheckParameters : public FilterParametersBase {
   /// Maximum number of iterations for internal Marquardt-Levenberg loop
   oops::Parameter<int> MaxMLIterations{"MaxMLIterations", 7, this};
 
+  /// Number of profiles minimized together. All profiles of a batch are advanced
+  /// simultaneously and the forward model is called once per iteration for the whole batch;
+  /// profiles are dropped from the batch as they converge or fail. Only used by the Newton
+  /// minimizer.
+  oops::Parameter<int> ProfilesPerBatch{"ProfilesPerBatch", 1, this};
+
+  /// Number of OpenMP threads used to process the observations. Each thread sets up its own
+  /// copy of the RTTOV coefficients. The results do not depend on the number of threads.
+  /// The progress of each retrieval is only logged when running on one thread, and
+  /// FullDiagnostics cannot be used with more than one thread.
+  oops::Parameter<int> NumThreads{"NumThreads", 1, this};
+
   /// Starting observation to run through 1d-var, subsetting for testing
   oops::Parameter<int> StartOb{"StartOb", 0, this};
 
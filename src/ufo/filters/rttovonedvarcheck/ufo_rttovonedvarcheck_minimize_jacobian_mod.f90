@@ -9,6 +9,7 @@ module ufo_rttovonedvarcheck_minimize_jacobian_mod
 
 use iso_c_binding
 use kinds
+use oops_variables_mod
 use ufo_constants_mod, only: zero
 use ufo_geovals_mod
 use ufo_radiancerttov_mod
@@ -23,6 +24,8 @@ implicit none
 private
 
 public ufo_rttovonedvarcheck_get_jacobian
+public ufo_rttovonedvarcheck_get_bts_batch
+public ufo_rttovonedvarcheck_get_jacobian_from_batch
 
 contains
 
@@ -98,6 +101,143 @@ logical, intent(in)                               :: FullDiagnostics
 real(kind_real), intent(out)                      :: hofx(:)        !< BT's
 real(kind_real), intent(out)                      :: H_matrix(:,:)  !< Jacobian
 
+! Local arguments
+real(c_double)               :: BT(size(ob % channels_all))
+
+call rttov_data % simobs(geovals, obsdb, size(ob % channels_all), 1, BT, hofxdiags, ob_info=[ob])
+
+call ufo_rttovonedvarcheck_HofxdiagsToHmatrix(geovals, ob, channels, profindex, &
+                                              hofxdiags, 1, BT, UseQtsplitRain, &
+                                              FullDiagnostics, hofx, H_matrix)
+
+end subroutine ufo_rttovonedvarcheck_GetHmatrixRTTOVsimobs
+
+!------------------------------------------------------------------------------
+!> Run the forward model for a batch of profiles at once.
+!!
+!! \details The profiles listed in \p profiles are gathered into a single GeoVaLs
+!! object so that rttov is called once for the whole batch rather than once per
+!! profile.  The jacobian of the jprof'th listed profile is returned in location
+!! jprof of hofxdiags and can be converted to the 1D-Var variables with
+!! ufo_rttovonedvarcheck_get_jacobian_from_batch.
+!!
+!! \author Met Office
+!!
+!! \date 09/06/2021: Created
+!!
+subroutine ufo_rttovonedvarcheck_get_bts_batch(self, geovals, obs, profiles, &
+                                               retrieval_vars, rttov_simobs, &
+                                               hofxdiags, BT)
+
+implicit none
+
+! subroutine arguments
+type(ufo_rttovonedvarcheck), intent(in)        :: self           !< Main 1D-Var object
+type(ufo_geovals), intent(in)                  :: geovals(:)     !< model data at each obs location
+type(ufo_rttovonedvarcheck_ob), intent(in)     :: obs(:)         !< satellite metadata for each location
+integer, intent(in)                            :: profiles(:)    !< indices of the profiles to simulate
+type(oops_variables), intent(in)               :: retrieval_vars !< jacobian variables
+type(ufo_radiancerttov), intent(inout)         :: rttov_simobs   !< rttov simulate obs object
+type(ufo_geovals), intent(inout)               :: hofxdiags      !< jacobian for each profile
+real(c_double), intent(out)                    :: BT(:,:)        !< BT's for all channels and profiles
+
+! Local arguments
+type(ufo_geovals) :: batch_geovals
+integer           :: nprofiles, jvar, jprof
+
+nprofiles = size(profiles)
+
+select case (trim(self % forward_mod_name))
+  case ("RTTOV")
+    ! Gather the profiles into a single GeoVaLs object
+    batch_geovals % nlocs = nprofiles
+    batch_geovals % nvar = geovals(profiles(1)) % nvar
+    allocate(batch_geovals % variables(batch_geovals % nvar))
+    batch_geovals % variables(:) = geovals(profiles(1)) % variables(:)
+    allocate(batch_geovals % geovals(batch_geovals % nvar))
+    do jvar = 1, batch_geovals % nvar
+      batch_geovals % geovals(jvar) % nval = geovals(profiles(1)) % geovals(jvar) % nval
+      batch_geovals % geovals(jvar) % nlocs = nprofiles
+      allocate(batch_geovals % geovals(jvar) % vals(batch_geovals % geovals(jvar) % nval, nprofiles))
+      do jprof = 1, nprofiles
+        batch_geovals % geovals(jvar) % vals(:, jprof) = &
+          geovals(profiles(jprof)) % geovals(jvar) % vals(:, 1)
+      end do
+    end do
+    batch_geovals % missing_value = geovals(profiles(1)) % missing_value
+    batch_geovals % linit = .true.
+
+    call ufo_geovals_setup(hofxdiags, retrieval_vars, nprofiles)
+    call rttov_simobs % simobs(batch_geovals, self % obsdb, size(BT, 1), nprofiles, &
+                               BT, hofxdiags, ob_info=obs(profiles))
+
+    call ufo_geovals_delete(batch_geovals)
+
+  case default
+    call abor1_ftn("rttovonedvarcheck get bts batch: no suitable forward model => exiting")
+end select
+
+end subroutine ufo_rttovonedvarcheck_get_bts_batch
+
+!------------------------------------------------------------------------------
+!> Get the hofx and jacobian of one profile of a batch processed by
+!! ufo_rttovonedvarcheck_get_bts_batch.
+!!
+!! \author Met Office
+!!
+!! \date 09/06/2021: Created
+!!
+subroutine ufo_rttovonedvarcheck_get_jacobian_from_batch(self, geovals, ob, channels, &
+                                                         profindex, hofxdiags, iprof, BT, &
+                                                         hofx, H_matrix)
+
+implicit none
+
+! subroutine arguments
+type(ufo_rttovonedvarcheck), intent(in)           :: self          !< Main 1D-Var object
+type(ufo_geovals), intent(in)                     :: geovals       !< model data at obs location
+type(ufo_rttovonedvarcheck_ob), intent(in)        :: ob            !< satellite metadata
+integer, intent(in)                               :: channels(:)   !< channels used for this calculation
+type(ufo_rttovonedvarcheck_profindex), intent(in) :: profindex     !< index array for x vector
+type(ufo_geovals), intent(in)                     :: hofxdiags     !< jacobians of the whole batch
+integer, intent(in)                               :: iprof         !< index of the profile in the batch
+real(c_double), intent(in)                        :: BT(:)         !< BT's for all channels
+real(kind_real), intent(out)                      :: hofx(:)       !< BT's
+real(kind_real), intent(out)                      :: H_matrix(:,:) !< Jacobian
+
+call ufo_rttovonedvarcheck_HofxdiagsToHmatrix(geovals, ob, channels, profindex, &
+                                              hofxdiags, iprof, BT, self % UseQtsplitRain, &
+                                              self % FullDiagnostics, hofx, H_matrix)
+
+end subroutine ufo_rttovonedvarcheck_get_jacobian_from_batch
+
+!------------------------------------------------------------------------------
+!> Convert the jacobian calculated by rttov for one profile to variables used
+!! in the 1D-Var.
+!!
+!! \author Met Office
+!!
+!! \date 09/06/2020: Created
+!!
+subroutine ufo_rttovonedvarcheck_HofxdiagsToHmatrix(geovals, ob, channels, profindex, &
+                                       hofxdiags, iprof, BT, UseQtsplitRain, &
+                                       FullDiagnostics, hofx, H_matrix)
+
+implicit none
+
+! subroutine arguments
+type(ufo_geovals), intent(in)                     :: geovals        !< model data at obs location
+type(ufo_rttovonedvarcheck_ob), intent(in)        :: ob             !< satellite metadata
+integer, intent(in)                               :: channels(:)    !< channels used for this calculation
+type(ufo_rttovonedvarcheck_profindex), intent(in) :: profindex      !< index array for x vector
+type(ufo_geovals), intent(in)                     :: hofxdiags      !< model data containing the jacobian
+integer, intent(in)                               :: iprof          !< location of the profile in hofxdiags
+real(c_double), intent(in)                        :: BT(:)          !< BT's for all channels
+logical, intent(in)                               :: UseQtsplitRain !< flag to make qtsplit use rain
+logical, intent(in)                               :: FullDiagnostics
+real(kind_real), intent(out)                      :: hofx(:)        !< BT's
+real(kind_real), intent(out)                      :: H_matrix(:,:)  !< Jacobian
+
 ! Local arguments
 integer :: nchans, nlevels, nq_levels
 integer :: i, j
@@ -113,13 +253,10 @@ real(kind_real), allocatable :: dqi_dqt(:)
 real(kind_real), allocatable :: dBT_dq(:)
 real(kind_real), allocatable :: dBT_dql(:)
 character(len=max_string)    :: varname
-real(c_double)               :: BT(size(ob % channels_all))
 real(kind_real)              :: u, v, dBT_du, dBT_dv, windsp
 
 nchans = size(channels)
 
-call rttov_data % simobs(geovals, obsdb, size(ob % channels_all), 1, BT, hofxdiags, ob_info=ob)
-
 ! --------------------
 !Get hofx for just channels used
 !--------------------
@@ -143,7 +280,7 @@ if (profindex % t(1) > 0) then
   do i = 1, nchans
     write(varname,"(3a,i0)") "brightness_temperature_jacobian_",trim(var_ts),"_",channels(i) ! K
     call ufo_geovals_get_var(hofxdiags , varname, geoval)
-    H_matrix(i,profindex % t(1):profindex % t(2)) = geoval % vals(:,1)
+    H_matrix(i,profindex % t(1):profindex % t(2)) = geoval % vals(:,iprof)
   end do
 end if
 
@@ -169,7 +306,7 @@ if (profindex % q(1) > 0) then
   do i = 1, nchans
     write(varname,"(3a,i0)") "brightness_temperature_jacobian_",trim(var_q),"_",channels(i) ! kg/kg
     call ufo_geovals_get_var(hofxdiags, varname, geoval)
-    H_matrix(i,profindex % q(1):profindex % q(2)) = geoval % vals(:,1) * q_kgkg(:)
+    H_matrix(i,profindex % q(1):profindex % q(2)) = geoval % vals(:,iprof) * q_kgkg(:)
   end do
 
   deallocate(q_kgkg)
@@ -226,12 +363,12 @@ if (profindex % qt(1) > 0) then
     write(varname,"(3a,i0)") "brightness_temperature_jacobian_", trim(var_q), "_", channels(i) ! kg/kg
     call ufo_geovals_get_var(hofxdiags, varname, geoval)
     dBT_dq(:) = zero
-    dBT_dq(:) = geoval % vals(:,1)
+    dBT_dq(:) = geoval % vals(:,iprof)
 
     write(varname,"(3a,i0)") "brightness_temperature_jacobian_", trim(var_clw), "_", channels(i) ! kg/kg
     call ufo_geovals_get_var(hofxdiags, varname, geoval)
     dBT_dql(:) = zero
-    dBT_dql(:) = geoval % vals(:,1)
+    dBT_dql(:) = geoval % vals(:,iprof)
 
     H_matrix(i,profindex % qt(1):profindex % qt(2)) = &
             (dBT_dq(:)  * dq_dqt(:) + &
@@ -260,7 +397,7 @@ if (profindex % t2 > 0) then
   do i = 1, nchans
     write(varname,"(3a,i0)") "brightness_temperature_jacobian_",trim(var_sfc_t2m),"_",channels(i) ! K
     call ufo_geovals_get_var(hofxdiags, varname, geoval)
-    H_matrix(i,profindex % t2) = geoval % vals(1,1)
+    H_matrix(i,profindex % t2) = geoval % vals(1,iprof)
   end do
 end if
 
@@ -273,7 +410,7 @@ if (profindex % q2 > 0) then
   do i = 1, nchans
     write(varname,"(3a,i0)") "brightness_temperature_jacobian_",trim(var_sfc_q2m),"_",channels(i) ! kg/kg
     call ufo_geovals_get_var(hofxdiags, varname, geoval)
-    H_matrix(i,profindex % q2) = geoval % vals(1,1) * s2m_kgkg
+    H_matrix(i,profindex % q2) = geoval % vals(1,iprof) * s2m_kgkg
   end do
 end if
 
@@ -283,7 +420,7 @@ if (profindex % pstar > 0) then
   do i = 1, nchans
     write(varname,"(3a,i0)") "brightness_temperature_jacobian_",trim(var_sfc_p2m),"_",channels(i)
     call ufo_geovals_get_var(hofxdiags, varname, geoval)
-    H_matrix(i,profindex % pstar) = geoval % vals(1,1)
+    H_matrix(i,profindex % pstar) = geoval % vals(1,iprof)
   end do
 end if
 
@@ -301,10 +438,10 @@ if (profindex % windspeed > 0) then
   do i = 1, nchans
     write(varname,"(3a,i0)") "brightness_temperature_jacobian_",trim(var_u),"_",channels(i)
     call ufo_geovals_get_var(hofxdiags, varname, geoval)
-    dBT_du = geoval % vals(1,1)
+    dBT_du = geoval % vals(1,iprof)
     write(varname,"(3a,i0)") "brightness_temperature_jacobian_",trim(var_v),"_",channels(i)
     call ufo_geovals_get_var(hofxdiags, varname, geoval)
-    dBT_dv = geoval % vals(1,1)
+    dBT_dv = geoval % vals(1,iprof)
     if (windsp > zero) then
       ! directional derivation of the Jacobian
       H_matrix(i,profindex % windspeed) = (dBT_du * u + dBT_dv * v) / windsp
@@ -320,7 +457,7 @@ if (profindex % tstar > 0) then
   do i = 1, nchans
     write(varname,"(3a,i0)") "brightness_temperature_jacobian_",trim(var_sfc_tskin),"_",channels(i)
     call ufo_geovals_get_var(hofxdiags, varname, geoval)
-    H_matrix(i,profindex % tstar) = geoval % vals(1,1)
+    H_matrix(i,profindex % tstar) = geoval % vals(1,iprof)
   end do
 end if
 
@@ -332,7 +469,7 @@ end if
 !    varname = "cloud_top_pressure"
 !    write(varname,"(3a,i0)") "brightness_temperature_jacobian_",trim(varname),"_",channels(i)
 !    call ufo_geovals_get_var(hofxdiags, varname, geoval)
-!    H_matrix(i,profindex % cloudtopp) = geoval % vals(1,1)
+!    H_matrix(i,profindex % cloudtopp) = geoval % vals(1,iprof)
 !  end do
 !end if
 
@@ -343,7 +480,7 @@ end if
 !  do i = 1, nchans
 !    varname = "cloud_fraction"
 !    call ufo_geovals_get_var(hofxdiags, varname, geoval)
-!    H_matrix(i,profindex % cloudfrac) = geoval % vals(1,1)
+!    H_matrix(i,profindex % cloudfrac) = geoval % vals(1,iprof)
 !  end do
 !end if
 
@@ -368,7 +505,7 @@ end if
 !      if (channels(i) == chan) then
 !        write(varname,"(3a,i0)") "brightness_temperature_jacobian_",trim(var_sfc_emiss),"_",channels(i)
 !        call ufo_geovals_get_var(hofxdiags, varname, geoval)
-!        H_matrix(i,profindex % mwemiss(1) + j - 1) = geoval % vals(1,1)
+!        H_matrix(i,profindex % mwemiss(1) + j - 1) = geoval % vals(1,iprof)
 !      end if
 !    end do
 !  end do
@@ -401,7 +538,7 @@ if (FullDiagnostics) then
     profindex )                  ! in
 end if
 
-end subroutine ufo_rttovonedvarcheck_GetHmatrixRTTOVsimobs
+end subroutine ufo_rttovonedvarcheck_HofxdiagsToHmatrix
 
 !---------------------------------------------------------------------------
 !> Routine to print the contents of the jacobian for testing
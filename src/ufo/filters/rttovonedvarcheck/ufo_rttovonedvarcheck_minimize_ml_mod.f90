@@ -93,7 +93,7 @@ subroutine ufo_rttovonedvarcheck_minimize_ml(self,      &
 
 implicit none
 
-type(ufo_rttovonedvarcheck), intent(inout) :: self   !< structure containing settings
+type(ufo_rttovonedvarcheck), intent(in)    :: self   !< structure containing settings
 type(ufo_rttovonedvarcheck_ob), intent(inout) :: ob  !< satellite metadata
 type(ufo_rttovonedvarcheck_rsubmatrix), intent(in) :: r_matrix !< observation error covariance
 real(kind_real), intent(in)       :: b_matrix(:,:)   !< state error covariance
@@ -162,7 +162,7 @@ allocate(Y(nchans))
 allocate(Y0(nchans))
 geovals = local_geovals
 
-call fckit_log % debug("Using ML solver")
+if (self % verbose) call fckit_log % debug("Using ML solver")
 
 ! Map GeovaLs to 1D-var profile using B matrix profile structure
 call ufo_rttovonedvarcheck_GeoVaLs2ProfVec(geovals, profile_index, ob, GuessProfile(:))
@@ -190,7 +190,7 @@ Iterations: do iter = 1, self % max1DVarIterations
 
   ! exit on error
   if (RTerrorcode /= 0) then
-    write(*,*) "Radiative transfer error"
+    if (self % verbose) write(*,*) "Radiative transfer error"
     exit Iterations
   end if
 
@@ -198,7 +198,7 @@ Iterations: do iter = 1, self % max1DVarIterations
   Ydiff(:) = ob % yobs(:) - Y(:)
   if (iter == 1) then
     Diffprofile(:) = GuessProfile(:) - BackProfile(:)
-    call ufo_rttovonedvarcheck_CostFunction(Diffprofile, b_inv, Ydiff, r_matrix, Jout)
+    call ufo_rttovonedvarcheck_CostFunction(Diffprofile, b_inv, Ydiff, r_matrix, Jout, self % verbose)
     Jcost = Jout(1)
     JCostOrig = Jcost
   end if
@@ -271,7 +271,7 @@ Iterations: do iter = 1, self % max1DVarIterations
 
   if (inversionStatus /= 0) then
     inversionStatus = 1
-    write(*,*) "inversion failed"
+    if (self % verbose) write(*,*) "inversion failed"
     exit Iterations
   end if
 
@@ -300,6 +300,7 @@ Iterations: do iter = 1, self % max1DVarIterations
         call ufo_rttovonedvarcheck_CheckCloudyIteration( geovals, & ! in
                                               profile_index,      & ! in
                                               self % nlevels,     & ! in
+                                              self % verbose,     & ! in
                                               OutOfRange )          ! out
 
     end if                                                                                  
@@ -316,7 +317,7 @@ Iterations: do iter = 1, self % max1DVarIterations
   if ((.not. outOfRange) .and. (.not. self % UseJForConvergence)) then
     absDiffProfile(:) = abs(GuessProfile(:) - OldProfile(:))
     if (ALL (absDiffProfile(:) <= B_sigma(:) * self % ConvergenceFactor)) then
-      write(*,*) "Profile used for convergence"
+      if (self % verbose) write(*,*) "Profile used for convergence"
       Converged = .true.
     end if
   end if
@@ -349,7 +350,7 @@ if (converged) then
   ob % output_profile(:) = GuessProfile(:)
 
   ! Recalculate final cost - to make sure output when using profile convergence
-  call ufo_rttovonedvarcheck_CostFunction(Diffprofile, b_inv, Ydiff, r_matrix, Jout)
+  call ufo_rttovonedvarcheck_CostFunction(Diffprofile, b_inv, Ydiff, r_matrix, Jout, self % verbose)
   ob % final_cost = Jout(1)
 
   ! If lwp output required then recalculate
@@ -357,6 +358,7 @@ if (converged) then
     call ufo_rttovonedvarcheck_CheckCloudyIteration( geovals, & ! in
                                             profile_index,    & ! in
                                             self % nlevels,   & ! in
+                                            self % verbose,   & ! in
                                             OutOfRange,       & ! out
                                             OutLWP = ob % LWP ) ! out
   end if
@@ -575,7 +577,7 @@ DescentLoop : do while (JCost > JOld .and.              &
                      New_DeltaProfile, &
                      Status)
   if (Status /= 0) then
-     write(*,*) 'Error in Cholesky decomposition'
+     if (self % verbose) write(*,*) 'Error in Cholesky decomposition'
   end if
 
   !------------------------------------------------------------------------
@@ -615,7 +617,7 @@ DescentLoop : do while (JCost > JOld .and.              &
     else
       DeltaProfile(:) = GuessProfile(:) - BackProfile(:)
       Ydiff(:) = ob % yobs(:) - BriTemp(:)
-      call ufo_rttovonedvarcheck_CostFunction(DeltaProfile, b_inv, Ydiff, r_matrix, Jout)
+      call ufo_rttovonedvarcheck_CostFunction(DeltaProfile, b_inv, Ydiff, r_matrix, Jout, self % verbose)
       Jcost = Jout(1)
       if (Status /= StatusOK) goto 9999
     end if
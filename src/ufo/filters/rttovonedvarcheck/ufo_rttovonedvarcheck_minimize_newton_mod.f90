@@ -6,7 +6,9 @@
 
 module ufo_rttovonedvarcheck_minimize_newton_mod
 
+use iso_c_binding
 use kinds
+use oops_variables_mod
 use ufo_constants_mod, only: zero
 use fckit_log_module, only : fckit_log
 use ufo_geovals_mod
@@ -25,6 +27,26 @@ private
 
 ! public subroutines
 public ufo_rttovonedvarcheck_minimize_newton
+public ufo_rttovonedvarcheck_minimize_newton_batch
+
+!> State of the minimization of a single profile of a batch
+type :: newton_state
+  logical                      :: running = .true.     ! still being minimized
+  logical                      :: converged = .false.
+  logical                      :: outOfRange = .false.
+  integer                      :: niter = 0
+  real(kind_real)              :: Jcost = 1.0e4_kind_real
+  real(kind_real)              :: JcostOld = 1.0e4_kind_real
+  real(kind_real)              :: JcostOrig = 1.0e4_kind_real
+  real(kind_real), allocatable :: OldProfile(:)
+  real(kind_real), allocatable :: GuessProfile(:)
+  real(kind_real), allocatable :: BackProfile(:)
+  real(kind_real), allocatable :: Diffprofile(:)
+  real(kind_real), allocatable :: Xdiff(:)
+  real(kind_real), allocatable :: Ydiff(:)
+  real(kind_real), allocatable :: Y(:)
+  real(kind_real), allocatable :: H_matrix(:,:)
+end type newton_state
 
 contains
 
@@ -91,7 +113,7 @@ subroutine ufo_rttovonedvarcheck_minimize_newton(self,  &
 
 implicit none
 
-type(ufo_rttovonedvarcheck), intent(inout) :: self   !< Main 1D-Var object
+type(ufo_rttovonedvarcheck), intent(in)    :: self   !< Main 1D-Var object
 type(ufo_rttovonedvarcheck_ob), intent(inout) :: ob  !< satellite metadata
 type(ufo_rttovonedvarcheck_rsubmatrix), intent(in) :: r_matrix !< observation error covariance
 real(kind_real), intent(in)       :: b_matrix(:,:)   !< state error covariance
@@ -158,7 +180,7 @@ allocate(Y0(nchans))
 geovals = local_geovals
 
 if (self % FullDiagnostics) call ufo_geovals_print(geovals,1)
-call fckit_log % debug("Using Newton solver")
+if (self % verbose) call fckit_log % debug("Using Newton solver")
 
 JCost = 1.0e4_kind_real
 
@@ -210,7 +232,7 @@ Iterations: do iter = 1, self % max1DVarIterations
 
   ! exit on error
   if (RTerrorcode /= 0) then
-    write(*,*) "Radiative transfer error"
+    if (self % verbose) write(*,*) "Radiative transfer error"
     exit Iterations
   end if
 
@@ -233,7 +255,7 @@ Iterations: do iter = 1, self % max1DVarIterations
 
   if (self % UseJForConvergence) then
 
-    call ufo_rttovonedvarcheck_CostFunction(Xdiff, b_inv, Ydiff, r_matrix, Jout)
+    call ufo_rttovonedvarcheck_CostFunction(Xdiff, b_inv, Ydiff, r_matrix, Jout, self % verbose)
     Jcost = Jout(1)
 
     ! exit on error
@@ -291,7 +313,7 @@ Iterations: do iter = 1, self % max1DVarIterations
 
   ! Iterate (Guess) profile vector
   if (nchans > nprofelements) then
-    call fckit_log % debug("Many Chans")
+    if (self % verbose) call fckit_log % debug("Many Chans")
     call ufo_rttovonedvarcheck_NewtonManyChans (Ydiff,          &
                                      nchans,                    &
                                      H_matrix(:,:),             & ! in
@@ -302,7 +324,7 @@ Iterations: do iter = 1, self % max1DVarIterations
                                      r_matrix,                  &
                                      inversionStatus)
   else ! nchans <= nprofelements
-    call fckit_log % debug("Few Chans")
+    if (self % verbose) call fckit_log % debug("Few Chans")
     call ufo_rttovonedvarcheck_NewtonFewChans (Ydiff,          &
                                     nchans,                    &
                                     H_matrix(:,:),             & ! in
@@ -325,7 +347,7 @@ Iterations: do iter = 1, self % max1DVarIterations
 
   if (inversionStatus /= 0) then
     inversionStatus = 1
-    write(*,*) "inversion failed"
+    if (self % verbose) write(*,*) "inversion failed"
     exit Iterations
   end if
 
@@ -356,6 +378,7 @@ Iterations: do iter = 1, self % max1DVarIterations
         call ufo_rttovonedvarcheck_CheckCloudyIteration( geovals, & ! in
                                               profile_index,      & ! in
                                               self % nlevels,     & ! in
+                                              self % verbose,     & ! in
                                               OutOfRange )          ! out
 
     end if
@@ -372,7 +395,7 @@ Iterations: do iter = 1, self % max1DVarIterations
   if ((.NOT. outOfRange) .and. (.NOT. self % UseJForConvergence))then
     absDiffProfile(:) = abs(GuessProfile(:) - OldProfile(:))
     if (ALL (absDiffProfile(:) <= B_sigma(:) * self % ConvergenceFactor)) then
-      call fckit_log % debug("Profile used for convergence")
+      if (self % verbose) call fckit_log % debug("Profile used for convergence")
       Converged = .true.
     end if
   end if
@@ -401,7 +424,7 @@ end do Iterations
 onedvar_success = converged
 
 ! Recalculate final cost - to make sure output when profile has not converged
-call ufo_rttovonedvarcheck_CostFunction(Xdiff, b_inv, Ydiff, r_matrix, Jout)
+call ufo_rttovonedvarcheck_CostFunction(Xdiff, b_inv, Ydiff, r_matrix, Jout, self % verbose)
 ob % final_cost = Jout(1)
 ob % niter = iter
 
@@ -410,7 +433,7 @@ if (converged) then
   ob % output_profile(:) = GuessProfile(:)
 
   ! Recalculate final cost - to make sure output when using profile convergence
-  call ufo_rttovonedvarcheck_CostFunction(Diffprofile, b_inv, Ydiff, r_matrix, Jout)
+  call ufo_rttovonedvarcheck_CostFunction(Diffprofile, b_inv, Ydiff, r_matrix, Jout, self % verbose)
   ob % final_cost = Jout(1)
 
   ! If lwp output required then recalculate
@@ -418,6 +441,7 @@ if (converged) then
     call ufo_rttovonedvarcheck_CheckCloudyIteration( geovals, & ! in
                                             profile_index,    & ! in
                                             self % nlevels,   & ! in
+                                            self % verbose,   & ! in
                                             OutOfRange,       & ! out
                                             OutLWP = ob % LWP ) ! out
   end if
@@ -456,10 +480,443 @@ if (allocated(Ydiff))              deallocate(Ydiff)
 if (allocated(Y))                  deallocate(Y)
 if (allocated(Y0))                 deallocate(Y0)
 
-call fckit_log % debug("finished with ufo_rttovonedvarcheck_minimize_newton")
+if (self % verbose) call fckit_log % debug("finished with ufo_rttovonedvarcheck_minimize_newton")
 
 end subroutine ufo_rttovonedvarcheck_minimize_newton
 
+!------------------------------------------------------------------------------
+!> Newton minimization of a batch of profiles.
+!!
+!! \details Each profile is minimized exactly as in ufo_rttovonedvarcheck_minimize_newton,
+!! but all the profiles of the batch are advanced together, so that the forward model
+!! is called once per iteration for all the profiles still being minimized rather than
+!! once per profile.  Profiles are masked out of the batch as soon as they converge or
+!! fail.
+!!
+!! \author Met Office
+!!
+!! \date 09/06/2021: Created
+!!
+subroutine ufo_rttovonedvarcheck_minimize_newton_batch(self, &
+                                         obs,            &
+                                         r_matrices,     &
+                                         b_matrices,     &
+                                         b_inverses,     &
+                                         b_sigmas,       &
+                                         local_geovals,  &
+                                         retrieval_vars, &
+                                         rttov_simobs,   &
+                                         profile_index,  &
+                                         onedvar_success)
+
+implicit none
+
+type(ufo_rttovonedvarcheck), intent(in)    :: self      !< Main 1D-Var object
+type(ufo_rttovonedvarcheck_ob), intent(inout) :: obs(:) !< satellite metadata for each profile
+type(ufo_rttovonedvarcheck_rsubmatrix), intent(in) :: r_matrices(:) !< observation error covariances
+real(kind_real), intent(in)       :: b_matrices(:,:,:) !< state error covariances (nprofelements,nprofelements,nprofiles)
+real(kind_real), intent(in)       :: b_inverses(:,:,:) !< inverses of the state error covariances
+real(kind_real), intent(in)       :: b_sigmas(:,:)     !< standard deviations of the state error covariance diagonals
+type(ufo_geovals), intent(in)     :: local_geovals(:)  !< model data at each obs location
+type(oops_variables), intent(in)  :: retrieval_vars    !< jacobian variables
+type(ufo_radiancerttov), intent(inout) :: rttov_simobs
+type(ufo_rttovonedvarcheck_profindex), intent(in) :: profile_index !< index array for x vector
+logical, intent(out)              :: onedvar_success(:) !< convergence flags
+
+! Local declarations:
+character(len=*), parameter     :: RoutineName = "ufo_rttovonedvarcheck_minimize_newton_batch"
+type(newton_state), allocatable :: states(:)
+integer, allocatable            :: profiles(:)
+real(c_double), allocatable     :: BT(:,:)
+real(kind_real), allocatable    :: out_H_matrix(:,:)
+real(kind_real), allocatable    :: out_Y(:)
+type(ufo_geovals), allocatable  :: geovals(:)
+type(ufo_geovals)               :: hofxdiags
+real(kind_real)                 :: Jout(3)
+integer                         :: nprofiles, nprofelements, nchans
+integer                         :: iter, jprof, kprof
+
+! ---------
+! Setup
+! ---------
+nprofiles = size(obs)
+nprofelements = profile_index % nprofelements
+allocate(states(nprofiles))
+allocate(geovals(nprofiles))
+! All the profiles of a batch are simulated for the same channels
+allocate(BT(size(obs(1) % channels_all), nprofiles))
+do jprof = 1, nprofiles
+  nchans = size(obs(jprof) % channels_used)
+  allocate(states(jprof) % OldProfile(nprofelements))
+  allocate(states(jprof) % GuessProfile(nprofelements))
+  allocate(states(jprof) % BackProfile(nprofelements))
+  allocate(states(jprof) % Diffprofile(nprofelements))
+  allocate(states(jprof) % Xdiff(nprofelements))
+  allocate(states(jprof) % Ydiff(nchans))
+  allocate(states(jprof) % Y(nchans))
+  allocate(states(jprof) % H_matrix(nchans,nprofelements))
+  geovals(jprof) = local_geovals(jprof)
+  if (self % FullDiagnostics) call ufo_geovals_print(geovals(jprof),1)
+end do
+
+if (self % verbose) call fckit_log % debug("Using batched Newton solver")
+
+Iterations: do iter = 1, self % max1DVarIterations
+
+  profiles = pack([(jprof, jprof = 1, nprofiles)], states(:) % running)
+  if (size(profiles) == 0) exit Iterations
+
+  do kprof = 1, size(profiles)
+    jprof = profiles(kprof)
+    call newton_batch_start_iteration(self, iter, geovals(jprof), obs(jprof), &
+                                      profile_index, states(jprof))
+  end do
+
+  ! Get hofx and jacobians of all active profiles with a single forward model call
+  call ufo_rttovonedvarcheck_get_bts_batch(self, geovals, obs, profiles, retrieval_vars, &
+                                           rttov_simobs, hofxdiags, BT(:, 1:size(profiles)))
+
+  do kprof = 1, size(profiles)
+    jprof = profiles(kprof)
+    call ufo_rttovonedvarcheck_get_jacobian_from_batch(self, geovals(jprof), obs(jprof), &
+                                           obs(jprof) % channels_used, profile_index, &
+                                           hofxdiags, kprof, BT(:, kprof), &
+                                           states(jprof) % Y, states(jprof) % H_matrix)
+    call newton_batch_finish_iteration(self, iter, geovals(jprof), obs(jprof), &
+                                       r_matrices(jprof), b_matrices(:,:,jprof), &
+                                       b_inverses(:,:,jprof), b_sigmas(:,jprof), &
+                                       profile_index, states(jprof))
+  end do
+
+end do Iterations
+
+! Profiles still running have used up all the iterations
+do jprof = 1, nprofiles
+  if (states(jprof) % running) states(jprof) % niter = iter
+end do
+
+! ---------------------------------------------------
+! Final costs, output profiles and diagnostics
+! ---------------------------------------------------
+do jprof = 1, nprofiles
+
+  ! Recalculate final cost - to make sure output when profile has not converged
+  call ufo_rttovonedvarcheck_CostFunction(states(jprof) % Xdiff, b_inverses(:,:,jprof), &
+                                          states(jprof) % Ydiff, r_matrices(jprof), Jout, self % verbose)
+  obs(jprof) % final_cost = Jout(1)
+  obs(jprof) % niter = states(jprof) % niter
+
+  if (states(jprof) % converged) then
+    obs(jprof) % output_profile(:) = states(jprof) % GuessProfile(:)
+
+    ! Recalculate final cost - to make sure output when using profile convergence
+    call ufo_rttovonedvarcheck_CostFunction(states(jprof) % Diffprofile, b_inverses(:,:,jprof), &
+                                            states(jprof) % Ydiff, r_matrices(jprof), Jout, self % verbose)
+    obs(jprof) % final_cost = Jout(1)
+
+    ! If lwp output required then recalculate
+    if (self % Store1DVarLWP) then
+      call ufo_rttovonedvarcheck_CheckCloudyIteration( geovals(jprof), & ! in
+                                              profile_index,           & ! in
+                                              self % nlevels,          & ! in
+                                              self % verbose,          & ! in
+                                              states(jprof) % OutOfRange, & ! out
+                                              OutLWP = obs(jprof) % LWP ) ! out
+    end if
+  end if
+
+  if (self % UseJForConvergence .and. self % FullDiagnostics) then
+    write(*,'(A70,3F10.3,I5,2L5)') "Newton J initial, final, lowest, iter, converged, outofrange = ", &
+                                   states(jprof) % JCostorig, states(jprof) % Jcost, &
+                                   states(jprof) % Jcost, states(jprof) % niter, &
+                                   states(jprof) % converged, states(jprof) % outOfRange
+  end if
+
+end do
+
+! Recalculate final BTs for all channels of the converged profiles
+profiles = pack([(jprof, jprof = 1, nprofiles)], states(:) % converged)
+if (size(profiles) > 0) then
+  call ufo_rttovonedvarcheck_get_bts_batch(self, geovals, obs, profiles, retrieval_vars, &
+                                           rttov_simobs, hofxdiags, BT(:, 1:size(profiles)))
+  do kprof = 1, size(profiles)
+    jprof = profiles(kprof)
+    allocate(out_H_matrix(size(obs(jprof) % channels_all),nprofelements))
+    allocate(out_Y(size(obs(jprof) % channels_all)))
+    call ufo_rttovonedvarcheck_get_jacobian_from_batch(self, geovals(jprof), obs(jprof), &
+                                           obs(jprof) % channels_all, profile_index, &
+                                           hofxdiags, kprof, BT(:, kprof), &
+                                           out_Y(:), out_H_matrix)
+    obs(jprof) % output_BT(:) = out_Y(:)
+    deallocate(out_Y)
+    deallocate(out_H_matrix)
+  end do
+end if
+
+onedvar_success(:) = states(:) % converged
+
+! ----------
+! Tidy up
+! ----------
+call ufo_geovals_delete(hofxdiags)
+do jprof = 1, nprofiles
+  call ufo_geovals_delete(geovals(jprof))
+end do
+deallocate(geovals)
+deallocate(states)
+deallocate(BT)
+
+if (self % verbose) call fckit_log % debug("finished with ufo_rttovonedvarcheck_minimize_newton_batch")
+
+end subroutine ufo_rttovonedvarcheck_minimize_newton_batch
+
+!------------------------------------------------------------------------------
+!> First part of a Newton iteration of a profile of a batch: everything before
+!! the forward model call.
+!!
+!! \author Met Office
+!!
+!! \date 09/06/2021: Created
+!!
+subroutine newton_batch_start_iteration(self, iter, geovals, ob, profile_index, state)
+
+implicit none
+
+type(ufo_rttovonedvarcheck), intent(in)           :: self          !< Main 1D-Var object
+integer, intent(in)                               :: iter          !< iteration number
+type(ufo_geovals), intent(in)                     :: geovals       !< model data at obs location
+type(ufo_rttovonedvarcheck_ob), intent(in)        :: ob            !< satellite metadata
+type(ufo_rttovonedvarcheck_profindex), intent(in) :: profile_index !< index array for x vector
+type(newton_state), intent(inout)                 :: state         !< minimization state
+
+! Save cost from previous iteration
+if (self % UseJForConvergence) then
+  state % JcostOld = state % Jcost
+end if
+
+! initialise profile increments on first iteration
+if (iter == 1) then
+
+  state % Diffprofile(:) = zero
+  state % JcostOld = 1.0e4_kind_real
+
+  ! Map GeovaLs to 1D-var profile using B matrix profile structure
+  call ufo_rttovonedvarcheck_GeoVaLs2ProfVec(geovals, profile_index, &
+                                             ob, state % GuessProfile(:))
+
+  if (self % FullDiagnostics) &
+    write(*,*) "Humidity GuessProfile 1st iteration = ", &
+               state % GuessProfile(profile_index % qt(1):profile_index % qt(2))
+
+end if
+
+! Save current profile
+state % OldProfile(:) = state % GuessProfile(:)
+
+end subroutine newton_batch_start_iteration
+
+!------------------------------------------------------------------------------
+!> Second part of a Newton iteration of a profile of a batch: everything after
+!! the forward model call.  Clears state % running if the minimization of this
+!! profile has finished.
+!!
+!! \author Met Office
+!!
+!! \date 09/06/2021: Created
+!!
+subroutine newton_batch_finish_iteration(self, iter, geovals, ob, r_matrix, b_matrix, &
+                                         b_inv, b_sigma, profile_index, state)
+
+implicit none
+
+type(ufo_rttovonedvarcheck), intent(in)           :: self          !< Main 1D-Var object
+integer, intent(in)                               :: iter          !< iteration number
+type(ufo_geovals), intent(inout)                  :: geovals       !< model data at obs location
+type(ufo_rttovonedvarcheck_ob), intent(inout)     :: ob            !< satellite metadata
+type(ufo_rttovonedvarcheck_rsubmatrix), intent(in) :: r_matrix     !< observation error covariance
+real(kind_real), intent(in)                       :: b_matrix(:,:) !< state error covariance
+real(kind_real), intent(in)                       :: b_inv(:,:)    !< inverse of the state error covariance
+real(kind_real), intent(in)                       :: b_sigma(:)    !< standard deviations of the state error covariance diagonal
+type(ufo_rttovonedvarcheck_profindex), intent(in) :: profile_index !< index array for x vector
+type(newton_state), intent(inout)                 :: state         !< minimization state
+
+integer         :: inversionstatus
+integer         :: nchans, nprofelements
+integer         :: ii, jj
+real(kind_real) :: DeltaJ
+real(kind_real) :: DeltaJo
+real(kind_real) :: Jout(3)
+
+nchans = size(ob % channels_used)
+nprofelements = profile_index % nprofelements
+inversionstatus = 0
+
+if (iter == 1) then
+  state % BackProfile(:) = state % GuessProfile(:)
+  do ii = 1, size(ob % channels_all)
+    do jj = 1, size(ob % channels_used)
+      if (ob % channels_all(ii) == ob % channels_used(jj)) then
+         ob % background_BT(ii) = state % Y(jj)
+      end if
+    end do
+  end do
+end if
+
+! Profile differences
+state % Xdiff(:) = state % GuessProfile(:) - state % BackProfile(:)
+state % Ydiff(:) = ob % yobs(:) - state % Y(:)
+
+if (self % FullDiagnostics) then
+  write(*,*) "Ob BT = "
+  write(*,'(10F10.3)') ob % yobs(:)
+  write(*,*) "HofX BT = "
+  write(*,'(10F10.3)') state % Y(:)
+end if
+
+! Determine convergence using the change in the cost function
+if (self % UseJForConvergence) then
+
+  call ufo_rttovonedvarcheck_CostFunction(state % Xdiff, b_inv, state % Ydiff, r_matrix, Jout, self % verbose)
+  state % Jcost = Jout(1)
+
+  ! store initial cost value
+  if (iter == 1) state % JCostOrig = state % Jcost
+
+  ! check for convergence
+  if (iter > 1) then
+
+    if (self % JConvergenceOption == 1) then
+      ! percentage change tested between iterations
+      DeltaJ = abs ((state % Jcost - state % JcostOld) / max (state % Jcost, tiny (zero)))
+      ! default test for checking that overall cost is getting smaller
+      DeltaJo = -1.0_kind_real
+    else
+      ! absolute change tested between iterations
+      DeltaJ = abs (state % Jcost - state % JcostOld)
+      ! change between current cost and initial
+      DeltaJo = state % Jcost - state % JCostorig
+    end if
+
+    if (self % FullDiagnostics) THEN
+      write (*, '(A,F12.5)') 'Cost Function = ', state % Jcost
+      write (*, '(A,F12.5)') 'Cost Function old = ', state % JcostOld
+      write (*, '(A,F12.5)') 'Cost Function Increment = ', deltaj
+    end if
+
+    if (DeltaJ < self % cost_convergencefactor .and. &
+        DeltaJo < zero)  then ! overall is cost getting smaller?
+      state % converged = .true.
+      if (self % FullDiagnostics) then
+        write (*, '(A,I0)') 'Iteration', iter
+        write (*, '(A)') '------------'
+        write (*, '(A,L1)') 'Status: converged = ', state % converged
+        write (*, '(A)') 'New profile:'
+        call ufo_geovals_print(geovals, 1)
+        write (*, '(A)')
+        write (*, '(A,3F12.5)') 'Cost Function, increment, cost_convergencefactor = ', &
+                                 state % Jcost, deltaj, self % cost_convergencefactor
+      end if
+      call newton_batch_stop(state, iter)
+      return
+    end if
+
+  end if
+
+end if ! end of specific code for cost test convergence
+
+! Iterate (Guess) profile vector
+if (nchans > nprofelements) then
+  call ufo_rttovonedvarcheck_NewtonManyChans (state % Ydiff, nchans,  &
+                                   state % H_matrix(:,:),             & ! in
+                                   transpose (state % H_matrix(:,:)), & ! in
+                                   nprofelements,                     &
+                                   state % Diffprofile,               &
+                                   b_inv,                             &
+                                   r_matrix,                          &
+                                   inversionStatus)
+else ! nchans <= nprofelements
+  call ufo_rttovonedvarcheck_NewtonFewChans (state % Ydiff, nchans,  &
+                                  state % H_matrix(:,:),             & ! in
+                                  transpose (state % H_matrix(:,:)), & ! in
+                                  nprofelements,                     &
+                                  state % Diffprofile,               &
+                                  b_matrix,                          &
+                                  r_matrix,                          &
+                                  inversionStatus)
+end if
+
+if (inversionStatus /= 0) then
+  if (self % verbose) write(*,*) "inversion failed"
+  call newton_batch_stop(state, iter)
+  return
+end if
+
+state % GuessProfile(:) = state % BackProfile(:) + state % Diffprofile(:)
+
+! Check profile and constrain humidity variables
+call ufo_rttovonedvarcheck_CheckIteration (self, & ! in
+                                geovals,         & ! in
+                                profile_index,   & ! in
+                                state % GuessProfile(:), & ! inout
+                                state % outOfRange)        ! out
+
+! Update geovals with guess profile
+call ufo_rttovonedvarcheck_ProfVec2GeoVaLs(geovals, profile_index, &
+                                           ob, state % GuessProfile, self % UseQtSplitRain)
+
+! if qtotal in retrieval vector check cloud variables for current iteration
+if ((.NOT. state % outofRange) .and. profile_index % qt(1) > 0) then
+  if (iter >= self % IterNumForLWPCheck) then
+    call ufo_rttovonedvarcheck_CheckCloudyIteration( geovals, & ! in
+                                          profile_index,      & ! in
+                                          self % nlevels,     & ! in
+                                          self % verbose,     & ! in
+                                          state % OutOfRange )  ! out
+  end if
+end if
+
+! Check for convergence using change in profile
+if ((.NOT. state % outOfRange) .and. (.NOT. self % UseJForConvergence)) then
+  if (ALL (abs(state % GuessProfile(:) - state % OldProfile(:)) <= &
+           b_sigma(:) * self % ConvergenceFactor)) then
+    if (self % verbose) call fckit_log % debug("Profile used for convergence")
+    state % converged = .true.
+  end if
+end if
+
+if (self % FullDiagnostics) then
+  write (*, '(A,I0)') 'Iteration', iter
+  write (*, '(A)') '------------'
+  write (*, '(A,L1)') 'Status: converged = ', state % converged
+  if (state % outOfRange) write (*, '(A)') 'exiting with bad increments'
+  write (*, '(A)') 'New profile:'
+  call ufo_geovals_print(geovals, 1)
+  write (*, '(A)')
+end if
+
+if (state % converged .or. state % outOfRange) call newton_batch_stop(state, iter)
+
+end subroutine newton_batch_finish_iteration
+
+!------------------------------------------------------------------------------
+!> Mark the minimization of a profile of a batch as finished.
+!!
+!! \author Met Office
+!!
+!! \date 09/06/2021: Created
+!!
+subroutine newton_batch_stop(state, iter)
+
+implicit none
+
+type(newton_state), intent(inout) :: state !< minimization state
+integer, intent(in)               :: iter  !< last iteration performed
+
+state % running = .false.
+state % niter = iter
+
+end subroutine newton_batch_stop
+
 !------------------------------------------------------------------------------
 !> Update the profile if newber of channels is less than number of elements in 
 !! the profile
@@ -32,6 +32,7 @@ public ufo_rttovonedvarcheck_CheckCloudyIteration
 public ufo_rttovonedvarcheck_PrintIterInfo
 
 character(len=max_string) :: message
+!$omp threadprivate(message)
 
 contains
 
@@ -484,7 +485,7 @@ real(kind_real)              :: skin_t, pressure_2m, temperature_2m, NewT
 integer                      :: level_1000hpa, level_950hpa
 
 write(message, *) routinename, " : started"
-call fckit_log % debug(message)
+if (self % verbose) call fckit_log % debug(message)
 
 ! -------------------------------------------
 ! Load variables needed by multiple routines
@@ -715,7 +716,7 @@ if (allocated(ql))             deallocate(ql)
 if (allocated(qi))             deallocate(qi)
 
 write(message, *) routinename, " : ended"
-call fckit_log % debug(message)
+if (self % verbose) call fckit_log % debug(message)
 
 end subroutine ufo_rttovonedvarcheck_check_geovals
 
@@ -733,7 +734,7 @@ end subroutine ufo_rttovonedvarcheck_check_geovals
 !!
 subroutine ufo_rttovonedvarcheck_CostFunction(DeltaProf, b_inv, &
                                               DeltaObs, r_matrix, &
-                                              Jcost)
+                                              Jcost, verbose)
 
 implicit none
 
@@ -743,6 +744,7 @@ real(kind_real), intent(in)       :: b_inv(:,:)
 real(kind_real), intent(in)       :: DeltaObs(:)
 type(ufo_rttovonedvarcheck_rsubmatrix), intent(in) :: r_matrix
 real(kind_real), intent(out)      :: Jcost(3)
+logical, intent(in)               :: verbose
 
 ! Local arguments:
 character(len=*), parameter  :: RoutineName = "ufo_rttovonedvarcheck_CostFunction"
@@ -766,8 +768,10 @@ Jcost(1) = (Jo + Jb) * two / real (y_size, kind_real)   ! Normalize cost by ncha
 Jcost(2) = Jb * two / real (y_size, kind_real)          ! Normalize cost by nchans
 Jcost(3) = Jo * two / real (y_size, kind_real)          ! Normalize cost by nchans
 
-write(message,*) "Jo, Jb, Jcurrent = ", Jo, Jb, Jcost(1)
-call fckit_log % debug(message)
+if (verbose) then
+  write(message,*) "Jo, Jb, Jcurrent = ", Jo, Jb, Jcost(1)
+  call fckit_log % debug(message)
+end if
 
 deallocate(RinvDeltaY)
 
@@ -1051,6 +1055,7 @@ subroutine ufo_rttovonedvarcheck_CheckCloudyIteration( &
   geovals,       & ! in
   profindex,     & ! in
   nlevels_1dvar, & ! in
+  verbose,       & ! in
   OutOfRange,    & ! out
   OutLWP         ) ! out
 
@@ -1059,6 +1064,7 @@ implicit none
 type(ufo_geovals), intent(in)          :: geovals
 type(ufo_rttovonedvarcheck_profindex), intent(in) :: profindex
 integer, intent(in)                    :: nlevels_1dvar
+logical, intent(in)                    :: verbose
 logical, intent(out)                   :: OutOfRange
 real(kind_real), optional, intent(out) :: OutLWP
 
@@ -1150,12 +1156,12 @@ if (any(ciw(:) > zero) .or. &
 !2.1 test if lwp iwp exceeds thresholds
 
   if ((IWP > MaxIWP) .or. (LWP > MaxLWP)) then
-    call fckit_log % debug("lwp or iwp exceeds thresholds")
+    if (verbose) call fckit_log % debug("lwp or iwp exceeds thresholds")
     OutOfRange = .true.
-    write(message,*) "lwp and iwp = ",LWP,IWP
-    call fckit_log % debug(message)
   else
-    call fckit_log % debug("lwp and iwp less than thresholds")
+    if (verbose) call fckit_log % debug("lwp and iwp less than thresholds")
+  end if
+  if (verbose) then
     write(message,*) "lwp and iwp = ",LWP,IWP
     call fckit_log % debug(message)
   end if
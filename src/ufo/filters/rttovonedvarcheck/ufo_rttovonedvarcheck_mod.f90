@@ -108,43 +108,31 @@ subroutine ufo_rttovonedvarcheck_apply(self, f_conf, vars, retrieval_vars, geova
 
   type(ufo_rttovonedvarcheck_obs)        :: obs            ! data for all observations read from db
   type(ufo_metoffice_bmatrixstatic)      :: full_bmatrix   ! full bmatrix read from file
-  type(ufo_geovals)                      :: local_geovals  ! geoval for one observation
-  type(ufo_rttovonedvarcheck_ob)         :: ob             ! observation data for a single observation
   type(ufo_rttovonedvarcheck_profindex)  :: prof_index     ! index for mapping geovals to 1d-var state profile
   type(ufo_metoffice_rmatrixradiance)    :: full_rmatrix   ! full r_matrix read from file
-  type(ufo_rttovonedvarcheck_rsubmatrix) :: r_submatrix    ! r_submatrix object
-  type(ufo_geovals)                      :: hofxdiags      ! hofxdiags containing jacobian
   type(ufo_rttovonedvarcheck_pcemis), target :: IR_pcemis  ! Infrared principal components object
-  type(ufo_geoval), pointer          :: geoval
   character(len=max_string)          :: sensor_id
   character(len=max_string)          :: var
   character(len=max_string)          :: varname
   character(len=max_string)          :: message
   integer                            :: jvar, ivar, jobs, band, ii ! counters
-  integer                            :: nchans_used      ! counter for number of channels used for an ob
-  integer                            :: jchans_used
   integer                            :: fileunit        ! unit number for reading in files
   integer                            :: apply_count
   integer                            :: nprofelements   ! number of elements in 1d-var state profile
   integer, allocatable               :: fields_in(:)
   real(kind_real)                    :: missing         ! missing value
   real(kind_real)                    :: t1, t2          ! timing
-  real(kind_real), allocatable       :: b_matrix(:,:)   ! 1d-var profile b matrix
-  real(kind_real), allocatable       :: b_inverse(:,:)  ! inverse for each 1d-var profile b matrix
-  real(kind_real), allocatable       :: b_sigma(:)      ! b_matrix diagonal error
   logical                            :: file_exists     ! check if a file exists logical
-  logical                            :: onedvar_success
   logical                            :: cloud_retrieval = .false.
   type(ufo_radiancerttov)            :: rttov_simobs
+  integer                            :: chunk_size      ! number of observations per threaded task
+  integer                            :: jchunk, first_ob, last_ob
 
   ! ------------------------------------------
   ! 1. Setup
   ! ------------------------------------------
   missing = missing_value(missing)
 
-  ! Setup rttov simobs
-  call rttov_simobs % setup(f_conf, self % channels)
-
   ! Setup IR emissivity - if needed
   if (self % pcemiss) then
     if (len(self % EmisAtlas) > 4) then
@@ -175,11 +163,6 @@ subroutine ufo_rttovonedvarcheck_apply(self, f_conf, vars, retrieval_vars, geova
   ! Read in observation data from obsspace
   call obs % setup(self, prof_index % nprofelements, geovals, vars, IR_pcemis)
 
-  ! Initialize data arrays
-  allocate(b_matrix(prof_index % nprofelements,prof_index % nprofelements))
-  allocate(b_inverse(prof_index % nprofelements,prof_index % nprofelements))
-  allocate(b_sigma(prof_index % nprofelements))
-
   ! Decide on loop parameters - testing
   if (self % StartOb == 0) self % StartOb = 1
   if (self % FinishOb == 0) self % FinishOb = obs % iloc
@@ -193,92 +176,146 @@ subroutine ufo_rttovonedvarcheck_apply(self, f_conf, vars, retrieval_vars, geova
   ! ------------------------------------------
   write(*,*) "Beginning loop over observations: ",trim(self%qcname)
   apply_count = 0
-  obs_loop: do jobs = self % StartOb, self % FinishOb
+  if (self % NumThreads > 1) then
+
+    ! Each thread needs its own rttov object, as it holds the profiles and
+    ! radiances of the current call.  Each observation only updates its own
+    ! column of obs, so the results do not depend on the number of threads.
+    ! Nothing is logged and self is not modified inside the parallel region.
+    write(message, *) "Processing observations on ", self % NumThreads, " threads"
+    call fckit_log % info(message)
+    if (self % ProfilesPerBatch > 1 .and. .not. self % UseMLMinimization) then
+      chunk_size = 4 * self % ProfilesPerBatch
+    else
+      chunk_size = 1
+    end if
+
+    !$omp parallel num_threads(self % NumThreads) default(shared) &
+    !$omp   private(rttov_simobs, jchunk, first_ob, last_ob) reduction(+:apply_count)
+    call rttov_simobs % setup(f_conf, self % channels, quiet=.true.)
+
+    !$omp do schedule(dynamic)
+    do jchunk = 1, (self % FinishOb - self % StartOb) / chunk_size + 1
+      first_ob = self % StartOb + (jchunk - 1) * chunk_size
+      last_ob = min(first_ob + chunk_size - 1, self % FinishOb)
+      call ufo_rttovonedvarcheck_minimize_range(self, obs, apply, geovals, retrieval_vars, &
+                                    full_bmatrix, full_rmatrix, prof_index, IR_pcemis, &
+                                    cloud_retrieval, rttov_simobs, first_ob, last_ob, apply_count)
+    end do
+    !$omp end do
+
+    call rttov_simobs % delete()
+    !$omp end parallel
+
+  else
+
+    call rttov_simobs % setup(f_conf, self % channels)
+    call ufo_rttovonedvarcheck_minimize_range(self, obs, apply, geovals, retrieval_vars, &
+                                  full_bmatrix, full_rmatrix, prof_index, IR_pcemis, &
+                                  cloud_retrieval, rttov_simobs, self % StartOb, self % FinishOb, &
+                                  apply_count)
+    call rttov_simobs % delete()
+
+  end if
+
+  !---------------------------------------------------
+  ! 3.0 Return variables and tidy up
+  !---------------------------------------------------
+
+  write(message, *) "Total number of observations = ", obs % iloc
+  call fckit_log % info(message)
+  write(message, *) "Number tested by 1dvar = ", apply_count
+  call fckit_log % info(message)
+
+  ! Put qcflags and output variables into observation space
+  call obs % output(self % obsdb, prof_index, vars, self % nchans)
+
+  ! Tidy up memory used for all observations
+  call full_bmatrix % delete()
+  call full_rmatrix % delete()
+  call obs % delete()
+  if (self % pcemiss) call IR_pcemis % delete()
+
+end subroutine ufo_rttovonedvarcheck_apply
+
+! ------------------------------------------------------------------------------
+!> Run the 1D-Var for the observations first_ob to last_ob
+!!
+!! \details Profiles are minimized in batches if ProfilesPerBatch is greater
+!! than one and the Newton minimizer is used, otherwise one at a time.  All
+!! the objects used for a single observation are local to this routine, so
+!! it can be called for different ranges on different threads as long as
+!! each thread has its own rttov_simobs.
+!!
+!! \author Met Office
+!!
+!! \date 09/06/2021: Created
+!!
+subroutine ufo_rttovonedvarcheck_minimize_range(self, obs, apply, geovals, retrieval_vars, &
+                                   full_bmatrix, full_rmatrix, prof_index, IR_pcemis, &
+                                   cloud_retrieval, rttov_simobs, first_ob, last_ob, apply_count)
+
+  implicit none
+  type(ufo_rttovonedvarcheck), intent(in)       :: self            !< rttovonedvarcheck main object
+  type(ufo_rttovonedvarcheck_obs), intent(inout) :: obs            !< data for all observations
+  logical, intent(in)                           :: apply(:)        !< qc manager flags
+  type(ufo_geovals), intent(in)                 :: geovals         !< model values at observation space
+  type(oops_variables), intent(in)              :: retrieval_vars  !< retrieval variables for 1D-Var
+  type(ufo_metoffice_bmatrixstatic), intent(in) :: full_bmatrix    !< full bmatrix read from file
+  type(ufo_metoffice_rmatrixradiance), intent(in) :: full_rmatrix  !< full r_matrix read from file
+  type(ufo_rttovonedvarcheck_profindex), intent(in) :: prof_index  !< index for mapping geovals to profile
+  type(ufo_rttovonedvarcheck_pcemis), target, intent(inout) :: IR_pcemis !< Infrared principal components object
+  logical, intent(in)                           :: cloud_retrieval !< cloud retrieval flag
+  type(ufo_radiancerttov), intent(inout)        :: rttov_simobs    !< rttov simulate obs object
+  integer, intent(in)                           :: first_ob        !< first observation to process
+  integer, intent(in)                           :: last_ob         !< last observation to process
+  integer, intent(inout)                        :: apply_count     !< number of observations tested
+
+  type(ufo_geovals)                      :: local_geovals  ! geoval for one observation
+  type(ufo_rttovonedvarcheck_ob)         :: ob             ! observation data for a single observation
+  type(ufo_rttovonedvarcheck_rsubmatrix) :: r_submatrix    ! r_submatrix object
+  type(ufo_geovals)                      :: hofxdiags      ! hofxdiags containing jacobian
+  real(kind_real), allocatable           :: b_matrix(:,:)  ! 1d-var profile b matrix
+  real(kind_real), allocatable           :: b_inverse(:,:) ! inverse for each 1d-var profile b matrix
+  real(kind_real), allocatable           :: b_sigma(:)     ! b_matrix diagonal error
+  character(len=max_string)              :: message
+  integer                                :: jobs
+  integer                                :: nchans_used    ! number of channels used for an ob
+  logical                                :: onedvar_success
+
+  if (self % ProfilesPerBatch > 1 .and. .not. self % UseMLMinimization) then
+    call ufo_rttovonedvarcheck_minimize_batches(self, obs, apply, geovals, retrieval_vars, &
+                                    full_bmatrix, full_rmatrix, prof_index, IR_pcemis, &
+                                    cloud_retrieval, rttov_simobs, first_ob, last_ob, apply_count)
+    return
+  end if
+
+  ! Initialize data arrays
+  allocate(b_matrix(prof_index % nprofelements,prof_index % nprofelements))
+  allocate(b_inverse(prof_index % nprofelements,prof_index % nprofelements))
+  allocate(b_sigma(prof_index % nprofelements))
+
+  obs_loop: do jobs = first_ob, last_ob
     if (apply(jobs)) then
 
       apply_count = apply_count + 1
       write(message, *) "starting obs number    ",jobs
-      call fckit_log % debug(message)
-      !---------------------------------------------------
-      ! 2.1 Setup Jb terms
-      !---------------------------------------------------
-      ! create one ob geovals from full all obs geovals
-      call ufo_geovals_copy_one(local_geovals, geovals, jobs)
-      call ufo_rttovonedvarcheck_check_geovals(self, local_geovals, &
-              prof_index, obs % surface_type(jobs))
-
-      ! create b matrix arrays for this single observation location
-      call full_bmatrix % reset( obs % lat(jobs), & ! in
-                    b_matrix, b_inverse, b_sigma  ) ! out
+      if (self % verbose) call fckit_log % debug(message)
 
       !---------------------------------------------------
-      ! 2.2 Setup Jo terms
+      ! 2.1 Setup Jb and Jo terms
       !---------------------------------------------------
-      ! Channel selection based on previous filters flags
-      nchans_used = 0
-      do jvar = 1, self%nchans
-        if( obs % QCflags(jvar,jobs) == self % passflag ) then
-          nchans_used = nchans_used + 1
-        end if
-      end do
-      if (nchans_used == 0) then
-        write(message, *) "No channels selected for observation number ", &
-               jobs, " : skipping"
-        call fckit_log % debug(message)
-        cycle obs_loop
-      end if
-
-      ! setup ob data for this observation
-      call ob % setup(nchans_used, self %  nlevels, prof_index % nprofelements, self % nchans)
-      ob % forward_mod_name = self % forward_mod_name
-      ob % latitude = obs % lat(jobs)
-      ob % longitude = obs % lon(jobs)
-      ob % elevation = obs % elevation(jobs)
-      ob % sensor_zenith_angle = obs % sat_zen(jobs)
-      ob % sensor_azimuth_angle = obs % sat_azi(jobs)
-      ob % solar_zenith_angle = obs % sol_zen(jobs)
-      ob % solar_azimuth_angle = obs % sol_azi(jobs)
-      ob % channels_all = self % channels
-      ob % surface_type = obs % surface_type(jobs)
-      ob % retrievecloud = cloud_retrieval
-      ob % pcemis => IR_pcemis
-      ob % calc_emiss = obs % calc_emiss(jobs)
-      if(self % RTTOV_mwscattSwitch) ob % mwscatt = .true.
-      if(self % RTTOV_usetotalice) ob % mwscatt_totalice = .true.
-
-      ! Store background T in ob data space
-      call ufo_geovals_get_var(local_geovals, var_ts, geoval)
-      ob % background_T(:) = geoval%vals(:, 1) ! K
-
-      ! Create obs vector and r matrix
-      jchans_used = 0
-      do jvar = 1, self%nchans
-        if( obs % QCflags(jvar,jobs) == self % passflag ) then
-          jchans_used = jchans_used + 1
-          ob % yobs(jchans_used) = obs % yobs(jvar, jobs)
-          ob % channels_used(jchans_used) = self % channels(jvar)
-          ob % emiss(jchans_used) = obs % emiss(jvar, jobs)
-        end if
-      end do
-      call r_submatrix % setup(nchans_used, ob % channels_used, full_rmatrix=full_rmatrix)
+      call ufo_rttovonedvarcheck_setup_ob(self, obs, jobs, geovals, full_bmatrix, &
+                                          full_rmatrix, prof_index, IR_pcemis, &
+                                          cloud_retrieval, local_geovals, ob, r_submatrix, &
+                                          b_matrix, b_inverse, b_sigma, nchans_used)
+      if (nchans_used == 0) cycle obs_loop
 
       ! Setup hofxdiags for this retrieval
       call ufo_geovals_setup(hofxdiags, retrieval_vars, 1)
 
-      if (self % FullDiagnostics) then
-        call ob % info()
-        call r_submatrix % info()
-        write(*, *) "Observations used = ",ob % yobs(:)
-        write(*,*) "ob % emiss = ",ob % emiss
-        write(*,*) "ob % calc_emiss = ",ob % calc_emiss
-        write(*,*) "Channel selection = "
-        write(*,'(15I5)') ob % channels_used
-        write(*,*) "All Channels = "
-        write(*,'(15I5)') ob % channels_all
-      end if
-
       !---------------------------------------------------
-      ! 2.3 Call minimization
+      ! 2.2 Call minimization
       !---------------------------------------------------
       if (self % UseMLMinimization) then
         call ufo_rttovonedvarcheck_minimize_ml(self, ob, &
@@ -292,21 +329,7 @@ subroutine ufo_rttovonedvarcheck_apply(self, f_conf, vars, retrieval_vars, geova
                                       prof_index, onedvar_success)
       end if
 
-      obs % output_BT(:, jobs) = ob % output_BT(:)
-      obs % background_BT(:, jobs) = ob % background_BT(:)
-      obs % output_profile(:,jobs) = ob % output_profile(:)
-      obs % final_cost(jobs) = ob % final_cost
-      obs % LWP(jobs) = ob % LWP
-      obs % niter(jobs) = ob % niter
-
-      ! Set QCflags based on output from minimization
-      if (.NOT. onedvar_success) then
-        do jvar = 1, self%nchans
-          if( obs % QCflags(jvar,jobs) == 0 ) then
-            obs % QCflags(jvar,jobs) = self % onedvarflag
-          end if
-        end do
-      end if
+      call ufo_rttovonedvarcheck_store_ob(self, obs, jobs, ob, onedvar_success)
 
       ! Tidy up memory specific to a single observation
       call ufo_geovals_delete(local_geovals)
@@ -315,33 +338,275 @@ subroutine ufo_rttovonedvarcheck_apply(self, f_conf, vars, retrieval_vars, geova
       call r_submatrix % delete()
 
     else
-      call fckit_log % info("Final 1Dvar cost, apply = F")
+      if (self % verbose) call fckit_log % info("Final 1Dvar cost, apply = F")
 
     endif
   end do obs_loop
 
+  deallocate(b_matrix, b_inverse, b_sigma)
+
+end subroutine ufo_rttovonedvarcheck_minimize_range
+
+! ------------------------------------------------------------------------------
+!> Run the 1D-Var for the observations first_ob to last_ob, minimizing batches of profiles together
+!!
+!! \details Observations are collected into batches of up to ProfilesPerBatch
+!! profiles, each of which is minimized by ufo_rttovonedvarcheck_minimize_newton_batch
+!! with a single forward model call per iteration.
+!!
+!! \author Met Office
+!!
+!! \date 09/06/2021: Created
+!!
+subroutine ufo_rttovonedvarcheck_minimize_batches(self, obs, apply, geovals, retrieval_vars, &
+                                   full_bmatrix, full_rmatrix, prof_index, IR_pcemis, &
+                                   cloud_retrieval, rttov_simobs, first_ob, last_ob, apply_count)
+
+  implicit none
+  type(ufo_rttovonedvarcheck), intent(in)       :: self            !< rttovonedvarcheck main object
+  type(ufo_rttovonedvarcheck_obs), intent(inout) :: obs            !< data for all observations
+  logical, intent(in)                           :: apply(:)        !< qc manager flags
+  type(ufo_geovals), intent(in)                 :: geovals         !< model values at observation space
+  type(oops_variables), intent(in)              :: retrieval_vars  !< retrieval variables for 1D-Var
+  type(ufo_metoffice_bmatrixstatic), intent(in) :: full_bmatrix    !< full bmatrix read from file
+  type(ufo_metoffice_rmatrixradiance), intent(in) :: full_rmatrix  !< full r_matrix read from file
+  type(ufo_rttovonedvarcheck_profindex), intent(in) :: prof_index  !< index for mapping geovals to profile
+  type(ufo_rttovonedvarcheck_pcemis), target, intent(inout) :: IR_pcemis !< Infrared principal components object
+  logical, intent(in)                           :: cloud_retrieval !< cloud retrieval flag
+  type(ufo_radiancerttov), intent(inout)        :: rttov_simobs    !< rttov simulate obs object
+  integer, intent(in)                           :: first_ob        !< first observation to process
+  integer, intent(in)                           :: last_ob         !< last observation to process
+  integer, intent(inout)                        :: apply_count     !< number of observations tested
+
+  type(ufo_geovals), allocatable                      :: batch_geovals(:)
+  type(ufo_rttovonedvarcheck_ob), allocatable         :: batch_obs(:)
+  type(ufo_rttovonedvarcheck_rsubmatrix), allocatable :: batch_rmatrices(:)
+  real(kind_real), allocatable :: b_matrices(:,:,:), b_inverses(:,:,:), b_sigmas(:,:)
+  integer, allocatable         :: batch_obs_index(:)
+  logical, allocatable         :: onedvar_success(:)
+  character(len=max_string)    :: message
+  integer                      :: nbatch, nprofiles, nprofelements, nchans_used, jobs
+
+  nbatch = self % ProfilesPerBatch
+  nprofelements = prof_index % nprofelements
+  allocate(batch_geovals(nbatch))
+  allocate(batch_obs(nbatch))
+  allocate(batch_rmatrices(nbatch))
+  allocate(b_matrices(nprofelements, nprofelements, nbatch))
+  allocate(b_inverses(nprofelements, nprofelements, nbatch))
+  allocate(b_sigmas(nprofelements, nbatch))
+  allocate(batch_obs_index(nbatch))
+  allocate(onedvar_success(nbatch))
+
+  nprofiles = 0
+  obs_loop: do jobs = first_ob, last_ob
+    if (apply(jobs)) then
+
+      apply_count = apply_count + 1
+      write(message, *) "starting obs number    ",jobs
+      if (self % verbose) call fckit_log % debug(message)
+
+      call ufo_rttovonedvarcheck_setup_ob(self, obs, jobs, geovals, full_bmatrix, &
+                                          full_rmatrix, prof_index, IR_pcemis, cloud_retrieval, &
+                                          batch_geovals(nprofiles + 1), batch_obs(nprofiles + 1), &
+                                          batch_rmatrices(nprofiles + 1), &
+                                          b_matrices(:, :, nprofiles + 1), &
+                                          b_inverses(:, :, nprofiles + 1), &
+                                          b_sigmas(:, nprofiles + 1), nchans_used)
+      if (nchans_used == 0) cycle obs_loop
+
+      nprofiles = nprofiles + 1
+      batch_obs_index(nprofiles) = jobs
+      if (nprofiles == nbatch) call minimize_batch()
+
+    else
+      if (self % verbose) call fckit_log % info("Final 1Dvar cost, apply = F")
+
+    end if
+  end do obs_loop
+
+  if (nprofiles > 0) call minimize_batch()
+
+  deallocate(batch_geovals, batch_obs, batch_rmatrices)
+  deallocate(b_matrices, b_inverses, b_sigmas, batch_obs_index, onedvar_success)
+
+contains
+
+  !> Minimize the profiles collected so far and store the results
+  subroutine minimize_batch()
+
+    integer :: jprof
+
+    call ufo_rttovonedvarcheck_minimize_newton_batch(self, batch_obs(1:nprofiles), &
+                                  batch_rmatrices(1:nprofiles), &
+                                  b_matrices(:, :, 1:nprofiles), b_inverses(:, :, 1:nprofiles), &
+                                  b_sigmas(:, 1:nprofiles), batch_geovals(1:nprofiles), &
+                                  retrieval_vars, rttov_simobs, prof_index, &
+                                  onedvar_success(1:nprofiles))
+
+    do jprof = 1, nprofiles
+      call ufo_rttovonedvarcheck_store_ob(self, obs, batch_obs_index(jprof), &
+                                          batch_obs(jprof), onedvar_success(jprof))
+      call ufo_geovals_delete(batch_geovals(jprof))
+      call batch_obs(jprof) % delete()
+      call batch_rmatrices(jprof) % delete()
+    end do
+    nprofiles = 0
+
+  end subroutine minimize_batch
+
+end subroutine ufo_rttovonedvarcheck_minimize_batches
+
+! ------------------------------------------------------------------------------
+!> Setup the Jb and Jo terms for a single observation
+!!
+!! \details Returns nchans_used = 0 if no channels are selected for this
+!! observation, which should then be skipped.
+!!
+!! \author Met Office
+!!
+!! \date 09/06/2020: Created
+!!
+subroutine ufo_rttovonedvarcheck_setup_ob(self, obs, jobs, geovals, full_bmatrix, &
+                                          full_rmatrix, prof_index, IR_pcemis, &
+                                          cloud_retrieval, local_geovals, ob, r_submatrix, &
+                                          b_matrix, b_inverse, b_sigma, nchans_used)
+
+  implicit none
+  type(ufo_rttovonedvarcheck), intent(in)       :: self            !< rttovonedvarcheck main object
+  type(ufo_rttovonedvarcheck_obs), intent(in)   :: obs             !< data for all observations
+  integer, intent(in)                           :: jobs            !< observation number
+  type(ufo_geovals), intent(in)                 :: geovals         !< model values at observation space
+  type(ufo_metoffice_bmatrixstatic), intent(in) :: full_bmatrix    !< full bmatrix read from file
+  type(ufo_metoffice_rmatrixradiance), intent(in) :: full_rmatrix  !< full r_matrix read from file
+  type(ufo_rttovonedvarcheck_profindex), intent(in) :: prof_index  !< index for mapping geovals to profile
+  type(ufo_rttovonedvarcheck_pcemis), target, intent(inout) :: IR_pcemis !< Infrared principal components object
+  logical, intent(in)                           :: cloud_retrieval !< cloud retrieval flag
+  type(ufo_geovals), intent(inout)              :: local_geovals   !< geoval for this observation
+  type(ufo_rttovonedvarcheck_ob), intent(inout) :: ob              !< observation data for this observation
+  type(ufo_rttovonedvarcheck_rsubmatrix), intent(inout) :: r_submatrix !< r_submatrix object
+  real(kind_real), intent(out)                  :: b_matrix(:,:)   !< 1d-var profile b matrix
+  real(kind_real), intent(out)                  :: b_inverse(:,:)  !< inverse of the b matrix
+  real(kind_real), intent(out)                  :: b_sigma(:)      !< b_matrix diagonal error
+  integer, intent(out)                          :: nchans_used     !< number of channels used
+
+  type(ufo_geoval), pointer :: geoval
+  character(len=max_string) :: message
+  integer                   :: jvar, jchans_used
+
   !---------------------------------------------------
-  ! 3.0 Return variables and tidy up
+  ! Setup Jb terms
   !---------------------------------------------------
+  ! create one ob geovals from full all obs geovals
+  call ufo_geovals_copy_one(local_geovals, geovals, jobs)
+  call ufo_rttovonedvarcheck_check_geovals(self, local_geovals, &
+          prof_index, obs % surface_type(jobs))
 
-  write(message, *) "Total number of observations = ", obs % iloc
-  call fckit_log % info(message)
-  write(message, *) "Number tested by 1dvar = ", apply_count
-  call fckit_log % info(message)
+  ! create b matrix arrays for this single observation location
+  call full_bmatrix % reset( obs % lat(jobs), & ! in
+                b_matrix, b_inverse, b_sigma  ) ! out
 
-  ! Put qcflags and output variables into observation space
-  call obs % output(self % obsdb, prof_index, vars, self % nchans)
+  !---------------------------------------------------
+  ! Setup Jo terms
+  !---------------------------------------------------
+  ! Channel selection based on previous filters flags
+  nchans_used = 0
+  do jvar = 1, self%nchans
+    if( obs % QCflags(jvar,jobs) == self % passflag ) then
+      nchans_used = nchans_used + 1
+    end if
+  end do
+  if (nchans_used == 0) then
+    write(message, *) "No channels selected for observation number ", &
+           jobs, " : skipping"
+    if (self % verbose) call fckit_log % debug(message)
+    return
+  end if
 
-  ! Tidy up memory used for all observations
-  call full_bmatrix % delete()
-  call full_rmatrix % delete()
-  call obs % delete()
-  if (self % pcemiss) call IR_pcemis % delete()
-  if (allocated(b_matrix))  deallocate(b_matrix)
-  if (allocated(b_inverse)) deallocate(b_inverse)
-  if (allocated(b_sigma))   deallocate(b_sigma)
-  call rttov_simobs % delete()
+  ! setup ob data for this observation
+  call ob % setup(nchans_used, self %  nlevels, prof_index % nprofelements, self % nchans)
+  ob % forward_mod_name = self % forward_mod_name
+  ob % latitude = obs % lat(jobs)
+  ob % longitude = obs % lon(jobs)
+  ob % elevation = obs % elevation(jobs)
+  ob % sensor_zenith_angle = obs % sat_zen(jobs)
+  ob % sensor_azimuth_angle = obs % sat_azi(jobs)
+  ob % solar_zenith_angle = obs % sol_zen(jobs)
+  ob % solar_azimuth_angle = obs % sol_azi(jobs)
+  ob % channels_all = self % channels
+  ob % surface_type = obs % surface_type(jobs)
+  ob % retrievecloud = cloud_retrieval
+  ob % pcemis => IR_pcemis
+  ob % calc_emiss = obs % calc_emiss(jobs)
+  if(self % RTTOV_mwscattSwitch) ob % mwscatt = .true.
+  if(self % RTTOV_usetotalice) ob % mwscatt_totalice = .true.
+
+  ! Store background T in ob data space
+  call ufo_geovals_get_var(local_geovals, var_ts, geoval)
+  ob % background_T(:) = geoval%vals(:, 1) ! K
+
+  ! Create obs vector and r matrix
+  jchans_used = 0
+  do jvar = 1, self%nchans
+    if( obs % QCflags(jvar,jobs) == self % passflag ) then
+      jchans_used = jchans_used + 1
+      ob % yobs(jchans_used) = obs % yobs(jvar, jobs)
+      ob % channels_used(jchans_used) = self % channels(jvar)
+      ob % emiss(jchans_used) = obs % emiss(jvar, jobs)
+    end if
+  end do
+  call r_submatrix % setup(nchans_used, ob % channels_used, full_rmatrix=full_rmatrix)
+
+  if (self % FullDiagnostics) then
+    call ob % info()
+    call r_submatrix % info()
+    write(*, *) "Observations used = ",ob % yobs(:)
+    write(*,*) "ob % emiss = ",ob % emiss
+    write(*,*) "ob % calc_emiss = ",ob % calc_emiss
+    write(*,*) "Channel selection = "
+    write(*,'(15I5)') ob % channels_used
+    write(*,*) "All Channels = "
+    write(*,'(15I5)') ob % channels_all
+  end if
 
-end subroutine ufo_rttovonedvarcheck_apply
+end subroutine ufo_rttovonedvarcheck_setup_ob
+
+! ------------------------------------------------------------------------------
+!> Store the results of the minimization of a single observation
+!!
+!! \author Met Office
+!!
+!! \date 09/06/2020: Created
+!!
+subroutine ufo_rttovonedvarcheck_store_ob(self, obs, jobs, ob, onedvar_success)
+
+  implicit none
+  type(ufo_rttovonedvarcheck), intent(in)       :: self            !< rttovonedvarcheck main object
+  type(ufo_rttovonedvarcheck_obs), intent(inout) :: obs            !< data for all observations
+  integer, intent(in)                           :: jobs            !< observation number
+  type(ufo_rttovonedvarcheck_ob), intent(in)    :: ob              !< observation data for this observation
+  logical, intent(in)                           :: onedvar_success !< convergence flag
+
+  integer :: jvar
+
+  obs % output_BT(:, jobs) = ob % output_BT(:)
+  obs % background_BT(:, jobs) = ob % background_BT(:)
+  obs % output_profile(:,jobs) = ob % output_profile(:)
+  obs % final_cost(jobs) = ob % final_cost
+  obs % LWP(jobs) = ob % LWP
+  obs % niter(jobs) = ob % niter
+
+  ! Set QCflags based on output from minimization
+  if (.NOT. onedvar_success) then
+    do jvar = 1, self%nchans
+      if( obs % QCflags(jvar,jobs) == 0 ) then
+        obs % QCflags(jvar,jobs) = self % onedvarflag
+      end if
+    end do
+  end if
+
+end subroutine ufo_rttovonedvarcheck_store_ob
+
+! ------------------------------------------------------------------------------
 
 end module ufo_rttovonedvarcheck_mod
@@ -56,6 +56,9 @@ type, public :: ufo_rttovonedvarcheck
   integer                          :: JConvergenceOption !< integer to select convergence option
   integer                          :: IterNumForLWPCheck !< choose which iteration to start checking LWP
   integer                          :: MaxMLIterations !< maximum number of iterations for internal Marquardt-Levenberg loop
+  integer                          :: ProfilesPerBatch !< number of profiles minimized together by the Newton minimizer
+  integer                          :: NumThreads !< number of OpenMP threads used to process the observations
+  logical                          :: verbose !< log the progress of each retrieval (false when threaded)
   real(kind_real)                  :: ConvergenceFactor !< 1d-var convergence if using change in profile
   real(kind_real)                  :: Cost_ConvergenceFactor !< 1d-var convergence if using % change in cost
   real(kind_real)                  :: EmissLandDefault !< default emissivity value to use over land
@@ -160,6 +163,13 @@ call f_conf % get_or_die("CostConvergenceFactor", self % Cost_ConvergenceFactor)
 ! Maximum number of iterations for internal Marquardt-Levenberg loop
 call f_conf % get_or_die("MaxMLIterations", self % MaxMLIterations)
 
+! Number of profiles minimized together (one rttov call per iteration for all of them)
+call f_conf % get_or_die("ProfilesPerBatch", self % ProfilesPerBatch)
+
+! Number of OpenMP threads used to process the observations
+call f_conf % get_or_die("NumThreads", self % NumThreads)
+self % verbose = (self % NumThreads == 1)
+
 ! Starting observation number for loop - used for testing
 call f_conf % get_or_die("StartOb", self % StartOb)
 
@@ -233,6 +243,8 @@ write(*,*) "IterNumForLWPCheck = ",self % IterNumForLWPCheck
 write(*,*) "ConvergenceFactor = ",self % ConvergenceFactor
 write(*,*) "CostConvergenceFactor = ",self % Cost_ConvergenceFactor
 write(*,*) "MaxMLIterations = ",self % MaxMLIterations
+write(*,*) "ProfilesPerBatch = ",self % ProfilesPerBatch
+write(*,*) "NumThreads = ",self % NumThreads
 write(*,*) "EmissLandDefault = ",self % EmissLandDefault
 write(*,*) "EmissSeaIceDefault = ",self % EmissSeaIceDefault
 write(*,*) "Use PC for Emissivity = ", self % pcemiss
@@ -28,7 +28,7 @@ namespace ufo {
       filtervars_(filtervars),
       flagged_(flagged)
   {
-    profileIndices_.reset(new ProfileIndices(obsdb_, options, apply));
+    profileIndices_.reset(new ProfileIndices(obsdb_, data.recordIndex(), options, apply));
     entireSampleDataHandler_.reset(new EntireSampleDataHandler(obsdb_, options));
   }
 
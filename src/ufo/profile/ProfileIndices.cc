@@ -12,12 +12,15 @@
 
 namespace ufo {
   ProfileIndices::ProfileIndices(ioda::ObsSpace &obsdb,
+                                 const RecordIndex &records,
                                  const DataHandlerParameters &options,
                                  const std::vector <bool> &apply)
     : obsdb_(obsdb),
       options_(options),
       apply_(apply),
-      profileNums_(obsdb.recnum())
+      profileNums_(obsdb.recnum()),
+      records_(records),
+      recordCurrent_(0)
   {
     this->reset();
 
@@ -45,11 +48,8 @@ namespace ufo {
     profileNumToFind_ = profileNums_[0];
     profIndex_ = 0;
 
-    // If sorting observations, point to beginning of record index iterator
-    if (!obsdb_.obs_sort_var().empty() &&
-        obsdb_.obs_sort_order() == "descending") {
-      profidx_current_ = obsdb_.recidx_begin();
-    }
+    // If sorting observations, point to the first record of the record index
+    recordCurrent_ = 0;
   }
 
   void ProfileIndices::updateNextProfileIndices()
@@ -77,7 +77,7 @@ namespace ufo {
       if (obsdb_.obs_sort_order() == "descending") {
         // Sort variable (usually pressure) in descending order
         // Sorted indices for the current profile
-        const std::vector<std::size_t> profidx_sorted = profidx_current_->second;
+        const RecordIndex::Record profidx_sorted = records_[recordCurrent_];
         auto it_profidx_sorted = profidx_sorted.begin();
         while (profIndex_ < profileNums_.size() && profileNums_[profIndex_] == profileNumToFind_) {
           if (apply_[profIndex_]) {
@@ -114,10 +114,10 @@ namespace ufo {
     if (profIndex_ < profileNums_.size()) {
       // Next profile number to find
       profileNumToFind_ = profileNums_[profIndex_];
-      // Iterator corresponding to next profile
+      // Record corresponding to next profile
       if (!obsdb_.obs_sort_var().empty() &&
           obsdb_.obs_sort_order() == "descending") {
-        std::advance(profidx_current_, 1);
+        ++recordCurrent_;
       }
     }
   }
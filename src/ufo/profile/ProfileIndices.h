@@ -20,6 +20,7 @@
 #include "ioda/ObsSpace.h"
 
 #include "ufo/profile/DataHandlerParameters.h"
+#include "ufo/utils/RecordIndex.h"
 
 namespace ioda {
   class ObsSpace;
@@ -40,6 +41,7 @@ namespace ufo {
   class ProfileIndices {
    public:
     ProfileIndices(ioda::ObsSpace &obsdb,
+                   const RecordIndex &records,
                    const DataHandlerParameters &options,
                    const std::vector <bool> &apply);
 
@@ -78,17 +80,11 @@ namespace ufo {
     /// Unique profile numbers for the entire sample.
     std::set <size_t> uniqueProfileNums_;
 
-    /// Profile index map.
-    typedef std::map<std::size_t, std::vector<std::size_t>> ProfIdxMap;
+    /// Locations of each record, in the order of the ObsSpace's record index (used for sorting).
+    const RecordIndex &records_;
 
-    /// Profile index map iterator.
-    typedef ProfIdxMap::const_iterator ProfIdxIter;
-
-    /// Iterator over profile indices (used for sorting).
-    ProfIdxMap profidx_;
-
-    /// Iterator pointing to current profile index (initially points to beginning).
-    ProfIdxIter profidx_current_;
+    /// Position of the current profile in records_ (initially points to beginning).
+    size_t recordCurrent_;
 
     /// Indices for this profile.
     std::vector <size_t> profileIndices_;
@@ -0,0 +1,53 @@
+/*
+ * (C) Crown copyright 2021 Met Office. All rights reserved.
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ */
+
+#include "ufo/utils/DictionaryEncodedStrings.h"
+
+#include <algorithm>
+#include <numeric>
+#include <utility>
+
+namespace ufo {
+
+DictionaryEncodedStrings::DictionaryEncodedStrings()
+  : dictionary_(std::make_shared<std::vector<std::string>>())
+{}
+
+DictionaryEncodedStrings::DictionaryEncodedStrings(const std::vector<std::string> &values) {
+  // Sort the indices of the values rather than the values themselves to avoid copying strings
+  // more than once.
+  std::vector<size_t> order(values.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin(), order.end(),
+            [&values](size_t a, size_t b) { return values[a] < values[b]; });
+
+  auto dictionary = std::make_shared<std::vector<std::string>>();
+  codes_.resize(values.size());
+  for (size_t i = 0; i < order.size(); ++i) {
+    const std::string &value = values[order[i]];
+    if (dictionary->empty() || dictionary->back() != value)
+      dictionary->push_back(value);
+    codes_[order[i]] = static_cast<int>(dictionary->size() - 1);
+  }
+  dictionary_ = std::move(dictionary);
+}
+
+int DictionaryEncodedStrings::code(const std::string &value) const {
+  const auto it = std::lower_bound(dictionary_->begin(), dictionary_->end(), value);
+  if (it == dictionary_->end() || *it != value)
+    return -1;
+  return static_cast<int>(it - dictionary_->begin());
+}
+
+std::vector<std::string> DictionaryEncodedStrings::decode() const {
+  std::vector<std::string> values;
+  values.reserve(codes_.size());
+  for (int code : codes_)
+    values.push_back((*dictionary_)[code]);
+  return values;
+}
+
+}  // namespace ufo
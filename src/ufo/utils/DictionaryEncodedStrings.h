@@ -0,0 +1,56 @@
+/*
+ * (C) Crown copyright 2021 Met Office. All rights reserved.
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ */
+
+#ifndef UFO_UTILS_DICTIONARYENCODEDSTRINGS_H_
+#define UFO_UTILS_DICTIONARYENCODEDSTRINGS_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace ufo {
+
+/// \brief A column of strings stored as integer codes into a dictionary of distinct values.
+///
+/// The dictionary is sorted in ascending order, so codes compare in the same way as the strings
+/// they represent. Grouping, sorting and equality tests can therefore operate on codes, and
+/// string operations (e.g. regex matching) need to be performed only once per distinct value.
+///
+/// The dictionary is shared between copies of an object of this class.
+class DictionaryEncodedStrings {
+ public:
+  /// \brief Create an empty column.
+  DictionaryEncodedStrings();
+
+  /// \brief Encode the strings \p values.
+  explicit DictionaryEncodedStrings(const std::vector<std::string> &values);
+
+  /// \brief Number of elements in the column.
+  size_t size() const { return codes_.size(); }
+
+  /// \brief Codes of successive elements of the column.
+  const std::vector<int> &codes() const { return codes_; }
+
+  /// \brief Distinct strings stored in the column, sorted in ascending order.
+  const std::vector<std::string> &dictionary() const { return *dictionary_; }
+
+  /// \brief Return the string stored in the \p i'th element of the column.
+  const std::string &operator[](size_t i) const { return (*dictionary_)[codes_[i]]; }
+
+  /// \brief Return the code of the string \p value, or -1 if it does not occur in the column.
+  int code(const std::string &value) const;
+
+  /// \brief Return the strings stored in the column.
+  std::vector<std::string> decode() const;
+
+ private:
+  std::vector<int> codes_;
+  std::shared_ptr<const std::vector<std::string>> dictionary_;
+};
+
+}  // namespace ufo
+
+#endif  // UFO_UTILS_DICTIONARYENCODEDSTRINGS_H_
@@ -0,0 +1,375 @@
+/*
+ * (C) Crown copyright 2021 Met Office. All rights reserved.
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ */
+
+#include "ufo/utils/Instrumentation.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <set>
+#include <sstream>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include <boost/core/demangle.hpp>
+
+#include "eckit/exception/Exceptions.h"
+#include "eckit/mpi/Comm.h"
+
+namespace ufo {
+
+namespace {
+
+/// The innermost scoped timer alive on the current thread.
+thread_local ScopedTimer *currentTimer = nullptr;
+
+const char regionSeparator = '\t';
+
+/// Gather the strings \p local from all ranks of \p comm and return their union.
+std::set<std::string> allGatherUnion(const eckit::mpi::Comm &comm,
+                                     const std::vector<std::string> &local) {
+  std::string packed;
+  for (const std::string &s : local) {
+    packed += s;
+    packed += '\n';
+  }
+
+  const int localSize = packed.size();
+  std::vector<int> sizes(comm.size());
+  comm.allGather(localSize, sizes.begin(), sizes.end());
+  std::vector<int> displs(comm.size(), 0);
+  for (size_t rank = 1; rank < comm.size(); ++rank)
+    displs[rank] = displs[rank - 1] + sizes[rank - 1];
+  std::vector<char> all(displs.back() + sizes.back());
+  comm.allGatherv(packed.begin(), packed.end(), all.begin(), sizes.data(), displs.data());
+
+  std::set<std::string> result;
+  std::string::size_type begin = 0;
+  const std::string allPacked(all.begin(), all.end());
+  for (std::string::size_type end = allPacked.find('\n'); end != std::string::npos;
+       begin = end + 1, end = allPacked.find('\n', begin))
+    result.insert(allPacked.substr(begin, end - begin));
+  return result;
+}
+
+std::string quoted(const std::string &s) {
+  std::string result = "\"";
+  for (char c : s) {
+    if (c == '"' || c == '\\')
+      result += '\\';
+    result += c;
+  }
+  return result + "\"";
+}
+
+struct Statistics {
+  double min;
+  double max;
+  double mean;
+};
+
+std::string formatStatistics(const Statistics &stats, bool yaml) {
+  const char *q = yaml ? "" : "\"";
+  std::ostringstream os;
+  os << std::setprecision(12) << "{" << q << "min" << q << ": " << stats.min << ", "
+     << q << "max" << q << ": " << stats.max << ", "
+     << q << "mean" << q << ": " << stats.mean << "}";
+  return os.str();
+}
+
+struct RegionReport {
+  std::string entryPoint;
+  std::string label;
+  Statistics calls;
+  Statistics seconds;
+  std::map<std::string, Statistics> counters;
+};
+
+void writeJson(std::ostream &os, const std::string &obsSpace, size_t numRanks,
+               const std::vector<RegionReport> &regions) {
+  os << "{\n"
+     << "  \"obs space\": " << quoted(obsSpace) << ",\n"
+     << "  \"number of ranks\": " << numRanks << ",\n"
+     << "  \"regions\": [";
+  for (size_t i = 0; i < regions.size(); ++i) {
+    const RegionReport &region = regions[i];
+    os << (i == 0 ? "\n" : ",\n")
+       << "    {\n"
+       << "      \"entry point\": " << quoted(region.entryPoint) << ",\n"
+       << "      \"label\": " << quoted(region.label) << ",\n"
+       << "      \"calls\": " << formatStatistics(region.calls, false) << ",\n"
+       << "      \"seconds\": " << formatStatistics(region.seconds, false) << ",\n"
+       << "      \"counters\": {";
+    bool first = true;
+    for (const auto &counter : region.counters) {
+      os << (first ? "\n" : ",\n") << "        " << quoted(counter.first) << ": "
+         << formatStatistics(counter.second, false);
+      first = false;
+    }
+    os << (first ? "}\n" : "\n      }\n") << "    }";
+  }
+  os << (regions.empty() ? "]\n" : "\n  ]\n") << "}\n";
+}
+
+void writeYaml(std::ostream &os, const std::string &obsSpace, size_t numRanks,
+               const std::vector<RegionReport> &regions) {
+  os << "obs space: " << quoted(obsSpace) << "\n"
+     << "number of ranks: " << numRanks << "\n"
+     << "regions:" << (regions.empty() ? " []\n" : "\n");
+  for (const RegionReport &region : regions) {
+    os << "- entry point: " << quoted(region.entryPoint) << "\n"
+       << "  label: " << quoted(region.label) << "\n"
+       << "  calls: " << formatStatistics(region.calls, true) << "\n"
+       << "  seconds: " << formatStatistics(region.seconds, true) << "\n"
+       << "  counters:" << (region.counters.empty() ? " {}\n" : "\n");
+    for (const auto &counter : region.counters)
+      os << "    " << quoted(counter.first) << ": "
+         << formatStatistics(counter.second, true) << "\n";
+  }
+}
+
+/// Return the path of the report on \p obsSpace requested by the environment variables described
+/// in the documentation of Instrumentation, or an empty string if no report was requested.
+/// \p suffix is appended to the base name of the file.
+std::string requestedReportFileName(const std::string &obsSpace, const std::string &suffix,
+                                    bool &yaml) {
+  const char *dir = std::getenv("UFO_INSTRUMENTATION_DIR");
+  if (dir == nullptr)
+    return std::string();
+  const char *format = std::getenv("UFO_INSTRUMENTATION_FORMAT");
+  yaml = format != nullptr && std::string(format) == "yaml";
+
+  std::string baseName = obsSpace;
+  std::replace_if(baseName.begin(), baseName.end(),
+                  [](char c) { return c == '/' || c == ' '; }, '_');
+  return std::string(dir) + "/" + baseName + "_instrumentation" + suffix +
+         (yaml ? ".yaml" : ".json");
+}
+
+void writeReportFile(const std::string &fileName, const std::string &obsSpace, size_t numRanks,
+                     const std::vector<RegionReport> &regions, bool yaml) {
+  std::ofstream os(fileName);
+  if (!os)
+    throw eckit::UserError("Unable to open the instrumentation report file '" + fileName + "'",
+                           Here());
+  if (yaml)
+    writeYaml(os, obsSpace, numRanks, regions);
+  else
+    writeJson(os, obsSpace, numRanks, regions);
+}
+
+}  // namespace
+
+// -----------------------------------------------------------------------------
+
+bool Instrumentation::Key::operator<(const Key &other) const {
+  return std::tie(obsSpace, entryPoint, label) <
+         std::tie(other.obsSpace, other.entryPoint, other.label);
+}
+
+// -----------------------------------------------------------------------------
+
+Instrumentation::Instrumentation()
+  : enabled_(std::getenv("UFO_INSTRUMENTATION_DIR") != nullptr)
+{}
+
+// -----------------------------------------------------------------------------
+
+Instrumentation &Instrumentation::instance() {
+  static Instrumentation instrumentation;
+  return instrumentation;
+}
+
+// -----------------------------------------------------------------------------
+
+void Instrumentation::record(const Key &key, double seconds,
+                             const std::map<std::string, double> &counters) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  Record &record = records_[key];
+  ++record.calls;
+  record.seconds += seconds;
+  for (const auto &counter : counters)
+    record.counters[counter.first] += counter.second;
+}
+
+// -----------------------------------------------------------------------------
+
+std::map<Instrumentation::Key, Instrumentation::Record> Instrumentation::records(
+    const std::string &obsSpace) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::map<Key, Record> result;
+  for (const auto &keyAndRecord : records_)
+    if (keyAndRecord.first.obsSpace == obsSpace)
+      result.insert(keyAndRecord);
+  return result;
+}
+
+// -----------------------------------------------------------------------------
+
+void Instrumentation::clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  records_.clear();
+}
+
+// -----------------------------------------------------------------------------
+
+void Instrumentation::writeReport(const eckit::mpi::Comm &comm, const std::string &obsSpace,
+                                  const std::string &fileName, bool yaml) const {
+  const std::map<Key, Record> localRecords = records(obsSpace);
+
+  // Agree on the list of regions and counters; a rank may not have visited them all.
+  std::vector<std::string> localNames;
+  for (const auto &keyAndRecord : localRecords) {
+    const std::string region = keyAndRecord.first.entryPoint + regionSeparator +
+                               keyAndRecord.first.label;
+    localNames.push_back(region);
+    for (const auto &counter : keyAndRecord.second.counters)
+      localNames.push_back(region + regionSeparator + counter.first);
+  }
+  const std::set<std::string> allNames = allGatherUnion(comm, localNames);
+
+  // Lay out the quantities to aggregate: calls, seconds and then each counter of every region.
+  std::vector<RegionReport> regions;
+  std::vector<double> values;
+  for (const std::string &name : allNames) {
+    const std::string::size_type labelStart = name.find(regionSeparator) + 1;
+    const std::string::size_type counterStart = name.find(regionSeparator, labelStart);
+    const Key key{obsSpace, name.substr(0, labelStart - 1),
+                  name.substr(labelStart, counterStart == std::string::npos ?
+                                          std::string::npos : counterStart - labelStart)};
+    const auto it = localRecords.find(key);
+    if (counterStart == std::string::npos) {
+      regions.push_back(RegionReport{key.entryPoint, key.label, {}, {}, {}});
+      values.push_back(it == localRecords.end() ? 0.0 : it->second.calls);
+      values.push_back(it == localRecords.end() ? 0.0 : it->second.seconds);
+    } else {
+      // Counters are sorted after the region they belong to.
+      const std::string counter = name.substr(counterStart + 1);
+      regions.back().counters[counter] = Statistics{};
+      double value = 0.0;
+      if (it != localRecords.end()) {
+        const auto counterIt = it->second.counters.find(counter);
+        if (counterIt != it->second.counters.end())
+          value = counterIt->second;
+      }
+      values.push_back(value);
+    }
+  }
+
+  std::vector<double> minValues = values, maxValues = values, sumValues = values;
+  comm.allReduceInPlace(minValues.begin(), minValues.end(), eckit::mpi::min());
+  comm.allReduceInPlace(maxValues.begin(), maxValues.end(), eckit::mpi::max());
+  comm.allReduceInPlace(sumValues.begin(), sumValues.end(), eckit::mpi::sum());
+
+  if (comm.rank() != 0)
+    return;
+
+  size_t i = 0;
+  auto nextStatistics = [&]() {
+    const Statistics stats{minValues[i], maxValues[i], sumValues[i] / comm.size()};
+    ++i;
+    return stats;
+  };
+  for (RegionReport &region : regions) {
+    region.calls = nextStatistics();
+    region.seconds = nextStatistics();
+    for (auto &counter : region.counters)
+      counter.second = nextStatistics();
+  }
+
+  writeReportFile(fileName, obsSpace, comm.size(), regions, yaml);
+}
+
+// -----------------------------------------------------------------------------
+
+void Instrumentation::writeReportIfRequested(const eckit::mpi::Comm &comm,
+                                             const std::string &obsSpace) const {
+  bool yaml = false;
+  const std::string fileName = requestedReportFileName(obsSpace, "", yaml);
+  if (!fileName.empty())
+    writeReport(comm, obsSpace, fileName, yaml);
+}
+
+// -----------------------------------------------------------------------------
+
+void Instrumentation::writeLocalReport(const std::string &obsSpace, const std::string &fileName,
+                                       bool yaml) const {
+  std::vector<RegionReport> regions;
+  for (const auto &keyAndRecord : records(obsSpace)) {
+    const Record &record = keyAndRecord.second;
+    RegionReport region{keyAndRecord.first.entryPoint, keyAndRecord.first.label,
+                        Statistics{static_cast<double>(record.calls),
+                                   static_cast<double>(record.calls),
+                                   static_cast<double>(record.calls)},
+                        Statistics{record.seconds, record.seconds, record.seconds}, {}};
+    for (const auto &counter : record.counters)
+      region.counters[counter.first] = Statistics{counter.second, counter.second, counter.second};
+    regions.push_back(std::move(region));
+  }
+  writeReportFile(fileName, obsSpace, 1, regions, yaml);
+}
+
+// -----------------------------------------------------------------------------
+
+void Instrumentation::writeLocalReportIfRequested(const std::string &obsSpace,
+                                                  size_t rank) const {
+  bool yaml = false;
+  const std::string fileName =
+      requestedReportFileName(obsSpace, "_rank" + std::to_string(rank), yaml);
+  if (!fileName.empty())
+    writeLocalReport(obsSpace, fileName, yaml);
+}
+
+// -----------------------------------------------------------------------------
+
+ScopedTimer::ScopedTimer(const std::string &obsSpace, const char *entryPoint,
+                         const std::type_info &type)
+  : active_(Instrumentation::instance().enabled()), parent_(nullptr)
+{
+  if (active_) {
+    key_ = Instrumentation::Key{obsSpace, entryPoint, boost::core::demangle(type.name())};
+    parent_ = currentTimer;
+    currentTimer = this;
+    start_ = std::chrono::steady_clock::now();
+  }
+}
+
+// -----------------------------------------------------------------------------
+
+ScopedTimer::ScopedTimer(const std::string &obsSpace, const char *entryPoint,
+                         const std::string &label)
+  : active_(Instrumentation::instance().enabled()), parent_(nullptr)
+{
+  if (active_) {
+    key_ = Instrumentation::Key{obsSpace, entryPoint, label};
+    parent_ = currentTimer;
+    currentTimer = this;
+    start_ = std::chrono::steady_clock::now();
+  }
+}
+
+// -----------------------------------------------------------------------------
+
+ScopedTimer::~ScopedTimer() {
+  if (!active_)
+    return;
+  const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start_;
+  currentTimer = parent_;
+  Instrumentation::instance().record(key_, elapsed.count(), counters_);
+}
+
+// -----------------------------------------------------------------------------
+
+void ScopedTimer::count(const char *counter, double value) {
+  if (currentTimer != nullptr)
+    currentTimer->counters_[counter] += value;
+}
+
+// -----------------------------------------------------------------------------
+
+}  // namespace ufo
@@ -0,0 +1,147 @@
+/*
+ * (C) Crown copyright 2021 Met Office. All rights reserved.
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ */
+
+#ifndef UFO_UTILS_INSTRUMENTATION_H_
+#define UFO_UTILS_INSTRUMENTATION_H_
+
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <string>
+#include <typeinfo>
+
+namespace eckit {
+  namespace mpi {
+    class Comm;
+  }
+}
+
+namespace ufo {
+
+/// \brief Timings and counters collected in the main entry points of UFO filters and operators.
+///
+/// Instrumentation is disabled by default. It is enabled by setting the
+/// `UFO_INSTRUMENTATION_DIR` environment variable to the directory in which reports should be
+/// written (or by calling setEnabled()). Two kinds of reports cover everything recorded for an
+/// ObsSpace since the start of the run:
+/// - a report aggregated across ranks, written whenever the ufo::QCmanager of the ObsSpace is
+///   destroyed, i.e. at the end of each outer loop of a run with filters. The QCmanager already
+///   communicates with the other ranks at that point; the report written last covers the whole
+///   run. It can also be written with an explicit (collective) call to writeReportIfRequested()
+///   or writeReport(), as ufo_replay does;
+/// - a report for each rank, written when the ufo::ObsOperator associated with the ObsSpace is
+///   destroyed. This involves no communication, so it is also available for ObsSpaces without
+///   filters.
+///
+/// Reports are written in JSON, or in YAML if the `UFO_INSTRUMENTATION_FORMAT` environment
+/// variable is set to `yaml`.
+///
+/// Data are recorded with ScopedTimer objects. When instrumentation is disabled, these objects
+/// do nothing beyond checking a flag.
+class Instrumentation {
+ public:
+  /// \brief Identifies an instrumented region.
+  struct Key {
+    /// Name of the ObsSpace being processed.
+    std::string obsSpace;
+    /// Name of the instrumented function, e.g. `FilterBase::applyFilter`.
+    std::string entryPoint;
+    /// Name of the class whose code ran, e.g. `ufo::BoundsCheck`.
+    std::string label;
+
+    bool operator<(const Key &other) const;
+  };
+
+  /// \brief Data recorded for an instrumented region on the current MPI rank.
+  struct Record {
+    size_t calls = 0;
+    double seconds = 0.0;
+    std::map<std::string, double> counters;
+  };
+
+  static Instrumentation &instance();
+
+  bool enabled() const { return enabled_; }
+  void setEnabled(bool enabled) { enabled_ = enabled; }
+
+  /// \brief Add the time spent in one call to the region \p key and the counters incremented
+  /// during this call.
+  void record(const Key &key, double seconds, const std::map<std::string, double> &counters);
+
+  /// \brief Return the data recorded on the current MPI rank for the ObsSpace \p obsSpace.
+  std::map<Key, Record> records(const std::string &obsSpace) const;
+
+  /// \brief Discard all recorded data.
+  void clear();
+
+  /// \brief Aggregate the data recorded for \p obsSpace across the ranks of \p comm and write
+  /// them to \p fileName on rank 0.
+  ///
+  /// For each region, the report lists the minimum, maximum and mean (over ranks) of the number
+  /// of calls, the time spent and each counter. This is a collective operation.
+  ///
+  /// \param yaml
+  ///   If true, the report is written in YAML, otherwise in JSON.
+  void writeReport(const eckit::mpi::Comm &comm, const std::string &obsSpace,
+                   const std::string &fileName, bool yaml = false) const;
+
+  /// \brief Call writeReport() with a file name derived from \p obsSpace and the environment
+  /// variables described in the class documentation. Does nothing if `UFO_INSTRUMENTATION_DIR`
+  /// is not set.
+  void writeReportIfRequested(const eckit::mpi::Comm &comm, const std::string &obsSpace) const;
+
+  /// \brief Write the data recorded for \p obsSpace on the current rank to \p fileName.
+  ///
+  /// Unlike writeReport(), this does not communicate with other ranks.
+  void writeLocalReport(const std::string &obsSpace, const std::string &fileName,
+                        bool yaml = false) const;
+
+  /// \brief Call writeLocalReport() with a file name derived from \p obsSpace, \p rank and the
+  /// environment variables described in the class documentation. Does nothing if
+  /// `UFO_INSTRUMENTATION_DIR` is not set.
+  void writeLocalReportIfRequested(const std::string &obsSpace, size_t rank) const;
+
+ private:
+  Instrumentation();
+
+  std::atomic<bool> enabled_;
+  mutable std::mutex mutex_;
+  std::map<Key, Record> records_;
+};
+
+/// \brief Records the time spent between its construction and destruction, and any counters
+/// incremented in the meantime by calls to count(), in the Instrumentation registry.
+///
+/// Scoped timers may be nested; each region records its inclusive time. Counters are attributed
+/// to the innermost scoped timer alive on the calling thread.
+class ScopedTimer {
+ public:
+  /// \param obsSpace Name of the ObsSpace being processed.
+  /// \param entryPoint Name of the instrumented function.
+  /// \param type Type of the object whose code is timed; its demangled name is used as the label.
+  ScopedTimer(const std::string &obsSpace, const char *entryPoint, const std::type_info &type);
+  ScopedTimer(const std::string &obsSpace, const char *entryPoint, const std::string &label);
+  ~ScopedTimer();
+
+  ScopedTimer(const ScopedTimer &) = delete;
+  ScopedTimer &operator=(const ScopedTimer &) = delete;
+
+  /// \brief Add \p value to the counter \p counter of the innermost scoped timer alive on the
+  /// calling thread (if any).
+  static void count(const char *counter, double value);
+
+ private:
+  bool active_;
+  Instrumentation::Key key_;
+  std::chrono::steady_clock::time_point start_;
+  std::map<std::string, double> counters_;
+  ScopedTimer *parent_;
+};
+
+}  // namespace ufo
+
+#endif  // UFO_UTILS_INSTRUMENTATION_H_
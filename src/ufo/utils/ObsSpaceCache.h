@@ -0,0 +1,89 @@
+/*
+ * (C) Crown copyright 2021 Met Office. All rights reserved.
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ */
+
+#ifndef UFO_UTILS_OBSSPACECACHE_H_
+#define UFO_UTILS_OBSSPACECACHE_H_
+
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+
+#include "ioda/distribution/Distribution.h"
+#include "ioda/ObsSpace.h"
+
+namespace ufo {
+
+/// \brief Objects of type \p Value associated with individual ObsSpace instances.
+///
+/// Filters are typically recreated in each outer loop, so data they want to reuse must be kept
+/// elsewhere. An ObsSpaceCache keeps such data for as long as the ObsSpace they were calculated
+/// for exists. Entries are identified by the ObsSpace instance and a string key (e.g. the filter
+/// options). ObsSpaces are identified by the Distribution each of them owns, which is held
+/// through a weak pointer: entries belonging to ObsSpaces that have been destroyed are evicted on
+/// the next call to get(), and a new ObsSpace never inherits the entries of an old one, even if
+/// it has the same name.
+///
+/// Cached values may still become stale if the ObsSpace contents they depend on are modified;
+/// users should validate them, e.g. with a fingerprint built with hashCombine().
+template <typename Value>
+class ObsSpaceCache {
+ public:
+  /// \brief Return the value associated with \p obsdb and \p key, calling \p create (which must
+  /// return a std::shared_ptr<Value>) to make it if there is none.
+  template <typename Create>
+  std::shared_ptr<Value> get(const ioda::ObsSpace &obsdb, const std::string &key,
+                             const Create &create) {
+    const DistributionPtr distribution = obsdb.distribution();
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto it = entries_.begin(); it != entries_.end();) {
+      if (it->first.expired())
+        it = entries_.erase(it);
+      else
+        ++it;
+    }
+    std::shared_ptr<Value> &entry = entries_[distribution][key];
+    if (!entry)
+      entry = create();
+    return entry;
+  }
+
+  /// \brief Discard all values.
+  void clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    entries_.clear();
+  }
+
+ private:
+  typedef std::weak_ptr<const ioda::Distribution> DistributionPtr;
+
+  std::mutex mutex_;
+  std::map<DistributionPtr, std::map<std::string, std::shared_ptr<Value>>,
+           std::owner_less<DistributionPtr>> entries_;
+};
+
+/// \brief Combine the hash \p seed with \p value.
+inline std::uint64_t hashCombine(std::uint64_t seed, std::uint64_t value) {
+  // Finalizer of the SplitMix64 generator.
+  std::uint64_t h = seed ^ (value + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2));
+  h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  h = (h ^ (h >> 27)) * 0x94d049bb133111ebULL;
+  return h ^ (h >> 31);
+}
+
+/// \brief Return the bit pattern of \p value, e.g. for use with hashCombine().
+inline std::uint64_t bitPattern(float value) {
+  std::uint32_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  return bits;
+}
+
+}  // namespace ufo
+
+#endif  // UFO_UTILS_OBSSPACECACHE_H_
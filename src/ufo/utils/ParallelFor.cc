@@ -0,0 +1,45 @@
+/*
+ * (C) Crown copyright 2021 Met Office. All rights reserved.
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ */
+
+#include "ufo/utils/ParallelFor.h"
+
+#include <atomic>
+#include <cstdlib>
+
+namespace ufo {
+
+namespace {
+
+std::atomic<size_t> numThreadsOverride(0);
+std::atomic<size_t> chunkSizeOverrideValue(0);
+
+}  // namespace
+
+size_t defaultNumThreads() {
+  static const size_t numThreads = []() -> size_t {
+    const char *value = std::getenv("UFO_NUM_THREADS");
+    if (value == nullptr)
+      return 1;
+    const long n = std::strtol(value, nullptr, 10);  // NOLINT(runtime/int)
+    return n > 0 ? static_cast<size_t>(n) : 1;
+  }();
+  const size_t overriddenNumThreads = numThreadsOverride;
+  return overriddenNumThreads != 0 ? overriddenNumThreads : numThreads;
+}
+
+void setDefaultNumThreads(size_t numThreads) {
+  numThreadsOverride = numThreads;
+}
+
+size_t chunkSizeOverride() {
+  return chunkSizeOverrideValue;
+}
+
+void setChunkSizeOverride(size_t chunkSize) {
+  chunkSizeOverrideValue = chunkSize;
+}
+
+}  // namespace ufo
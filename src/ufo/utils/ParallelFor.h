@@ -0,0 +1,119 @@
+/*
+ * (C) Crown copyright 2021 Met Office. All rights reserved.
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ */
+
+#ifndef UFO_UTILS_PARALLELFOR_H_
+#define UFO_UTILS_PARALLELFOR_H_
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ufo {
+
+/// \brief Return the maximum number of threads used by default by parallelFor().
+///
+/// This is the value of the `UFO_NUM_THREADS` environment variable or 1 if it is not set (or
+/// not a positive integer). Note that UFO code is usually run on multiple MPI ranks; the total
+/// number of threads created on a node is the product of this number and the number of ranks
+/// running on that node.
+size_t defaultNumThreads();
+
+/// \brief Make defaultNumThreads() return \p numThreads, or restore its original behaviour if
+/// \p numThreads is 0.
+///
+/// This is meant for tools comparing the performance of different configurations in a single
+/// run, such as the replay application.
+void setDefaultNumThreads(size_t numThreads);
+
+/// \brief Return the chunk size set by setChunkSizeOverride() or 0 if none has been set.
+size_t chunkSizeOverride();
+
+/// \brief Make parallelForChunks() use chunks of \p chunkSize elements regardless of the
+/// minimum chunk size requested by its caller. A value of 0 cancels the override.
+void setChunkSizeOverride(size_t chunkSize);
+
+/// \brief Call `task(i)` for each `i` from 0 to \p numTasks - 1, distributing the calls among
+/// up to \p numThreads threads.
+///
+/// Tasks are handed out dynamically, so they do not need to have similar costs. Each task
+/// must only modify data not accessed by the other tasks. The order in which tasks are
+/// executed is unspecified, so the results must not depend on it.
+///
+/// If \p numThreads is 1 or \p numTasks is smaller than 2, all tasks are executed in order on
+/// the calling thread. If any task throws an exception, the remaining tasks may not be run and
+/// one of the exceptions is rethrown on the calling thread.
+template <typename Task>
+void parallelFor(size_t numTasks, const Task &task, size_t numThreads = defaultNumThreads()) {
+  numThreads = std::min(numThreads, numTasks);
+  if (numThreads <= 1) {
+    for (size_t i = 0; i < numTasks; ++i)
+      task(i);
+    return;
+  }
+
+  std::atomic<size_t> nextTask(0);
+  std::atomic<bool> failed(false);
+  std::exception_ptr exception;
+  std::mutex exceptionMutex;
+
+  auto worker = [&]() {
+    try {
+      for (size_t i = nextTask++; i < numTasks && !failed; i = nextTask++)
+        task(i);
+    } catch (...) {
+      std::lock_guard<std::mutex> lock(exceptionMutex);
+      if (!exception)
+        exception = std::current_exception();
+      failed = true;
+    }
+  };
+
+  std::vector<std::thread> threads;
+  threads.reserve(numThreads - 1);
+  for (size_t t = 1; t < numThreads; ++t)
+    threads.emplace_back(worker);
+  worker();
+  for (std::thread &thread : threads)
+    thread.join();
+
+  if (exception)
+    std::rethrow_exception(exception);
+}
+
+/// \brief Split the range [0, \p size) into contiguous chunks of at least \p minChunkSize
+/// elements (except possibly the last one) and call `task(begin, end)` for each chunk
+/// [begin, end), distributing the calls among up to \p numThreads threads.
+///
+/// This is a convenience wrapper around parallelFor() for loops whose iterations are cheap and
+/// of similar cost. If a chunk size override is in force (see setChunkSizeOverride()), chunks
+/// of exactly that size (except possibly the last one) are used instead.
+template <typename Task>
+void parallelForChunks(size_t size, size_t minChunkSize, const Task &task,
+                       size_t numThreads = defaultNumThreads()) {
+  size_t chunkSize = chunkSizeOverride();
+  if (chunkSize == 0) {
+    minChunkSize = std::max<size_t>(minChunkSize, 1);
+    const size_t maxNumChunks = (size + minChunkSize - 1) / minChunkSize;
+    // A few chunks per thread help balance the load.
+    const size_t numChunks = std::min(maxNumChunks, 4 * numThreads);
+    if (numChunks == 0)
+      return;
+    chunkSize = (size + numChunks - 1) / numChunks;
+  }
+  parallelFor((size + chunkSize - 1) / chunkSize,
+              [&](size_t chunk) {
+                const size_t begin = chunk * chunkSize;
+                task(begin, std::min(begin + chunkSize, size));
+              },
+              numThreads);
+}
+
+}  // namespace ufo
+
+#endif  // UFO_UTILS_PARALLELFOR_H_
@@ -5,16 +5,19 @@
  * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
  */
 
+#include <algorithm>
+#include <cmath>
 #include <stdexcept>
 #include <utility>
 
+#include "oops/util/missingValues.h"
 #include "ufo/utils/PiecewiseLinearInterpolation.h"
-#include "ufo/utils/VertInterp.interface.h"
 
 namespace ufo {
 
-PiecewiseLinearInterpolation::PiecewiseLinearInterpolation(
-    std::vector<double> sortedAbscissas, std::vector<double> ordinates) {
+template <typename T>
+PiecewiseLinearKernel<T>::PiecewiseLinearKernel(std::vector<T> sortedAbscissas,
+                                                std::vector<T> ordinates) {
   if (sortedAbscissas.empty())
     throw std::invalid_argument("At least one interpolation point must be provided");
 
@@ -23,28 +26,127 @@ PiecewiseLinearInterpolation::PiecewiseLinearInterpolation(
 
   abscissas_ = std::move(sortedAbscissas);
   ordinates_ = std::move(ordinates);
+  if (abscissas_.back() < abscissas_.front()) {
+    descending_ = true;
+    std::reverse(abscissas_.begin(), abscissas_.end());
+    std::reverse(ordinates_.begin(), ordinates_.end());
+  }
+
+  const T missing = util::missingValue(missing);
+  const size_t numSegments = abscissas_.size() - 1;
+  slopes_.assign(numSegments, 0);
+  missingSegments_.assign(numSegments, 0);
+  for (size_t k = 0; k < numSegments; ++k) {
+    if (ordinates_[k] == missing || ordinates_[k + 1] == missing) {
+      missingSegments_[k] = 1;
+      anyMissingSegments_ = true;
+    } else if (abscissas_[k + 1] != abscissas_[k]) {
+      slopes_[k] = (ordinates_[k + 1] - ordinates_[k]) / (abscissas_[k + 1] - abscissas_[k]);
+    }
+  }
+
+  if (numSegments > 0) {
+    const T spacing = (abscissas_.back() - abscissas_.front()) / numSegments;
+    uniform_ = spacing > 0;
+    for (size_t k = 0; uniform_ && k < numSegments; ++k)
+      uniform_ = std::abs(abscissas_[k + 1] - abscissas_[k] - spacing) <= T(1e-4) * spacing;
+    if (uniform_)
+      inverseSpacing_ = 1 / spacing;
+  }
 }
 
-double PiecewiseLinearInterpolation::operator()(double abscissa) const {
-  return interpolate(abscissas_, ordinates_, abscissa);
+template <typename T>
+size_t PiecewiseLinearKernel<T>::segment(T abscissa) const {
+  const size_t lastSegment = abscissas_.size() - 2;
+  if (uniform_) {
+    // The estimate may be off by one near segment boundaries because of rounding errors.
+    const T offset = (abscissa - abscissas_[0]) * inverseSpacing_;
+    size_t k = !(offset > 0) ? 0 :
+               offset >= lastSegment ? lastSegment : static_cast<size_t>(offset);
+    if (descending_) {
+      while (k > 0 && abscissa <= abscissas_[k])
+        --k;
+      while (k < lastSegment && abscissa > abscissas_[k + 1])
+        ++k;
+    } else {
+      while (k > 0 && abscissa < abscissas_[k])
+        --k;
+      while (k < lastSegment && abscissa >= abscissas_[k + 1])
+        ++k;
+    }
+    return k;
+  }
+
+  const T *base = abscissas_.data();
+  size_t length = lastSegment + 1;
+  if (descending_) {
+    while (length > 1) {
+      const size_t half = length / 2;
+      base = base[half] < abscissa ? base + half : base;
+      length -= half;
+    }
+  } else {
+    while (length > 1) {
+      const size_t half = length / 2;
+      base = base[half] <= abscissa ? base + half : base;
+      length -= half;
+    }
+  }
+  return base - abscissas_.data();
 }
 
-double PiecewiseLinearInterpolation::interpolate(const std::vector<double> &sortedAbscissas,
-                                                 const std::vector<double> &ordinates,
-                                                 double abscissa) {
-  if (sortedAbscissas.size() == 1) {
-    // The Fortran functions don't handle this case correctly.
-    return ordinates[0];
+template <typename T>
+T PiecewiseLinearKernel<T>::evaluateOnSegment(size_t segment, T abscissa) const {
+  if (anyMissingSegments_ && missingSegments_[segment])
+    return util::missingValue(abscissa);
+  // Below the tabulated range, segment is 0 and the clamped offset vanishes.
+  const T clamped = std::max(abscissa, abscissas_.front());
+  return clamped >= abscissas_.back() ? ordinates_.back() :
+         ordinates_[segment] + slopes_[segment] * (clamped - abscissas_[segment]);
+}
+
+template <typename T>
+T PiecewiseLinearKernel<T>::operator()(T abscissa) const {
+  if (abscissas_.size() == 1)
+    return ordinates_[0];
+  return evaluateOnSegment(segment(abscissa), abscissa);
+}
+
+template <typename T>
+void PiecewiseLinearKernel<T>::evaluate(size_t n, const T *abscissas, T *values) const {
+  if (abscissas_.size() == 1) {
+    std::fill_n(values, n, ordinates_[0]);
+    return;
   }
+  for (size_t i = 0; i < n; ++i)
+    values[i] = evaluateOnSegment(segment(abscissas[i]), abscissas[i]);
+}
+
+template class PiecewiseLinearKernel<float>;
+template class PiecewiseLinearKernel<double>;
+
+// -----------------------------------------------------------------------------
+
+PiecewiseLinearInterpolation::PiecewiseLinearInterpolation(
+    std::vector<double> sortedAbscissas, std::vector<double> ordinates)
+  : kernel_(std::move(sortedAbscissas), std::move(ordinates))
+{}
 
-  int wi = 0;
-  double wf = 0.0;
-  vert_interp_weights_f90(sortedAbscissas.size(), abscissa, sortedAbscissas.data(), wi, wf);
+double PiecewiseLinearInterpolation::operator()(double abscissa) const {
+  return kernel_(abscissa);
+}
 
-  double f = 0.0;
-  vert_interp_apply_f90(ordinates.size(), ordinates.data(), f, wi, wf);
+std::vector<double> PiecewiseLinearInterpolation::operator()(
+    const std::vector<double> &abscissas) const {
+  std::vector<double> values(abscissas.size());
+  kernel_.evaluate(abscissas.size(), abscissas.data(), values.data());
+  return values;
+}
 
-  return f;
+double PiecewiseLinearInterpolation::interpolate(const std::vector<double> &sortedAbscissas,
+                                                 const std::vector<double> &ordinates,
+                                                 double abscissa) {
+  return PiecewiseLinearKernel<double>(sortedAbscissas, ordinates)(abscissa);
 }
 
 }  // namespace ufo
@@ -8,10 +8,72 @@
 #ifndef UFO_UTILS_PIECEWISELINEARINTERPOLATION_H_
 #define UFO_UTILS_PIECEWISELINEARINTERPOLATION_H_
 
+#include <cstddef>
 #include <vector>
 
 namespace ufo {
 
+/// \brief Evaluates a piecewise linear function defined by a table of data points, one value at a
+/// time or over whole columns of abscissas.
+///
+/// The slopes of all segments are computed once, on construction. The segment containing an
+/// abscissa is found by a branchless binary search or, if the tabulated abscissas are uniformly
+/// spaced, by direct indexing. Outside the tabulated range the function is extrapolated as a
+/// constant. If either ordinate bounding the segment used to evaluate the function is missing,
+/// the result is missing.
+///
+/// The segment used at a tabulated abscissa (or at a run of equal tabulated abscissas) is the one
+/// chosen by the Fortran routine vert_interp_weights: the segment following that abscissa in the
+/// order in which the abscissas were supplied. For descending tables, this is the segment
+/// extending towards smaller abscissas.
+///
+/// The template is instantiated for `float` and `double`.
+template <typename T>
+class PiecewiseLinearKernel
+{
+ public:
+  /// \brief Create a kernel evaluating the piecewise linear interpolation of the data points
+  /// (sortedAbscissas[i], ordinates[i]).
+  ///
+  /// Both arguments must have the same length and be non-empty. The elements of \p sortedAbscissas
+  /// must be sorted in ascending or descending order.
+  PiecewiseLinearKernel(std::vector<T> sortedAbscissas, std::vector<T> ordinates);
+
+  /// \brief Evaluate the interpolated function at \p abscissa.
+  T operator()(T abscissa) const;
+
+  /// \brief Evaluate the interpolated function at each of the \p n elements of \p abscissas and
+  /// store the results in \p values.
+  void evaluate(size_t n, const T *abscissas, T *values) const;
+
+  /// \brief Return true if the tabulated abscissas are uniformly spaced and segments are
+  /// therefore located by direct indexing.
+  bool hasUniformAbscissas() const { return uniform_; }
+
+ private:
+  /// Return the index of the segment used to evaluate the function at \p abscissa, i.e. of the
+  /// last tabulated abscissa not exceeding \p abscissa (or, if the abscissas were supplied in
+  /// descending order, lower than \p abscissa), or 0 if there is none, capped at the index of
+  /// the last segment.
+  size_t segment(T abscissa) const;
+
+  T evaluateOnSegment(size_t segment, T abscissa) const;
+
+  /// Abscissas sorted in ascending order.
+  std::vector<T> abscissas_;
+  /// True if the abscissas were supplied in descending order (and have been reversed).
+  bool descending_ = false;
+  std::vector<T> ordinates_;
+  /// Slope of each segment.
+  std::vector<T> slopes_;
+  /// Nonzero for segments with a missing ordinate at either end.
+  std::vector<char> missingSegments_;
+  bool anyMissingSegments_ = false;
+  bool uniform_ = false;
+  /// Inverse of the spacing of uniformly spaced abscissas.
+  T inverseSpacing_ = 0;
+};
+
 /// \brief Represents a piecewise linear interpolation of a set of data points.
 class PiecewiseLinearInterpolation
 {
@@ -27,6 +89,9 @@ class PiecewiseLinearInterpolation
   /// \brief Evaluate the interpolated function at \p abscissa.
   double operator()(double abscissa) const;
 
+  /// \brief Evaluate the interpolated function at each element of \p abscissas.
+  std::vector<double> operator()(const std::vector<double> &abscissas) const;
+
   /// \brief Convenience function interpolating the data points (sortedAbscissas[i], ordinates[i])
   /// at \p abscissa without creating a PiecewiseLinearInterpolation object.
   static double interpolate(const std::vector<double> &sortedAbscissas,
@@ -34,8 +99,7 @@ class PiecewiseLinearInterpolation
                             double abscissa);
 
  private:
-  std::vector<double> abscissas_;
-  std::vector<double> ordinates_;
+  PiecewiseLinearKernel<double> kernel_;
 };
 
 }  // namespace ufo
@@ -0,0 +1,292 @@
+/*
+ * (C) Copyright 2019 Met Office UK
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ */
+
+#ifndef UFO_UTILS_POINTINDEX_H_
+#define UFO_UTILS_POINTINDEX_H_
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+#include "eckit/container/KDTree.h"
+#include "eckit/exception/Exceptions.h"
+#include "oops/util/IsAnyPointInVolumeInterior.h"
+
+namespace ufo {
+
+/// \brief Abstract interface of a container storing point sets and able to answer spatial queries
+/// needed by PoissonDiskThinning ("does any point lie in the interior of an axis-aligned
+/// ellipsoid/cylinder?").
+template <int numDims_>
+class PointIndex {
+ public:
+  typedef float CoordType;
+  static const int numDims = numDims_;
+
+  typedef std::array<CoordType, numDims> Point;
+  typedef std::array<CoordType, numDims> Extent;
+
+  virtual ~PointIndex() {}
+
+  virtual void insert(const Point &point) = 0;
+
+  virtual bool isAnyPointInCylinderInterior(const Point &center,
+                                            const Extent &semiAxes,
+                                            int numSpatialDims) const = 0;
+
+  virtual bool isAnyPointInEllipsoidInterior(const Point &center,
+                                             const Extent &semiAxes) const = 0;
+};
+
+/// \brief An implementation of PointIndex storing the point set in a kd-tree.
+template <int numDims_>
+class KDTree : public PointIndex<numDims_> {
+ public:
+  typedef PointIndex<numDims_> Base;
+
+  typedef typename Base::CoordType CoordType;
+  typedef typename Base::Point Point;
+  typedef typename Base::Extent Extent;
+
+  static const int numDims = Base::numDims;
+
+  void insert(const Point &point) override;
+
+  bool isAnyPointInCylinderInterior(const Point &center,
+                                    const Extent &semiAxes,
+                                    int numSpatialDims) const override;
+
+  bool isAnyPointInEllipsoidInterior(const Point &center,
+                                     const Extent &semiAxes) const override;
+
+ private:
+  struct EmptyPayload {};
+
+  struct TreeTraits {
+    typedef eckit::geometry::KPoint<numDims> Point;
+    typedef EmptyPayload Payload;
+  };
+
+  typedef eckit::KDTreeMemory<TreeTraits> KDTreeImpl;
+  typedef typename KDTreeImpl::Alloc Alloc;
+  typedef typename KDTreeImpl::Node Node;
+  typedef typename KDTreeImpl::Point KPoint;
+  typedef typename KDTreeImpl::Value Value;
+
+  KDTreeImpl tree_;
+};
+
+template <int numDims_>
+void KDTree<numDims_>::insert(
+    const Point &point) {
+  tree_.insert(Value(KPoint(point), EmptyPayload()));
+}
+
+template <int numDims_>
+bool KDTree<numDims_>::isAnyPointInEllipsoidInterior(
+    const Point &center, const Extent &semiAxes) const {
+  KPoint lbound, ubound;
+  for (int d = 0; d < numDims; ++d) {
+    lbound.data()[d] = center[d] - semiAxes[d];
+    ubound.data()[d] = center[d] + semiAxes[d];
+  }
+  return util::isAnyPointInEllipsoidInterior(tree_, lbound, ubound);
+}
+
+template <int numDims_>
+bool KDTree<numDims_>::isAnyPointInCylinderInterior(
+    const Point &center, const Extent &semiAxes, int numSpatialDims) const {
+  KPoint lbound, ubound;
+  for (int d = 0; d < numDims; ++d) {
+    lbound.data()[d] = center[d] - semiAxes[d];
+    ubound.data()[d] = center[d] + semiAxes[d];
+  }
+  return util::isAnyPointInCylinderInterior(tree_, lbound, ubound, numSpatialDims);
+}
+
+/// \brief An implementation of PointIndex storing the point set in a uniform grid of cells.
+///
+/// Only non-empty cells are stored (in a hash table). A query examines only the points lying in
+/// cells overlapping the bounding box of the query volume. If the cells are at least as large as
+/// the semi-axes of each query volume, at most three cells are examined along each dimension, so
+/// the cost of a query does not grow with the number of points in the index.
+///
+/// Like the KDTree class, this class treats the query volume as the ellipsoid or cylinder
+/// inscribed in the box [center - semiAxes, center + semiAxes] (with bounds calculated in single
+/// precision), so both classes return the same answers. All semi-axes must be positive.
+template <int numDims_>
+class GridIndex : public PointIndex<numDims_> {
+ public:
+  typedef PointIndex<numDims_> Base;
+
+  typedef typename Base::CoordType CoordType;
+  typedef typename Base::Point Point;
+  typedef typename Base::Extent Extent;
+
+  static const int numDims = Base::numDims;
+
+  /// \brief Create an empty index with cells of size \p cellSizes (all of which must be
+  /// positive).
+  explicit GridIndex(const Extent &cellSizes);
+
+  void insert(const Point &point) override;
+
+  bool isAnyPointInCylinderInterior(const Point &center,
+                                    const Extent &semiAxes,
+                                    int numSpatialDims) const override;
+
+  bool isAnyPointInEllipsoidInterior(const Point &center,
+                                     const Extent &semiAxes) const override;
+
+ private:
+  typedef std::array<std::int64_t, numDims> CellIndex;
+  typedef std::array<double, numDims> DoublePoint;
+
+  struct CellIndexHash {
+    size_t operator()(const CellIndex &index) const {
+      size_t hash = 0;
+      for (std::int64_t i : index)
+        hash = hash * 1000003 ^ std::hash<std::int64_t>()(i);
+      return hash;
+    }
+  };
+
+  std::int64_t cellIndex(double coord, int dim) const;
+
+  /// Return true if \p isInterior returns true for any point lying in the box
+  /// [\p lbound, \p ubound].
+  template <typename Predicate>
+  bool isAnyPointInBox(const DoublePoint &lbound, const DoublePoint &ubound,
+                       const Predicate &isInterior) const;
+
+  std::array<double, numDims> inverseCellSizes_;
+  std::unordered_map<CellIndex, std::vector<Point>, CellIndexHash> cells_;
+};
+
+template <int numDims_>
+GridIndex<numDims_>::GridIndex(const Extent &cellSizes) {
+  for (int d = 0; d < numDims; ++d) {
+    ASSERT(cellSizes[d] > 0);
+    inverseCellSizes_[d] = 1.0 / cellSizes[d];
+  }
+}
+
+template <int numDims_>
+std::int64_t GridIndex<numDims_>::cellIndex(double coord, int dim) const {
+  // Clamp the index to avoid overflow for outlying coordinates (e.g. missing values).
+  const double maxIndex = std::ldexp(1.0, 62);
+  const double index = std::floor(coord * inverseCellSizes_[dim]);
+  return static_cast<std::int64_t>(std::max(-maxIndex, std::min(maxIndex, index)));
+}
+
+template <int numDims_>
+void GridIndex<numDims_>::insert(const Point &point) {
+  CellIndex index;
+  for (int d = 0; d < numDims; ++d)
+    index[d] = cellIndex(point[d], d);
+  cells_[index].push_back(point);
+}
+
+template <int numDims_>
+template <typename Predicate>
+bool GridIndex<numDims_>::isAnyPointInBox(const DoublePoint &lbound, const DoublePoint &ubound,
+                                          const Predicate &isInterior) const {
+  CellIndex lowerCell, upperCell;
+  double numCellsInBox = 1;
+  for (int d = 0; d < numDims; ++d) {
+    lowerCell[d] = cellIndex(lbound[d], d);
+    upperCell[d] = cellIndex(ubound[d], d);
+    numCellsInBox *= static_cast<double>(upperCell[d] - lowerCell[d] + 1);
+  }
+
+  auto isCellInBox = [&](const CellIndex &cell) {
+    for (int d = 0; d < numDims; ++d)
+      if (cell[d] < lowerCell[d] || cell[d] > upperCell[d])
+        return false;
+    return true;
+  };
+  auto isAnyPointInCellInterior = [&](const std::vector<Point> &points) {
+    return std::any_of(points.begin(), points.end(), isInterior);
+  };
+
+  if (numCellsInBox > cells_.size()) {
+    // It's cheaper to visit all non-empty cells.
+    for (const auto &cell : cells_)
+      if (isCellInBox(cell.first) && isAnyPointInCellInterior(cell.second))
+        return true;
+    return false;
+  }
+
+  // Visit all cells in the box, incrementing the cell index like an odometer.
+  CellIndex cell = lowerCell;
+  while (true) {
+    const auto it = cells_.find(cell);
+    if (it != cells_.end() && isAnyPointInCellInterior(it->second))
+      return true;
+    int d = 0;
+    while (d < numDims && cell[d] == upperCell[d]) {
+      cell[d] = lowerCell[d];
+      ++d;
+    }
+    if (d == numDims)
+      return false;
+    ++cell[d];
+  }
+}
+
+template <int numDims_>
+bool GridIndex<numDims_>::isAnyPointInEllipsoidInterior(
+    const Point &center, const Extent &semiAxes) const {
+  DoublePoint lbound, ubound, boxCenter, boxSemiAxes;
+  for (int d = 0; d < numDims; ++d) {
+    lbound[d] = center[d] - semiAxes[d];
+    ubound[d] = center[d] + semiAxes[d];
+    boxCenter[d] = 0.5 * (lbound[d] + ubound[d]);
+    boxSemiAxes[d] = 0.5 * (ubound[d] - lbound[d]);
+  }
+  return isAnyPointInBox(lbound, ubound, [&](const Point &point) {
+    double sum = 0;
+    for (int d = 0; d < numDims; ++d) {
+      const double x = (point[d] - boxCenter[d]) / boxSemiAxes[d];
+      sum += x * x;
+    }
+    return sum < 1;
+  });
+}
+
+template <int numDims_>
+bool GridIndex<numDims_>::isAnyPointInCylinderInterior(
+    const Point &center, const Extent &semiAxes, int numSpatialDims) const {
+  DoublePoint lbound, ubound, boxCenter, boxSemiAxes;
+  for (int d = 0; d < numDims; ++d) {
+    lbound[d] = center[d] - semiAxes[d];
+    ubound[d] = center[d] + semiAxes[d];
+    boxCenter[d] = 0.5 * (lbound[d] + ubound[d]);
+    boxSemiAxes[d] = 0.5 * (ubound[d] - lbound[d]);
+  }
+  return isAnyPointInBox(lbound, ubound, [&](const Point &point) {
+    double sum = 0;
+    for (int d = 0; d < numSpatialDims; ++d) {
+      const double x = (point[d] - boxCenter[d]) / boxSemiAxes[d];
+      sum += x * x;
+    }
+    if (sum >= 1)
+      return false;
+    for (int d = numSpatialDims; d < numDims; ++d)
+      if (std::abs(point[d] - boxCenter[d]) >= boxSemiAxes[d])
+        return false;
+    return true;
+  });
+}
+
+}  // namespace ufo
+
+#endif  // UFO_UTILS_POINTINDEX_H_
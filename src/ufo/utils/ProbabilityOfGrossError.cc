@@ -7,26 +7,52 @@
 
 #include "ufo/utils/ProbabilityOfGrossError.h"
 
+#include <array>
+
 namespace ufo {
+  namespace {
+    /// Number of locations gathered into the contiguous buffers of BayesianPGEUpdate().
+    const size_t tileSize = 256;
+    /// PGE multiplication factor used to store PGE values for later use.
+    const double PGEMult = 1000.0;
+    /// Missing data indicator for stored PGEs.
+    const double PGEMDI = 1.111;
+  }  // namespace
+
+  void computeDeparturesAndErrorVariances(size_t size, const size_t *indices,
+                                          const float *obsVal, const float *bkgVal,
+                                          const float *obsErr, const float *bkgErr,
+                                          float obErrMult, float bkgErrMult,
+                                          float *departures, double *errVars)
+  {
+    const float missingValueFloat = util::missingValue(1.0f);
+    const double missingValueDouble = util::missingValue(1.0);
+    for (size_t i = 0; i < size; ++i) {
+      const size_t jloc = indices ? indices[i] : i;
+      if (obsVal[jloc] != missingValueFloat && bkgVal[jloc] != missingValueFloat)
+        departures[jloc] = obsVal[jloc] - bkgVal[jloc];
+      else
+        departures[jloc] = missingValueFloat;
+      if (!errVars)
+        continue;
+      if (obsErr && bkgErr && obsErr[jloc] >= 0 && bkgErr[jloc] >= 0) {
+        // The squares of single-precision numbers are exact in double precision.
+        const double scaledObsErr = obErrMult * obsErr[jloc];
+        const double scaledBkgErr = bkgErrMult * bkgErr[jloc];
+        errVars[jloc] = scaledObsErr * scaledObsErr + scaledBkgErr * scaledBkgErr;
+      } else {
+        errVars[jloc] = missingValueDouble;
+      }
+    }
+  }
+
   void BayesianPGEUpdate(const ProbabilityOfGrossErrorParameters &options,
-                         const std::vector<float> &obsVal,
-                         const std::vector<float> &obsErr,
-                         const std::vector<float> &bkgVal,
-                         const std::vector<float> &bkgErr,
-                         const std::vector<float> &PdBad,
+                         const BayesianPGEBatch &batch,
                          const bool ModelLevels,
-                         std::vector<int> &flags,
-                         std::vector<float> &PGE,
-                         std::vector<float> &PGEBd,
-                         float ErrVarMax,
-                         const std::vector<float> *obsVal2,
-                         const std::vector<float> *bkgVal2)
+                         float ErrVarMax)
   {
     const float missingValueFloat = util::missingValue(1.0f);
-    // PGE multiplication factor used to store PGE values for later use.
-    const double PGEMult = 1000.0;
-    // Missing data indicator for stored PGEs.
-    const double PGEMDI = 1.111;
+    const double missingValueDouble = util::missingValue(1.0);
     // Maximum value of exponent in background QC.
     const double ExpArgMax = options.PGE_ExpArgMax.value();
     // PGE rejection limit.
@@ -35,89 +61,154 @@ namespace ufo {
     const float ObErrMult = options.PGE_ObErrMult.value();
     // Multiplication factor for background errors.
     const float BkgErrMult = options.PGE_BkgErrMult.value();
+    // Is the observable a vector?
+    const bool vectorObs = batch.obsVal2 && batch.bkgVal2;
     // Critical value for squared difference from background / ErrVar.
-    const double SDiffCrit = obsVal2 && bkgVal2 ?
+    const double SDiffCrit = vectorObs ?
       options.PGE_SDiffCrit.value() * 2.0 :
       options.PGE_SDiffCrit.value();
-    // Number of levels in profile, or total number of single-level obs.
-    const size_t numLocs = obsVal.size();
-
-    // Initialise buddy check PGE to missing data indicator.
-    PGEBd.assign(obsVal.size(), PGEMDI);
 
+    // Buffers holding the data of one tile.
+    std::array<size_t, tileSize> locs;
+    std::array<float, tileSize> obsVal, bkgVal, obsErr, bkgErr;
+    std::array<float, tileSize> departures;
+    std::array<double, tileSize> errVars;
+    // Squared departure (summed over both components of vector observables).
+    std::array<double, tileSize> sqDepartures;
     // Combined (obs and bkg) error variance.
-    float ErrVar = 0.0;
+    std::array<float, tileSize> ErrVar;
+    // Product of the bad-observation probability density and prior PGE.
+    std::array<float, tileSize> PdBadPGE;
+    // Prior PGE.
+    std::array<float, tileSize> priorPGE;
+    // Are all of the required values present?
+    std::array<unsigned char, tileSize> valid;
+    // Is the second component of a vector observable present?
+    std::array<unsigned char, tileSize> bivariate;
     // Squared difference from background / ErrVar.
-    double SDiff = 0.0;
-    // Probability density of good observation.
-    double PdGood = 0.0;
+    std::array<double, tileSize> SDiff;
     // PGE after background check.
-    double PGEBk = 0.0;
+    std::array<double, tileSize> PGEBk;
 
-    const bool obsErrEmpty = obsErr.empty();
-    const bool bkgErrEmpty = bkgErr.empty();
+    const bool haveErrors = batch.obsErr && batch.bkgErr;
+    for (size_t start = 0; start < batch.size; start += tileSize) {
+      const size_t n = std::min(tileSize, batch.size - start);
 
-    for (size_t jloc = 0; jloc < numLocs; ++jloc) {
-      // Calculate combined error variance.
-      if (!obsErrEmpty && !bkgErrEmpty &&
-          obsErr[jloc] >= 0 && bkgErr[jloc] >= 0) {
-        ErrVar = std::pow(ObErrMult * obsErr[jloc], 2) +
-          std::pow(BkgErrMult * bkgErr[jloc], 2);
-      } else {
-        ErrVar = missingValueFloat;
-      }
-      // Set combined error variance to maximum value (if defined).
-      if (ErrVarMax > 0.0) {
-        ErrVar = std::min(ErrVar, ErrVarMax);
+      // Gather.
+      for (size_t i = 0; i < n; ++i) {
+        const size_t jloc = batch.indices ? batch.indices[start + i] : start + i;
+        locs[i] = jloc;
+        obsVal[i] = batch.obsVal[jloc];
+        bkgVal[i] = batch.bkgVal[jloc];
+        if (haveErrors) {
+          obsErr[i] = batch.obsErr[jloc];
+          bkgErr[i] = batch.bkgErr[jloc];
+        }
       }
-
-      // Update PGE (if all of the required values are present).
-      if (obsVal[jloc] != missingValueFloat &&
-          bkgVal[jloc] != missingValueFloat &&
-          ErrVar != missingValueFloat) {
-        if (obsVal2 && bkgVal2 &&
-            (*obsVal2)[jloc] != missingValueFloat &&
-            (*bkgVal2)[jloc] != missingValueFloat) {  // Vector observable.
-          SDiff = (std::pow(obsVal[jloc] - bkgVal[jloc], 2) +
-                   std::pow((*obsVal2)[jloc] - (*bkgVal2)[jloc], 2)) / static_cast<double>(ErrVar);
-          // Bivariate normal distribution; square root does not appear in denominator.
-          PdGood = std::exp(-0.5 * std::min(SDiff, 2.0 * ExpArgMax)) / (2.0 * M_PI * ErrVar);
-        } else {  // Scalar observable.
-          SDiff = std::pow(obsVal[jloc] - bkgVal[jloc], 2) / ErrVar;
-          // Univariate normal distribution; square root appears in denominator.
-          PdGood = std::exp(-0.5 * std::min(SDiff, 2.0 * ExpArgMax)) /
-            std::sqrt(2.0 * M_PI * ErrVar);
+      computeDeparturesAndErrorVariances(n, nullptr, obsVal.data(), bkgVal.data(),
+                                         haveErrors ? obsErr.data() : nullptr,
+                                         haveErrors ? bkgErr.data() : nullptr,
+                                         ObErrMult, BkgErrMult,
+                                         departures.data(), errVars.data());
+      for (size_t i = 0; i < n; ++i) {
+        const size_t jloc = locs[i];
+        float errVar = errVars[i] != missingValueDouble ?
+          static_cast<float>(errVars[i]) : missingValueFloat;
+        // Set combined error variance to maximum value (if defined).
+        if (ErrVarMax > 0.0) {
+          errVar = std::min(errVar, ErrVarMax);
         }
+        valid[i] = departures[i] != missingValueFloat && errVar != missingValueFloat;
+        bivariate[i] = valid[i] && vectorObs &&
+          batch.obsVal2[jloc] != missingValueFloat &&
+          batch.bkgVal2[jloc] != missingValueFloat;
+        const double departure1 = valid[i] ? departures[i] : 0.0f;
+        const double departure2 = bivariate[i] ? batch.obsVal2[jloc] - batch.bkgVal2[jloc] : 0.0f;
+        const float PdBad = batch.PdBad ? batch.PdBad[jloc] : batch.PdBadValue;
+        // Invalid entries are given harmless values; their results are discarded below.
+        sqDepartures[i] = departure1 * departure1 + departure2 * departure2;
+        ErrVar[i] = valid[i] ? errVar : 1.0f;
+        PdBadPGE[i] = valid[i] ? PdBad * batch.PGE[jloc] : 1.0f;
+        priorPGE[i] = valid[i] ? batch.PGE[jloc] : 0.0f;
+      }
 
-        // Calculate PGE after background check, normalising appropriately.
-        PGEBk = (PdBad[jloc] * PGE[jloc]) /
-          (PdBad[jloc] * PGE[jloc] + PdGood * (1.0 - PGE[jloc]));
+      // Compute, without branches.
+      for (size_t i = 0; i < n; ++i) {
+        const double sDiff = sqDepartures[i] / static_cast<double>(ErrVar[i]);
+        const double twoPiErrVar = 2.0 * M_PI * ErrVar[i];
+        // Bivariate normal distribution: square root does not appear in denominator.
+        // Univariate normal distribution: square root appears in denominator.
+        const double PdGood = std::exp(-0.5 * std::min(sDiff, 2.0 * ExpArgMax)) /
+          (bivariate[i] ? twoPiErrVar : std::sqrt(twoPiErrVar));
+        // PGE after background check, normalised appropriately.
+        const double pgeBk = PdBadPGE[i] / (PdBadPGE[i] + PdGood * (1.0 - priorPGE[i]));
+        SDiff[i] = valid[i] ? sDiff : SDiffCrit;
+        PGEBk[i] = valid[i] ? pgeBk : PGEMDI;
+      }
 
+      // Scatter.
+      for (size_t i = 0; i < n; ++i) {
+        const size_t jloc = locs[i];
+        int flags = batch.flags[jloc];
+        double pgeBk = PGEBk[i];
         // Set QC flags.
-        flags[jloc] |= ufo::MetOfficeQCFlags::Elem::BackPerfFlag;
-        if (PGEBk >= PGECrit) {
-          flags[jloc] |= ufo::MetOfficeQCFlags::Elem::BackRejectFlag;
+        if (valid[i]) {
+          flags |= ufo::MetOfficeQCFlags::Elem::BackPerfFlag;
+          if (pgeBk >= PGECrit) {
+            flags |= ufo::MetOfficeQCFlags::Elem::BackRejectFlag;
+          }
         }
-      } else {
-        // Deal with missing data.
-        SDiff = SDiffCrit;
-        PGEBk = PGEMDI;
-      }
 
-      // Pack PGEs for use in later routines.
-      PGE[jloc] = trunc(PGEBk * PGEMult) + PGE[jloc];
+        // Pack PGEs for use in later routines.
+        batch.PGE[jloc] = trunc(pgeBk * PGEMult) + batch.PGE[jloc];
 
-      // Model-level data may have additional processing.
-      if (ModelLevels &&
-          (SDiff >= SDiffCrit ||
-           flags[jloc] & ufo::MetOfficeQCFlags::Elem::PermRejectFlag ||
-           flags[jloc] & ufo::MetOfficeQCFlags::Elem::FinalRejectFlag)) {
-        PGEBk = PGEMDI;  // Do not apply buddy check in this case.
-        flags[jloc] |= ufo::MetOfficeQCFlags::Elem::FinalRejectFlag;
+        // Model-level data may have additional processing.
+        if (ModelLevels &&
+            (SDiff[i] >= SDiffCrit ||
+             flags & ufo::MetOfficeQCFlags::Elem::PermRejectFlag ||
+             flags & ufo::MetOfficeQCFlags::Elem::FinalRejectFlag)) {
+          pgeBk = PGEMDI;  // Do not apply buddy check in this case.
+          flags |= ufo::MetOfficeQCFlags::Elem::FinalRejectFlag;
+        }
+
+        batch.flags[jloc] = flags;
+        // Update PGE for buddy check.
+        batch.PGEBd[jloc] = pgeBk;
       }
+    }
+  }
+
+  void BayesianPGEUpdate(const ProbabilityOfGrossErrorParameters &options,
+                         const std::vector<float> &obsVal,
+                         const std::vector<float> &obsErr,
+                         const std::vector<float> &bkgVal,
+                         const std::vector<float> &bkgErr,
+                         const std::vector<float> &PdBad,
+                         const bool ModelLevels,
+                         std::vector<int> &flags,
+                         std::vector<float> &PGE,
+                         std::vector<float> &PGEBd,
+                         float ErrVarMax,
+                         const std::vector<float> *obsVal2,
+                         const std::vector<float> *bkgVal2)
+  {
+    // Initialise buddy check PGE to missing data indicator.
+    PGEBd.assign(obsVal.size(), PGEMDI);
 
-      // Update PGE for buddy check.
-      PGEBd[jloc] = PGEBk;
+    BayesianPGEBatch batch;
+    batch.size = obsVal.size();
+    batch.obsVal = obsVal.data();
+    batch.obsErr = obsErr.empty() ? nullptr : obsErr.data();
+    batch.bkgVal = bkgVal.data();
+    batch.bkgErr = bkgErr.empty() ? nullptr : bkgErr.data();
+    if (obsVal2 && bkgVal2) {
+      batch.obsVal2 = obsVal2->data();
+      batch.bkgVal2 = bkgVal2->data();
     }
+    batch.PdBad = PdBad.data();
+    batch.flags = flags.data();
+    batch.PGE = PGE.data();
+    batch.PGEBd = PGEBd.data();
+    BayesianPGEUpdate(options, batch, ModelLevels, ErrVarMax);
   }
 }  // namespace ufo
@@ -9,6 +9,9 @@
 #define UFO_UTILS_PROBABILITYOFGROSSERROR_H_
 
 #include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
 #include <string>
 #include <vector>
 
@@ -18,6 +21,44 @@
 #include "ufo/utils/ProbabilityOfGrossErrorParameters.h"
 
 namespace ufo {
+  /// \brief Structure-of-arrays description of a batch of observations processed by
+  /// BayesianPGEUpdate().
+  ///
+  /// All pointers refer to arrays indexed by location. If \c indices is set, only the locations
+  /// \c indices[0], ..., \c indices[size - 1] are processed; otherwise locations 0 to
+  /// \c size - 1 are. This makes it possible to process a subset of the locations of an
+  /// ObsSpace without copying the data into reduced vectors.
+  struct BayesianPGEBatch {
+    /// Number of locations to process.
+    size_t size = 0;
+    /// (Optional) Indices of the locations to process.
+    const size_t *indices = nullptr;
+
+    /// Observation values.
+    const float *obsVal = nullptr;
+    /// Observation errors. If null, all errors are treated as missing.
+    const float *obsErr = nullptr;
+    /// Background values.
+    const float *bkgVal = nullptr;
+    /// Background errors. If null, all errors are treated as missing.
+    const float *bkgErr = nullptr;
+    /// (Optional) Second component of 2D observation values.
+    const float *obsVal2 = nullptr;
+    /// (Optional) Second component of 2D background values.
+    const float *bkgVal2 = nullptr;
+    /// (Optional) Probability density for 'bad' observations. If null, \c PdBadValue is used
+    /// at all locations.
+    const float *PdBad = nullptr;
+    float PdBadValue = 0.0f;
+
+    /// QC flags (updated).
+    int *flags = nullptr;
+    /// Probability of gross error (updated).
+    float *PGE = nullptr;
+    /// PGE for input to buddy check (output).
+    float *PGEBd = nullptr;
+  };
+
   /// \brief Bayesian update of probability of gross error (PGE)
   /// \details Update PGE across locations according to (obsVal-bkgVal), obsErr, and bkgErr,
   /// and update flags to say BG check performed, and whether obs rejected or not.
@@ -52,6 +93,69 @@ namespace ufo {
                          float ErrVarMax = -1,
                          const std::vector<float> *obsVal2 = nullptr,
                          const std::vector<float> *bkgVal2 = nullptr);
+
+  /// \brief Bayesian update of probability of gross error (PGE) for a batch of observations.
+  /// \details Equivalent to the vector-based overload, but operates in place on the arrays
+  /// described by \p batch. The locations are processed in tiles: the inputs of each tile are
+  /// gathered into contiguous buffers, the PGEs are computed in a branch-free loop and the
+  /// results are scattered back. Both components of vector observables are handled in the same
+  /// pass. The results are identical to those of the vector-based overload.
+  ///
+  /// \param[in] options: Configurable parameters that govern the operation of this routine.
+  /// \param[inout] batch: Inputs and outputs; see BayesianPGEBatch.
+  /// \param[in] ModelLevels: Have the data been averaged onto model levels?
+  /// \param[in] ErrVarMax: (Optional) Maximum error variance.
+  void BayesianPGEUpdate(const ProbabilityOfGrossErrorParameters &options,
+                         const BayesianPGEBatch &batch,
+                         const bool ModelLevels,
+                         float ErrVarMax = -1);
+
+  /// \brief Compute background departures and combined error variances of a batch of
+  /// observations.
+  /// \details For each location \c j (taken from \p indices if set, otherwise 0 to \p size - 1),
+  /// \c departures[j] is set to \c obsVal[j] - \c bkgVal[j] and \c errVars[j] to
+  /// \c (obErrMult * obsErr[j])^2 + (bkgErrMult * bkgErr[j])^2. Outputs are set to the missing
+  /// value indicator if any of the inputs they depend on is missing or if an error is negative.
+  /// If \p errVars is null, only the departures are computed.
+  void computeDeparturesAndErrorVariances(size_t size, const size_t *indices,
+                                          const float *obsVal, const float *bkgVal,
+                                          const float *obsErr, const float *bkgErr,
+                                          float obErrMult, float bkgErrMult,
+                                          float *departures, double *errVars);
+
+  /// \brief Fast approximation of exp(x) for x clamped to [-700, 700].
+  /// \details The argument is reduced to r = x - k ln 2 with |r| <= ln(2) / 2, exp(r) is
+  /// evaluated with a polynomial and the result is scaled by 2^k by setting the exponent bits
+  /// directly. The relative error is within a couple of ulps of std::exp. The function
+  /// contains no branches or library calls, so loops calling it can be vectorised.
+  inline double clampedExp(double x) {
+    const double log2e = 1.4426950408889634;
+    // ln(2) split into a part with trailing zero bits (so that k * ln2Hi is exact) and the rest.
+    const double ln2Hi = 6.93147180369123816490e-1;
+    const double ln2Lo = 1.90821492927058770002e-10;
+    x = std::min(std::max(x, -700.0), 700.0);
+    const double k = std::floor(x * log2e + 0.5);
+    const double r = (x - k * ln2Hi) - k * ln2Lo;
+    // Taylor series of exp(r) truncated after the r^12 term, evaluated with Horner's scheme.
+    double p = 1.0 / 479001600.0;
+    p = p * r + 1.0 / 39916800.0;
+    p = p * r + 1.0 / 3628800.0;
+    p = p * r + 1.0 / 362880.0;
+    p = p * r + 1.0 / 40320.0;
+    p = p * r + 1.0 / 5040.0;
+    p = p * r + 1.0 / 720.0;
+    p = p * r + 1.0 / 120.0;
+    p = p * r + 1.0 / 24.0;
+    p = p * r + 1.0 / 6.0;
+    p = p * r + 0.5;
+    p = p * r + 1.0;
+    p = p * r + 1.0;
+    const std::uint64_t bits = static_cast<std::uint64_t>(static_cast<std::int64_t>(k) + 1023)
+                               << 52;
+    double scale;
+    std::memcpy(&scale, &bits, sizeof(scale));
+    return p * scale;
+  }
 }  // namespace ufo
 
 #endif  // UFO_UTILS_PROBABILITYOFGROSSERROR_H_
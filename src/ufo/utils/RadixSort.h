@@ -0,0 +1,143 @@
+/*
+ * (C) Crown copyright 2021 Met Office. All rights reserved.
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ */
+
+#ifndef UFO_UTILS_RADIXSORT_H_
+#define UFO_UTILS_RADIXSORT_H_
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+namespace ufo {
+
+/// \brief Maps values of type \p T to unsigned integers ordered in the same way as the original
+/// values.
+///
+/// Specializations are provided for integral and floating-point types. Positive and negative
+/// floating-point zeros are mapped to the same integer, since they compare equal. The relative
+/// order of NaNs and other values is unspecified.
+template <typename T, typename Enable = void>
+struct RadixKeyTraits;
+
+template <typename T>
+struct RadixKeyTraits<T, typename std::enable_if<std::is_integral<T>::value &&
+                                                 std::is_unsigned<T>::value>::type> {
+  typedef T UInt;
+  static UInt encode(T value) { return value; }
+};
+
+template <typename T>
+struct RadixKeyTraits<T, typename std::enable_if<std::is_integral<T>::value &&
+                                                 std::is_signed<T>::value>::type> {
+  typedef typename std::make_unsigned<T>::type UInt;
+  static UInt encode(T value) {
+    // Flipping the sign bit moves negative numbers below positive ones.
+    return static_cast<UInt>(value) ^ (UInt(1) << (8 * sizeof(T) - 1));
+  }
+};
+
+template <typename T>
+struct RadixKeyTraits<T, typename std::enable_if<std::is_floating_point<T>::value>::type> {
+  typedef typename std::conditional<sizeof(T) == 4, std::uint32_t, std::uint64_t>::type UInt;
+  static_assert(sizeof(T) == sizeof(UInt), "Unsupported floating-point type");
+  static UInt encode(T value) {
+    if (value == 0)
+      value = 0;  // Replace -0 by +0
+    UInt bits;
+    std::memcpy(&bits, &value, sizeof(T));
+    const UInt signBit = UInt(1) << (8 * sizeof(T) - 1);
+    // Negative numbers: flip all bits, reversing their order. Positive numbers: set the sign bit.
+    return (bits & signBit) ? ~bits : (bits | signBit);
+  }
+};
+
+/// \brief A sort key packed together with the index of the element it belongs to.
+template <typename UInt>
+struct KeyedIndex {
+  UInt key;
+  size_t index;
+};
+
+/// \brief Sort \p items in ascending order of their keys using a least-significant-digit radix
+/// sort. The sort is stable.
+///
+/// \param buffer
+///   Scratch space. Passing the same vector to multiple calls avoids repeated memory allocation.
+///
+/// Passes over digits shared by all keys are skipped, so keys spanning a narrow range are sorted
+/// in few passes.
+template <typename UInt>
+void radixSort(std::vector<KeyedIndex<UInt>> &items, std::vector<KeyedIndex<UInt>> &buffer) {
+  const size_t numDigits = sizeof(UInt);
+  const size_t radix = 256;
+  const size_t n = items.size();
+  if (n < 2)
+    return;
+
+  // Build the histograms of all digits in a single pass.
+  std::array<std::array<size_t, radix>, numDigits> counts{};
+  for (const KeyedIndex<UInt> &item : items)
+    for (size_t digit = 0; digit < numDigits; ++digit)
+      ++counts[digit][(item.key >> (8 * digit)) & (radix - 1)];
+
+  buffer.resize(n);
+  for (size_t digit = 0; digit < numDigits; ++digit) {
+    std::array<size_t, radix> &offsets = counts[digit];
+    const size_t shift = 8 * digit;
+    if (offsets[(items.front().key >> shift) & (radix - 1)] == n)
+      continue;  // All keys share this digit
+    size_t offset = 0;
+    for (size_t &count : offsets) {
+      const size_t c = count;
+      count = offset;
+      offset += c;
+    }
+    for (const KeyedIndex<UInt> &item : items)
+      buffer[offsets[(item.key >> shift) & (radix - 1)]++] = item;
+    items.swap(buffer);
+  }
+}
+
+/// \brief Stably sort the indices in the range [\p first, \p last) in ascending order of
+/// `keys[index]`.
+///
+/// Ranges longer than a small threshold are sorted with radixSort(), shorter ones with
+/// std::stable_sort(); both produce the same ordering.
+///
+/// \param buffer
+///   Scratch space. Passing the same vector to multiple calls avoids repeated memory allocation.
+template <typename T, typename Iterator>
+void stableSortIndicesByKey(Iterator first, Iterator last, const std::vector<T> &keys,
+                            std::vector<KeyedIndex<typename RadixKeyTraits<T>::UInt>> &buffer) {
+  typedef RadixKeyTraits<T> Traits;
+  typedef typename Traits::UInt UInt;
+  const size_t minRadixSortSize = 64;
+
+  const size_t n = last - first;
+  if (n < minRadixSortSize) {
+    std::stable_sort(first, last,
+                     [&keys](size_t a, size_t b) { return keys[a] < keys[b]; });
+    return;
+  }
+
+  std::vector<KeyedIndex<UInt>> items(n);
+  Iterator it = first;
+  for (KeyedIndex<UInt> &item : items) {
+    item.index = *it++;
+    item.key = Traits::encode(keys[item.index]);
+  }
+  radixSort(items, buffer);
+  it = first;
+  for (const KeyedIndex<UInt> &item : items)
+    *it++ = item.index;
+}
+
+}  // namespace ufo
+
+#endif  // UFO_UTILS_RADIXSORT_H_
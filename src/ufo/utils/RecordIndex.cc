@@ -0,0 +1,79 @@
+/*
+ * (C) Crown copyright 2021 Met Office. All rights reserved.
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ */
+
+#include "ufo/utils/RecordIndex.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "eckit/exception/Exceptions.h"
+#include "ioda/ObsSpace.h"
+#include "oops/util/missingValues.h"
+#include "ufo/utils/ObsSpaceCache.h"
+
+namespace ufo {
+
+// -----------------------------------------------------------------------------
+
+RecordIndex::RecordIndex(const ioda::ObsSpace &obsdb) {
+  offsets_.reserve(obsdb.nrecs() + 1);
+  recordNumbers_.reserve(obsdb.nrecs());
+  locations_.reserve(obsdb.nlocs());
+  offsets_.push_back(0);
+  for (ioda::ObsSpace::RecIdxIter irec = obsdb.recidx_begin(); irec != obsdb.recidx_end();
+       ++irec) {
+    const std::vector<size_t> &locs = obsdb.recidx_vector(irec);
+    recordNumbers_.push_back(obsdb.recidx_recnum(irec));
+    locations_.insert(locations_.end(), locs.begin(), locs.end());
+    offsets_.push_back(locations_.size());
+  }
+}
+
+// -----------------------------------------------------------------------------
+
+RecordIndex::RecordIndex(std::vector<size_t> recordNumbers, std::vector<size_t> offsets,
+                         std::vector<size_t> locations)
+  : recordNumbers_(std::move(recordNumbers)), offsets_(std::move(offsets)),
+    locations_(std::move(locations))
+{
+  if (offsets_.size() != recordNumbers_.size() + 1 || offsets_.front() != 0 ||
+      offsets_.back() != locations_.size() ||
+      !std::is_sorted(offsets_.begin(), offsets_.end()))
+    throw eckit::BadParameter("Inconsistent record index offsets", Here());
+}
+
+// -----------------------------------------------------------------------------
+
+std::shared_ptr<const RecordIndex> RecordIndex::get(const ioda::ObsSpace &obsdb) {
+  // The grouping and sorting of locations into records is fixed when an ObsSpace is created,
+  // so the index of a given ObsSpace never needs to be rebuilt.
+  static ObsSpaceCache<const RecordIndex> cache;
+  return cache.get(obsdb, "", [&obsdb] { return std::make_shared<const RecordIndex>(obsdb); });
+}
+
+// -----------------------------------------------------------------------------
+
+RecordIndex RecordIndex::sortedBy(const std::vector<float> &coordinate, SortOrder order) const {
+  const float missing = util::missingValue(missing);
+  const bool ascending = order == SortOrder::ASCENDING;
+  // Missing values compare greater than all others in either order.
+  auto precedes = [&](size_t a, size_t b) {
+    const float ca = coordinate[a], cb = coordinate[b];
+    if (ca == missing || cb == missing)
+      return cb == missing && ca != missing;
+    return ascending ? ca < cb : ca > cb;
+  };
+
+  std::vector<size_t> locations = locations_;
+  for (size_t i = 0; i < numRecords(); ++i)
+    std::stable_sort(locations.begin() + offsets_[i], locations.begin() + offsets_[i + 1],
+                     precedes);
+  return RecordIndex(recordNumbers_, offsets_, std::move(locations));
+}
+
+// -----------------------------------------------------------------------------
+
+}  // namespace ufo
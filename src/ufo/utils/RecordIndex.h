@@ -0,0 +1,99 @@
+/*
+ * (C) Crown copyright 2021 Met Office. All rights reserved.
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ */
+
+#ifndef UFO_UTILS_RECORDINDEX_H_
+#define UFO_UTILS_RECORDINDEX_H_
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace ioda {
+  class ObsSpace;
+}
+
+namespace ufo {
+
+/// \brief Locations of the observations belonging to each record of an ObsSpace, stored in the
+/// compressed sparse row (CSR) format.
+///
+/// The indices of the locations of all records are held in a single vector; the locations of
+/// record `i` occupy the slice `[offsets()[i], offsets()[i + 1])` of that vector. Records are
+/// stored in ascending order of their record numbers and the locations of each record in the
+/// order of the ObsSpace's record index (i.e. sorted by the `obs sort variable`, if any).
+///
+/// Iterating over the records therefore requires no allocations, unlike calls to
+/// ioda::ObsSpace::recidx_vector(), which return copies of the index vectors.
+class RecordIndex {
+ public:
+  /// \brief The indices of the locations belonging to a single record.
+  class Record {
+   public:
+    Record(const size_t *begin, const size_t *end) : begin_(begin), end_(end) {}
+
+    const size_t *begin() const { return begin_; }
+    const size_t *end() const { return end_; }
+    size_t size() const { return end_ - begin_; }
+    bool empty() const { return begin_ == end_; }
+    size_t operator[](size_t i) const { return begin_[i]; }
+
+   private:
+    const size_t *begin_;
+    const size_t *end_;
+  };
+
+  /// \brief Order in which sortedBy() arranges the locations of each record.
+  enum class SortOrder { ASCENDING, DESCENDING };
+
+  /// \brief Build the index of the records of \p obsdb.
+  explicit RecordIndex(const ioda::ObsSpace &obsdb);
+
+  /// \brief Build an index from its constituent vectors.
+  ///
+  /// \p offsets must contain one more element than \p recordNumbers, start at 0, be
+  /// non-decreasing and end at the length of \p locations.
+  RecordIndex(std::vector<size_t> recordNumbers, std::vector<size_t> offsets,
+              std::vector<size_t> locations);
+
+  /// \brief Return the index of the records of \p obsdb, building it if necessary.
+  ///
+  /// Indices are cached for as long as the ObsSpace exists, so that they are shared by all filters
+  /// and survive the re-creation of filters in each outer loop.
+  static std::shared_ptr<const RecordIndex> get(const ioda::ObsSpace &obsdb);
+
+  /// \brief Number of records.
+  size_t numRecords() const { return recordNumbers_.size(); }
+
+  /// \brief Record number of the \p i'th record.
+  size_t recordNumber(size_t i) const { return recordNumbers_[i]; }
+
+  /// \brief Locations of the \p i'th record.
+  Record operator[](size_t i) const {
+    return Record(locations_.data() + offsets_[i], locations_.data() + offsets_[i + 1]);
+  }
+
+  /// \brief Offsets of the first location of each record in locations(), followed by the total
+  /// number of locations.
+  const std::vector<size_t> &offsets() const { return offsets_; }
+
+  /// \brief Locations of all records, concatenated.
+  const std::vector<size_t> &locations() const { return locations_; }
+
+  /// \brief Return a copy of this index with the locations of each record stably sorted by the
+  /// values of \p coordinate (typically a vertical coordinate such as pressure or height).
+  ///
+  /// Locations at which \p coordinate is missing are placed at the end of each record.
+  RecordIndex sortedBy(const std::vector<float> &coordinate, SortOrder order) const;
+
+ private:
+  std::vector<size_t> recordNumbers_;
+  std::vector<size_t> offsets_;
+  std::vector<size_t> locations_;
+};
+
+}  // namespace ufo
+
+#endif  // UFO_UTILS_RECORDINDEX_H_
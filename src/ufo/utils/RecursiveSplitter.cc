@@ -9,12 +9,54 @@
 
 #include <algorithm>
 #include <numeric>
+#include <string>
+#include <type_traits>
+#include <utility>
 
 #include "oops/util/Random.h"
+#include "ufo/utils/ParallelFor.h"
+#include "ufo/utils/RadixSort.h"
 
 namespace ufo
 {
 
+namespace {
+
+/// Minimum number of elements sorted by a single task in RecursiveSplitter::stableSortRanges().
+const size_t minNumElementsPerTask = 4096;
+
+/// Sorts ranges of ids by arithmetic keys using a radix sort.
+template <typename T, bool isArithmetic = std::is_arithmetic<T>::value>
+class RangeSorter {
+ public:
+  explicit RangeSorter(const std::vector<T> &keys) : keys_(keys) {}
+
+  void operator()(std::vector<size_t>::iterator first, std::vector<size_t>::iterator last) {
+    stableSortIndicesByKey(first, last, keys_, buffer_);
+  }
+
+ private:
+  const std::vector<T> &keys_;
+  std::vector<KeyedIndex<typename RadixKeyTraits<T>::UInt>> buffer_;
+};
+
+/// Sorts ranges of ids by other keys (e.g. strings) using a comparison sort.
+template <typename T>
+class RangeSorter<T, false> {
+ public:
+  explicit RangeSorter(const std::vector<T> &keys) : keys_(keys) {}
+
+  void operator()(std::vector<size_t>::iterator first, std::vector<size_t>::iterator last) {
+    std::stable_sort(first, last,
+                     [this](size_t idA, size_t idB) { return keys_[idA] < keys_[idB]; });
+  }
+
+ private:
+  const std::vector<T> &keys_;
+};
+
+}  // namespace
+
 RecursiveSplitter::RecursiveSplitter(size_t numIds) {
   orderedIds_.resize(numIds);
   std::iota(orderedIds_.begin(), orderedIds_.end(), 0);
@@ -33,25 +75,50 @@ void RecursiveSplitter::initializeEncodedGroups() {
   }
 }
 
+std::vector<std::pair<size_t, size_t>> RecursiveSplitter::multiElementGroupBounds() const {
+  std::vector<std::pair<size_t, size_t>> bounds;
+  for (Group group : multiElementGroups())
+    bounds.emplace_back(group.begin() - orderedIds_.cbegin(), group.end() - orderedIds_.cbegin());
+  return bounds;
+}
+
+template <typename T>
+void RecursiveSplitter::stableSortRanges(const std::vector<std::pair<size_t, size_t>> &bounds,
+                                         const std::vector<T> &keys) {
+  // Assign consecutive ranges to tasks, each containing at least minNumElementsPerTask elements
+  // (apart from the last one), so that many small groups are not sorted by separate tasks.
+  std::vector<size_t> firstRangeInTask(1, 0);
+  size_t numElementsInTask = 0;
+  for (size_t range = 0; range < bounds.size(); ++range) {
+    numElementsInTask += bounds[range].second - bounds[range].first;
+    if (numElementsInTask >= minNumElementsPerTask) {
+      firstRangeInTask.push_back(range + 1);
+      numElementsInTask = 0;
+    }
+  }
+  if (firstRangeInTask.back() != bounds.size())
+    firstRangeInTask.push_back(bounds.size());
+
+  parallelFor(firstRangeInTask.size() - 1, [&](size_t task) {
+    RangeSorter<T> sorter(keys);
+    for (size_t range = firstRangeInTask[task]; range < firstRangeInTask[task + 1]; ++range)
+      sorter(orderedIds_.begin() + bounds[range].first, orderedIds_.begin() + bounds[range].second);
+  });
+}
+
 template <typename T>
 void RecursiveSplitter::groupByImpl(const std::vector<T> &categories) {
   auto orderedCategory = [&](size_t index) { return categories[orderedIds_[index]]; };
 
+  const std::vector<std::pair<size_t, size_t>> bounds = multiElementGroupBounds();
+  stableSortRanges(bounds, categories);
+
+  // Now update the groups
   const auto numIds = orderedIds_.size();
-  ptrdiff_t lastIndexInGroup = -1;
   ptrdiff_t lastIndexInLastGroup = -1;
-  while (lastIndexInGroup + 1 < numIds) {
-    const size_t firstIndexInGroup = encodedGroups_[lastIndexInGroup + 1];
-    if (firstIndexInGroup + 1 >= numIds)
-      break;
-    lastIndexInGroup = encodedGroups_[firstIndexInGroup + 1];
-
-    std::stable_sort(orderedIds_.begin() + firstIndexInGroup,
-                     orderedIds_.begin() + lastIndexInGroup + 1,
-                     [&categories](size_t idA, size_t idB)
-                     { return categories[idA] < categories[idB];});
-
-    // Now update the group
+  for (const std::pair<size_t, size_t> &range : bounds) {
+    const size_t firstIndexInGroup = range.first;
+    const size_t lastIndexInGroup = range.second - 1;
     size_t newFirstIndex = firstIndexInGroup;
     for (size_t newLastIndex = firstIndexInGroup;
          newLastIndex <= lastIndexInGroup;
@@ -74,6 +141,11 @@ void RecursiveSplitter::groupByImpl(const std::vector<T> &categories) {
     encodedGroups_[lastIndexInLastGroup + 1] = numIds;
 }
 
+template <typename T>
+void RecursiveSplitter::sortGroupsByKey(const std::vector<T> &keys) {
+  stableSortRanges(multiElementGroupBounds(), keys);
+}
+
 void RecursiveSplitter::shuffleGroups() {
   for (Group group : multiElementGroups()) {
     std::vector<size_t>::iterator nonConstGroupBegin =
@@ -93,4 +165,10 @@ template void RecursiveSplitter::groupByImpl(const std::vector<int> &);
 template void RecursiveSplitter::groupByImpl(const std::vector<size_t> &);
 template void RecursiveSplitter::groupByImpl(const std::vector<std::string> &);
 
+template void RecursiveSplitter::sortGroupsByKey(const std::vector<int> &);
+template void RecursiveSplitter::sortGroupsByKey(const std::vector<int64_t> &);
+template void RecursiveSplitter::sortGroupsByKey(const std::vector<size_t> &);
+template void RecursiveSplitter::sortGroupsByKey(const std::vector<float> &);
+template void RecursiveSplitter::sortGroupsByKey(const std::vector<double> &);
+
 }  // namespace ufo
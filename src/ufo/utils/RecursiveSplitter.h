@@ -11,7 +11,9 @@
 #include <algorithm>
 #include <cassert>
 #include <cstddef>  // for size_t
+#include <cstdint>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "ufo/utils/ArrowProxy.h"
@@ -57,6 +59,11 @@ namespace ufo {
 ///   Elements with these indices are equivalent: 5, 7,
 /// \endcode
 ///
+/// Groups are split and sorted with a stable sort, so elements that compare equal keep their
+/// relative order. Integer and floating-point keys are sorted with a radix sort, and independent
+/// groups may be processed concurrently on up to defaultNumThreads() threads; neither affects
+/// the results.
+///
 /// \internal In the implementation, indices into the partitioned array are referred to as _ids_.
 /// The term _index_ denotes an index into the vector \c orderedIds_.
 class RecursiveSplitter
@@ -299,6 +306,31 @@ class RecursiveSplitter
   template <typename Compare>
   void sortGroupsBy(Compare comp);
 
+  /// \brief Stably sort the elements in each equivalence class in ascending order of their keys.
+  ///
+  /// \param keys
+  ///   A vector assigning a key to each element of the partitioned array.
+  ///
+  /// This is equivalent to, but typically much faster than
+  /// \code
+  /// sortGroupsBy([&keys](size_t a, size_t b) { return keys[a] < keys[b]; })
+  /// \endcode
+  /// except that elements with equal keys are guaranteed to keep their relative order.
+  ///
+  /// Supported key types: int, int64_t, size_t, float and double.
+  template <typename T>
+  void sortGroupsByKey(const std::vector<T> &keys);
+
+  /// \brief Stably sort the elements in each equivalence class in lexicographical order of the
+  /// tuples of keys (`keys1[id]`, `keys2[id]`, ...).
+  template <typename T, typename... Ts>
+  void sortGroupsByKeys(const std::vector<T> &keys, const std::vector<Ts> &... moreKeys) {
+    // The least significant keys are sorted first; stability preserves their order among
+    // elements with equal more significant keys.
+    sortGroupsByKeys(moreKeys...);
+    sortGroupsByKey(keys);
+  }
+
   /// \brief Randomly shuffle the elements of each equivalence class.
   void shuffleGroups();
 
@@ -318,6 +350,18 @@ class RecursiveSplitter
   template <typename T>
   void groupByImpl(const std::vector<T> &categories);
 
+  /// Terminates the recursion in sortGroupsByKeys().
+  void sortGroupsByKeys() {}
+
+  /// Return the bounds [begin, end) of the ranges of indices of all multi-element equivalence
+  /// classes.
+  std::vector<std::pair<size_t, size_t>> multiElementGroupBounds() const;
+
+  /// Stably sort the elements in the index ranges \p bounds in ascending order of \p keys.
+  template <typename T>
+  void stableSortRanges(const std::vector<std::pair<size_t, size_t>> &bounds,
+                        const std::vector<T> &keys);
+
   /// Indices of elements of the partitioned array ordered by equivalence class.
   std::vector<size_t> orderedIds_;
   /// Encoded locations of multi-element equivalence classes in orderedIds_.
@@ -77,6 +77,11 @@ class SpatialBinSelector {
     return longitudeBinSelectors_[latitudeBin].binCenter(longitudeBin);
   }
 
+  /// \brief Return the number of zonal bands of bins.
+  IndexType numLatitudeBins() const {
+    return latitudeBinSelector_.numBins();
+  }
+
   /// \brief Return the number of bins into which the sphere is split.
   IndexType totalNumBins() const;
 
@@ -0,0 +1,91 @@
+/*
+ * (C) Crown copyright 2021 Met Office. All rights reserved.
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ */
+
+#include "ufo/utils/VariableRegistry.h"
+
+#include <unordered_map>
+
+#include "eckit/exception/Exceptions.h"
+#include "oops/base/Variables.h"
+
+namespace ufo {
+
+// -----------------------------------------------------------------------------
+
+constexpr int VariableRegistry::noChannel;
+
+// -----------------------------------------------------------------------------
+
+VariableRegistry &VariableRegistry::instance() {
+  static VariableRegistry registry;
+  return registry;
+}
+
+// -----------------------------------------------------------------------------
+
+VariableHandle VariableRegistry::intern(const std::string &name, const std::string &group,
+                                        int channel) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  const auto inserted = handles_.insert(std::make_pair(std::make_tuple(name, group, channel),
+                                                       VariableHandle{entries_.size()}));
+  if (inserted.second) {
+    const std::string variable =
+        channel == noChannel ? name : name + "_" + std::to_string(channel);
+    entries_.push_back(Entry{variable, group, channel});
+  }
+  return inserted.first->second;
+}
+
+// -----------------------------------------------------------------------------
+
+const VariableRegistry::Entry &VariableRegistry::entry(VariableHandle handle) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  ASSERT(handle.index < entries_.size());
+  return entries_[handle.index];
+}
+
+// -----------------------------------------------------------------------------
+
+const std::string &VariableRegistry::variable(VariableHandle handle) const {
+  return entry(handle).variable;
+}
+
+// -----------------------------------------------------------------------------
+
+const std::string &VariableRegistry::group(VariableHandle handle) const {
+  return entry(handle).group;
+}
+
+// -----------------------------------------------------------------------------
+
+int VariableRegistry::channel(VariableHandle handle) const {
+  return entry(handle).channel;
+}
+
+// -----------------------------------------------------------------------------
+
+std::vector<size_t> findVariables(const oops::Variables &vars,
+                                  const std::vector<VariableHandle> &handles) {
+  std::unordered_map<std::string, size_t> positions;
+  for (size_t jv = vars.size(); jv-- > 0; )
+    positions[vars[jv]] = jv;  // iterate backwards to keep the first occurrence of duplicates
+
+  const VariableRegistry &registry = VariableRegistry::instance();
+  std::vector<size_t> result;
+  result.reserve(handles.size());
+  for (VariableHandle handle : handles) {
+    const std::string &variable = registry.variable(handle);
+    const auto it = positions.find(variable);
+    if (it == positions.end())
+      throw eckit::UserError("Variable " + variable + " not found", Here());
+    result.push_back(it->second);
+  }
+  return result;
+}
+
+// -----------------------------------------------------------------------------
+
+}  // namespace ufo
@@ -0,0 +1,88 @@
+/*
+ * (C) Crown copyright 2021 Met Office. All rights reserved.
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ */
+
+#ifndef UFO_UTILS_VARIABLEREGISTRY_H_
+#define UFO_UTILS_VARIABLEREGISTRY_H_
+
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace oops {
+  class Variables;
+}
+
+namespace ufo {
+
+/// \brief Dense integer identifying a (variable, group, channel) triple interned in the
+/// VariableRegistry.
+///
+/// Handles are meant to be obtained once, e.g. in filter constructors, and then used in place of
+/// variable names in loops over channels, avoiding repeated construction and comparison of
+/// strings such as `brightness_temperature_123`.
+struct VariableHandle {
+  size_t index;
+
+  bool operator==(const VariableHandle &other) const { return index == other.index; }
+  bool operator!=(const VariableHandle &other) const { return index != other.index; }
+  bool operator<(const VariableHandle &other) const { return index < other.index; }
+};
+
+/// \brief Process-wide registry assigning a VariableHandle to each distinct (variable, group,
+/// channel) triple.
+///
+/// Handles are never invalidated; the strings returned by variable() and group() remain valid
+/// until the end of the program.
+class VariableRegistry {
+ public:
+  /// Value of the `channel` argument of intern() denoting a variable without channels.
+  static constexpr int noChannel = -1;
+
+  static VariableRegistry &instance();
+
+  /// \brief Return the handle of the variable \p name with channel \p channel in group \p group,
+  /// registering it if necessary.
+  VariableHandle intern(const std::string &name, const std::string &group,
+                        int channel = noChannel);
+
+  /// \brief Name of the variable identified by \p handle, including the channel suffix
+  /// (e.g. `brightness_temperature_123`).
+  const std::string &variable(VariableHandle handle) const;
+  /// \brief Group of the variable identified by \p handle.
+  const std::string &group(VariableHandle handle) const;
+  /// \brief Channel of the variable identified by \p handle, or noChannel.
+  int channel(VariableHandle handle) const;
+
+ private:
+  struct Entry {
+    std::string variable;
+    std::string group;
+    int channel;
+  };
+
+  VariableRegistry() = default;
+  const Entry &entry(VariableHandle handle) const;
+
+  mutable std::mutex mutex_;
+  std::map<std::tuple<std::string, std::string, int>, VariableHandle> handles_;
+  // A deque, since references to its elements stay valid when new elements are appended.
+  std::deque<Entry> entries_;
+};
+
+/// \brief Return the positions in \p vars of the variables identified by \p handles (whose groups
+/// are ignored).
+///
+/// This can be used to resolve once the indices of the rows of an ioda::ObsDataVector holding
+/// these variables. Throws an exception if any of the variables is not in \p vars.
+std::vector<size_t> findVariables(const oops::Variables &vars,
+                                  const std::vector<VariableHandle> &handles);
+
+}  // namespace ufo
+
+#endif  // UFO_UTILS_VARIABLEREGISTRY_H_
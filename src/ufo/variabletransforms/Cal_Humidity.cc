@@ -48,7 +48,7 @@ void Cal_RelativeHumidity::runTransform() {
 void Cal_RelativeHumidity::methodDEFAULT() {
   const size_t nlocs = obsdb_.nlocs();
 
-  float esat, qvs, qv, satVaporPres;
+  float esat, qvs, qv;
 
   std::vector<float> specificHumidity;
   std::vector<float> airTemperature;
@@ -78,14 +78,22 @@ void Cal_RelativeHumidity::methodDEFAULT() {
   // Initialise this vector with missing value
   relativeHumidity.assign(nlocs, missingValueFloat);
 
+  // Calculate saturation vapor pressure from temperature according to requested formulation,
+  // for all obs at once. Temperatures at locations skipped below are masked, so that invalid
+  // values there cannot raise floating-point exceptions.
+  std::vector<float> usedAirTemperature(airTemperature);
+  for (size_t jobs = 0; jobs < nlocs; ++jobs)
+    if (specificHumidity[jobs] == missingValueFloat || pressure[jobs] == missingValueFloat)
+      usedAirTemperature[jobs] = missingValueFloat;
+  std::vector<float> satVaporPres;
+  formulas::SatVaporPres_fromTemp(usedAirTemperature, satVaporPres, formulation());
+
   // Loop over all obs
   for (size_t jobs = 0; jobs < nlocs; ++jobs) {
     if (specificHumidity[jobs] != missingValueFloat &&
         airTemperature[jobs] != missingValueFloat && pressure[jobs] != missingValueFloat) {
-      // Calculate saturation vapor pressure from temperature according to requested formulation
-      // Double-check result is always lower than 15% of incoming pressure.
-      satVaporPres = formulas::SatVaporPres_fromTemp(airTemperature[jobs], formulation());
-      esat = std::min(pressure[jobs]*0.15f, satVaporPres);
+      // Double-check saturation vapor pressure is always lower than 15% of incoming pressure.
+      esat = std::min(pressure[jobs]*0.15f, satVaporPres[jobs]);
 
       // Convert sat. vapor pressure to sat water vapor mixing ratio
       qvs = 0.622 * esat/(pressure[jobs]-esat);
@@ -135,7 +143,7 @@ void Cal_SpecificHumidity::runTransform() {
 
 void Cal_SpecificHumidity::methodDEFAULT() {
   const size_t nlocs = obsdb_.nlocs();
-  float esat, qvs, qv, satVaporPres;
+  float esat, qvs, qv;
   std::vector<float> relativeHumidity;
   std::vector<float> airTemperature;
   std::vector<float> pressure;
@@ -164,14 +172,22 @@ void Cal_SpecificHumidity::methodDEFAULT() {
   // Initialise this vector with missing value
   specificHumidity.assign(nlocs, missingValueFloat);
 
+  // Calculate saturation vapor pressure from temperature according to requested formulation,
+  // for all obs at once. Temperatures at locations skipped below are masked, so that invalid
+  // values there cannot raise floating-point exceptions.
+  std::vector<float> usedAirTemperature(airTemperature);
+  for (size_t jobs = 0; jobs < nlocs; ++jobs)
+    if (relativeHumidity[jobs] == missingValueFloat || pressure[jobs] == missingValueFloat)
+      usedAirTemperature[jobs] = missingValueFloat;
+  std::vector<float> satVaporPres;
+  formulas::SatVaporPres_fromTemp(usedAirTemperature, satVaporPres, formulation());
+
   // Loop over all obs
   for (size_t jobs = 0; jobs < nlocs; ++jobs) {
     if (relativeHumidity[jobs] != missingValueFloat &&
         airTemperature[jobs] != missingValueFloat && pressure[jobs] != missingValueFloat) {
-      // Calculate saturation vapor pressure from temperature according to requested formulation
-      // Double-check result is always lower than 15% of incoming pressure.
-      satVaporPres = formulas::SatVaporPres_fromTemp(airTemperature[jobs], formulation());
-      esat = std::min(pressure[jobs]*0.15f, satVaporPres);
+      // Double-check saturation vapor pressure is always lower than 15% of incoming pressure.
+      esat = std::min(pressure[jobs]*0.15f, satVaporPres[jobs]);
 
       // Convert sat. vapor pressure to sat water vapor mixing ratio
       qvs = 0.622 * esat/(pressure[jobs]-esat);
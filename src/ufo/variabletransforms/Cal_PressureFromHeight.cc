@@ -8,6 +8,7 @@
 #include "ufo/variabletransforms/Cal_PressureFromHeight.h"
 #include "ufo/filters/ProfileConsistencyCheckParameters.h"
 #include "ufo/utils/Constants.h"
+#include "ufo/utils/RecordIndex.h"
 
 namespace ufo {
 /************************************************************************************/
@@ -67,7 +68,8 @@ void Cal_PressureFromHeightForProfile::methodUKMO() {
   bool hasBeenUpdated = false;
 
   const size_t nlocs_ = obsdb_.nlocs();
-  ioda::ObsSpace::RecIdxIter irec;
+  const std::shared_ptr<const RecordIndex> recordIndex = RecordIndex::get(obsdb_);
+  const RecordIndex &records = *recordIndex;
 
   // return if no data
   if (obsdb_.nlocs() == 0) {
@@ -141,11 +143,19 @@ void Cal_PressureFromHeightForProfile::methodUKMO() {
     }
   }
 
+  // Vapour pressure at each upper air dew point; it does not depend on the profile integration
+  // below, so it is calculated for all locations at once.
+  std::vector<float> dewPointVapourPressure;
+  if (!dewPointTemperature.empty()) {
+    formulas::SatVaporPres_fromTemp(dewPointTemperature, dewPointVapourPressure, formulation());
+    formulas::SatVaporPres_correction(dewPointVapourPressure, dewPointTemperature, formulation());
+  }
+
   // 4. Starting the calculation
   //    Loop over each record
   // -------------------------------------------------------------------------------------
-  for (irec = obsdb_.recidx_begin(); irec != obsdb_.recidx_end(); ++irec) {
-    const std::vector<std::size_t> &rSort = obsdb_.recidx_vector(irec);
+  for (size_t irec = 0; irec < records.numRecords(); ++irec) {
+    const RecordIndex::Record rSort = records[irec];
     size_t ilocs = 0;
 
     // 4.1 Initialise for surface values
@@ -205,11 +215,7 @@ void Cal_PressureFromHeightForProfile::methodUKMO() {
       } else {
         // Update Tcurrent if dew point positive
         if (dewPointTemperature[rSort[ilocs]] != missingValueFloat) {
-          Pvap =
-              formulas::SatVaporPres_fromTemp(dewPointTemperature[rSort[ilocs]], formulation());
-          Pvap = formulas::SatVaporPres_correction(Pvap,
-                                                   dewPointTemperature[rSort[ilocs]],
-                                                   formulation());
+          Pvap = dewPointVapourPressure[rSort[ilocs]];
           Tcurrent = formulas::VirtualTemp_From_Psat_P_T(Pvap, Pprev, Tcurrent, formulation());
         }
       }
@@ -273,7 +279,8 @@ void Cal_PressureFromHeightForICAO::methodUKMO() {
 
   const size_t nlocs_ = obsdb_.nlocs();
 
-  ioda::ObsSpace::RecIdxIter irec;
+  const std::shared_ptr<const RecordIndex> recordIndex = RecordIndex::get(obsdb_);
+  const RecordIndex &records = *recordIndex;
 
   // 0. Initialise the ouput array
   // -------------------------------------------------------------------------------
@@ -297,10 +304,13 @@ void Cal_PressureFromHeightForICAO::methodUKMO() {
     throw eckit::BadValue("GeopotentialHeight vector is the wrong size or empty ", Here());
   }
 
-  // 3. Loop over each record
+  // 3. Convert all heights at once, then loop over each record
   // -------------------------------------------------------------------------------------
-  for (irec = obsdb_.recidx_begin(); irec != obsdb_.recidx_end(); ++irec) {
-    const std::vector<std::size_t> &rSort = obsdb_.recidx_vector(irec);
+  std::vector<float> icaoPressure;
+  formulas::Height_To_Pressure_ICAO_atmos(geopotentialHeight, icaoPressure, formulation());
+
+  for (size_t irec = 0; irec < records.numRecords(); ++irec) {
+    const RecordIndex::Record rSort = records[irec];
     size_t ilocs = 0;
 
     // 3.1 Loop over each record
@@ -308,8 +318,7 @@ void Cal_PressureFromHeightForICAO::methodUKMO() {
       // Cycle if airPressure is valid
       if (airPressure[rSort[ilocs]] != missingValueFloat) continue;
 
-      airPressure[rSort[ilocs]] = formulas::Height_To_Pressure_ICAO_atmos(
-          geopotentialHeight[rSort[ilocs]], formulation());
+      airPressure[rSort[ilocs]] = icaoPressure[rSort[ilocs]];
 
       hasBeenUpdated = true;
     }
@@ -40,78 +40,198 @@ MethodFormulation resolveFormulations(const std::string& input, const std::strin
   }
 }
 
+namespace {
+
+// Kernels evaluating the formulations below at a single point. They are shared by the scalar
+// and array versions of each formula, so that both produce identical results.
+
+struct SatVaporPresSonntag {
+  float operator()(float temp_K) const {
+    /* I. Source: Eqn 7, Sonntag, D., Advancements in the field of hygrometry,
+     *     Meteorol. Zeitschrift, N. F., 3, 51-66, 1994.
+     *     Most radiosonde manufacturers use Wexler, or Hyland and Wexler
+     *     or Sonntag formulations, which are all very similar (Holger Vomel,
+     *     pers. comm., 2011)
+    */
+    return std::exp(-6096.9385f / temp_K + 21.2409642f - 2.711193E-2f * temp_K +
+                    1.673952E-5f * temp_K * temp_K + 2.433502f * std::log(temp_K));
+  }
+};
+
+struct SatVaporPresWalko {
+  float operator()(float temp_K) const {
+    // Polynomial fit of Goff-Gratch (1946) formulation. (Walko, 1991)
+    const float t0c = static_cast<float>(ufo::Constants::t0c);
+    const float x = std::max(-80.0f, temp_K-t0c);
+    const float c[] = {610.5851f, 44.40316f, 1.430341f, 0.2641412e-1f,
+      0.2995057e-3f, 0.2031998e-5f, 0.6936113e-8f, 0.2564861e-11f, -0.3704404e-13f};
+    return c[0]+x*(c[1]+x*(c[2]+x*(c[3]+x*(c[4]+x*(c[5]+x*(c[6]+x*(c[7]+x*c[8])))))));
+  }
+};
+
+struct SatVaporPresMurphy {
+  float operator()(float temp_K) const {
+    // ALTERNATIVE (costs more CPU, more accurate than Walko, 1991)
+    // Source: Murphy and Koop, Review of the vapour pressure of ice and
+    //       supercooled water for atmospheric applications, Q. J. R.
+    //       Meteorol. Soc (2005), 131, pp. 1539-1565.
+    return std::exp(54.842763f - 6763.22f / temp_K - 4.210f * std::log(temp_K)
+                    + 0.000367f * temp_K + std::tanh(0.0415f * (temp_K - 218.8f))
+                    * (53.878f - 1331.22f / temp_K - 9.44523f * std::log(temp_K)
+                    + 0.014025f * temp_K));
+  }
+};
+
+struct SatVaporPresRogers {
+  float operator()(float temp_K) const {
+    // Classical formula from Rogers and Yau (1989; Eq2.17)
+    const float t0c = static_cast<float>(ufo::Constants::t0c);
+    return 1000. * 0.6112 * std::exp(17.67f * (temp_K - t0c) / (temp_K - 29.65f));
+  }
+};
+
+struct SatVaporPresCorrectionSonntag {
+  float operator()(float e_sub_s, float temp_K) const {
+    /* e_sub_s above is the saturation vapour pressure of pure water vapour
+       FsubW (~ 1.005 at 1000 hPa) is the enhancement factor needed for moist
+        air (eg eqns 20, 22 of Sonntag, but for consistency with QSAT the formula
+        below is from eqn A4.6 of Adrian Gill's book)
+    */
+    const float t0c = static_cast<float>(ufo::Constants::t0c);
+    const float FsubW = 1.0f - 1.0E-8f *
+        (4.5f + 6.0E-4f * (temp_K - t0c) *(temp_K - t0c));  // Enhancement factor
+    return e_sub_s * FsubW;
+  }
+};
+
+struct PressureFromHeightICAO {
+  float operator()(float height) const {
+    const float missingValueFloat = util::missingValue(1.0f);
+    float Pressure = missingValueFloat;
+    float RepT_Bot, RepT_Top, ZP1, ZP2;
+
+    RepT_Bot = 1.0 / Constants::icao_temp_surface;
+    RepT_Top = 1.0 / Constants::icao_temp_isothermal_layer;
+    ZP1 = Constants::g_over_rd / Constants::icao_lapse_rate_l;
+    ZP2 = Constants::g_over_rd / Constants::icao_lapse_rate_u;
+
+    if (height <= missingValueFloat) {
+      Pressure = missingValueFloat;
+    } else if (height < -5000.0) {
+      // TODO(david simonin): The original code has this test.
+      // Not sure why! Are we expecting very negative height value??
+      Pressure = missingValueFloat;
+    } else if (height < Constants::icao_height_l) {
+      // Heights up to 11,000 geopotential heigh in meter [gpm]
+      Pressure = Constants::icao_lapse_rate_l * height * RepT_Bot;
+      Pressure = std::pow((1.0 - Pressure), ZP1);
+      Pressure = 100.0 * Pressure * Constants::icao_pressure_surface;
+    } else if (height < Constants::icao_height_u) {
+      // Heights between 11,000 and 20,000 geopotential heigh in meter [gpm]
+      Pressure = Constants::g_over_rd * (height - Constants::icao_height_l) * RepT_Top;
+      Pressure = std::log(Constants::icao_pressure_l) - Pressure;
+      Pressure = 100.0 * std::exp(Pressure);
+    } else {
+      // Heights above 20,000 geopotential heigh in meter [gpm]
+      Pressure = Constants::icao_lapse_rate_u * RepT_Top *
+                 (height - Constants::icao_height_u);
+      Pressure = 100.0 * Constants::icao_pressure_u *
+                 std::pow((1.0 - Pressure), ZP2);
+    }
+    return Pressure;
+  }
+};
+
+/// Set each element of \p out to \p kernel applied to the corresponding element of \p in, or
+/// to \p resultForMissing if that element is missing.
+///
+/// The kernel is applied to \p harmlessInput in place of missing inputs so that the loop has no
+/// branches (and raises no floating-point exceptions), which lets the compiler vectorise it.
+template <typename Kernel>
+void applyToNonMissing(const std::vector<float> &in, std::vector<float> &out,
+                       const Kernel &kernel, float harmlessInput, float resultForMissing) {
+  const float missing = util::missingValue(missing);
+  const size_t n = in.size();
+  out.resize(n);
+  const float *x = in.data();
+  float *y = out.data();
+  for (size_t i = 0; i < n; ++i) {
+    const bool valid = x[i] != missing;
+    const float result = kernel(valid ? x[i] : harmlessInput);
+    y[i] = valid ? result : resultForMissing;
+  }
+}
+
+}  // namespace
+
 /* -------------------------------------------------------------------------------------*/
 float SatVaporPres_fromTemp(float temp_K, MethodFormulation formulation) {
   const float missingValueFloat = util::missingValue(1.0f);
-  const float t0c = static_cast<float>(ufo::Constants::t0c);
   float e_sub_s = missingValueFloat;  // Saturation vapour pressure (Pa)
 
   switch (formulation) {
     case formulas::MethodFormulation::UKMO:
     case formulas::MethodFormulation::Sonntag: {
-      /* I. Source: Eqn 7, Sonntag, D., Advancements in the field of hygrometry,
-       *     Meteorol. Zeitschrift, N. F., 3, 51-66, 1994.
-       *     Most radiosonde manufacturers use Wexler, or Hyland and Wexler
-       *     or Sonntag formulations, which are all very similar (Holger Vomel,
-       *     pers. comm., 2011)
-      */
       if (temp_K != missingValueFloat) {
-        e_sub_s = std::exp(-6096.9385f / temp_K + 21.2409642f - 2.711193E-2f * temp_K +
-                        1.673952E-5f * temp_K * temp_K + 2.433502f * std::log(temp_K));
+        e_sub_s = SatVaporPresSonntag()(temp_K);
       } else {
         e_sub_s = 0.0f;
       }
       break;
     }
     case formulas::MethodFormulation::Walko: {
-          // Polynomial fit of Goff-Gratch (1946) formulation. (Walko, 1991)
-          float x = std::max(-80.0f, temp_K-t0c);
-          const std::vector<float> c{610.5851f, 44.40316f, 1.430341f, 0.2641412e-1f,
-            0.2995057e-3f, 0.2031998e-5f, 0.6936113e-8f, 0.2564861e-11f, -0.3704404e-13f};
-          e_sub_s = c[0]+x*(c[1]+x*(c[2]+x*(c[3]+x*(c[4]+x*(c[5]+x*(c[6]+x*(c[7]+x*c[8])))))));
-          break;
+      e_sub_s = SatVaporPresWalko()(temp_K);
+      break;
     }
     case formulas::MethodFormulation::Murphy: {
-      // ALTERNATIVE (costs more CPU, more accurate than Walko, 1991)
-      // Source: Murphy and Koop, Review of the vapour pressure of ice and
-      //       supercooled water for atmospheric applications, Q. J. R.
-      //       Meteorol. Soc (2005), 131, pp. 1539-1565.
-      e_sub_s = std::exp(54.842763f - 6763.22f / temp_K - 4.210f * std::log(temp_K)
-                     + 0.000367f * temp_K + std::tanh(0.0415f * (temp_K - 218.8f))
-                     * (53.878f - 1331.22f / temp_K - 9.44523f * std::log(temp_K)
-                     + 0.014025f * temp_K));
+      e_sub_s = SatVaporPresMurphy()(temp_K);
       break;
     }
     case formulas::MethodFormulation::NCAR:
     case formulas::MethodFormulation::NOAA:
     case formulas::MethodFormulation::Rogers:
     default: {
-      // Classical formula from Rogers and Yau (1989; Eq2.17)
-      e_sub_s = 1000. * 0.6112 * std::exp(17.67f * (temp_K - t0c) / (temp_K - 29.65f));
+      e_sub_s = SatVaporPresRogers()(temp_K);
       break;
     }
   }
   return e_sub_s;
 }
 
-/* -------------------------------------------------------------------------------------*/
-float SatVaporPres_correction(float e_sub_s, float temp_K, MethodFormulation formulation) {
+void SatVaporPres_fromTemp(const std::vector<float> &temp_K, std::vector<float> &e_sub_s,
+                           MethodFormulation formulation) {
+  const float missingValueFloat = util::missingValue(1.0f);
   const float t0c = static_cast<float>(ufo::Constants::t0c);
 
+  switch (formulation) {
+    case formulas::MethodFormulation::UKMO:
+    case formulas::MethodFormulation::Sonntag:
+      // As in the scalar version, missing temperatures produce zero.
+      applyToNonMissing(temp_K, e_sub_s, SatVaporPresSonntag(), t0c, 0.0f);
+      break;
+    case formulas::MethodFormulation::Walko:
+      applyToNonMissing(temp_K, e_sub_s, SatVaporPresWalko(), t0c, missingValueFloat);
+      break;
+    case formulas::MethodFormulation::Murphy:
+      applyToNonMissing(temp_K, e_sub_s, SatVaporPresMurphy(), t0c, missingValueFloat);
+      break;
+    case formulas::MethodFormulation::NCAR:
+    case formulas::MethodFormulation::NOAA:
+    case formulas::MethodFormulation::Rogers:
+    default:
+      applyToNonMissing(temp_K, e_sub_s, SatVaporPresRogers(), t0c, missingValueFloat);
+      break;
+  }
+}
+
+/* -------------------------------------------------------------------------------------*/
+float SatVaporPres_correction(float e_sub_s, float temp_K, MethodFormulation formulation) {
   switch (formulation) {
     case formulas::MethodFormulation::NCAR:
     case formulas::MethodFormulation::NOAA:
     case formulas::MethodFormulation::UKMO:
     case formulas::MethodFormulation::Sonntag: {
-      /* e_sub_s above is the saturation vapour pressure of pure water vapour
-         FsubW (~ 1.005 at 1000 hPa) is the enhancement factor needed for moist
-          air (eg eqns 20, 22 of Sonntag, but for consistency with QSAT the formula
-          below is from eqn A4.6 of Adrian Gill's book)
-      */
-      float FsubW;  // Enhancement factor
-      FsubW = 1.0f - 1.0E-8f *
-          (4.5f + 6.0E-4f * (temp_K - t0c) *(temp_K - t0c));
-      e_sub_s = e_sub_s * FsubW;
+      e_sub_s = SatVaporPresCorrectionSonntag()(e_sub_s, temp_K);
       break;
     }
     default: {
@@ -124,6 +244,38 @@ float SatVaporPres_correction(float e_sub_s, float temp_K, MethodFormulation for
 }
 /* -------------------------------------------------------------------------------------*/
 
+void SatVaporPres_correction(std::vector<float> &e_sub_s, const std::vector<float> &temp_K,
+                             MethodFormulation formulation) {
+  ASSERT(e_sub_s.size() == temp_K.size());
+  const float missing = util::missingValue(missing);
+  const size_t n = e_sub_s.size();
+
+  switch (formulation) {
+    case formulas::MethodFormulation::NCAR:
+    case formulas::MethodFormulation::NOAA:
+    case formulas::MethodFormulation::UKMO:
+    case formulas::MethodFormulation::Sonntag: {
+      // As in applyToNonMissing(), harmless inputs replace missing ones so that the loop has no
+      // branches and raises no floating-point exceptions.
+      const float t0c = static_cast<float>(ufo::Constants::t0c);
+      for (size_t i = 0; i < n; ++i) {
+        const bool valid = e_sub_s[i] != missing && temp_K[i] != missing;
+        const float corrected = SatVaporPresCorrectionSonntag()(valid ? e_sub_s[i] : 0.0f,
+                                                                valid ? temp_K[i] : t0c);
+        e_sub_s[i] = valid ? corrected : missing;
+      }
+      break;
+    }
+    default: {
+      std::string errString = "Aborting, no method matches enum formulas::MethodFormulation";
+      oops::Log::error() << errString;
+      throw eckit::BadValue(errString);
+    }
+  }
+}
+
+/* -------------------------------------------------------------------------------------*/
+
 float Qsat_From_Psat(float Psat, float P, MethodFormulation formulation) {
   float QSat = util::missingValue(1.0f);  // Saturated specific humidity or
                                           // saturated vapour pressure (if P<0)
@@ -192,42 +344,32 @@ float Height_To_Pressure_ICAO_atmos(float height, MethodFormulation formulation)
     case formulas::MethodFormulation::NOAA:
     case formulas::MethodFormulation::UKMO:
     default: {
-      float RepT_Bot, RepT_Top, ZP1, ZP2;
-
-      RepT_Bot = 1.0 / Constants::icao_temp_surface;
-      RepT_Top = 1.0 / Constants::icao_temp_isothermal_layer;
-      ZP1 = Constants::g_over_rd / Constants::icao_lapse_rate_l;
-      ZP2 = Constants::g_over_rd / Constants::icao_lapse_rate_u;
-
-      if (height <= missingValueFloat) {
-        Pressure = missingValueFloat;
-      } else if (height < -5000.0) {
-        // TODO(david simonin): The original code has this test.
-        // Not sure why! Are we expecting very negative height value??
-        Pressure = missingValueFloat;
-      } else if (height < Constants::icao_height_l) {
-        // Heights up to 11,000 geopotential heigh in meter [gpm]
-        Pressure = Constants::icao_lapse_rate_l * height * RepT_Bot;
-        Pressure = std::pow((1.0 - Pressure), ZP1);
-        Pressure = 100.0 * Pressure * Constants::icao_pressure_surface;
-      } else if (height < Constants::icao_height_u) {
-        // Heights between 11,000 and 20,000 geopotential heigh in meter [gpm]
-        Pressure = Constants::g_over_rd * (height - Constants::icao_height_l) * RepT_Top;
-        Pressure = std::log(Constants::icao_pressure_l) - Pressure;
-        Pressure = 100.0 * std::exp(Pressure);
-      } else {
-        // Heights above 20,000 geopotential heigh in meter [gpm]
-        Pressure = Constants::icao_lapse_rate_u * RepT_Top *
-                   (height - Constants::icao_height_u);
-        Pressure = 100.0 * Constants::icao_pressure_u *
-                   std::pow((1.0 - Pressure), ZP2);
-      }
+      Pressure = PressureFromHeightICAO()(height);
       break;
     }
   }
   return Pressure;
 }
 
+void Height_To_Pressure_ICAO_atmos(const std::vector<float> &height,
+                                   std::vector<float> &pressure,
+                                   MethodFormulation formulation) {
+  pressure.resize(height.size());
+
+  switch (formulation) {
+    case formulas::MethodFormulation::NCAR:
+    case formulas::MethodFormulation::NOAA:
+    case formulas::MethodFormulation::UKMO:
+    default: {
+      // The formula differs between atmospheric layers, so the loop is not branch-free; the
+      // formulation is nonetheless resolved only once.
+      const PressureFromHeightICAO kernel;
+      std::transform(height.begin(), height.end(), pressure.begin(), kernel);
+      break;
+    }
+  }
+}
+
 float GetWindDirection(float u, float v) {
   const float missing = util::missingValue(1.0f);
   float windDirection = missing;  // wind direction
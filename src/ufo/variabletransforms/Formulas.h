@@ -69,6 +69,22 @@ MethodFormulation resolveFormulations(const std::string& input, const std::strin
 float SatVaporPres_fromTemp(const float temp_K,
                    const MethodFormulation formulation = formulas::MethodFormulation::DEFAULT);
 
+/*!
+* \brief Calculates saturated vapour pressure from each element of an array of temperatures
+*
+* The formulation is resolved once for the whole array. The result for each non-missing
+* temperature is identical to that of the scalar function. Missing temperatures produce 0 with
+* the UKMO and Sonntag formulations, as in the scalar function, and missing values with the
+* others (for which the scalar function does not check for missing temperatures).
+*
+* \param temp_K
+*     Temperatures [k]
+* \param[out] e_sub_s
+*     Saturated vapour pressures; resized to match \p temp_K
+*/
+void SatVaporPres_fromTemp(const std::vector<float> &temp_K, std::vector<float> &e_sub_s,
+                   const MethodFormulation formulation = formulas::MethodFormulation::DEFAULT);
+
 
 // -------------------------------------------------------------------------------------
 /*!
@@ -93,6 +109,16 @@ float SatVaporPres_fromTemp(const float temp_K,
 */
 float SatVaporPres_correction(float e_sub_s, float temp_K,
                         const MethodFormulation formulation = formulas::MethodFormulation::DEFAULT);
+
+/*!
+* \brief Applies SatVaporPres_correction() in place to each element of \p e_sub_s
+*
+* Elements for which either \p e_sub_s or \p temp_K is missing are set to the missing value
+* (the scalar function does not check for missing inputs). The results for other elements are
+* identical to those of the scalar function. Both arrays must have the same size.
+*/
+void SatVaporPres_correction(std::vector<float> &e_sub_s, const std::vector<float> &temp_K,
+                        const MethodFormulation formulation = formulas::MethodFormulation::DEFAULT);
 // -------------------------------------------------------------------------------------
 /*!
 * \brief Calculates Saturated specific humidity or saturated vapour pressure using
@@ -179,6 +205,18 @@ float VirtualTemp_From_Rh_Psat_P_T(float Rh, float Psat, float P, float T,
 float Height_To_Pressure_ICAO_atmos(float Height,
                             MethodFormulation formulation = formulas::MethodFormulation::DEFAULT);
 
+/*!
+* \brief Converts each element of \p height to pressure using the ICAO atmosphere
+*
+* The results are identical to those of the scalar function, including for missing heights.
+*
+* \param[out] pressure
+*     Pressures; resized to match \p height
+*/
+void Height_To_Pressure_ICAO_atmos(const std::vector<float> &height,
+                                   std::vector<float> &pressure,
+                            MethodFormulation formulation = formulas::MethodFormulation::DEFAULT);
+
 // -------------------------------------------------------------------------------------
 /*!
 * \brief Converts u and v wind component into wind direction.
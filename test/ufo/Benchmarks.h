@@ -0,0 +1,598 @@
+/*
+ * (C) Crown copyright 2021 Met Office. All rights reserved.
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ */
+
+#ifndef TEST_UFO_BENCHMARKS_H_
+#define TEST_UFO_BENCHMARKS_H_
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "eckit/config/LocalConfiguration.h"
+#include "eckit/exception/Exceptions.h"
+#include "eckit/geometry/Point2.h"
+#include "eckit/mpi/Comm.h"
+#include "ioda/ObsDataVector.h"
+#include "ioda/ObsSpace.h"
+#include "ioda/ObsVector.h"
+#include "oops/mpi/mpi.h"
+#include "oops/runs/Application.h"
+#include "oops/util/DateTime.h"
+#include "oops/util/Logger.h"
+#include "oops/util/parameters/Parameter.h"
+#include "oops/util/parameters/Parameters.h"
+#include "oops/util/parameters/RequiredParameter.h"
+#include "ufo/filters/Gaussian_Thinning.h"
+#include "ufo/filters/MetOfficeBuddyCheck.h"
+#include "ufo/filters/ObsFilterData.h"
+#include "ufo/filters/PoissonDiskThinning.h"
+#include "ufo/filters/processWhere.h"
+#include "ufo/filters/TemporalThinning.h"
+#include "ufo/filters/Thinning.h"
+#include "ufo/filters/TrackCheck.h"
+#include "ufo/filters/TrackCheckShip.h"
+#include "ufo/GeoVaLs.h"
+#include "ufo/Locations.h"
+#include "ufo/ObsBias.h"
+#include "ufo/ObsBiasOperator.h"
+#include "ufo/ObsDiagnostics.h"
+#include "ufo/obslocalization/ObsLocalization.h"
+#include "ufo/utils/Constants.h"
+#include "ufo/utils/dataextractor/DataExtractor.h"
+#include "ufo/utils/VertInterp.interface.h"
+
+namespace ufo {
+namespace test {
+
+/// \brief Options of a single benchmark.
+class BenchmarkParameters : public oops::Parameters {
+  OOPS_CONCRETE_PARAMETERS(BenchmarkParameters, Parameters)
+
+ public:
+  /// Name of the benchmark; see the documentation of the Benchmarks class for the list of
+  /// supported names.
+  oops::RequiredParameter<std::string> name{"name", this};
+
+  /// Options of the benchmarked component, e.g. the parameters of the filter being timed.
+  oops::Parameter<eckit::LocalConfiguration> options{"options", eckit::LocalConfiguration(),
+                                                     this};
+};
+
+/// \brief Options of the `ufo_benchmarks` application.
+class BenchmarksParameters : public oops::Parameters {
+  OOPS_CONCRETE_PARAMETERS(BenchmarksParameters, Parameters)
+
+ public:
+  oops::RequiredParameter<util::DateTime> windowBegin{"window begin", this};
+  oops::RequiredParameter<util::DateTime> windowEnd{"window end", this};
+
+  /// Options of the synthetic ObsSpaces. Their `generate` section is filled in automatically.
+  oops::RequiredParameter<eckit::LocalConfiguration> obsSpace{"obs space", this};
+
+  /// Numbers of locations of the synthetic ObsSpaces. Each benchmark is run for each size.
+  oops::RequiredParameter<std::vector<int>> sizes{"sizes", this};
+
+  /// Number of timed runs of each benchmark.
+  oops::Parameter<int> repetitions{"repetitions", 3, this};
+
+  /// Seed used to generate the synthetic observations.
+  oops::Parameter<int> randomSeed{"random seed", 1, this};
+
+  /// Mean number of observations taken by each synthetic station. Stations are boxes of equal
+  /// size in latitude and longitude, so observations taken by the same station are close.
+  oops::Parameter<int> locationsPerStation{"locations per station", 50, this};
+
+  /// Path to the JSON file to which results are written.
+  oops::Parameter<std::string> outputFile{"output file", "ufo_benchmarks.json", this};
+
+  oops::RequiredParameter<std::vector<BenchmarkParameters>> benchmarks{"benchmarks", this};
+};
+
+// -----------------------------------------------------------------------------
+
+namespace benchmarks {
+
+/// \brief Run \p body \p repetitions times, calling \p reset (untimed) before each run.
+///
+/// \returns The wall-clock time taken by each run on the slowest MPI rank.
+inline std::vector<double> timeRepetitions(const eckit::mpi::Comm &comm, int repetitions,
+                                           const std::function<void()> &reset,
+                                           const std::function<void()> &body) {
+  std::vector<double> seconds;
+  for (int rep = 0; rep < repetitions; ++rep) {
+    reset();
+    comm.barrier();
+    const auto start = std::chrono::steady_clock::now();
+    body();
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    double maxElapsed = elapsed.count();
+    comm.allReduceInPlace(maxElapsed, eckit::mpi::max());
+    seconds.push_back(maxElapsed);
+  }
+  return seconds;
+}
+
+/// \brief Create an ObsSpace with \p nlocs randomly placed locations and fill it with the
+/// variables used by the benchmarks.
+///
+/// The following variables are created in addition to those produced by the ioda generator:
+/// * `MetaData/air_pressure`: uniformly distributed between 100 and 1010 hPa,
+/// * `MetaData/station_id`: index of the latitude-longitude box containing the location,
+/// * `MetaData/category` and `MetaData/priority`: integers between 0 and 9,
+/// * `ObsValue`, `HofX` and `GrossErrorProbability` of each simulated variable.
+inline std::unique_ptr<ioda::ObsSpace> makeSyntheticObsSpace(const BenchmarksParameters &params,
+                                                             size_t nlocs) {
+  eckit::LocalConfiguration obsSpaceConf(params.obsSpace.value());
+  const size_t nvars = obsSpaceConf.getStringVector("simulated variables").size();
+
+  eckit::LocalConfiguration randomConf;
+  randomConf.set("nobs", static_cast<int>(nlocs));
+  randomConf.set("lat1", -90.0);
+  randomConf.set("lat2", 90.0);
+  randomConf.set("lon1", -180.0);
+  randomConf.set("lon2", 180.0);
+  randomConf.set("random seed", params.randomSeed.value());
+  eckit::LocalConfiguration generateConf;
+  generateConf.set("random", randomConf);
+  generateConf.set("obs errors", std::vector<double>(nvars, 1.0));
+  obsSpaceConf.set("generate", generateConf);
+
+  std::unique_ptr<ioda::ObsSpace> obsspace(new ioda::ObsSpace(
+      obsSpaceConf, oops::mpi::world(), params.windowBegin, params.windowEnd,
+      oops::mpi::myself()));
+
+  const size_t n = obsspace->nlocs();
+  std::vector<float> lats(n), lons(n);
+  obsspace->get_db("MetaData", "latitude", lats);
+  obsspace->get_db("MetaData", "longitude", lons);
+
+  std::mt19937 generator(params.randomSeed.value() + obsspace->comm().rank());
+  std::uniform_real_distribution<float> pressureDistribution(10000.0f, 101000.0f);
+  std::uniform_int_distribution<int> digitDistribution(0, 9);
+  std::normal_distribution<float> valueDistribution(280.0f, 10.0f);
+  std::normal_distribution<float> departureDistribution(0.0f, 1.0f);
+
+  const double boxSize = std::min(180.0, std::sqrt(360.0 * 180.0 *
+                                                   params.locationsPerStation.value() / nlocs));
+  const int numLonBoxes = static_cast<int>(std::ceil(360.0 / boxSize));
+
+  std::vector<float> pressures(n);
+  std::vector<int> stationIds(n), categories(n), priorities(n);
+  for (size_t loc = 0; loc < n; ++loc) {
+    pressures[loc] = pressureDistribution(generator);
+    const double lon = std::fmod(std::fmod(lons[loc] + 180.0, 360.0) + 360.0, 360.0);
+    const int latBox = static_cast<int>((std::min(lats[loc], 89.999f) + 90.0) / boxSize);
+    const int lonBox = static_cast<int>(lon / boxSize);
+    stationIds[loc] = latBox * numLonBoxes + lonBox;
+    categories[loc] = digitDistribution(generator);
+    priorities[loc] = digitDistribution(generator);
+  }
+  obsspace->put_db("MetaData", "air_pressure", pressures);
+  obsspace->put_db("MetaData", "station_id", stationIds);
+  obsspace->put_db("MetaData", "category", categories);
+  obsspace->put_db("MetaData", "priority", priorities);
+
+  const oops::Variables &vars = obsspace->obsvariables();
+  for (size_t jvar = 0; jvar < vars.size(); ++jvar) {
+    std::vector<float> obsValues(n), hofx(n);
+    for (size_t loc = 0; loc < n; ++loc) {
+      obsValues[loc] = valueDistribution(generator);
+      hofx[loc] = obsValues[loc] + departureDistribution(generator);
+    }
+    obsspace->put_db("ObsValue", vars[jvar], obsValues);
+    obsspace->put_db("HofX", vars[jvar], hofx);
+    obsspace->put_db("GrossErrorProbability", vars[jvar], std::vector<float>(n, 0.05f));
+  }
+
+  return obsspace;
+}
+
+inline Locations makeLocations(const ioda::ObsSpace &obsspace) {
+  std::vector<float> lons(obsspace.nlocs()), lats(obsspace.nlocs());
+  std::vector<util::DateTime> times(obsspace.nlocs());
+  obsspace.get_db("MetaData", "latitude", lats);
+  obsspace.get_db("MetaData", "longitude", lons);
+  obsspace.get_db("MetaData", "datetime", times);
+  return Locations(lons, lats, times, obsspace.distribution());
+}
+
+/// \brief Fill each level of each variable in \p geovals with the pressures (for air_pressure)
+/// or values (for other variables) of a profile spanning 10 to 1050 hPa.
+inline void fillGeoVaLs(const GeoVaLs &geovals, const oops::Variables &vars) {
+  for (size_t jvar = 0; jvar < vars.size(); ++jvar) {
+    const size_t nlevs = geovals.nlevs(vars[jvar]);
+    for (size_t lev = 0; lev < nlevs; ++lev) {
+      const double pressure = 1000.0 + lev * (105000.0 - 1000.0) / (nlevs - 1);
+      const double value = vars[jvar] == "air_pressure" ? pressure : 200.0 + pressure / 1000.0;
+      geovals.put(std::vector<double>(geovals.nlocs(), value), vars[jvar], lev);
+    }
+  }
+}
+
+// -----------------------------------------------------------------------------
+
+/// \brief Options of the `process where` benchmark.
+class WhereOptions : public oops::Parameters {
+  OOPS_CONCRETE_PARAMETERS(WhereOptions, Parameters)
+
+ public:
+  oops::Parameter<std::vector<WhereParameters>> where{"where", {}, this};
+};
+
+/// \brief Time processWhere() with the `where` clauses given in \p options.
+inline std::vector<double> benchmarkProcessWhere(ioda::ObsSpace &obsspace,
+                                                 const eckit::LocalConfiguration &options,
+                                                 int repetitions) {
+  WhereOptions whereOptions;
+  whereOptions.validateAndDeserialize(options);
+
+  const ObsFilterData data(obsspace);
+  size_t numSelected = 0;
+  const std::vector<double> seconds = timeRepetitions(
+        obsspace.comm(), repetitions, [] {},
+        [&] {
+          const std::vector<bool> apply = processWhere(whereOptions.where, data);
+          numSelected = std::count(apply.begin(), apply.end(), true);
+        });
+  oops::Log::info() << "processWhere selected " << numSelected << " locations" << std::endl;
+  return seconds;
+}
+
+/// \brief Time the application of the filter of type \p FilterT configured with \p options.
+///
+/// QC flags are reset and a new filter is constructed (untimed) before each run, so that state
+/// kept by the filter object does not carry over from one run to the next. Caches attached to the
+/// ObsSpace do; the first run is therefore reported separately. The filter is run in whichever
+/// stage it requests (pre- or post-processing); in the latter case H(x) and the background
+/// errors are taken from the synthetic ObsSpace.
+template <typename FilterT>
+std::vector<double> benchmarkFilter(ioda::ObsSpace &obsspace,
+                                    const eckit::LocalConfiguration &options,
+                                    int repetitions) {
+  typename FilterT::Parameters_ filterParameters;
+  filterParameters.validateAndDeserialize(options);
+
+  std::shared_ptr<ioda::ObsDataVector<float>> obserr(new ioda::ObsDataVector<float>(
+      obsspace, obsspace.obsvariables(), "ObsError"));
+  std::shared_ptr<ioda::ObsDataVector<int>> qcflags(new ioda::ObsDataVector<int>(
+      obsspace, obsspace.obsvariables()));
+  std::unique_ptr<FilterT> filter;
+  const ioda::ObsDataVector<float> initialObserr(*obserr);
+
+  const ioda::ObsVector hofx(obsspace, "HofX");
+  const oops::Variables &vars = obsspace.obsvariables();
+  oops::Variables diagVars;
+  for (size_t jvar = 0; jvar < vars.size(); ++jvar)
+    diagVars.push_back(vars[jvar] + "_background_error");
+  ObsDiagnostics diags(obsspace, makeLocations(obsspace), diagVars);
+  diags.allocate(1, diagVars);
+  for (size_t jvar = 0; jvar < diagVars.size(); ++jvar)
+    diags.save(std::vector<double>(obsspace.nlocs(), 1.0), diagVars[jvar], 1);
+
+  return timeRepetitions(
+        obsspace.comm(), repetitions,
+        [&] {
+          for (size_t jvar = 0; jvar < qcflags->nvars(); ++jvar)
+            std::fill((*qcflags)[jvar].begin(), (*qcflags)[jvar].end(), QCflags::pass);
+          *obserr = initialObserr;
+          filter.reset(new FilterT(obsspace, filterParameters, qcflags, obserr));
+        },
+        [&] {
+          filter->preProcess();
+          filter->postFilter(hofx, diags);
+        });
+}
+
+/// \brief Time DataExtractor lookups of a value tabulated as a function of the station ID
+/// (exact match) and pressure (linear interpolation) at every location.
+///
+/// Supported options:
+/// * `levels`: number of pressure levels in the table (default: 50),
+/// * `file`: path to the CSV file holding the table, created by the benchmark
+///   (default: `ufo_benchmarks_extractor.csv`).
+inline std::vector<double> benchmarkDataExtractor(ioda::ObsSpace &obsspace,
+                                                  const eckit::LocalConfiguration &options,
+                                                  int repetitions) {
+  const int nlevs = options.getInt("levels", 50);
+  const std::string fileName = options.getString("file", "ufo_benchmarks_extractor.csv");
+
+  std::vector<int> stationIds(obsspace.nlocs());
+  std::vector<float> pressures(obsspace.nlocs());
+  obsspace.get_db("MetaData", "station_id", stationIds);
+  obsspace.get_db("MetaData", "air_pressure", pressures);
+  int maxStationId = stationIds.empty() ? 0 :
+                     *std::max_element(stationIds.begin(), stationIds.end());
+  obsspace.comm().allReduceInPlace(maxStationId, eckit::mpi::max());
+
+  if (obsspace.comm().rank() == 0) {
+    std::ofstream os(fileName);
+    if (!os)
+      throw eckit::UserError("Unable to open the file '" + fileName + "'", Here());
+    os << "station_id@MetaData,air_pressure@MetaData,air_temperature@ObsBias\n"
+       << "int,float,float\n";
+    for (int station = 0; station <= maxStationId; ++station)
+      for (int lev = 0; lev < nlevs; ++lev)
+        os << station << "," << 1000.0 + lev * (105000.0 - 1000.0) / (nlevs - 1) << ","
+           << 0.01 * lev << "\n";
+  }
+  obsspace.comm().barrier();
+
+  DataExtractor extractor(fileName, "ObsBias");
+  extractor.scheduleSort("station_id@MetaData", InterpMethod::EXACT);
+  extractor.scheduleSort("air_pressure@MetaData", InterpMethod::LINEAR);
+  extractor.sort();
+
+  std::vector<float> result(obsspace.nlocs());
+  return timeRepetitions(
+        obsspace.comm(), repetitions, [] {},
+        [&] {
+          for (size_t loc = 0; loc < obsspace.nlocs(); ++loc) {
+            extractor.extract(stationIds[loc]);
+            extractor.extract(pressures[loc]);
+            result[loc] = extractor.getResult();
+          }
+        });
+}
+
+/// \brief Model traits used to instantiate ObsLocalization outside a model interface: the
+/// geometry iterator only needs to dereference to the longitude and latitude of a point.
+struct BenchmarkModelTraits {
+  class GeometryIterator {
+   public:
+    explicit GeometryIterator(const eckit::geometry::Point2 &point) : point_(point) {}
+    eckit::geometry::Point2 operator*() const {return point_;}
+
+   private:
+    eckit::geometry::Point2 point_;
+  };
+};
+
+/// \brief Time ObsLocalization queries centred at points of a Fibonacci lattice.
+///
+/// Supported options: those of ObsLocalization (`lengthscale`, `search method` etc.) and
+/// `reference points` (number of queries per run; default: 1000). The ObsSpace must use the
+/// `InefficientDistribution` or `Halo` distribution.
+inline std::vector<double> benchmarkObsLocalization(ioda::ObsSpace &obsspace,
+                                                    const eckit::LocalConfiguration &options,
+                                                    int repetitions) {
+  const int numPoints = options.getInt("reference points", 1000);
+  const ObsLocalization<BenchmarkModelTraits> localization(options, obsspace);
+  std::vector<BenchmarkModelTraits::GeometryIterator> points;
+  const double goldenAngle = 180.0 * (3.0 - std::sqrt(5.0));
+  for (int i = 0; i < numPoints; ++i) {
+    const double lat = std::asin(-1.0 + (2.0 * i + 1.0) / numPoints) * Constants::rad2deg;
+    const double lon = std::fmod(i * goldenAngle, 360.0) - 180.0;
+    points.emplace_back(eckit::geometry::Point2(lon, lat));
+  }
+
+  ioda::ObsDataVector<int> outside(obsspace, obsspace.obsvariables());
+  ioda::ObsVector locvector(obsspace);
+  size_t numLocal = 0;
+  const std::vector<double> seconds = timeRepetitions(
+        obsspace.comm(), repetitions, [&] { numLocal = 0; },
+        [&] {
+          for (const BenchmarkModelTraits::GeometryIterator &point : points) {
+            localization.computeLocalization(point, outside, locvector);
+            numLocal += localization.localobs().size();
+          }
+        });
+  oops::Log::info() << "ObsLocalization found " << numLocal << " local observations"
+                    << std::endl;
+  return seconds;
+}
+
+/// \brief Time GeoVaLs::put() and GeoVaLs::get() calls writing and reading every level of
+/// `air_temperature` and `specific_humidity`.
+///
+/// Supported options: `levels` (default: 70).
+inline std::vector<double> benchmarkGeoVaLs(ioda::ObsSpace &obsspace,
+                                            const eckit::LocalConfiguration &options,
+                                            int repetitions) {
+  const int nlevs = options.getInt("levels", 70);
+  const oops::Variables vars({"air_temperature", "specific_humidity"});
+  GeoVaLs geovals(makeLocations(obsspace), vars);
+  geovals.allocate(nlevs, vars);
+
+  std::vector<double> values(obsspace.nlocs(), 1.0);
+  return timeRepetitions(
+        obsspace.comm(), repetitions, [] {},
+        [&] {
+          for (size_t jvar = 0; jvar < vars.size(); ++jvar)
+            for (int lev = 0; lev < nlevs; ++lev)
+              geovals.put(values, vars[jvar], lev);
+          for (size_t jvar = 0; jvar < vars.size(); ++jvar)
+            for (int lev = 0; lev < nlevs; ++lev)
+              geovals.get(values, vars[jvar], lev);
+        });
+}
+
+/// \brief Time the vertical interpolation of `air_temperature` GeoVaLs to the observation
+/// pressures, done in the same way as in the ObsAtmVertInterp operator.
+///
+/// Supported options: `levels` (default: 70).
+inline std::vector<double> benchmarkVerticalInterpolation(ioda::ObsSpace &obsspace,
+                                                          const eckit::LocalConfiguration &options,
+                                                          int repetitions) {
+  const int nlevs = options.getInt("levels", 70);
+  const oops::Variables vars({"air_pressure", "air_temperature"});
+  GeoVaLs geovals(makeLocations(obsspace), vars);
+  geovals.allocate(nlevs, vars);
+  fillGeoVaLs(geovals, vars);
+
+  std::vector<float> obsPressures(obsspace.nlocs());
+  obsspace.get_db("MetaData", "air_pressure", obsPressures);
+
+  std::vector<double> pressureProfile(nlevs), temperatureProfile(nlevs);
+  std::vector<double> result(obsspace.nlocs());
+  return timeRepetitions(
+        obsspace.comm(), repetitions, [] {},
+        [&] {
+          for (size_t loc = 0; loc < obsspace.nlocs(); ++loc) {
+            geovals.getAtLocation(pressureProfile, "air_pressure", loc);
+            geovals.getAtLocation(temperatureProfile, "air_temperature", loc);
+            const double obsPressure = obsPressures[loc];
+            int wi;
+            double wf;
+            vert_interp_weights_f90(nlevs, obsPressure, pressureProfile.data(), wi, wf);
+            vert_interp_apply_f90(nlevs, temperatureProfile.data(), result[loc], wi, wf);
+          }
+        });
+}
+
+/// \brief Time ObsBiasOperator::computeObsBias() with the bias model configured in \p options
+/// (an `obs bias` section). GeoVaLs required by the predictors have 70 levels.
+inline std::vector<double> benchmarkBiasCorrection(ioda::ObsSpace &obsspace,
+                                                   const eckit::LocalConfiguration &options,
+                                                   int repetitions) {
+  ObsBiasParameters biasParameters;
+  biasParameters.validateAndDeserialize(options);
+  const ObsBias bias(obsspace, biasParameters);
+
+  const Locations locations = makeLocations(obsspace);
+  GeoVaLs geovals(locations, bias.requiredVars());
+  geovals.allocate(70, bias.requiredVars());
+  fillGeoVaLs(geovals, bias.requiredVars());
+  ObsDiagnostics diags(obsspace, locations, bias.requiredHdiagnostics());
+
+  const ObsBiasOperator biasOperator(obsspace);
+  ioda::ObsVector ybias(obsspace);
+  return timeRepetitions(
+        obsspace.comm(), repetitions, [] {},
+        [&] { biasOperator.computeObsBias(geovals, ybias, bias, diags); });
+}
+
+// -----------------------------------------------------------------------------
+
+struct BenchmarkResult {
+  std::string name;
+  size_t locations;
+  std::vector<double> seconds;
+};
+
+inline void writeJson(std::ostream &os, size_t numRanks,
+                      const std::vector<BenchmarkResult> &results) {
+  os << std::setprecision(12)
+     << "{\n"
+     << "  \"number of ranks\": " << numRanks << ",\n"
+     << "  \"benchmarks\": [";
+  for (size_t i = 0; i < results.size(); ++i) {
+    const BenchmarkResult &result = results[i];
+    double sum = 0.0;
+    for (double seconds : result.seconds)
+      sum += seconds;
+    const double mean = result.seconds.empty() ? 0.0 : sum / result.seconds.size();
+    const double min = result.seconds.empty() ? 0.0 :
+                       *std::min_element(result.seconds.begin(), result.seconds.end());
+    const double max = result.seconds.empty() ? 0.0 :
+                       *std::max_element(result.seconds.begin(), result.seconds.end());
+    os << (i == 0 ? "\n" : ",\n")
+       << "    {\n"
+       << "      \"name\": \"" << result.name << "\",\n"
+       << "      \"locations\": " << result.locations << ",\n"
+       << "      \"repetitions\": " << result.seconds.size() << ",\n"
+       << "      \"seconds\": {\"min\": " << min << ", \"max\": " << max
+       << ", \"mean\": " << mean << "},\n"
+       << "      \"first run seconds\": "
+       << (result.seconds.empty() ? 0.0 : result.seconds.front()) << ",\n"
+       << "      \"locations per second\": " << (min > 0.0 ? result.locations / min : 0.0)
+       << "\n"
+       << "    }";
+  }
+  os << (results.empty() ? "]\n" : "\n  ]\n") << "}\n";
+}
+
+}  // namespace benchmarks
+
+// -----------------------------------------------------------------------------
+
+/// \brief Times key UFO components on synthetic ObsSpaces of configurable size and writes the
+/// results to a JSON file, so that performance can be compared between releases.
+///
+/// Supported benchmark names:
+/// * `process where` (options: a `where` list),
+/// * `Gaussian Thinning`, `Poisson Disk Thinning`, `Temporal Thinning`, `Thinning`,
+///   `Met Office Buddy Check`, `Track Check` and `Ship Track Check` (options: filter parameters),
+/// * `DataExtractor`, `ObsLocalization`, `GeoVaLs`, `vertical interpolation` and
+///   `bias correction` (see the documentation of the corresponding functions in the
+///   ufo::test::benchmarks namespace).
+///
+/// For each size, the timings reported are those of the slowest MPI rank in each repetition.
+/// Each benchmark gets a new ObsSpace, so its first run is done with cold caches; the time it
+/// took is reported separately in addition to the statistics over all runs.
+class Benchmarks : public oops::Application {
+ public:
+  explicit Benchmarks(const eckit::mpi::Comm &comm = oops::mpi::world()) : Application(comm) {}
+
+  int execute(const eckit::Configuration &config) const override {
+    BenchmarksParameters params;
+    params.validateAndDeserialize(config);
+    if (params.repetitions.value() < 1)
+      throw eckit::UserError("The number of repetitions must be positive", Here());
+
+    typedef std::function<std::vector<double>(ioda::ObsSpace &,
+                                              const eckit::LocalConfiguration &, int)> Benchmark;
+    const std::map<std::string, Benchmark> available{
+      {"process where", benchmarks::benchmarkProcessWhere},
+      {"Gaussian Thinning", benchmarks::benchmarkFilter<Gaussian_Thinning>},
+      {"Poisson Disk Thinning", benchmarks::benchmarkFilter<PoissonDiskThinning>},
+      {"Temporal Thinning", benchmarks::benchmarkFilter<TemporalThinning>},
+      {"Thinning", benchmarks::benchmarkFilter<Thinning>},
+      {"Met Office Buddy Check", benchmarks::benchmarkFilter<MetOfficeBuddyCheck>},
+      {"Track Check", benchmarks::benchmarkFilter<TrackCheck>},
+      {"Ship Track Check", benchmarks::benchmarkFilter<TrackCheckShip>},
+      {"DataExtractor", benchmarks::benchmarkDataExtractor},
+      {"ObsLocalization", benchmarks::benchmarkObsLocalization},
+      {"GeoVaLs", benchmarks::benchmarkGeoVaLs},
+      {"vertical interpolation", benchmarks::benchmarkVerticalInterpolation},
+      {"bias correction", benchmarks::benchmarkBiasCorrection}
+    };
+    for (const BenchmarkParameters &benchmark : params.benchmarks.value())
+      if (available.find(benchmark.name) == available.end())
+        throw eckit::UserError("Unknown benchmark: '" + benchmark.name.value() + "'", Here());
+
+    std::vector<benchmarks::BenchmarkResult> results;
+    for (int size : params.sizes.value()) {
+      for (const BenchmarkParameters &benchmark : params.benchmarks.value()) {
+        const std::unique_ptr<ioda::ObsSpace> obsspace =
+            benchmarks::makeSyntheticObsSpace(params, size);
+        const std::vector<double> seconds = available.at(benchmark.name)(
+              *obsspace, benchmark.options, params.repetitions);
+        oops::Log::info() << "Benchmark '" << benchmark.name.value() << "', " << size
+                          << " locations: " << *std::min_element(seconds.begin(), seconds.end())
+                          << " s (best of " << seconds.size() << "), first run: "
+                          << seconds.front() << " s" << std::endl;
+        results.push_back({benchmark.name, static_cast<size_t>(size), seconds});
+      }
+    }
+
+    if (getComm().rank() == 0) {
+      std::ofstream os(params.outputFile.value());
+      if (!os)
+        throw eckit::UserError("Unable to open the file '" + params.outputFile.value() + "'",
+                               Here());
+      benchmarks::writeJson(os, getComm().size(), results);
+    }
+    return 0;
+  }
+
+ private:
+  std::string appname() const override {
+    return "ufo::test::Benchmarks";
+  }
+};
+
+}  // namespace test
+}  // namespace ufo
+
+#endif  // TEST_UFO_BENCHMARKS_H_
@@ -0,0 +1,65 @@
+/*
+ * (C) Crown copyright 2021 Met Office. All rights reserved.
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ */
+
+#ifndef TEST_UFO_DICTIONARYENCODEDSTRINGS_H_
+#define TEST_UFO_DICTIONARYENCODEDSTRINGS_H_
+
+#include <string>
+#include <vector>
+
+#include "eckit/testing/Test.h"
+#include "oops/runs/Test.h"
+#include "oops/util/Expect.h"
+#include "ufo/utils/DictionaryEncodedStrings.h"
+
+namespace ufo {
+namespace test {
+
+CASE("ufo/DictionaryEncodedStrings/Empty") {
+  const ufo::DictionaryEncodedStrings strings(std::vector<std::string>{});
+  EXPECT_EQUAL(strings.size(), 0);
+  EXPECT(strings.codes().empty());
+  EXPECT(strings.dictionary().empty());
+  EXPECT_EQUAL(strings.code("ABC"), -1);
+}
+
+CASE("ufo/DictionaryEncodedStrings/Nonempty") {
+  const std::vector<std::string> values{"def", "abc", "ghi", "abc", "def", "abc"};
+  const ufo::DictionaryEncodedStrings strings(values);
+
+  EXPECT_EQUAL(strings.size(), values.size());
+  EXPECT_EQUAL(strings.dictionary(), (std::vector<std::string>{"abc", "def", "ghi"}));
+  EXPECT_EQUAL(strings.codes(), (std::vector<int>{1, 0, 2, 0, 1, 0}));
+  for (size_t i = 0; i < values.size(); ++i)
+    EXPECT_EQUAL(strings[i], values[i]);
+  EXPECT_EQUAL(strings.decode(), values);
+
+  EXPECT_EQUAL(strings.code("abc"), 0);
+  EXPECT_EQUAL(strings.code("ghi"), 2);
+  EXPECT_EQUAL(strings.code("bcd"), -1);
+  EXPECT_EQUAL(strings.code("xyz"), -1);
+
+  // Copies share the dictionary.
+  const ufo::DictionaryEncodedStrings copy = strings;
+  EXPECT(&copy.dictionary() == &strings.dictionary());
+}
+
+class DictionaryEncodedStrings : public oops::Test {
+ public:
+  DictionaryEncodedStrings() {}
+
+ private:
+  std::string testid() const override {return "ufo::test::DictionaryEncodedStrings";}
+
+  void register_tests() const override {}
+
+  void clear() const override {}
+};
+
+}  // namespace test
+}  // namespace ufo
+
+#endif  // TEST_UFO_DICTIONARYENCODEDSTRINGS_H_
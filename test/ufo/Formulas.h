@@ -0,0 +1,126 @@
+/*
+ * (C) Crown copyright 2021 Met Office. All rights reserved.
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ */
+
+#ifndef TEST_UFO_FORMULAS_H_
+#define TEST_UFO_FORMULAS_H_
+
+#include <string>
+#include <vector>
+
+#include "eckit/testing/Test.h"
+#include "oops/runs/Test.h"
+#include "oops/util/Expect.h"
+#include "oops/util/missingValues.h"
+#include "ufo/variabletransforms/Formulas.h"
+
+namespace ufo {
+namespace test {
+
+using formulas::MethodFormulation;
+
+const std::vector<MethodFormulation> &allFormulations() {
+  static const std::vector<MethodFormulation> formulations{
+    MethodFormulation::UKMO, MethodFormulation::NCAR, MethodFormulation::NOAA,
+    MethodFormulation::DEFAULT, MethodFormulation::Murphy, MethodFormulation::Sonntag,
+    MethodFormulation::Walko, MethodFormulation::Rogers};
+  return formulations;
+}
+
+bool isSonntag(MethodFormulation formulation) {
+  return formulation == MethodFormulation::UKMO || formulation == MethodFormulation::Sonntag;
+}
+
+/// Temperatures [K] spanning the range of atmospheric values, including a missing value.
+std::vector<float> testTemperatures() {
+  std::vector<float> temperatures;
+  for (float t = 180.0f; t <= 320.0f; t += 2.5f)
+    temperatures.push_back(t);
+  temperatures.push_back(util::missingValue(1.0f));
+  temperatures.push_back(273.15f);
+  return temperatures;
+}
+
+CASE("ufo/Formulas/SatVaporPres_fromTemp") {
+  const float missing = util::missingValue(missing);
+  const std::vector<float> temperatures = testTemperatures();
+  for (MethodFormulation formulation : allFormulations()) {
+    std::vector<float> e_sub_s;
+    formulas::SatVaporPres_fromTemp(temperatures, e_sub_s, formulation);
+    EXPECT_EQUAL(e_sub_s.size(), temperatures.size());
+    for (size_t i = 0; i < temperatures.size(); ++i) {
+      if (temperatures[i] != missing || isSonntag(formulation)) {
+        EXPECT_EQUAL(e_sub_s[i], formulas::SatVaporPres_fromTemp(temperatures[i], formulation));
+      } else {
+        // The scalar version does not check for missing temperatures in these formulations
+        // (and may raise floating-point exceptions if given one).
+        EXPECT_EQUAL(e_sub_s[i], missing);
+      }
+    }
+  }
+}
+
+CASE("ufo/Formulas/SatVaporPres_correction") {
+  const float missing = util::missingValue(missing);
+  const std::vector<float> temperatures = testTemperatures();
+  for (MethodFormulation formulation : allFormulations()) {
+    std::vector<float> e_sub_s;
+    formulas::SatVaporPres_fromTemp(temperatures, e_sub_s, MethodFormulation::Walko);
+    e_sub_s[1] = missing;
+
+    if (formulation == MethodFormulation::DEFAULT || formulation == MethodFormulation::Murphy ||
+        formulation == MethodFormulation::Walko || formulation == MethodFormulation::Rogers) {
+      // These formulations are not supported.
+      EXPECT_THROWS(formulas::SatVaporPres_correction(e_sub_s, temperatures, formulation));
+      continue;
+    }
+
+    std::vector<float> corrected(e_sub_s);
+    formulas::SatVaporPres_correction(corrected, temperatures, formulation);
+    for (size_t i = 0; i < temperatures.size(); ++i) {
+      if (e_sub_s[i] != missing && temperatures[i] != missing)
+        EXPECT_EQUAL(corrected[i], formulas::SatVaporPres_correction(e_sub_s[i], temperatures[i],
+                                                                     formulation));
+      else
+        EXPECT_EQUAL(corrected[i], missing);
+    }
+  }
+
+  std::vector<float> tooShort(temperatures.size() - 1, 1000.0f);
+  EXPECT_THROWS(formulas::SatVaporPres_correction(tooShort, temperatures));
+}
+
+CASE("ufo/Formulas/Height_To_Pressure_ICAO_atmos") {
+  const float missing = util::missingValue(missing);
+  // Heights in each layer of the ICAO atmosphere, on the layer boundaries, below the lowest
+  // supported height and missing.
+  const std::vector<float> heights{missing, -6000.0f, -100.0f, 0.0f, 5000.0f, 11000.0f, 15000.0f,
+                                   20000.0f, 30000.0f};
+  for (MethodFormulation formulation : allFormulations()) {
+    std::vector<float> pressures;
+    formulas::Height_To_Pressure_ICAO_atmos(heights, pressures, formulation);
+    EXPECT_EQUAL(pressures.size(), heights.size());
+    for (size_t i = 0; i < heights.size(); ++i)
+      EXPECT_EQUAL(pressures[i], formulas::Height_To_Pressure_ICAO_atmos(heights[i], formulation));
+  }
+  std::vector<float> pressures;
+  formulas::Height_To_Pressure_ICAO_atmos(heights, pressures);
+  EXPECT_EQUAL(pressures[0], missing);
+  EXPECT_EQUAL(pressures[1], missing);
+}
+
+class Formulas : public oops::Test {
+ private:
+  std::string testid() const override {return "ufo::test::Formulas";}
+
+  void register_tests() const override {}
+
+  void clear() const override {}
+};
+
+}  // namespace test
+}  // namespace ufo
+
+#endif  // TEST_UFO_FORMULAS_H_
@@ -69,16 +69,33 @@ void testGaussianThinning(const eckit::LocalConfiguration &conf) {
   ufo::Gaussian_Thinning filter(obsspace, filterParameters, qcflags, obserr);
   filter.preProcess();
 
-  const std::vector<size_t> expectedThinnedObsIndices =
-      conf.getUnsignedVector("expected_thinned_obs_indices");
-  std::vector<size_t> thinnedObsIndices;
-  for (size_t i = 0; i < qcflags->nlocs(); ++i)
-    if ((*qcflags)[0][i] == ufo::QCflags::thinned)
-      thinnedObsIndices.push_back(i);
-  EXPECT_EQUAL(thinnedObsIndices.size(), expectedThinnedObsIndices.size());
-  const bool equal = std::equal(thinnedObsIndices.begin(), thinnedObsIndices.end(),
-                                expectedThinnedObsIndices.begin());
-  EXPECT(equal);
+  auto expectThinnedObsIndices = [&qcflags](const std::vector<size_t> &expectedThinnedObsIndices) {
+    std::vector<size_t> thinnedObsIndices;
+    for (size_t i = 0; i < qcflags->nlocs(); ++i)
+      if ((*qcflags)[0][i] == ufo::QCflags::thinned)
+        thinnedObsIndices.push_back(i);
+    EXPECT_EQUAL(thinnedObsIndices.size(), expectedThinnedObsIndices.size());
+    const bool equal = std::equal(thinnedObsIndices.begin(), thinnedObsIndices.end(),
+                                  expectedThinnedObsIndices.begin());
+    EXPECT(equal);
+  };
+
+  expectThinnedObsIndices(conf.getUnsignedVector("expected_thinned_obs_indices"));
+
+  if (conf.has("second pass")) {
+    // Simulate a subsequent outer loop: clear the thinning flags, reject some observations and
+    // apply a new instance of the filter (which should reuse the bins calculated previously).
+    const eckit::LocalConfiguration secondPassConf(conf, "second pass");
+    for (size_t i = 0; i < qcflags->nlocs(); ++i)
+      if ((*qcflags)[0][i] == ufo::QCflags::thinned)
+        (*qcflags)[0][i] = ufo::QCflags::pass;
+    for (size_t i : secondPassConf.getUnsignedVector("rejected_obs_indices"))
+      (*qcflags)[0][i] = ufo::QCflags::bounds;
+
+    ufo::Gaussian_Thinning secondFilter(obsspace, filterParameters, qcflags, obserr);
+    secondFilter.preProcess();
+    expectThinnedObsIndices(secondPassConf.getUnsignedVector("expected_thinned_obs_indices"));
+  }
 }
 
 class GaussianThinning : public oops::Test {
@@ -26,7 +26,9 @@
 
 namespace ufo {
 namespace test {
-void testHistoryCheck(const eckit::LocalConfiguration &conf) {
+/// Run the history check on the obs space described by \p conf and return the indices of the
+/// observations it rejects.
+std::vector<size_t> runHistoryCheck(const eckit::LocalConfiguration &conf) {
   util::DateTime bgn(conf.getString("window begin"));
   util::DateTime end(conf.getString("window end"));
 
@@ -60,12 +62,27 @@ void testHistoryCheck(const eckit::LocalConfiguration &conf) {
   ufo::HistoryCheck filter(obsspace, filterParameters, qcflags, obserr, conf);
   filter.preProcess();
 
-  const std::vector<size_t> expectedRejectedObsIndices =
-      conf.getUnsignedVector("expected rejected obs indices");
   std::vector<size_t> rejectedObsIndices;
   for (size_t i = 0; i < qcflags->nlocs(); ++i)
     if ((*qcflags)[0][i] == ufo::QCflags::history)
       rejectedObsIndices.push_back(i);
+  return rejectedObsIndices;
+}
+
+void testHistoryCheck(const eckit::LocalConfiguration &conf) {
+  // Used to test the incremental mode: run the filter on the previous cycle first,
+  // saving the history state to a file that is then read when processing the current cycle.
+  if (conf.has("previous cycle")) {
+    const eckit::LocalConfiguration previousCycleConf(conf, "previous cycle");
+    const std::vector<size_t> rejectedObsIndices = runHistoryCheck(previousCycleConf);
+    if (previousCycleConf.has("expected rejected obs indices"))
+      EXPECT_EQUAL(rejectedObsIndices,
+                   previousCycleConf.getUnsignedVector("expected rejected obs indices"));
+  }
+
+  const std::vector<size_t> expectedRejectedObsIndices =
+      conf.getUnsignedVector("expected rejected obs indices");
+  const std::vector<size_t> rejectedObsIndices = runHistoryCheck(conf);
   EXPECT_EQUAL(rejectedObsIndices, expectedRejectedObsIndices);
 }
 
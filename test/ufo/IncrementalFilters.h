@@ -0,0 +1,161 @@
+/*
+ * (C) Crown copyright 2021 Met Office. All rights reserved.
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ */
+
+#ifndef TEST_UFO_INCREMENTALFILTERS_H_
+#define TEST_UFO_INCREMENTALFILTERS_H_
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#define ECKIT_TESTING_SELF_REGISTER_CASES 0
+
+#include "eckit/config/LocalConfiguration.h"
+#include "eckit/testing/Test.h"
+#include "ioda/ObsDataVector.h"
+#include "ioda/ObsSpace.h"
+#include "oops/mpi/mpi.h"
+#include "oops/runs/Test.h"
+#include "oops/util/Expect.h"
+#include "test/TestEnvironment.h"
+#include "ufo/filters/Gaussian_Thinning.h"
+#include "ufo/filters/ObsBoundsCheck.h"
+#include "ufo/filters/QCflags.h"
+#include "ufo/filters/Thinning.h"
+#include "ufo/utils/Instrumentation.h"
+
+namespace ufo {
+namespace test {
+
+/// \brief Apply a filter of type FilterT, configured with \p filterConf, to \p obsspace both in
+/// the incremental mode and in the normal mode, and check that both flag the same observations.
+///
+/// \param rejectedObsIndices
+///   Indices of observations rejected before the filter is applied.
+///
+/// \returns The number of locations re-evaluated in the incremental mode.
+template <typename FilterT>
+size_t applyIncrementally(ioda::ObsSpace &obsspace, const eckit::LocalConfiguration &filterConf,
+                          const std::vector<size_t> &rejectedObsIndices) {
+  Instrumentation::instance().clear();
+  Instrumentation::instance().setEnabled(true);
+
+  std::map<bool, std::shared_ptr<ioda::ObsDataVector<int>>> qcflags;
+  for (bool incremental : {true, false}) {
+    qcflags[incremental].reset(new ioda::ObsDataVector<int>(obsspace, obsspace.obsvariables()));
+    std::shared_ptr<ioda::ObsDataVector<float>> obserr(new ioda::ObsDataVector<float>(
+        obsspace, obsspace.obsvariables(), "ObsError"));
+    for (size_t i : rejectedObsIndices)
+      (*qcflags[incremental])[0][i] = QCflags::bounds;
+
+    eckit::LocalConfiguration conf(filterConf);
+    conf.set("incremental", incremental);
+    typename FilterT::Parameters_ parameters;
+    parameters.validateAndDeserialize(conf);
+    FilterT filter(obsspace, parameters, qcflags[incremental], obserr);
+    filter.preProcess();
+  }
+
+  for (size_t i = 0; i < obsspace.nlocs(); ++i)
+    EXPECT_EQUAL((*qcflags[true])[0][i], (*qcflags[false])[0][i]);
+
+  double numReevaluated = 0;
+  for (const auto &keyAndRecord : Instrumentation::instance().records(obsspace.obsname())) {
+    const auto it = keyAndRecord.second.counters.find("re-evaluated locations");
+    if (it != keyAndRecord.second.counters.end())
+      numReevaluated += it->second;
+  }
+
+  Instrumentation::instance().setEnabled(false);
+  Instrumentation::instance().clear();
+  return numReevaluated;
+}
+
+void testIncrementalModeNotSupported(const eckit::LocalConfiguration &conf) {
+  util::DateTime bgn(conf.getString("window begin"));
+  util::DateTime end(conf.getString("window end"));
+  const eckit::LocalConfiguration obsSpaceConf(conf, "obs space");
+  ioda::ObsSpace obsspace(obsSpaceConf, oops::mpi::world(), bgn, end, oops::mpi::myself());
+
+  const eckit::LocalConfiguration boundsCheckConf(conf, "bounds check");
+  const eckit::LocalConfiguration randomThinningConf(conf, "random thinning");
+
+  // The bounds check is no more expensive than checking its inputs for changes.
+  EXPECT_THROWS_MSG(applyIncrementally<ObsBoundsCheck>(obsspace, boundsCheckConf, {}),
+                    "does not support the incremental mode");
+  // Random thinning may flag different observations each time.
+  EXPECT_THROWS_MSG(applyIncrementally<Thinning>(obsspace, randomThinningConf, {}),
+                    "does not support the incremental mode");
+  Instrumentation::instance().setEnabled(false);
+  Instrumentation::instance().clear();
+}
+
+void testIncrementalGaussianThinning(const eckit::LocalConfiguration &conf) {
+  util::DateTime bgn(conf.getString("window begin"));
+  util::DateTime end(conf.getString("window end"));
+  const eckit::LocalConfiguration obsSpaceConf(conf, "obs space");
+  ioda::ObsSpace obsspace(obsSpaceConf, oops::mpi::world(), bgn, end, oops::mpi::myself());
+  const eckit::LocalConfiguration filterConf(conf, "gaussian thinning");
+
+  EXPECT_EQUAL(applyIncrementally<Gaussian_Thinning>(obsspace, filterConf, {}), 6);
+  // Nothing has changed.
+  EXPECT_EQUAL(applyIncrementally<Gaussian_Thinning>(obsspace, filterConf, {}), 0);
+  // The filter should be rerun at all locations, even if only one of them has changed.
+  EXPECT_EQUAL(applyIncrementally<Gaussian_Thinning>(obsspace, filterConf, {0}), 6);
+}
+
+void testIncrementalGaussianThinningWithPriority(const eckit::LocalConfiguration &conf) {
+  util::DateTime bgn(conf.getString("window begin"));
+  util::DateTime end(conf.getString("window end"));
+  const eckit::LocalConfiguration obsSpaceConf(conf, "obs space");
+  const eckit::LocalConfiguration filterConf(conf, "gaussian thinning with priority");
+
+  std::vector<int> priorities{1, 2, 3, 4, 5, 6};
+  {
+    ioda::ObsSpace obsspace(obsSpaceConf, oops::mpi::world(), bgn, end, oops::mpi::myself());
+    obsspace.put_db("MetaData", "priority", priorities);
+    EXPECT_EQUAL(applyIncrementally<Gaussian_Thinning>(obsspace, filterConf, {}), 6);
+    EXPECT_EQUAL(applyIncrementally<Gaussian_Thinning>(obsspace, filterConf, {}), 0);
+    // The priority variable is an input, so changing it at any location reruns the filter.
+    priorities[2] = 10;
+    obsspace.put_db("MetaData", "priority", priorities);
+    EXPECT_EQUAL(applyIncrementally<Gaussian_Thinning>(obsspace, filterConf, {}), 6);
+    EXPECT_EQUAL(applyIncrementally<Gaussian_Thinning>(obsspace, filterConf, {}), 0);
+  }
+  // A new ObsSpace with the same name and contents must not reuse the results obtained for the
+  // previous one.
+  ioda::ObsSpace obsspace(obsSpaceConf, oops::mpi::world(), bgn, end, oops::mpi::myself());
+  obsspace.put_db("MetaData", "priority", priorities);
+  EXPECT_EQUAL(applyIncrementally<Gaussian_Thinning>(obsspace, filterConf, {}), 6);
+}
+
+class IncrementalFilters : public oops::Test {
+ private:
+  std::string testid() const override {return "ufo::test::IncrementalFilters";}
+
+  void register_tests() const override {
+    std::vector<eckit::testing::Test>& ts = eckit::testing::specification();
+
+    ts.emplace_back(CASE("ufo/IncrementalFilters/NotSupported") {
+                      testIncrementalModeNotSupported(::test::TestEnvironment::config());
+                    });
+    ts.emplace_back(CASE("ufo/IncrementalFilters/GaussianThinning") {
+                      testIncrementalGaussianThinning(::test::TestEnvironment::config());
+                    });
+    ts.emplace_back(CASE("ufo/IncrementalFilters/GaussianThinningWithPriority") {
+                      testIncrementalGaussianThinningWithPriority(
+                            ::test::TestEnvironment::config());
+                    });
+  }
+
+  void clear() const override {}
+};
+
+}  // namespace test
+}  // namespace ufo
+
+#endif  // TEST_UFO_INCREMENTALFILTERS_H_
@@ -0,0 +1,161 @@
+/*
+ * (C) Crown copyright 2021 Met Office. All rights reserved.
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ */
+
+#ifndef TEST_UFO_INSTRUMENTATION_H_
+#define TEST_UFO_INSTRUMENTATION_H_
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "eckit/config/LocalConfiguration.h"
+#include "eckit/config/YAMLConfiguration.h"
+#include "eckit/filesystem/PathName.h"
+#include "eckit/testing/Test.h"
+#include "oops/mpi/mpi.h"
+#include "oops/runs/Test.h"
+#include "oops/util/Expect.h"
+#include "ufo/utils/Instrumentation.h"
+
+namespace ufo {
+namespace test {
+
+/// Enables instrumentation for the lifetime of the object and discards the recorded data.
+class InstrumentationEnabler {
+ public:
+  InstrumentationEnabler() {
+    ufo::Instrumentation::instance().clear();
+    ufo::Instrumentation::instance().setEnabled(true);
+  }
+  ~InstrumentationEnabler() {
+    ufo::Instrumentation::instance().setEnabled(false);
+    ufo::Instrumentation::instance().clear();
+  }
+};
+
+void recordNestedRegions() {
+  for (int i = 0; i < 2; ++i) {
+    ufo::ScopedTimer outer("space", "FilterBase::doFilter", "ufo::Filter");
+    ufo::ScopedTimer::count("bytes read", 8);
+    {
+      ufo::ScopedTimer inner("space", "FilterBase::applyFilter", "ufo::Filter");
+      ufo::ScopedTimer::count("bytes read", 100);
+      ufo::ScopedTimer::count("allocations", 1);
+    }
+  }
+}
+
+CASE("ufo/Instrumentation/Disabled") {
+  ufo::Instrumentation::instance().setEnabled(false);
+  ufo::Instrumentation::instance().clear();
+  recordNestedRegions();
+  EXPECT(ufo::Instrumentation::instance().records("space").empty());
+}
+
+CASE("ufo/Instrumentation/NestedRegions") {
+  InstrumentationEnabler enabler;
+  recordNestedRegions();
+
+  typedef ufo::Instrumentation::Key Key;
+  const std::map<Key, ufo::Instrumentation::Record> records =
+      ufo::Instrumentation::instance().records("space");
+  EXPECT_EQUAL(records.size(), 2);
+  EXPECT(ufo::Instrumentation::instance().records("other space").empty());
+
+  const ufo::Instrumentation::Record &outer =
+      records.at(Key{"space", "FilterBase::doFilter", "ufo::Filter"});
+  const ufo::Instrumentation::Record &inner =
+      records.at(Key{"space", "FilterBase::applyFilter", "ufo::Filter"});
+  EXPECT_EQUAL(outer.calls, 2);
+  EXPECT_EQUAL(inner.calls, 2);
+  EXPECT(outer.seconds >= inner.seconds);
+  // Counters are attributed to the innermost region only.
+  EXPECT_EQUAL(outer.counters.at("bytes read"), 16);
+  EXPECT_EQUAL(outer.counters.count("allocations"), 0);
+  EXPECT_EQUAL(inner.counters.at("bytes read"), 200);
+  EXPECT_EQUAL(inner.counters.at("allocations"), 2);
+}
+
+CASE("ufo/Instrumentation/TypeLabel") {
+  InstrumentationEnabler enabler;
+  {
+    ufo::ScopedTimer timer("space", "ObsOperator::simulateObs", typeid(InstrumentationEnabler));
+  }
+  const auto records = ufo::Instrumentation::instance().records("space");
+  EXPECT_EQUAL(records.size(), 1);
+  EXPECT_EQUAL(records.begin()->first.label, "ufo::test::InstrumentationEnabler");
+}
+
+void checkReport(const std::string &fileName, size_t numRanks) {
+  const eckit::YAMLConfiguration report{eckit::PathName(fileName)};
+  EXPECT_EQUAL(report.getString("obs space"), "space");
+  EXPECT_EQUAL(static_cast<size_t>(report.getInt("number of ranks")), numRanks);
+
+  const std::vector<eckit::LocalConfiguration> regions = report.getSubConfigurations("regions");
+  EXPECT_EQUAL(regions.size(), 2);
+  // Regions are sorted by entry point.
+  EXPECT_EQUAL(regions[0].getString("entry point"), "FilterBase::applyFilter");
+  EXPECT_EQUAL(regions[1].getString("entry point"), "FilterBase::doFilter");
+  for (const eckit::LocalConfiguration &region : regions) {
+    EXPECT_EQUAL(region.getString("label"), "ufo::Filter");
+    const eckit::LocalConfiguration calls(region, "calls");
+    EXPECT_EQUAL(calls.getDouble("min"), 2);
+    EXPECT_EQUAL(calls.getDouble("max"), 2);
+    EXPECT_EQUAL(calls.getDouble("mean"), 2);
+    const eckit::LocalConfiguration seconds(region, "seconds");
+    EXPECT(seconds.getDouble("min") <= seconds.getDouble("mean"));
+    EXPECT(seconds.getDouble("mean") <= seconds.getDouble("max"));
+  }
+  const eckit::LocalConfiguration innerCounters(regions[0], "counters");
+  const eckit::LocalConfiguration bytesRead(innerCounters, "bytes read");
+  EXPECT_EQUAL(bytesRead.getDouble("max"), 200);
+  const eckit::LocalConfiguration outerCounters(regions[1], "counters");
+  EXPECT(!outerCounters.has("allocations"));
+}
+
+CASE("ufo/Instrumentation/JsonReport") {
+  InstrumentationEnabler enabler;
+  recordNestedRegions();
+  ufo::Instrumentation::instance().writeReport(oops::mpi::world(), "space",
+                                               "instrumentation_report.json");
+  oops::mpi::world().barrier();
+  checkReport("instrumentation_report.json", oops::mpi::world().size());
+}
+
+CASE("ufo/Instrumentation/YamlReport") {
+  InstrumentationEnabler enabler;
+  recordNestedRegions();
+  ufo::Instrumentation::instance().writeReport(oops::mpi::world(), "space",
+                                               "instrumentation_report.yaml", true);
+  oops::mpi::world().barrier();
+  checkReport("instrumentation_report.yaml", oops::mpi::world().size());
+}
+
+CASE("ufo/Instrumentation/LocalReport") {
+  InstrumentationEnabler enabler;
+  recordNestedRegions();
+  const std::string fileName =
+      "instrumentation_report_rank" + std::to_string(oops::mpi::world().rank()) + ".json";
+  ufo::Instrumentation::instance().writeLocalReport("space", fileName);
+  checkReport(fileName, 1);
+}
+
+class Instrumentation : public oops::Test {
+ public:
+  Instrumentation() {}
+
+ private:
+  std::string testid() const override {return "ufo::test::Instrumentation";}
+
+  void register_tests() const override {}
+
+  void clear() const override {}
+};
+
+}  // namespace test
+}  // namespace ufo
+
+#endif  // TEST_UFO_INSTRUMENTATION_H_
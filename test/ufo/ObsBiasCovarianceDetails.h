@@ -20,6 +20,7 @@
 #include "oops/runs/Test.h"
 #include "oops/util/DateTime.h"
 #include "oops/util/Duration.h"
+#include "oops/util/FloatCompare.h"
 #include "oops/util/Logger.h"
 #include "test/TestEnvironment.h"
 #include "ufo/ObsBias.h"
@@ -110,6 +111,47 @@ void testObsBiasCovarianceDetails() {
     EXPECT(ybias_inc.norm() - ybias_inc_3.norm() < tolerance);
     oops::Log::test() << "ufo::testObsBiasCovarianceDetails inverseMultiply is verified"
                       << std::endl;
+
+    // accept all obs. and linearize a new covariance for the second outer loop
+    const std::vector<int> accepted(odb.nlocs(), 0);
+    for ( const auto & var : vars)
+     odb.put_db("EffectiveQC0", var , accepted);
+    ObsBiasCovariance ybias_cov_2(odb, biasparams);
+
+    // retrieve the prior variances: B applied to a vector of ones
+    ObsBiasIncrement ones(ybias_inc);
+    ones.data().setConstant(1.0);
+    ObsBiasIncrement variances(ybias_inc);
+    ybias_cov_2.multiply(ones, variances);
+
+    ybias_cov_2.linearize(ybias, biaserrconf);
+
+    // All predictors and errors are 1, so for each variable the Hessian block is N 1 1^T, where
+    // N is the number of obs. With the prior variances v_p the analysis variances are
+    // 1 / (1 / v_p + N) if only its diagonal is used and, from the Sherman-Morrison formula,
+    // v_p - N v_p^2 / (1 + N \sum_q v_q) if the full block is used.
+    const bool fullHessian = biasparams.covariance.value()->fullHessian;
+    const double nobs = odb.globalNumLocs();
+    const std::size_t npreds = ybias_cov_2.predictorNames().size();
+    const std::vector<double> &analysisVariances = ybias_cov_2.analysisVariances();
+    ASSERT(analysisVariances.size() == variances.data().size());
+    std::size_t numDifferent = 0;
+    for (std::size_t jvar = 0; jvar < analysisVariances.size() / npreds; ++jvar) {
+      const double sumVariances = variances.data().segment(jvar*npreds, npreds).sum();
+      for (std::size_t p = 0; p < npreds; ++p) {
+        const double v = variances.data()[jvar*npreds + p];
+        const double diagonal = 1.0 / (1.0 / v + nobs);
+        const double full = v - nobs * v * v / (1.0 + nobs * sumVariances);
+        EXPECT(oops::is_close_relative(analysisVariances[jvar*npreds + p],
+                                       fullHessian ? full : diagonal, 1.0e-6));
+        if (!oops::is_close_relative(full, diagonal, 1.0e-3))
+          ++numDifferent;
+      }
+    }
+    // Make sure the two cases can be told apart
+    EXPECT(numDifferent > 0);
+    oops::Log::test() << "ufo::testObsBiasCovarianceDetails analysis variances are verified"
+                      << std::endl;
   }
 }
 
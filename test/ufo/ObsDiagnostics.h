@@ -9,6 +9,7 @@
 #define TEST_UFO_OBSDIAGNOSTICS_H_
 
 #include <memory>
+#include <set>
 #include <string>
 #include <vector>
 
@@ -21,6 +22,7 @@
 #include "oops/base/Variables.h"
 #include "oops/mpi/mpi.h"
 #include "oops/runs/Test.h"
+#include "oops/util/IntSetParser.h"
 #include "test/TestEnvironment.h"
 #include "ufo/GeoVaLs.h"
 #include "ufo/Locations.h"
@@ -106,6 +108,28 @@ void testObsDiagnostics() {
           ": difference between reference and computed: " << ref << std::endl;
     }
   }
+
+  // check that the tensors of multi-channel diagnostics hold the same values
+  if (diagconf.has("channels")) {
+    const std::set<int> channelSet = oops::parseIntSet(diagconf.getString("channels"));
+    const std::vector<int> channels(channelSet.begin(), channelSet.end());
+    for (const std::string & family : diagconf.getStringVector("variables")) {
+      const ObsDiagnosticsTensor & tensor = diags.getTensor(family, channels);
+      EXPECT_EQUAL(tensor.nchans(), channels.size());
+      EXPECT_EQUAL(tensor.nlocs(), nlocs);
+      for (size_t ichan = 0; ichan < channels.size(); ++ichan) {
+        const std::string var = family + "_" + std::to_string(channels[ichan]);
+        EXPECT_EQUAL(tensor.nlevs(), diags.nlevs(var));
+        for (size_t ilev = 0; ilev < tensor.nlevs(); ++ilev) {
+          std::vector<float> expected(nlocs);
+          diags.get(expected, var, ilev+1);
+          const std::vector<float> actual(tensor.slice(ichan, ilev),
+                                          tensor.slice(ichan, ilev) + nlocs);
+          EXPECT(actual == expected);
+        }
+      }
+    }
+  }
 }
 
 // -----------------------------------------------------------------------------
@@ -8,6 +8,7 @@
 #ifndef TEST_UFO_OBSFILTERDATA_H_
 #define TEST_UFO_OBSFILTERDATA_H_
 
+#include <algorithm>
 #include <string>
 #include <vector>
 
@@ -175,6 +176,15 @@ void testObsFilterData() {
         gval.get(ref, geovars.variable(jvar).variable(), nlevs);
         EXPECT(vec == ref);
       }
+///  all levels can also be retrieved at once with getAllLevels(var)
+      std::vector<float> allLevels;
+      data.getAllLevels(geovars.variable(jvar), allLevels);
+      EXPECT(allLevels.size() == static_cast<size_t>(nlevs) * ospace.nlocs());
+      for (int jlev = 0; jlev < nlevs; ++jlev) {
+        std::vector<float> ref(ospace.nlocs());
+        gval.get(ref, geovars.variable(jvar).variable(), jlev + 1);
+        EXPECT(std::equal(ref.begin(), ref.end(), allLevels.begin() + jlev * ospace.nlocs()));
+      }
     }
 
 ///  Check that associate(), has() and get() work on ObsDiags:
@@ -204,6 +214,15 @@ void testObsFilterData() {
         obsdiags.get(ref, diagvars.variable(jvar).variable(), nlevs);
         EXPECT(vec == ref);
       }
+///  all levels can also be retrieved at once with getAllLevels(var)
+      std::vector<float> allLevels;
+      data.getAllLevels(diagvars.variable(jvar), allLevels);
+      EXPECT(allLevels.size() == static_cast<size_t>(nlevs) * ospace.nlocs());
+      for (int jlev = 0; jlev < nlevs; ++jlev) {
+        std::vector<float> ref(ospace.nlocs());
+        obsdiags.get(ref, diagvars.variable(jvar).variable(), jlev + 1);
+        EXPECT(std::equal(ref.begin(), ref.end(), allLevels.begin() + jlev * ospace.nlocs()));
+      }
     }
   }
 }
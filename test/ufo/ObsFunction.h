@@ -31,6 +31,7 @@
 #include "ufo/GeoVaLs.h"
 #include "ufo/ObsDiagnostics.h"
 #include "ufo/ObsTraits.h"
+#include "ufo/utils/Instrumentation.h"
 
 namespace ufo {
 namespace test {
@@ -107,7 +108,22 @@ void testFunction() {
 
 ///  Compute function result through ObsFilterData
     ioda::ObsDataVector<float> vals_ofd(ospace, outputvars, "ObsFunction", false);
-    inputs.get(funcname, vals_ofd);
+    const bool wasEnabled = Instrumentation::instance().enabled();
+    Instrumentation::instance().setEnabled(true);
+    {
+      ScopedTimer timer(ospace.obsname(), "testFunction", "ObsFilterData::get");
+      inputs.get(funcname, vals_ofd);
+    }
+    Instrumentation::instance().setEnabled(wasEnabled);
+
+///  Check how many functions (including nested ones) were computed
+    if (obsfuncconf.has("expected number of evaluations")) {
+      const Instrumentation::Key key{ospace.obsname(), "testFunction", "ObsFilterData::get"};
+      const Instrumentation::Record record =
+          Instrumentation::instance().records(ospace.obsname()).at(key);
+      EXPECT_EQUAL(record.counters.at("ObsFunction evaluations"),
+                   obsfuncconf.getInt("expected number of evaluations"));
+    }
 
 ///  Read reference values from ObsSpace
     ioda::ObsDataVector<float> ref(ospace, outputvars, "TestReference");
@@ -8,6 +8,8 @@
 #ifndef TEST_UFO_PIECEWISELINEARINTERPOLATION_H_
 #define TEST_UFO_PIECEWISELINEARINTERPOLATION_H_
 
+#include <algorithm>
+#include <cmath>
 #include <string>
 #include <vector>
 
@@ -15,6 +17,8 @@
 #include "eckit/testing/Test.h"
 #include "oops/runs/Test.h"
 #include "oops/util/Expect.h"
+#include "oops/util/FloatCompare.h"
+#include "oops/util/missingValues.h"
 #include "test/TestEnvironment.h"
 #include "ufo/utils/PiecewiseLinearInterpolation.h"
 
@@ -60,6 +64,184 @@ CASE("ufo/PiecewiseLinearInterpolation/differentNumberOfAbscissasAndOrdinates")
   EXPECT_THROWS(ufo::PiecewiseLinearInterpolation({1.0, 2.0, 3.0}, {1.0, 2.0}));
 }
 
+CASE("ufo/PiecewiseLinearInterpolation/descendingAbscissas") {
+  ufo::PiecewiseLinearInterpolation interp({5.0, 1.0, -1.0}, {0.0, 4.0, 2.0});
+
+  EXPECT_EQUAL(interp(-10.0), 2.0);
+  EXPECT_EQUAL(interp(-1.0), 2.0);
+  EXPECT_EQUAL(interp(0.0), 3.0);
+  EXPECT_EQUAL(interp(1.0), 4.0);
+  EXPECT_EQUAL(interp(2.0), 3.0);
+  EXPECT_EQUAL(interp(10.0), 0.0);
+}
+
+CASE("ufo/PiecewiseLinearInterpolation/missingOrdinates") {
+  const double missing = util::missingValue(missing);
+  ufo::PiecewiseLinearInterpolation interp({0.0, 1.0, 2.0, 3.0}, {1.0, missing, 3.0, 4.0});
+
+  EXPECT_EQUAL(interp(-1.0), missing);
+  EXPECT_EQUAL(interp(0.5), missing);
+  EXPECT_EQUAL(interp(1.5), missing);
+  EXPECT_EQUAL(interp(2.5), 3.5);
+  EXPECT_EQUAL(interp(10.0), 4.0);
+}
+
+/// Transliteration of the Fortran routines vert_interp_weights and vert_interp_apply, formerly
+/// used by PiecewiseLinearInterpolation.
+template <typename T>
+T fortranVertInterp(const std::vector<T> &vec, const std::vector<T> &fvec, T obl) {
+  const size_t nlev = vec.size();
+  size_t wi = 0;
+  T wf = 0;
+  if (vec[0] < vec[nlev - 1]) {
+    if (obl < vec[0]) {
+      wi = 0;
+      wf = 1;
+    } else if (obl > vec[nlev - 1]) {
+      wi = nlev - 2;
+      wf = 0;
+    } else {
+      for (size_t k = 0; k < nlev - 1; ++k)
+        if (obl >= vec[k] && obl <= vec[k + 1])
+          wi = k;
+      wf = (vec[wi + 1] - obl) / (vec[wi + 1] - vec[wi]);
+    }
+  } else {
+    if (obl > vec[0]) {
+      wi = 0;
+      wf = 1;
+    } else if (obl < vec[nlev - 1]) {
+      wi = nlev - 2;
+      wf = 0;
+    } else {
+      for (size_t k = 0; k < nlev - 1; ++k)
+        if (obl >= vec[k + 1] && obl <= vec[k])
+          wi = k;
+      wf = (vec[wi + 1] - obl) / (vec[wi + 1] - vec[wi]);
+    }
+  }
+  const T missing = util::missingValue(missing);
+  if (fvec[wi] == missing || fvec[wi + 1] == missing)
+    return missing;
+  return fvec[wi] * wf + fvec[wi + 1] * (1 - wf);
+}
+
+/// Check that the kernel matches the Fortran implementation at and between all tabulated
+/// abscissas of \p abscissas and outside the tabulated range.
+template <typename T>
+void compareWithFortran(const std::vector<T> &abscissas, const std::vector<T> &ordinates) {
+  const T missing = util::missingValue(missing);
+  ufo::PiecewiseLinearKernel<T> kernel(abscissas, ordinates);
+  std::vector<T> testAbscissas;
+  for (size_t i = 0; i < abscissas.size(); ++i) {
+    testAbscissas.push_back(abscissas[i]);
+    if (i + 1 < abscissas.size())
+      testAbscissas.push_back((abscissas[i] + abscissas[i + 1]) / 2);
+  }
+  testAbscissas.push_back(abscissas.front() - (abscissas.back() - abscissas.front()));
+  testAbscissas.push_back(abscissas.back() + (abscissas.back() - abscissas.front()));
+
+  for (T x : testAbscissas) {
+    const T expected = fortranVertInterp(abscissas, ordinates, x);
+    // The Fortran code divides by zero at a run of equal abscissas ending the table.
+    if (std::isnan(expected))
+      continue;
+    const T actual = kernel(x);
+    if (expected == missing || actual == missing)
+      EXPECT_EQUAL(actual, expected);
+    else
+      EXPECT(oops::is_close_absolute(actual, expected, T(1e-5)));
+  }
+}
+
+CASE("ufo/PiecewiseLinearInterpolation/descendingAbscissasAtKnots") {
+  const double missing = util::missingValue(missing);
+  ufo::PiecewiseLinearInterpolation interp({20.0, 10.0, 0.0}, {missing, 2.0, 1.0});
+  // As in the Fortran code, the segment extending towards smaller abscissas is used at a knot.
+  EXPECT_EQUAL(interp(10.0), 2.0);
+  EXPECT_EQUAL(interp(5.0), 1.5);
+  EXPECT_EQUAL(interp(15.0), missing);
+  ufo::PiecewiseLinearInterpolation ascending({0.0, 10.0, 20.0}, {1.0, 2.0, missing});
+  EXPECT_EQUAL(ascending(10.0), missing);
+}
+
+CASE("ufo/PiecewiseLinearInterpolation/matchesFortran") {
+  const double missing = util::missingValue(missing);
+  const float missingFloat = util::missingValue(missingFloat);
+  // Ascending and descending tables, uniformly and non-uniformly spaced, with missing ordinates
+  // and runs of equal abscissas.
+  const std::vector<std::vector<double>> abscissaSets{
+    {0.0, 10.0, 20.0, 30.0, 40.0},
+    {0.0, 10.0, 10.0, 20.0, 35.0},
+    {0.0, 5.0, 5.0, 5.0, 20.0, 40.0},
+    {-3.0, 1.0, 2.0, 8.0}
+  };
+  const std::vector<std::vector<double>> ordinateSets{
+    {1.0, 2.0, missing, 4.0, 5.0, 6.0},
+    {missing, 2.0, 3.0, 4.0, 5.0, missing},
+    {1.0, 2.0, 3.0, missing, 5.0, 6.0},
+    {1.0, 3.0, 2.0, 7.0, 4.0, 5.0}
+  };
+  for (std::vector<double> abscissas : abscissaSets) {
+    for (bool descending : {false, true}) {
+      if (descending)
+        std::reverse(abscissas.begin(), abscissas.end());
+      for (std::vector<double> ordinates : ordinateSets) {
+        ordinates.resize(abscissas.size());
+        compareWithFortran(abscissas, ordinates);
+
+        std::vector<float> floatAbscissas(abscissas.begin(), abscissas.end());
+        std::vector<float> floatOrdinates;
+        for (double ordinate : ordinates)
+          floatOrdinates.push_back(ordinate == missing ? missingFloat
+                                                       : static_cast<float>(ordinate));
+        compareWithFortran(floatAbscissas, floatOrdinates);
+      }
+    }
+  }
+}
+
+CASE("ufo/PiecewiseLinearInterpolation/columns") {
+  ufo::PiecewiseLinearInterpolation interp({-1.0, 1.0, 5.0}, {2.0, 4.0, 0.0});
+
+  const std::vector<double> abscissas{-10.0, -1.0, 0.0, 1.0, 2.0, 5.0, 10.0};
+  const std::vector<double> expectedValues{2.0, 2.0, 3.0, 4.0, 3.0, 0.0, 0.0};
+  EXPECT_EQUAL(interp(abscissas), expectedValues);
+}
+
+CASE("ufo/PiecewiseLinearInterpolation/uniformAbscissas") {
+  // Uniformly spaced abscissas are located by direct indexing. Away from the perturbed point,
+  // the results must match those obtained by binary search over perturbed abscissas.
+  std::vector<float> uniformAbscissas, perturbedAbscissas, ordinates;
+  for (int i = 0; i <= 20; ++i) {
+    uniformAbscissas.push_back(0.1f * i);
+    perturbedAbscissas.push_back(0.1f * i);
+    ordinates.push_back(i * i);
+  }
+  perturbedAbscissas[11] += 0.02f;
+  ufo::PiecewiseLinearKernel<float> uniform(uniformAbscissas, ordinates);
+  ufo::PiecewiseLinearKernel<float> perturbed(perturbedAbscissas, ordinates);
+  EXPECT(uniform.hasUniformAbscissas());
+  EXPECT_NOT(perturbed.hasUniformAbscissas());
+
+  for (int i = 0; i <= 20; ++i)
+    EXPECT_EQUAL(uniform(uniformAbscissas[i]), ordinates[i]);
+
+  std::vector<float> abscissas;
+  for (int i = -10; i <= 230; ++i)
+    abscissas.push_back(0.01f * i);
+  std::vector<float> values(abscissas.size());
+  uniform.evaluate(abscissas.size(), abscissas.data(), values.data());
+  for (size_t i = 0; i < abscissas.size(); ++i) {
+    const float x = std::min(std::max(abscissas[i], 0.0f), 2.0f);
+    const int k = std::min(static_cast<int>(x / 0.1f), 19);
+    const float expected = k * k + (2 * k + 1) * (x - 0.1f * k) / 0.1f;
+    EXPECT(oops::is_close_absolute(values[i], expected, 1e-3f));
+    if (abscissas[i] < 1.0f || abscissas[i] > 1.2f)
+      EXPECT(oops::is_close_absolute(perturbed(abscissas[i]), values[i], 1e-3f));
+  }
+}
+
 class PiecewiseLinearInterpolation : public oops::Test {
  private:
   std::string testid() const override {return "ufo::test::PiecewiseLinearInterpolation";}
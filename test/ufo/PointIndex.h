@@ -0,0 +1,136 @@
+/*
+ * (C) Crown copyright 2021 Met Office. All rights reserved.
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ */
+
+#ifndef TEST_UFO_POINTINDEX_H_
+#define TEST_UFO_POINTINDEX_H_
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "eckit/testing/Test.h"
+#include "oops/runs/Test.h"
+#include "oops/util/Expect.h"
+#include "ufo/utils/Constants.h"
+#include "ufo/utils/PointIndex.h"
+
+namespace ufo {
+namespace test {
+
+typedef ufo::PointIndex<4>::Point Point4D;
+typedef ufo::PointIndex<4>::Extent Extent4D;
+
+/// Convert a latitude, longitude and pressure into the coordinates used by PoissonDiskThinning:
+/// three Cartesian coordinates on the surface of the Earth followed by the pressure.
+inline Point4D toPoint(float lat, float lon, float pressure) {
+  const float deg2rad = static_cast<float>(M_PI / 180.0);
+  const float earthRadius = ufo::Constants::mean_earth_rad;
+  const float sinLat = std::sin(deg2rad * lat), cosLat = std::cos(deg2rad * lat);
+  const float sinLon = std::sin(deg2rad * lon), cosLon = std::cos(deg2rad * lon);
+  return Point4D{earthRadius * cosLat * cosLon, earthRadius * cosLat * sinLon,
+                 earthRadius * sinLat, pressure};
+}
+
+/// Generate points concentrated around the poles and the dateline, plus some points on exactly
+/// these lines, and points spread over the whole globe.
+inline std::vector<Point4D> makePoints(std::mt19937 &generator) {
+  std::uniform_real_distribution<float> polarLat(85.0f, 90.0f);
+  std::uniform_real_distribution<float> anyLat(-90.0f, 90.0f);
+  std::uniform_real_distribution<float> anyLon(-180.0f, 180.0f);
+  std::uniform_real_distribution<float> datelineLonOffset(0.0f, 5.0f);
+  std::uniform_real_distribution<float> pressure(10000.0f, 10100.0f);
+  std::bernoulli_distribution coin;
+
+  std::vector<Point4D> points;
+  for (int i = 0; i < 300; ++i) {
+    const float lat = coin(generator) ? polarLat(generator) : -polarLat(generator);
+    points.push_back(toPoint(lat, anyLon(generator), pressure(generator)));
+  }
+  for (int i = 0; i < 300; ++i) {
+    const float lon = coin(generator) ? 180.0f - datelineLonOffset(generator)
+                                      : -180.0f + datelineLonOffset(generator);
+    points.push_back(toPoint(anyLat(generator), lon, pressure(generator)));
+  }
+  for (int i = 0; i < 300; ++i)
+    points.push_back(toPoint(anyLat(generator), anyLon(generator), pressure(generator)));
+  for (float lat : {-90.0f, -89.9f, 89.9f, 90.0f})
+    for (float lon : {-180.0f, -179.9f, 0.0f, 179.9f, 180.0f})
+      points.push_back(toPoint(lat, lon, 10050.0f));
+  std::shuffle(points.begin(), points.end(), generator);
+  return points;
+}
+
+/// Insert \p points one by one into a kd-tree and a grid index, as PoissonDiskThinning does,
+/// and check that both indices give the same answers to all exclusion-volume queries centred on
+/// each point before it is inserted.
+inline void compareIndices(const std::vector<Point4D> &points, const Extent4D &semiAxes,
+                           int numSpatialDims) {
+  ufo::KDTree<4> kdTree;
+  ufo::GridIndex<4> gridIndex(semiAxes);
+  size_t numQueriesWithPointsInInterior = 0;
+  for (const Point4D &point : points) {
+    const bool kdTreeInEllipsoid = kdTree.isAnyPointInEllipsoidInterior(point, semiAxes);
+    const bool gridInEllipsoid = gridIndex.isAnyPointInEllipsoidInterior(point, semiAxes);
+    EXPECT_EQUAL(gridInEllipsoid, kdTreeInEllipsoid);
+
+    const bool kdTreeInCylinder =
+        kdTree.isAnyPointInCylinderInterior(point, semiAxes, numSpatialDims);
+    const bool gridInCylinder =
+        gridIndex.isAnyPointInCylinderInterior(point, semiAxes, numSpatialDims);
+    EXPECT_EQUAL(gridInCylinder, kdTreeInCylinder);
+
+    if (kdTreeInEllipsoid || kdTreeInCylinder)
+      ++numQueriesWithPointsInInterior;
+    kdTree.insert(point);
+    gridIndex.insert(point);
+  }
+  // Make sure the comparison isn't vacuous.
+  EXPECT(numQueriesWithPointsInInterior > 0);
+  EXPECT(numQueriesWithPointsInInterior < points.size());
+}
+
+CASE("ufo/PointIndex/GridIndexMatchesKDTree") {
+  std::mt19937 generator(12345);
+  const std::vector<Point4D> points = makePoints(generator);
+
+  // Horizontal spacings of 100 km and 500 km, vertical spacings of 10 Pa and 50 Pa.
+  for (float horizontalSpacing : {100.0f, 500.0f}) {
+    for (float verticalSpacing : {10.0f, 50.0f}) {
+      const Extent4D semiAxes{horizontalSpacing, horizontalSpacing, horizontalSpacing,
+                              verticalSpacing};
+      compareIndices(points, semiAxes, 3);
+    }
+  }
+}
+
+CASE("ufo/PointIndex/GridIndexMatchesKDTreeOnCellBoundaries") {
+  // Points lying exactly on cell boundaries and on the boundaries of the query volumes.
+  std::vector<Point4D> points;
+  for (float x : {-2.0f, -1.0f, 0.0f, 1.0f, 2.0f})
+    for (float y : {-1.0f, 0.0f, 1.0f})
+      points.push_back(Point4D{x, y, 0.0f, 0.5f * x});
+  compareIndices(points, Extent4D{2.0f, 2.0f, 2.0f, 1.0f}, 3);
+  compareIndices(points, Extent4D{2.0f, 2.0f, 2.0f, 1.0f}, 2);
+}
+
+class PointIndex : public oops::Test {
+ public:
+  PointIndex() {}
+
+ private:
+  std::string testid() const override {return "ufo::test::PointIndex";}
+
+  void register_tests() const override {}
+
+  void clear() const override {}
+};
+
+}  // namespace test
+}  // namespace ufo
+
+#endif  // TEST_UFO_POINTINDEX_H_
@@ -0,0 +1,258 @@
+/*
+ * (C) Crown copyright 2021 Met Office. All rights reserved.
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ */
+
+#ifndef TEST_UFO_PROBABILITYOFGROSSERROR_H_
+#define TEST_UFO_PROBABILITYOFGROSSERROR_H_
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "eckit/testing/Test.h"
+#include "oops/runs/Test.h"
+#include "oops/util/Expect.h"
+#include "oops/util/missingValues.h"
+#include "ufo/utils/metoffice/MetOfficeQCFlags.h"
+#include "ufo/utils/ProbabilityOfGrossError.h"
+
+namespace ufo {
+namespace test {
+
+/// Straightforward implementation of the Bayesian PGE update, processing one location at a time.
+/// BayesianPGEUpdate() must reproduce its results exactly.
+inline void referenceBayesianPGEUpdate(const ufo::ProbabilityOfGrossErrorParameters &options,
+                                       const std::vector<float> &obsVal,
+                                       const std::vector<float> &obsErr,
+                                       const std::vector<float> &bkgVal,
+                                       const std::vector<float> &bkgErr,
+                                       const std::vector<float> &PdBad,
+                                       const bool ModelLevels,
+                                       std::vector<int> &flags,
+                                       std::vector<float> &PGE,
+                                       std::vector<float> &PGEBd,
+                                       float ErrVarMax,
+                                       const std::vector<float> *obsVal2,
+                                       const std::vector<float> *bkgVal2) {
+  const float missingValueFloat = util::missingValue(1.0f);
+  const double PGEMult = 1000.0;
+  const double PGEMDI = 1.111;
+  const double ExpArgMax = options.PGE_ExpArgMax.value();
+  const double PGECrit = options.PGE_PGECrit.value();
+  const float ObErrMult = options.PGE_ObErrMult.value();
+  const float BkgErrMult = options.PGE_BkgErrMult.value();
+  const double SDiffCrit = obsVal2 && bkgVal2 ?
+    options.PGE_SDiffCrit.value() * 2.0 :
+    options.PGE_SDiffCrit.value();
+
+  PGEBd.assign(obsVal.size(), PGEMDI);
+  for (size_t jloc = 0; jloc < obsVal.size(); ++jloc) {
+    float ErrVar = missingValueFloat;
+    if (obsErr[jloc] >= 0 && bkgErr[jloc] >= 0)
+      ErrVar = std::pow(ObErrMult * obsErr[jloc], 2) + std::pow(BkgErrMult * bkgErr[jloc], 2);
+    if (ErrVarMax > 0.0)
+      ErrVar = std::min(ErrVar, ErrVarMax);
+
+    double SDiff, PGEBk;
+    if (obsVal[jloc] != missingValueFloat && bkgVal[jloc] != missingValueFloat &&
+        ErrVar != missingValueFloat) {
+      double PdGood;
+      if (obsVal2 && bkgVal2 &&
+          (*obsVal2)[jloc] != missingValueFloat && (*bkgVal2)[jloc] != missingValueFloat) {
+        SDiff = (std::pow(obsVal[jloc] - bkgVal[jloc], 2) +
+                 std::pow((*obsVal2)[jloc] - (*bkgVal2)[jloc], 2)) / static_cast<double>(ErrVar);
+        PdGood = std::exp(-0.5 * std::min(SDiff, 2.0 * ExpArgMax)) / (2.0 * M_PI * ErrVar);
+      } else {
+        SDiff = std::pow(obsVal[jloc] - bkgVal[jloc], 2) / ErrVar;
+        PdGood = std::exp(-0.5 * std::min(SDiff, 2.0 * ExpArgMax)) /
+          std::sqrt(2.0 * M_PI * ErrVar);
+      }
+      PGEBk = (PdBad[jloc] * PGE[jloc]) /
+        (PdBad[jloc] * PGE[jloc] + PdGood * (1.0 - PGE[jloc]));
+      flags[jloc] |= ufo::MetOfficeQCFlags::Elem::BackPerfFlag;
+      if (PGEBk >= PGECrit)
+        flags[jloc] |= ufo::MetOfficeQCFlags::Elem::BackRejectFlag;
+    } else {
+      SDiff = SDiffCrit;
+      PGEBk = PGEMDI;
+    }
+    PGE[jloc] = trunc(PGEBk * PGEMult) + PGE[jloc];
+    if (ModelLevels &&
+        (SDiff >= SDiffCrit ||
+         flags[jloc] & ufo::MetOfficeQCFlags::Elem::PermRejectFlag ||
+         flags[jloc] & ufo::MetOfficeQCFlags::Elem::FinalRejectFlag)) {
+      PGEBk = PGEMDI;
+      flags[jloc] |= ufo::MetOfficeQCFlags::Elem::FinalRejectFlag;
+    }
+    PGEBd[jloc] = PGEBk;
+  }
+}
+
+/// Inputs and outputs of a Bayesian PGE update.
+struct PGEData {
+  std::vector<float> obsVal, obsErr, bkgVal, bkgErr, obsVal2, bkgVal2, PdBad;
+  std::vector<int> flags;
+  std::vector<float> PGE, PGEBd;
+};
+
+/// Generate \p n random observations. About one in ten inputs is missing (or, for errors,
+/// negative). Some departures are large enough for the observations to be rejected.
+inline PGEData makePGEData(size_t n, std::mt19937 &generator) {
+  const float missing = util::missingValue(1.0f);
+  std::uniform_real_distribution<float> value(270.0f, 290.0f);
+  std::uniform_real_distribution<float> departure(-15.0f, 15.0f);
+  std::uniform_real_distribution<float> error(0.5f, 3.0f);
+  std::uniform_real_distribution<float> probability(0.001f, 0.5f);
+  std::bernoulli_distribution isMissing(0.1);
+  auto maybeMissing = [&](float x) { return isMissing(generator) ? missing : x; };
+
+  PGEData data;
+  for (size_t i = 0; i < n; ++i) {
+    const float bkg = value(generator);
+    data.bkgVal.push_back(maybeMissing(bkg));
+    data.obsVal.push_back(maybeMissing(bkg + departure(generator)));
+    data.bkgErr.push_back(isMissing(generator) ? -1.0f : error(generator));
+    data.obsErr.push_back(maybeMissing(error(generator)));
+    const float bkg2 = value(generator);
+    data.bkgVal2.push_back(maybeMissing(bkg2));
+    data.obsVal2.push_back(maybeMissing(bkg2 + departure(generator)));
+    data.PdBad.push_back(probability(generator) * 0.01f);
+    data.PGE.push_back(probability(generator));
+    data.flags.push_back(isMissing(generator) ? ufo::MetOfficeQCFlags::Elem::PermRejectFlag : 0);
+  }
+  return data;
+}
+
+inline void expectSameResults(const PGEData &actual, const PGEData &expected) {
+  EXPECT_EQUAL(actual.flags, expected.flags);
+  EXPECT_EQUAL(actual.PGE, expected.PGE);
+  EXPECT_EQUAL(actual.PGEBd, expected.PGEBd);
+}
+
+CASE("ufo/ProbabilityOfGrossError/clampedExp") {
+  for (double x = -700.0; x <= 700.0; x += 0.37) {
+    const double expected = std::exp(x);
+    EXPECT(std::abs(ufo::clampedExp(x) - expected) <=
+           4 * std::numeric_limits<double>::epsilon() * expected);
+  }
+  for (double x : {-1e-300, 0.0, 1e-300, 0.5 * std::log(2.0), -0.5 * std::log(2.0)})
+    EXPECT(std::abs(ufo::clampedExp(x) - std::exp(x)) <=
+           4 * std::numeric_limits<double>::epsilon() * std::exp(x));
+  // Arguments outside [-700, 700] are clamped.
+  EXPECT_EQUAL(ufo::clampedExp(-1000.0), ufo::clampedExp(-700.0));
+  EXPECT_EQUAL(ufo::clampedExp(1000.0), ufo::clampedExp(700.0));
+  EXPECT(ufo::clampedExp(-1000.0) > 0.0);
+  EXPECT(std::isfinite(ufo::clampedExp(1000.0)));
+}
+
+CASE("ufo/ProbabilityOfGrossError/BatchMatchesReference") {
+  ufo::ProbabilityOfGrossErrorParameters options;
+  std::mt19937 generator(1);
+  // More than one tile, with a partial last tile.
+  const PGEData input = makePGEData(1000, generator);
+
+  for (bool vectorObs : {false, true}) {
+    for (bool modelLevels : {false, true}) {
+      for (float errVarMax : {-1.0f, 4.0f}) {
+        PGEData expected = input;
+        referenceBayesianPGEUpdate(options, expected.obsVal, expected.obsErr, expected.bkgVal,
+                                   expected.bkgErr, expected.PdBad, modelLevels, expected.flags,
+                                   expected.PGE, expected.PGEBd, errVarMax,
+                                   vectorObs ? &expected.obsVal2 : nullptr,
+                                   vectorObs ? &expected.bkgVal2 : nullptr);
+
+        PGEData actual = input;
+        ufo::BayesianPGEUpdate(options, actual.obsVal, actual.obsErr, actual.bkgVal,
+                               actual.bkgErr, actual.PdBad, modelLevels, actual.flags,
+                               actual.PGE, actual.PGEBd, errVarMax,
+                               vectorObs ? &actual.obsVal2 : nullptr,
+                               vectorObs ? &actual.bkgVal2 : nullptr);
+        expectSameResults(actual, expected);
+
+        // Make sure the comparison isn't vacuous.
+        const auto isRejected = [](int flags) {
+          return (flags & ufo::MetOfficeQCFlags::Elem::BackRejectFlag) != 0;
+        };
+        EXPECT(std::any_of(actual.flags.begin(), actual.flags.end(), isRejected));
+        EXPECT(!std::all_of(actual.flags.begin(), actual.flags.end(), isRejected));
+      }
+    }
+  }
+}
+
+CASE("ufo/ProbabilityOfGrossError/BatchWithIndices") {
+  ufo::ProbabilityOfGrossErrorParameters options;
+  std::mt19937 generator(2);
+  const PGEData input = makePGEData(700, generator);
+  const float PdBadValue = 1e-3f;
+
+  // Process every third location, in place.
+  std::vector<size_t> indices;
+  for (size_t i = 0; i < input.obsVal.size(); i += 3)
+    indices.push_back(i);
+
+  PGEData actual = input;
+  actual.PGEBd.assign(input.obsVal.size(), -1.0f);
+  ufo::BayesianPGEBatch batch;
+  batch.size = indices.size();
+  batch.indices = indices.data();
+  batch.obsVal = actual.obsVal.data();
+  batch.obsErr = actual.obsErr.data();
+  batch.bkgVal = actual.bkgVal.data();
+  batch.bkgErr = actual.bkgErr.data();
+  batch.obsVal2 = actual.obsVal2.data();
+  batch.bkgVal2 = actual.bkgVal2.data();
+  batch.PdBadValue = PdBadValue;
+  batch.flags = actual.flags.data();
+  batch.PGE = actual.PGE.data();
+  batch.PGEBd = actual.PGEBd.data();
+  ufo::BayesianPGEUpdate(options, batch, true);
+
+  // Apply the reference implementation to copies of the selected locations.
+  PGEData reduced;
+  for (size_t i : indices) {
+    reduced.obsVal.push_back(input.obsVal[i]);
+    reduced.obsErr.push_back(input.obsErr[i]);
+    reduced.bkgVal.push_back(input.bkgVal[i]);
+    reduced.bkgErr.push_back(input.bkgErr[i]);
+    reduced.obsVal2.push_back(input.obsVal2[i]);
+    reduced.bkgVal2.push_back(input.bkgVal2[i]);
+    reduced.PdBad.push_back(PdBadValue);
+    reduced.flags.push_back(input.flags[i]);
+    reduced.PGE.push_back(input.PGE[i]);
+  }
+  referenceBayesianPGEUpdate(options, reduced.obsVal, reduced.obsErr, reduced.bkgVal,
+                             reduced.bkgErr, reduced.PdBad, true, reduced.flags, reduced.PGE,
+                             reduced.PGEBd, -1.0f, &reduced.obsVal2, &reduced.bkgVal2);
+
+  PGEData expected = input;
+  expected.PGEBd.assign(input.obsVal.size(), -1.0f);
+  for (size_t j = 0; j < indices.size(); ++j) {
+    expected.flags[indices[j]] = reduced.flags[j];
+    expected.PGE[indices[j]] = reduced.PGE[j];
+    expected.PGEBd[indices[j]] = reduced.PGEBd[j];
+  }
+  expectSameResults(actual, expected);
+}
+
+class ProbabilityOfGrossError : public oops::Test {
+ public:
+  ProbabilityOfGrossError() {}
+
+ private:
+  std::string testid() const override {return "ufo::test::ProbabilityOfGrossError";}
+
+  void register_tests() const override {}
+
+  void clear() const override {}
+};
+
+}  // namespace test
+}  // namespace ufo
+
+#endif  // TEST_UFO_PROBABILITYOFGROSSERROR_H_
@@ -67,6 +67,11 @@ void testProcessWhere(const eckit::LocalConfiguration &conf,
       const int size = std::count(result.begin(), result.end(), true);
       oops::Log::info() << "reference: " << size_ref << ", compare with " << size << std::endl;
       EXPECT(size == size_ref);
+
+      // Evaluating the compiled clauses repeatedly must give the same result
+      const CompiledWhere compiledWhere(params.where);
+      EXPECT(compiledWhere.evaluate(data) == result);
+      EXPECT(compiledWhere.evaluate(data) == result);
     }
   }
 }
@@ -0,0 +1,77 @@
+/*
+ * (C) Crown copyright 2021 Met Office. All rights reserved.
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ */
+
+#ifndef TEST_UFO_RECORDINDEX_H_
+#define TEST_UFO_RECORDINDEX_H_
+
+#include <string>
+#include <vector>
+
+#include "eckit/testing/Test.h"
+#include "oops/runs/Test.h"
+#include "oops/util/Expect.h"
+#include "oops/util/missingValues.h"
+#include "ufo/utils/RecordIndex.h"
+
+namespace ufo {
+namespace test {
+
+inline std::vector<size_t> toVector(const ufo::RecordIndex::Record &record) {
+  return std::vector<size_t>(record.begin(), record.end());
+}
+
+CASE("ufo/RecordIndex/Slices") {
+  const ufo::RecordIndex index({3, 5, 8}, {0, 2, 2, 5}, {4, 0, 1, 3, 2});
+
+  EXPECT_EQUAL(index.numRecords(), 3);
+  EXPECT_EQUAL(index.recordNumber(0), 3);
+  EXPECT_EQUAL(index.recordNumber(2), 8);
+  EXPECT_EQUAL(toVector(index[0]), (std::vector<size_t>{4, 0}));
+  EXPECT(index[1].empty());
+  EXPECT_EQUAL(index[2].size(), 3);
+  EXPECT_EQUAL(index[2][1], 3);
+  EXPECT_EQUAL(toVector(index[2]), (std::vector<size_t>{1, 3, 2}));
+}
+
+CASE("ufo/RecordIndex/SortedBy") {
+  const float missing = util::missingValue(missing);
+  const ufo::RecordIndex index({0, 1}, {0, 4, 6}, {0, 1, 2, 3, 4, 5});
+  const std::vector<float> pressure{500.0f, missing, 850.0f, 500.0f, 300.0f, 200.0f};
+
+  const ufo::RecordIndex ascending =
+      index.sortedBy(pressure, ufo::RecordIndex::SortOrder::ASCENDING);
+  EXPECT_EQUAL(toVector(ascending[0]), (std::vector<size_t>{0, 3, 2, 1}));
+  EXPECT_EQUAL(toVector(ascending[1]), (std::vector<size_t>{5, 4}));
+
+  const ufo::RecordIndex descending =
+      index.sortedBy(pressure, ufo::RecordIndex::SortOrder::DESCENDING);
+  EXPECT_EQUAL(toVector(descending[0]), (std::vector<size_t>{2, 0, 3, 1}));
+  EXPECT_EQUAL(toVector(descending[1]), (std::vector<size_t>{4, 5}));
+  EXPECT_EQUAL(descending.offsets(), index.offsets());
+}
+
+CASE("ufo/RecordIndex/InconsistentOffsets") {
+  EXPECT_THROWS(ufo::RecordIndex({0, 1}, {0, 2}, {0, 1}));
+  EXPECT_THROWS(ufo::RecordIndex({0, 1}, {0, 2, 3}, {0, 1}));
+  EXPECT_THROWS(ufo::RecordIndex({0, 1}, {0, 2, 1}, {0, 1}));
+}
+
+class RecordIndex : public oops::Test {
+ public:
+  RecordIndex() {}
+
+ private:
+  std::string testid() const override {return "ufo::test::RecordIndex";}
+
+  void register_tests() const override {}
+
+  void clear() const override {}
+};
+
+}  // namespace test
+}  // namespace ufo
+
+#endif  // TEST_UFO_RECORDINDEX_H_
@@ -10,10 +10,14 @@
 
 #include "ufo/utils/RecursiveSplitter.h"
 
+#include <algorithm>
+#include <cstdint>
 #include <iomanip>
 #include <memory>
+#include <numeric>
 #include <set>
 #include <string>
+#include <tuple>
 #include <vector>
 
 #include "eckit/testing/Test.h"
@@ -235,6 +239,47 @@ CASE("ufo/RecursiveSplitter/Recurse") {
   orderedComparison(splitter, expected);
 }
 
+CASE("ufo/RecursiveSplitter/SortGroupsByKeys") {
+  // Enough elements to exercise both the radix sort and the comparison sort.
+  const size_t numIds = 1000;
+  std::vector<int> categories(numIds);
+  std::vector<float> primaryKeys(numIds);
+  std::vector<int64_t> secondaryKeys(numIds);
+  for (size_t id = 0; id < numIds; ++id) {
+    categories[id] = (id * 7) % 3 + (id < 10 ? 3 : 0);
+    primaryKeys[id] = 0.5f * (static_cast<int>((id * 13) % 11) - 5);
+    if (id % 4 == 0 && primaryKeys[id] == 0.0f)
+      primaryKeys[id] = -0.0f;
+    secondaryKeys[id] = static_cast<int64_t>((id * 17) % 5) - 2;
+  }
+
+  ufo::RecursiveSplitter splitter(numIds);
+  splitter.groupBy(categories);
+  splitter.sortGroupsByKeys(primaryKeys, secondaryKeys);
+
+  // Compare against a reference ordering obtained with std::stable_sort.
+  std::vector<size_t> ids(numIds);
+  std::iota(ids.begin(), ids.end(), 0);
+  std::stable_sort(ids.begin(), ids.end(),
+                   [&](size_t a, size_t b) {
+                     return std::make_tuple(categories[a], primaryKeys[a], secondaryKeys[a]) <
+                            std::make_tuple(categories[b], primaryKeys[b], secondaryKeys[b]);
+                   });
+  std::vector<std::vector<size_t>> expected;
+  for (size_t i = 0; i < numIds; ++i) {
+    if (i == 0 || categories[ids[i]] != categories[ids[i - 1]])
+      expected.emplace_back();
+    expected.back().push_back(ids[i]);
+  }
+
+  std::vector<std::vector<size_t>> actual;
+  for (const auto &group : splitter.groups())
+    actual.emplace_back(group.begin(), group.end());
+  std::sort(expected.begin(), expected.end());
+  std::sort(actual.begin(), actual.end());
+  EXPECT(actual == expected);
+}
+
 
 class RecursiveSplitter : public oops::Test {
  public:
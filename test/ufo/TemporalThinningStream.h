@@ -0,0 +1,90 @@
+/*
+ * (C) Crown copyright 2021 Met Office. All rights reserved.
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ */
+
+#ifndef TEST_UFO_TEMPORALTHINNINGSTREAM_H_
+#define TEST_UFO_TEMPORALTHINNINGSTREAM_H_
+
+#include <string>
+#include <vector>
+
+#define ECKIT_TESTING_SELF_REGISTER_CASES 0
+
+#include <boost/optional.hpp>
+
+#include "eckit/config/LocalConfiguration.h"
+#include "eckit/testing/Test.h"
+#include "oops/runs/Test.h"
+#include "oops/util/DateTime.h"
+#include "oops/util/Expect.h"
+#include "test/TestEnvironment.h"
+#include "ufo/filters/TemporalThinningParameters.h"
+#include "ufo/filters/TemporalThinningStream.h"
+
+namespace ufo {
+namespace test {
+
+/// Pass the observations listed in \p conf to a TemporalThinningStream and check that it rejects
+/// the expected observations, in the expected order.
+void thinStream(const eckit::LocalConfiguration &conf) {
+  ufo::TemporalThinningParameters options;
+  options.validateAndDeserialize(eckit::LocalConfiguration(conf, "TemporalThinning"));
+  ufo::TemporalThinningStream stream(options);
+
+  const std::vector<std::string> stations = conf.getStringVector("stations");
+  const std::vector<std::string> datetimes = conf.getStringVector("datetimes");
+  std::vector<int> priorities(stations.size(), 0);
+  if (conf.has("priority"))
+    priorities = conf.getIntVector("priority");
+  ASSERT(datetimes.size() == stations.size() && priorities.size() == stations.size());
+
+  std::vector<size_t> rejectedObsIndices;
+  for (size_t obsIndex = 0; obsIndex < stations.size(); ++obsIndex) {
+    const boost::optional<size_t> rejectedObsIndex = stream.add(
+          stations[obsIndex], obsIndex, util::DateTime(datetimes[obsIndex]),
+          priorities[obsIndex]);
+    if (rejectedObsIndex != boost::none)
+      rejectedObsIndices.push_back(*rejectedObsIndex);
+  }
+
+  const std::vector<size_t> expectedRejectedObsIndices =
+      conf.getUnsignedVector("expected_rejected_obs_indices");
+  EXPECT_EQUAL(rejectedObsIndices, expectedRejectedObsIndices);
+}
+
+void testTemporalThinningStream(const eckit::LocalConfiguration &conf) {
+  if (conf.has("expect_exception_with_message")) {
+    const std::string expectedMessage = conf.getString("expect_exception_with_message");
+    EXPECT_THROWS_MSG(thinStream(conf), expectedMessage.c_str());
+  } else {
+    thinStream(conf);
+  }
+}
+
+class TemporalThinningStream : public oops::Test {
+ private:
+  std::string testid() const override {return "ufo::test::TemporalThinningStream";}
+
+  void register_tests() const override {
+    std::vector<eckit::testing::Test>& ts = eckit::testing::specification();
+
+    const eckit::LocalConfiguration conf(::test::TestEnvironment::config());
+    for (const std::string & testCaseName : conf.keys())
+    {
+      const eckit::LocalConfiguration testCaseConf(::test::TestEnvironment::config(), testCaseName);
+      ts.emplace_back(CASE("ufo/TemporalThinningStream/" + testCaseName, testCaseConf)
+                      {
+                        testTemporalThinningStream(testCaseConf);
+                      });
+    }
+  }
+
+  void clear() const override {}
+};
+
+}  // namespace test
+}  // namespace ufo
+
+#endif  // TEST_UFO_TEMPORALTHINNINGSTREAM_H_
@@ -0,0 +1,86 @@
+/*
+ * (C) Crown copyright 2021 Met Office. All rights reserved.
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ */
+
+#ifndef TEST_UFO_VARIABLEREGISTRY_H_
+#define TEST_UFO_VARIABLEREGISTRY_H_
+
+#include <string>
+#include <vector>
+
+#include "eckit/testing/Test.h"
+#include "oops/base/Variables.h"
+#include "oops/runs/Test.h"
+#include "oops/util/Expect.h"
+#include "ufo/filters/Variable.h"
+#include "ufo/filters/Variables.h"
+#include "ufo/utils/VariableRegistry.h"
+
+namespace ufo {
+namespace test {
+
+CASE("ufo/VariableRegistry/Intern") {
+  ufo::VariableRegistry &registry = ufo::VariableRegistry::instance();
+  const VariableHandle t = registry.intern("air_temperature", "ObsValue");
+  const VariableHandle bt1 = registry.intern("brightness_temperature", "ObsValue", 1);
+  const VariableHandle bt2 = registry.intern("brightness_temperature", "ObsValue", 2);
+  const VariableHandle bt1HofX = registry.intern("brightness_temperature", "HofX", 1);
+
+  EXPECT(t != bt1);
+  EXPECT(bt1 != bt2);
+  EXPECT(bt1 != bt1HofX);
+  EXPECT(registry.intern("brightness_temperature", "ObsValue", 1) == bt1);
+
+  EXPECT_EQUAL(registry.variable(t), "air_temperature");
+  EXPECT_EQUAL(registry.group(t), "ObsValue");
+  EXPECT_EQUAL(registry.channel(t), ufo::VariableRegistry::noChannel);
+  EXPECT_EQUAL(registry.variable(bt2), "brightness_temperature_2");
+  EXPECT_EQUAL(registry.group(bt1HofX), "HofX");
+  EXPECT_EQUAL(registry.channel(bt2), 2);
+}
+
+CASE("ufo/VariableRegistry/Variables") {
+  ufo::Variables vars;
+  vars += ufo::Variable("air_temperature@HofX");
+  vars += ufo::Variable("brightness_temperature@HofX", {3, 5});
+  const std::vector<VariableHandle> handles = vars.handles();
+  EXPECT_EQUAL(handles.size(), vars.nvars());
+
+  const ufo::VariableRegistry &registry = ufo::VariableRegistry::instance();
+  for (size_t jv = 0; jv < vars.nvars(); ++jv) {
+    EXPECT(handles[jv] == vars.variable(jv).handle());
+    EXPECT_EQUAL(registry.variable(handles[jv]), vars.variable(jv).variable());
+    EXPECT_EQUAL(registry.group(handles[jv]), "HofX");
+  }
+}
+
+CASE("ufo/VariableRegistry/findVariables") {
+  const oops::Variables observed({"brightness_temperature_5", "air_temperature",
+                                  "brightness_temperature_3"});
+  ufo::Variables vars;
+  vars += ufo::Variable("air_temperature@ObsValue");
+  vars += ufo::Variable("brightness_temperature@ObsValue", {3, 5});
+  EXPECT_EQUAL(findVariables(observed, vars.handles()), (std::vector<size_t>{1, 2, 0}));
+
+  const ufo::Variable missing("brightness_temperature@ObsValue", {4});
+  EXPECT_THROWS(findVariables(observed, {missing.handle()}));
+}
+
+class VariableRegistry : public oops::Test {
+ public:
+  VariableRegistry() {}
+
+ private:
+  std::string testid() const override {return "ufo::test::VariableRegistry";}
+
+  void register_tests() const override {}
+
+  void clear() const override {}
+};
+
+}  // namespace test
+}  // namespace ufo
+
+#endif  // TEST_UFO_VARIABLEREGISTRY_H_